@@ -35,6 +35,7 @@
 #endif // _WIN32
 
 // libcomp Includes
+#include <BlowfishEcb.h>
 #include <DatabaseMariaDB.h>
 #include <DatabaseSQLite3.h>
 #include <Decrypt.h>
@@ -122,6 +123,26 @@ bool BaseServer::Initialize()
     // Create the generic workers
     CreateWorkers();
 
+    // Create the network reactors
+    CreateReactors();
+
+    // Buffer what each connection receives so one read can hold many packets
+    TcpConnection::SetReceiveBufferSize(mConfig->GetReceiveBufferSize());
+
+    // Limit how much each connection may have encrypted but not yet sent
+    TcpConnection::SetSendBudget(mConfig->GetSendBudget());
+
+    // Time the Blowfish engines now instead of on the first packet
+    LOG_DEBUG(String("Using the %1 Blowfish engine\n").Arg(
+        BlowfishEcb::GetEngineName(BlowfishEcb::GetEngine())));
+
+    // Keep the handshake math of new connections off the network threads
+    if(mConfig->GetMultithreadMode())
+    {
+        SetHandshakeThreads(mConfig->GetHandshakeThreads(),
+            mConfig->GetHandshakeKeyPairs());
+    }
+
     // Add the server as a system manager for libcomp::Message::Init.
     mMainWorker.AddManager(std::dynamic_pointer_cast<Manager>(
         shared_from_this()));
@@ -290,8 +311,8 @@ int BaseServer::Run()
     // Cleanup for any other tasks that should run in the main thread.
     Cleanup();
 
-    // Stop the network service (this will kill any existing connections).
-    mService.stop();
+    // Stop the network services (this will kill any existing connections).
+    StopReactors();
 
     return 0;
 }
@@ -407,6 +428,11 @@ bool BaseServer::ReadConfig(std::shared_ptr<objects::ServerConfig> config, tinyx
             log->SetLogPath(config->GetLogFile(), !config->GetLogFileAppend());
             log->SetLogFileTimestampsEnabled(config->GetLogFileTimestamp());
         }
+
+        if(config->GetLogAsync())
+        {
+            log->StartAsync((size_t)config->GetLogQueueSize());
+        }
     }
 
     return true;
@@ -443,6 +469,29 @@ void BaseServer::CreateWorkers()
     }
 }
 
+void BaseServer::CreateReactors()
+{
+    uint32_t numberOfReactors = 1;
+    if(mConfig->GetMultithreadMode())
+    {
+        numberOfReactors = mConfig->GetNetworkThreads();
+        if(0 == numberOfReactors)
+        {
+            numberOfReactors = std::thread::hardware_concurrency();
+            if(0 == numberOfReactors)
+            {
+                LOG_WARNING("The maximum hardware concurrency level of this"
+                    " machine could not be detected. A single network"
+                    " thread will be used.\n");
+                numberOfReactors = 1;
+            }
+        }
+    }
+
+    SetReactorCount(numberOfReactors, mConfig->GetNetworkBalance() ==
+        objects::ServerConfig::NetworkBalance_t::LEAST_LOADED);
+}
+
 bool BaseServer::AssignMessageQueue(const std::shared_ptr<
     libcomp::EncryptedConnection>& connection)
 {
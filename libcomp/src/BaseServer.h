@@ -231,6 +231,13 @@ protected:
      */
     void CreateWorkers();
 
+    /**
+     * Set how many network reactors the server will run based upon the
+     * server config. Each reactor runs in its own thread and accepted
+     * connections are spread across them.
+     */
+    void CreateReactors();
+
     /**
      * Retrieve and assign a message queue to use for a new connection.
      * The method of deciding which worker to use is not contained in this
@@ -0,0 +1,527 @@
+/**
+ * @file libcomp/src/BlowfishEcb.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Blowfish ECB engines that encrypt several blocks at once.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "BlowfishEcb.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+// The AVX2 engine is compiled with a function target attribute so the rest
+// of the library does not need to be built for AVX2.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMP_BLOWFISH_AVX2
+#include <immintrin.h>
+#endif // __GNUC__ && x86
+
+using namespace libcomp;
+
+static_assert(sizeof(BF_LONG) == sizeof(uint32_t),
+    "BlowfishEcb expects 32-bit Blowfish words");
+
+/// Number of rounds of the cipher (the same as OpenSSL)
+static const int BLOWFISH_ROUNDS = 16;
+
+/// Engine used by Encrypt and Decrypt (AUTO until the first call)
+static std::atomic<BlowfishEcb::Engine_t> gEngine(
+    BlowfishEcb::Engine_t::AUTO);
+
+/// Makes sure the engines are only timed once when none was set
+static std::once_flag gPickEngineOnce;
+
+namespace
+{
+
+/**
+ * Blowfish round function.
+ * @param pS S-boxes of the key (4 tables of 256 words).
+ * @param x Half of the block.
+ * @return Value to mix into the other half.
+ */
+inline uint32_t Feistel(const BF_LONG *pS, uint32_t x)
+{
+    return (uint32_t)(((pS[x >> 24] + pS[0x100 + ((x >> 16) & 0xFF)]) ^
+        pS[0x200 + ((x >> 8) & 0xFF)]) + pS[0x300 + (x & 0xFF)]);
+}
+
+/**
+ * Run one round on every lane.
+ * @param pS S-boxes of the key.
+ * @param a Halves to mix the round into.
+ * @param b Other halves of the blocks.
+ * @param p Subkey of the round.
+ */
+template<size_t Lanes>
+inline void Round(const BF_LONG *pS, uint32_t (&a)[Lanes],
+    const uint32_t (&b)[Lanes], BF_LONG p)
+{
+    for(size_t i = 0; i < Lanes; i++)
+    {
+        a[i] ^= (uint32_t)p ^ Feistel(pS, b[i]);
+    }
+}
+
+/**
+ * Run Lanes blocks through the cipher together. Each round is done for
+ * every lane before the next round so the lookups of one lane overlap with
+ * the others. The rounds are written out so this does not depend on the
+ * optimizer unrolling them.
+ * @param key Blowfish key.
+ * @param pData First of Lanes blocks to process in place.
+ */
+template<size_t Lanes, bool Encrypting>
+inline void ProcessLanes(const BF_KEY& key, uint8_t *pData)
+{
+    const BF_LONG *pP = key.P;
+    const BF_LONG *pS = key.S;
+
+    uint32_t l[Lanes], r[Lanes];
+
+    for(size_t i = 0; i < Lanes; i++)
+    {
+        memcpy(&l[i], pData + i * 8, sizeof(uint32_t));
+        memcpy(&r[i], pData + i * 8 + 4, sizeof(uint32_t));
+    }
+
+    if(Encrypting)
+    {
+        for(size_t i = 0; i < Lanes; i++)
+        {
+            l[i] ^= (uint32_t)pP[0];
+        }
+
+        Round(pS, r, l, pP[1]);
+        Round(pS, l, r, pP[2]);
+        Round(pS, r, l, pP[3]);
+        Round(pS, l, r, pP[4]);
+        Round(pS, r, l, pP[5]);
+        Round(pS, l, r, pP[6]);
+        Round(pS, r, l, pP[7]);
+        Round(pS, l, r, pP[8]);
+        Round(pS, r, l, pP[9]);
+        Round(pS, l, r, pP[10]);
+        Round(pS, r, l, pP[11]);
+        Round(pS, l, r, pP[12]);
+        Round(pS, r, l, pP[13]);
+        Round(pS, l, r, pP[14]);
+        Round(pS, r, l, pP[15]);
+        Round(pS, l, r, pP[16]);
+
+        for(size_t i = 0; i < Lanes; i++)
+        {
+            r[i] ^= (uint32_t)pP[BLOWFISH_ROUNDS + 1];
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < Lanes; i++)
+        {
+            l[i] ^= (uint32_t)pP[BLOWFISH_ROUNDS + 1];
+        }
+
+        Round(pS, r, l, pP[16]);
+        Round(pS, l, r, pP[15]);
+        Round(pS, r, l, pP[14]);
+        Round(pS, l, r, pP[13]);
+        Round(pS, r, l, pP[12]);
+        Round(pS, l, r, pP[11]);
+        Round(pS, r, l, pP[10]);
+        Round(pS, l, r, pP[9]);
+        Round(pS, r, l, pP[8]);
+        Round(pS, l, r, pP[7]);
+        Round(pS, r, l, pP[6]);
+        Round(pS, l, r, pP[5]);
+        Round(pS, r, l, pP[4]);
+        Round(pS, l, r, pP[3]);
+        Round(pS, r, l, pP[2]);
+        Round(pS, l, r, pP[1]);
+
+        for(size_t i = 0; i < Lanes; i++)
+        {
+            r[i] ^= (uint32_t)pP[0];
+        }
+    }
+
+    // The halves are swapped on the way out.
+    for(size_t i = 0; i < Lanes; i++)
+    {
+        memcpy(pData + i * 8, &r[i], sizeof(uint32_t));
+        memcpy(pData + i * 8 + 4, &l[i], sizeof(uint32_t));
+    }
+}
+
+/**
+ * Process every block with the scalar lanes, finishing any blocks that do
+ * not fill all of the lanes one at a time.
+ * @param key Blowfish key.
+ * @param pData Data to process in place.
+ * @param blockCount Number of blocks to process.
+ */
+template<size_t Lanes, bool Encrypting>
+void ProcessScalar(const BF_KEY& key, uint8_t *pData, uint32_t blockCount)
+{
+    for(; Lanes <= blockCount; blockCount -= (uint32_t)Lanes)
+    {
+        ProcessLanes<Lanes, Encrypting>(key, pData);
+        pData += Lanes * 8;
+    }
+
+    for(; 0 < blockCount; blockCount--)
+    {
+        ProcessLanes<1, Encrypting>(key, pData);
+        pData += 8;
+    }
+}
+
+/**
+ * Process every block with OpenSSL one block at a time.
+ * @param key Blowfish key.
+ * @param pData Data to process in place.
+ * @param blockCount Number of blocks to process.
+ */
+template<bool Encrypting>
+void ProcessOpenSsl(const BF_KEY& key, uint8_t *pData, uint32_t blockCount)
+{
+    for(; 0 < blockCount; blockCount--)
+    {
+        if(Encrypting)
+        {
+            BF_encrypt(reinterpret_cast<BF_LONG*>(pData), &key);
+        }
+        else
+        {
+            BF_decrypt(reinterpret_cast<BF_LONG*>(pData), &key);
+        }
+
+        pData += 8;
+    }
+}
+
+#ifdef COMP_BLOWFISH_AVX2
+/**
+ * Blowfish round function for eight halves at once.
+ * @param pS S-boxes of the key.
+ * @param x Eight block halves.
+ * @return Values to mix into the other halves.
+ */
+__attribute__((target("avx2")))
+inline __m256i FeistelAvx2(const int *pS, __m256i x)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+
+    __m256i a = _mm256_i32gather_epi32(pS, _mm256_srli_epi32(x, 24), 4);
+    __m256i b = _mm256_i32gather_epi32(pS + 0x100, _mm256_and_si256(
+        _mm256_srli_epi32(x, 16), mask), 4);
+    __m256i c = _mm256_i32gather_epi32(pS + 0x200, _mm256_and_si256(
+        _mm256_srli_epi32(x, 8), mask), 4);
+    __m256i d = _mm256_i32gather_epi32(pS + 0x300, _mm256_and_si256(
+        x, mask), 4);
+
+    return _mm256_add_epi32(_mm256_xor_si256(_mm256_add_epi32(a, b), c), d);
+}
+
+/**
+ * Process every block eight at a time in AVX2 registers and the rest with
+ * the scalar lanes.
+ * @param key Blowfish key.
+ * @param pData Data to process in place.
+ * @param blockCount Number of blocks to process.
+ */
+template<bool Encrypting>
+__attribute__((target("avx2")))
+void ProcessAvx2(const BF_KEY& key, uint8_t *pData, uint32_t blockCount)
+{
+    const BF_LONG *pP = key.P;
+    const int *pS = reinterpret_cast<const int*>(key.S);
+
+    // Split 4 blocks into the left halves then the right halves and back.
+    const __m256i split = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    const __m256i join = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    for(; 8 <= blockCount; blockCount -= 8)
+    {
+        __m256i lo = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pData)), split);
+        __m256i hi = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(
+            reinterpret_cast<const __m256i*>(pData + 32)), split);
+
+        __m256i l = _mm256_permute2x128_si256(lo, hi, 0x20);
+        __m256i r = _mm256_permute2x128_si256(lo, hi, 0x31);
+
+        if(Encrypting)
+        {
+            l = _mm256_xor_si256(l, _mm256_set1_epi32((int)pP[0]));
+
+            for(int round = 1; round <= BLOWFISH_ROUNDS; round += 2)
+            {
+                r = _mm256_xor_si256(r, _mm256_xor_si256(_mm256_set1_epi32(
+                    (int)pP[round]), FeistelAvx2(pS, l)));
+                l = _mm256_xor_si256(l, _mm256_xor_si256(_mm256_set1_epi32(
+                    (int)pP[round + 1]), FeistelAvx2(pS, r)));
+            }
+
+            r = _mm256_xor_si256(r, _mm256_set1_epi32(
+                (int)pP[BLOWFISH_ROUNDS + 1]));
+        }
+        else
+        {
+            l = _mm256_xor_si256(l, _mm256_set1_epi32(
+                (int)pP[BLOWFISH_ROUNDS + 1]));
+
+            for(int round = BLOWFISH_ROUNDS; round >= 2; round -= 2)
+            {
+                r = _mm256_xor_si256(r, _mm256_xor_si256(_mm256_set1_epi32(
+                    (int)pP[round]), FeistelAvx2(pS, l)));
+                l = _mm256_xor_si256(l, _mm256_xor_si256(_mm256_set1_epi32(
+                    (int)pP[round - 1]), FeistelAvx2(pS, r)));
+            }
+
+            r = _mm256_xor_si256(r, _mm256_set1_epi32((int)pP[0]));
+        }
+
+        // The halves are swapped on the way out.
+        lo = _mm256_permutevar8x32_epi32(_mm256_permute2x128_si256(
+            r, l, 0x20), join);
+        hi = _mm256_permutevar8x32_epi32(_mm256_permute2x128_si256(
+            r, l, 0x31), join);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pData), lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pData + 32), hi);
+
+        pData += 64;
+    }
+
+    ProcessScalar<4, Encrypting>(key, pData, blockCount);
+}
+#endif // COMP_BLOWFISH_AVX2
+
+/**
+ * Process blocks with an engine.
+ * @param engine Engine to use.
+ * @param key Blowfish key.
+ * @param pData Data to process in place.
+ * @param blockCount Number of blocks to process.
+ */
+template<bool Encrypting>
+void ProcessWith(BlowfishEcb::Engine_t engine, const BF_KEY& key,
+    void *pData, uint32_t blockCount)
+{
+    uint8_t *pBytes = reinterpret_cast<uint8_t*>(pData);
+
+    switch(engine)
+    {
+#ifdef COMP_BLOWFISH_AVX2
+        case BlowfishEcb::Engine_t::AVX2:
+            ProcessAvx2<Encrypting>(key, pBytes, blockCount);
+            break;
+#endif // COMP_BLOWFISH_AVX2
+        case BlowfishEcb::Engine_t::LANES_8:
+            ProcessScalar<8, Encrypting>(key, pBytes, blockCount);
+            break;
+        case BlowfishEcb::Engine_t::LANES_4:
+            ProcessScalar<4, Encrypting>(key, pBytes, blockCount);
+            break;
+        default:
+            ProcessOpenSsl<Encrypting>(key, pBytes, blockCount);
+            break;
+    }
+}
+
+/**
+ * Time each supported engine on the same data and return the fastest. How
+ * well the interleaving and the AVX2 gathers work depends a lot on the CPU
+ * so this is measured instead of guessed.
+ * @return Fastest engine.
+ */
+BlowfishEcb::Engine_t PickFastestEngine()
+{
+    static const BlowfishEcb::Engine_t engines[] = {
+        BlowfishEcb::Engine_t::OPENSSL,
+        BlowfishEcb::Engine_t::LANES_4,
+        BlowfishEcb::Engine_t::LANES_8,
+        BlowfishEcb::Engine_t::AVX2,
+    };
+
+    BF_KEY key;
+    uint8_t keyData[16];
+    std::vector<uint8_t> data(4096);
+
+    for(size_t i = 0; i < sizeof(keyData); i++)
+    {
+        keyData[i] = (uint8_t)(i * 13 + 7);
+    }
+
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = (uint8_t)i;
+    }
+
+    BF_set_key(&key, (int)sizeof(keyData), keyData);
+
+    BlowfishEcb::Engine_t best = BlowfishEcb::Engine_t::OPENSSL;
+    auto bestTime = std::chrono::steady_clock::duration::max();
+
+    for(auto engine : engines)
+    {
+        if(!BlowfishEcb::IsSupported(engine))
+        {
+            continue;
+        }
+
+        // Take the best of a few runs to skip over any interruptions.
+        for(int run = 0; run < 3; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            for(int i = 0; i < 16; i++)
+            {
+                ProcessWith<true>(engine, key, data.data(), (uint32_t)(
+                    data.size() / 8));
+            }
+
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            if(elapsed < bestTime)
+            {
+                best = engine;
+                bestTime = elapsed;
+            }
+        }
+    }
+
+    return best;
+}
+
+/**
+ * Get the engine to use, picking one the first time if none was set.
+ * @return Engine to use.
+ */
+BlowfishEcb::Engine_t ResolveEngine()
+{
+    if(BlowfishEcb::Engine_t::AUTO == gEngine)
+    {
+        std::call_once(gPickEngineOnce, []()
+        {
+            // Do not replace an engine set while the engines were timed.
+            BlowfishEcb::Engine_t expected = BlowfishEcb::Engine_t::AUTO;
+            (void)gEngine.compare_exchange_strong(expected,
+                PickFastestEngine());
+        });
+    }
+
+    return gEngine;
+}
+
+/**
+ * Process blocks with the engine in use.
+ * @param key Blowfish key.
+ * @param pData Data to process in place.
+ * @param blockCount Number of blocks to process.
+ */
+template<bool Encrypting>
+void Process(const BF_KEY& key, void *pData, uint32_t blockCount)
+{
+    ProcessWith<Encrypting>(ResolveEngine(), key, pData, blockCount);
+}
+
+} // namespace
+
+bool BlowfishEcb::IsSupported(Engine_t engine)
+{
+    switch(engine)
+    {
+        case Engine_t::AUTO:
+        case Engine_t::OPENSSL:
+        case Engine_t::LANES_4:
+        case Engine_t::LANES_8:
+            return true;
+        case Engine_t::AVX2:
+#ifdef COMP_BLOWFISH_AVX2
+            return 0 != __builtin_cpu_supports("avx2");
+#else // COMP_BLOWFISH_AVX2
+            return false;
+#endif // COMP_BLOWFISH_AVX2
+    }
+
+    return false;
+}
+
+bool BlowfishEcb::SetEngine(Engine_t engine)
+{
+    if(!IsSupported(engine))
+    {
+        return false;
+    }
+
+    if(Engine_t::AUTO == engine)
+    {
+        engine = PickFastestEngine();
+    }
+
+    gEngine = engine;
+
+    return true;
+}
+
+BlowfishEcb::Engine_t BlowfishEcb::GetEngine()
+{
+    return ResolveEngine();
+}
+
+const char* BlowfishEcb::GetEngineName(Engine_t engine)
+{
+    switch(engine)
+    {
+        case Engine_t::AUTO:
+            return "auto";
+        case Engine_t::OPENSSL:
+            return "openssl";
+        case Engine_t::LANES_4:
+            return "4 lanes";
+        case Engine_t::LANES_8:
+            return "8 lanes";
+        case Engine_t::AVX2:
+            return "avx2";
+    }
+
+    return "unknown";
+}
+
+void BlowfishEcb::Encrypt(const BF_KEY& key, void *pData,
+    uint32_t blockCount)
+{
+    Process<true>(key, pData, blockCount);
+}
+
+void BlowfishEcb::Decrypt(const BF_KEY& key, void *pData,
+    uint32_t blockCount)
+{
+    Process<false>(key, pData, blockCount);
+}
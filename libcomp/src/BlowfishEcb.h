@@ -0,0 +1,120 @@
+/**
+ * @file libcomp/src/BlowfishEcb.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Blowfish ECB engines that encrypt several blocks at once.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_BLOWFISHECB_H
+#define LIBCOMP_SRC_BLOWFISHECB_H
+
+#include "PushIgnore.h"
+#include <openssl/blowfish.h>
+#include "PopIgnore.h"
+
+// Standard C++11 Includes
+#include <stdint.h>
+
+namespace libcomp
+{
+
+/**
+ * Blowfish in ECB mode for the packet and file encryption. Each block is
+ * independent so several blocks are run through the rounds together to
+ * hide the latency of the S-box lookups. The result is the same as calling
+ * BF_encrypt or BF_decrypt on each block in place (the block is two 32-bit
+ * words in host byte order).
+ */
+namespace BlowfishEcb
+{
+
+/**
+ * Implementation used to process the blocks.
+ */
+enum class Engine_t : uint8_t
+{
+    /// Time each engine the CPU supports and use the fastest
+    AUTO = 0,
+
+    /// One block at a time with BF_encrypt and BF_decrypt
+    OPENSSL,
+
+    /// Four blocks interleaved in scalar code
+    LANES_4,
+
+    /// Eight blocks interleaved in scalar code
+    LANES_8,
+
+    /// Eight blocks in AVX2 registers with gathered S-box lookups
+    AVX2,
+};
+
+/**
+ * Check if an engine can run on this CPU.
+ * @param engine Engine to check.
+ * @return true if the engine can be used.
+ */
+bool IsSupported(Engine_t engine);
+
+/**
+ * Set the engine used by @ref Encrypt and @ref Decrypt. An engine the CPU
+ * does not support is ignored. If this is not called the engine is picked
+ * with AUTO the first time a block is processed.
+ * @param engine Engine to use or AUTO to pick the fastest.
+ * @return true if the engine was set.
+ */
+bool SetEngine(Engine_t engine);
+
+/**
+ * Get the engine used by @ref Encrypt and @ref Decrypt.
+ * @return Engine in use (never AUTO).
+ */
+Engine_t GetEngine();
+
+/**
+ * Get the name of an engine for logs and benchmarks.
+ * @param engine Engine to get the name of.
+ * @return Name of the engine.
+ */
+const char* GetEngineName(Engine_t engine);
+
+/**
+ * Encrypt blocks of data in place.
+ * @param key Blowfish key to encrypt with.
+ * @param pData Data to encrypt.
+ * @param blockCount Number of 8 byte blocks to encrypt.
+ */
+void Encrypt(const BF_KEY& key, void *pData, uint32_t blockCount);
+
+/**
+ * Decrypt blocks of data in place.
+ * @param key Blowfish key to decrypt with.
+ * @param pData Data to decrypt.
+ * @param blockCount Number of 8 byte blocks to decrypt.
+ */
+void Decrypt(const BF_KEY& key, void *pData, uint32_t blockCount);
+
+} // namespace BlowfishEcb
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_BLOWFISHECB_H
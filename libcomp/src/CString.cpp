@@ -25,6 +25,7 @@
  */
 
 #include "CString.h"
+#include "StringFormat.h"
 
 #include <regex_ext>
 #include <algorithm>
@@ -560,27 +561,53 @@ String String::Replace(const String& _search, const String& _replace) const
 
 String String::Arg(const String& a) const
 {
+    const std::string& src = d->mString;
+    const std::string& value = a.d->mString;
+
+    std::string s;
+    s.reserve(src.size() + value.size());
+
     int matchCount = 0;
+    size_t literal = 0;
+    size_t i = 0;
 
-    auto callback = [&](const std::smatch& match)
+    // Single pass over the string replacing %1 and shifting every other
+    // argument down by one
+    while(std::string::npos != (i = src.find('%', i)))
     {
-        int n = std::atoi(match.str(1).c_str());
+        size_t end = i + 1;
+
+        while(end < src.size() && '0' <= src[end] && '9' >= src[end])
+        {
+            end++;
+        }
+
+        if(end == i + 1)
+        {
+            i = end;
+            continue;
+        }
+
+        s.append(src, literal, i - literal);
+
+        int n = std::atoi(src.c_str() + i + 1);
 
         if(1 == n)
         {
             matchCount++;
 
-            return a.d->mString;
+            s.append(value);
         }
         else
         {
-            return "%" + std::to_string(n - 1);
+            s.push_back('%');
+            s.append(std::to_string(n - 1));
         }
-    };
 
-    std::regex re("\\%([0-9]+)");
-    std::string s = std::regex_replace(d->mString.cbegin(),
-        d->mString.cend(), re, callback);
+        literal = i = end;
+    }
+
+    s.append(src, literal, std::string::npos);
 
     if(0 == matchCount && mBadArgumentReporting)
     {
@@ -590,8 +617,19 @@ String String::Arg(const String& a) const
     return String(s);
 }
 
+String String::FormatValues(const String& format, const String *pValues,
+    size_t count)
+{
+    return StringFormat(format).Apply(pValues, count);
+}
+
 String String::Arg(int16_t a, int fieldWidth, int base, char fillChar)
 {
+    if(0 == fieldWidth && 10 == base)
+    {
+        return Arg(String(std::to_string(a)));
+    }
+
     std::stringstream ss;
     ss.width(fieldWidth);
     ss.fill(fillChar);
@@ -603,6 +641,11 @@ String String::Arg(int16_t a, int fieldWidth, int base, char fillChar)
 
 String String::Arg(uint16_t a, int fieldWidth, int base, char fillChar)
 {
+    if(0 == fieldWidth && 10 == base)
+    {
+        return Arg(String(std::to_string(a)));
+    }
+
     std::stringstream ss;
     ss.width(fieldWidth);
     ss.fill(fillChar);
@@ -614,6 +657,11 @@ String String::Arg(uint16_t a, int fieldWidth, int base, char fillChar)
 
 String String::Arg(int32_t a, int fieldWidth, int base, char fillChar)
 {
+    if(0 == fieldWidth && 10 == base)
+    {
+        return Arg(String(std::to_string(a)));
+    }
+
     std::stringstream ss;
     ss.width(fieldWidth);
     ss.fill(fillChar);
@@ -625,6 +673,11 @@ String String::Arg(int32_t a, int fieldWidth, int base, char fillChar)
 
 String String::Arg(uint32_t a, int fieldWidth, int base, char fillChar)
 {
+    if(0 == fieldWidth && 10 == base)
+    {
+        return Arg(String(std::to_string(a)));
+    }
+
     std::stringstream ss;
     ss.width(fieldWidth);
     ss.fill(fillChar);
@@ -636,6 +689,11 @@ String String::Arg(uint32_t a, int fieldWidth, int base, char fillChar)
 
 String String::Arg(int64_t a, int fieldWidth, int base, char fillChar)
 {
+    if(0 == fieldWidth && 10 == base)
+    {
+        return Arg(String(std::to_string(a)));
+    }
+
     std::stringstream ss;
     ss.width(fieldWidth);
     ss.fill(fillChar);
@@ -647,6 +705,11 @@ String String::Arg(int64_t a, int fieldWidth, int base, char fillChar)
 
 String String::Arg(uint64_t a, int fieldWidth, int base, char fillChar)
 {
+    if(0 == fieldWidth && 10 == base)
+    {
+        return Arg(String(std::to_string(a)));
+    }
+
     std::stringstream ss;
     ss.width(fieldWidth);
     ss.fill(fillChar);
@@ -29,6 +29,7 @@
 
 #include <stdint.h>
 
+#include <array>
 #include <iomanip>
 #include <limits>
 #include <list>
@@ -36,6 +37,7 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace libcomp
@@ -256,6 +258,98 @@ public:
      */
     String Arg(const String& a) const;
 
+    /**
+     * Replace every argument of a format string (%1, %2, ...) in a single
+     * pass. The result is the same as chaining @ref Arg for each value
+     * except that the values themselves are never searched for arguments.
+     * Arguments past the number of values are shifted down like they are
+     * by @ref Arg. Code that formats the same string often can keep a
+     * @ref StringFormat to skip parsing the format each time.
+     *
+     * @param format Format string with the arguments to replace.
+     * @param args Values to place into the arguments. Strings, numbers
+     *  and anything @ref FormatValue accepts may be used.
+     * @returns Formatted string.
+     */
+    template<typename... Args>
+    static String Format(const String& format, Args&&... args)
+    {
+        const std::array<String, sizeof...(Args)> values = {{
+            FormatValue(std::forward<Args>(args))... }};
+
+        return FormatValues(format, values.data(), values.size());
+    }
+
+    /**
+     * Replace every argument of a format string with a list of values.
+     * @param format Format string with the arguments to replace.
+     * @param pValues Values to place into the arguments.
+     * @param count Number of values.
+     * @returns Formatted string.
+     * @sa Format
+     */
+    static String FormatValues(const String& format, const String *pValues,
+        size_t count);
+
+    /**
+     * Convert a value for @ref Format.
+     * @param value Value to convert.
+     * @returns The value as a string.
+     */
+    static String FormatValue(const String& value)
+    {
+        return value;
+    }
+
+    /**
+     * Convert a value for @ref Format.
+     * @param szValue Value to convert.
+     * @returns The value as a string.
+     */
+    static String FormatValue(const char *szValue)
+    {
+        return String(szValue);
+    }
+
+    /**
+     * Convert a value for @ref Format.
+     * @param value Value to convert.
+     * @returns The value as a string.
+     */
+    static String FormatValue(const std::string& value)
+    {
+        return String(value);
+    }
+
+    /**
+     * Convert an integer for @ref Format in base 10.
+     * @param value Value to convert.
+     * @returns The value as a string.
+     */
+    template<typename T>
+    static typename std::enable_if<std::is_integral<T>::value,
+        String>::type FormatValue(T value)
+    {
+        return String(std::to_string(value));
+    }
+
+    /**
+     * Convert a floating point number for @ref Format with the same
+     * precision as @ref Arg.
+     * @param value Value to convert.
+     * @returns The value as a string.
+     */
+    template<typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value,
+        String>::type FormatValue(T value)
+    {
+        std::stringstream ss;
+        ss << std::setprecision(std::numeric_limits<T>::max_digits10 + 1)
+            << value;
+
+        return String(ss.str());
+    }
+
     /**
      * Convert the string into lowercase.
      * @returns Copy of the string in lowercase.
@@ -69,7 +69,11 @@ void ChannelConnection::PreparePackets(std::list<ReadOnlyPacket>& packets)
             {
                 finalPacket.WriteU16Big((uint16_t)(packet.Size() + 2));
                 finalPacket.WriteU16Little((uint16_t)(packet.Size() + 2));
+                uint32_t dataStart = finalPacket.Tell();
                 finalPacket.WriteArray(packet.ConstData(), packet.Size());
+
+                // Fill in any per-connection values of a shared packet.
+                packet.ApplyPatches(finalPacket.Data() + dataStart);
             }
 
             int32_t originalSize = static_cast<int32_t>(
@@ -164,6 +164,12 @@ namespace libcomp
 /// Chat Radius for Say Chat.
 #define CHAT_RADIUS_SAY (8000)
 
+/// Time between area of interest visibility updates (in microseconds).
+#define INTEREST_UPDATE_INTERVAL (500000)
+
+/// Time between the start of each channel server tick (in milliseconds).
+#define TICK_DELTA (100)
+
 /// Number of G1 times stored.
 #define G1_TIME_COUNT (18)
 
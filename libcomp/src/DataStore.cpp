@@ -273,6 +273,11 @@ int64_t DataStore::FileSize(const libcomp::String& path)
     return size;
 }
 
+int64_t DataStore::LastModified(const libcomp::String& path)
+{
+    return PHYSFS_getLastModTime(path.C());
+}
+
 bool DataStore::Delete(const libcomp::String& path, bool recursive)
 {
     const char *szPath = path.C();
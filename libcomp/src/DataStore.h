@@ -66,6 +66,7 @@ public:
 
     bool Exists(const libcomp::String& path);
     int64_t FileSize(const libcomp::String& path);
+    int64_t LastModified(const libcomp::String& path);
 
     libcomp::String GetHash(const libcomp::String& path);
 
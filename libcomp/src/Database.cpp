@@ -26,15 +26,43 @@
 
 #include "Database.h"
 
+// libcomp Includes
+#include "DatabaseBind.h"
+#include "Log.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <unordered_set>
+
 using namespace libcomp;
 
+/// Time the transaction writer waits for more changes to join a batch
+static const std::chrono::milliseconds WRITE_BATCH_DELAY(50);
+
+/// true while the current thread is writing a batch or change set
+static thread_local bool tWritingChanges = false;
+
 Database::Database(const std::shared_ptr<objects::DatabaseConfig>& config)
+    : mQueuedGeneration(0), mTakenGeneration(0), mWrittenGeneration(0),
+    mFlushRequested(false), mWriterRunning(false), mWriterStopping(false),
+    mQueueStats(), mTotalCommitTime(0)
 {
     mConfig = config;
 }
 
 Database::~Database()
 {
+    // The writer calls back into the derived class so it has to be
+    // stopped before getting here
+    if(mTransactionWriter.joinable())
+    {
+        LOG_ERROR("Database destroyed without stopping the transaction"
+            " writer.\n");
+
+        mTransactionWriter.detach();
+    }
 }
 
 bool Database::Execute(const String& query)
@@ -90,10 +118,191 @@ std::shared_ptr<PersistentObject> Database::LoadSingleObject(size_t typeHash,
     return objects.size() > 0 ? objects.front() : nullptr;
 }
 
+std::list<std::shared_ptr<PersistentObject>> Database::LoadObjectsIn(
+    size_t typeHash, const String& column,
+    const std::list<libobjgen::UUID>& values)
+{
+    // Batches are padded up to one of these sizes so only two statements
+    // are ever prepared per type and column.
+    static const size_t SMALL_BATCH = 8;
+    static const size_t LARGE_BATCH = 64;
+
+    std::list<std::shared_ptr<PersistentObject>> objects;
+
+    auto metaObject = PersistentObject::GetRegisteredMetadata(typeHash);
+
+    if(nullptr == metaObject)
+    {
+        LOG_ERROR("Failed to lookup MetaObject.\n");
+
+        return {};
+    }
+
+    std::vector<libobjgen::UUID> uuids;
+    std::unordered_set<libobjgen::UUID> seen;
+
+    for(auto& value : values)
+    {
+        if(!value.IsNull() && seen.insert(value).second)
+        {
+            uuids.push_back(value);
+        }
+    }
+
+    int failures = 0;
+
+    for(size_t offset = 0; offset < uuids.size();)
+    {
+        size_t remaining = uuids.size() - offset;
+        size_t batchSize = remaining <= SMALL_BATCH
+            ? SMALL_BATCH : LARGE_BATCH;
+        size_t used = std::min(batchSize, remaining);
+
+        // Repeat the last value to fill the batch, IN ignores duplicates.
+        std::list<DatabaseBind*> binds;
+        for(size_t i = 0; i < batchSize; i++)
+        {
+            binds.push_back(new DatabaseBindUUID(String("%1%2").Arg(
+                column).Arg((uint32_t)i), uuids[offset + std::min(i,
+                used - 1)]));
+        }
+
+        auto getSQL = [&]()
+        {
+            std::list<String> params;
+            for(auto bind : binds)
+            {
+                params.push_back(String(":%1").Arg(bind->GetColumn()));
+            }
+
+            return String("SELECT * FROM `%1` WHERE `%2` IN (%3)").Arg(
+                metaObject->GetName()).Arg(column).Arg(
+                String::Join(params, ", "));
+        };
+
+        DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+            metaObject->GetName(), DatabaseStatementCache::Operation::SELECT,
+            binds),
+            getSQL);
+
+        bool ok = query.IsValid();
+
+        if(!ok)
+        {
+            LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+                getSQL()));
+            LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+        }
+
+        for(auto bind : binds)
+        {
+            if(ok && !bind->Bind(query))
+            {
+                LOG_ERROR(String("Failed to bind value: %1\n").Arg(
+                    bind->GetColumn()));
+                LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+
+                ok = false;
+            }
+        }
+
+        if(ok && !query.Execute())
+        {
+            LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+                getSQL()));
+            LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+
+            ok = false;
+        }
+
+        for(auto bind : binds)
+        {
+            delete bind;
+        }
+
+        if(!ok)
+        {
+            return {};
+        }
+
+        while(query.Next())
+        {
+            auto obj = LoadSingleObjectFromRow(typeHash, query);
+
+            if(nullptr != obj)
+            {
+                objects.push_back(obj);
+            }
+            else
+            {
+                failures++;
+            }
+        }
+
+        offset += used;
+    }
+
+    if(failures > 0)
+    {
+        LOG_ERROR(String("%1 '%2' row%3 failed to load.\n").Arg(failures).Arg(
+            metaObject->GetName()).Arg(failures != 1 ? "s" : ""));
+    }
+
+    return objects;
+}
+
+bool Database::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
+{
+    WaitForQueuedChanges({ obj });
+
+    std::stringstream objstream;
+    if(!obj->Save(objstream))
+    {
+        return false;
+    }
+
+    if(obj->GetUUID().IsNull() && !obj->Register(obj))
+    {
+        return false;
+    }
+
+    auto values = obj->GetMemberBindValues(true);
+
+    return InsertValues(obj, values);
+}
+
+bool Database::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
+{
+    WaitForQueuedChanges({ obj });
+
+    std::stringstream objstream;
+    if(!obj->Save(objstream))
+    {
+        return false;
+    }
+
+    if(obj->GetUUID().IsNull())
+    {
+        return false;
+    }
+
+    auto values = obj->GetMemberBindValues();
+    if(values.size() == 0)
+    {
+        //Nothing updated, nothing to do
+        return true;
+    }
+
+    return UpdateValues(obj, values);
+}
+
 bool Database::DeleteSingleObject(std::shared_ptr<PersistentObject>& obj)
 {
     std::list<std::shared_ptr<PersistentObject>> objs;
     objs.push_back(obj);
+
+    WaitForQueuedChanges(objs);
+
     return DeleteObjects(objs);
 }
 
@@ -141,30 +350,86 @@ bool Database::QueueChangeSet(const std::shared_ptr<
 
         if(standardChanges)
         {
-            std::lock_guard<std::mutex> lock(mTransactionLock);
-            auto queueEntry = mTransactionQueue[key];
-            if(queueEntry == nullptr)
-            {
-                queueEntry = std::make_shared<DBStandardChangeSet>(uuid);
-            }
+            // Copy the field values on the calling thread since the
+            // objects can keep changing until the queue is written
+            DBStandardChangeSet copy(uuid);
+
+            std::list<libobjgen::UUID> objUUIDs;
 
             for(auto obj : standardChanges->GetInserts())
             {
-                queueEntry->Insert(obj);
+                copy.InsertCopy(obj);
+                objUUIDs.push_back(obj->GetUUID());
             }
 
             for(auto obj : standardChanges->GetUpdates())
             {
-                queueEntry->Update(obj);
+                copy.UpdateCopy(obj);
+                objUUIDs.push_back(obj->GetUUID());
             }
 
             for(auto obj : standardChanges->GetDeletes())
             {
-                queueEntry->Delete(obj);
+                copy.Delete(obj);
+                objUUIDs.push_back(obj->GetUUID());
             }
 
+            uint64_t count = (uint64_t)objUUIDs.size();
+
+            std::unique_lock<std::mutex> lock(mTransactionLock);
+            auto queueEntry = mTransactionQueue[key];
+            if(queueEntry == nullptr)
+            {
+                queueEntry = std::make_shared<DBStandardChangeSet>(uuid);
+            }
+
+            queueEntry->Merge(copy);
+
             mTransactionQueue[key] = queueEntry;
 
+            // Remember which objects are waiting to be written so direct
+            // writes to them can wait for the queue first
+            uint64_t generation = ++mQueuedGeneration;
+            for(auto& objUUID : objUUIDs)
+            {
+                if(!objUUID.IsNull())
+                {
+                    mQueuedObjects[objUUID] = generation;
+                }
+            }
+
+            bool wasEmpty = 0 == mQueueStats.QueueDepth;
+
+            mQueueStats.QueueDepth += count;
+            if(mQueueStats.QueueDepth > mQueueStats.MaxQueueDepth)
+            {
+                mQueueStats.MaxQueueDepth = mQueueStats.QueueDepth;
+            }
+
+            if(mWriterRunning)
+            {
+                uint64_t limit = (uint64_t)mConfig->GetWriteQueueLimit();
+
+                if(limit > 0 && mQueueStats.QueueDepth >= limit &&
+                    std::this_thread::get_id() != mTransactionWriter.get_id())
+                {
+                    // The writer is falling behind so wait for it to take
+                    // the queue instead of letting it grow without bound
+                    mQueueStats.BackpressureWaits++;
+                    mTransactionQueued.notify_one();
+
+                    mTransactionTaken.wait(lock, [this, limit]()
+                        {
+                            return !mWriterRunning ||
+                                mQueueStats.QueueDepth < limit;
+                        });
+                }
+                else if(wasEmpty)
+                {
+                    mTransactionQueued.notify_one();
+                }
+            }
+
             return true;
         }
     }
@@ -176,20 +441,88 @@ std::list<libobjgen::UUID> Database::ProcessTransactionQueue()
 {
     std::list<libobjgen::UUID> failures;
 
-    std::unordered_map<std::string,
-        std::shared_ptr<DBStandardChangeSet>> queue;
+    std::unique_lock<std::mutex> lock(mTransactionLock);
+
+    // Report anything the writer failed to process first
+    failures.swap(mWriterFailures);
+
+    if(mWriterRunning || mTransactionQueue.size() == 0)
+    {
+        return failures;
+    }
+
+    failures.splice(failures.end(), WriteQueue(lock));
+
+    return failures;
+}
+
+void Database::StartTransactionWriter()
+{
+    if(!UsesTransactionWriter())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mTransactionLock);
+
+    if(mWriterRunning)
+    {
+        return;
+    }
+
+    mWriterRunning = true;
+    mWriterStopping = false;
+
+    mTransactionWriter = std::thread([this]()
+    {
+#if !defined(_WIN32)
+        pthread_setname_np(pthread_self(), "db_writer");
+#endif // !defined(_WIN32)
+
+        TransactionWriterMain();
+    });
+}
+
+void Database::StopTransactionWriter()
+{
     {
         std::lock_guard<std::mutex> lock(mTransactionLock);
+        mWriterStopping = true;
+    }
 
-        if(mTransactionQueue.size() == 0)
-        {
-            return failures;
-        }
+    mTransactionQueued.notify_all();
+
+    if(mTransactionWriter.joinable())
+    {
+        mTransactionWriter.join();
+    }
+}
+
+Database::TransactionQueueStats Database::GetTransactionQueueStats()
+{
+    std::lock_guard<std::mutex> lock(mTransactionLock);
 
-        queue = mTransactionQueue;
-        mTransactionQueue.clear();
+    TransactionQueueStats stats = mQueueStats;
+    if(stats.Batches > 0)
+    {
+        stats.AvgCommitTime = mTotalCommitTime / stats.Batches;
     }
 
+    return stats;
+}
+
+std::list<libobjgen::UUID> Database::ProcessQueue(
+    std::unordered_map<std::string,
+    std::shared_ptr<DBStandardChangeSet>>& queue)
+{
+    std::list<libobjgen::UUID> failures;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t total = queue.size();
+
+    bool wasWriting = tWritingChanges;
+    tWritingChanges = true;
+
     // Process the general queue transaction first
     auto nullKey = NULLUUID.ToString();
     if(queue.find(nullKey) != queue.end())
@@ -210,27 +543,289 @@ std::list<libobjgen::UUID> Database::ProcessTransactionQueue()
         }
     }
 
+    tWritingChanges = wasWriting;
+
+    uint64_t elapsed = (uint64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::steady_clock::now() -
+        start).count();
+
+    std::lock_guard<std::mutex> lock(mTransactionLock);
+
+    mQueueStats.Batches++;
+    mQueueStats.Committed += (uint64_t)(total - failures.size());
+    mQueueStats.Failed += (uint64_t)failures.size();
+    mQueueStats.LastCommitTime = elapsed;
+    mTotalCommitTime += elapsed;
+
+    if(elapsed > mQueueStats.MaxCommitTime)
+    {
+        mQueueStats.MaxCommitTime = elapsed;
+    }
+
+    return failures;
+}
+
+void Database::TransactionWriterMain()
+{
+    std::unique_lock<std::mutex> lock(mTransactionLock);
+
+    while(true)
+    {
+        mTransactionQueued.wait(lock, [this]()
+            {
+                return mWriterStopping || !mTransactionQueue.empty();
+            });
+
+        if(mTransactionQueue.empty())
+        {
+            // Stopping and everything has been written
+            break;
+        }
+
+        // Give more changes a chance to join the batch unless callers
+        // are already waiting on the writer
+        uint64_t limit = (uint64_t)mConfig->GetWriteQueueLimit();
+        mTransactionQueued.wait_for(lock, WRITE_BATCH_DELAY, [this, limit]()
+            {
+                return mWriterStopping || mFlushRequested ||
+                    (limit > 0 && mQueueStats.QueueDepth >= limit);
+            });
+
+        auto failures = WriteQueue(lock);
+
+        mWriterFailures.splice(mWriterFailures.end(), failures);
+    }
+
+    mWriterRunning = false;
+    mTransactionTaken.notify_all();
+    mTransactionWritten.notify_all();
+}
+
+std::list<libobjgen::UUID> Database::WriteQueue(
+    std::unique_lock<std::mutex>& lock)
+{
+    // Only one batch is written at a time so the written generation
+    // never skips past a batch still being written
+    mTransactionWritten.wait(lock, [this]()
+        {
+            return mTakenGeneration == mWrittenGeneration;
+        });
+
+    std::unordered_map<std::string,
+        std::shared_ptr<DBStandardChangeSet>> queue;
+    queue.swap(mTransactionQueue);
+    mQueueStats.QueueDepth = 0;
+    mFlushRequested = false;
+
+    uint64_t generation = mQueuedGeneration;
+    mTakenGeneration = generation;
+
+    mTransactionTaken.notify_all();
+
+    std::list<libobjgen::UUID> failures;
+    if(!queue.empty())
+    {
+        lock.unlock();
+
+        failures = ProcessQueue(queue);
+
+        lock.lock();
+    }
+
+    mWrittenGeneration = generation;
+
+    for(auto it = mQueuedObjects.begin(); it != mQueuedObjects.end();)
+    {
+        if(it->second <= generation)
+        {
+            it = mQueuedObjects.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+
+    mTransactionWritten.notify_all();
+
     return failures;
 }
 
+void Database::WaitForQueuedChanges(
+    const std::list<std::shared_ptr<PersistentObject>>& objs)
+{
+    if(tWritingChanges)
+    {
+        // Already writing a batch or change set on this thread
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mTransactionLock);
+
+    if(mQueuedObjects.empty())
+    {
+        return;
+    }
+
+    uint64_t generation = 0;
+    for(auto& obj : objs)
+    {
+        auto it = obj ? mQueuedObjects.find(obj->GetUUID())
+            : mQueuedObjects.end();
+        if(it != mQueuedObjects.end() && it->second > generation)
+        {
+            generation = it->second;
+        }
+    }
+
+    while(mWrittenGeneration < generation)
+    {
+        if(mWriterRunning)
+        {
+            // Have the writer take the queue now instead of waiting for
+            // more changes to join the batch
+            if(mTakenGeneration < generation)
+            {
+                mFlushRequested = true;
+                mTransactionQueued.notify_one();
+            }
+
+            mTransactionWritten.wait(lock);
+        }
+        else if(mTakenGeneration < generation)
+        {
+            // The failures are reported by the next ProcessTransactionQueue
+            auto failures = WriteQueue(lock);
+            mWriterFailures.splice(mWriterFailures.end(), failures);
+        }
+        else
+        {
+            // Another thread is writing the batch
+            mTransactionWritten.wait(lock);
+        }
+    }
+}
+
+DatabaseStatementCache::Stats Database::GetStatementCacheStats()
+{
+    DatabaseStatementCache::Stats stats = {};
+
+    return stats;
+}
+
+bool Database::UsesTransactionWriter() const
+{
+    return true;
+}
+
+DatabaseStatementCache* Database::GetStatementCache()
+{
+    return nullptr;
+}
+
+DatabaseQuery Database::PrepareCached(const DatabaseStatementCache::Key& key,
+    const std::function<String()>& getQuery)
+{
+    auto pCache = GetStatementCache();
+
+    if(nullptr != pCache)
+    {
+        auto pImpl = pCache->Take(key);
+        if(nullptr != pImpl)
+        {
+            return DatabaseQuery(pImpl, pCache, key);
+        }
+    }
+
+    DatabaseQuery query = Prepare(getQuery());
+
+    if(nullptr != pCache && query.IsValid())
+    {
+        query.SetStatementCache(pCache, key);
+    }
+
+    return query;
+}
+
+bool Database::InsertChangeSetObject(const std::shared_ptr<
+    DBStandardChangeSet>& changes, std::shared_ptr<PersistentObject>& obj)
+{
+    std::list<DatabaseBind*> values;
+    if(!changes->TakeValues(obj, values))
+    {
+        return InsertSingleObject(obj);
+    }
+
+    if(values.size() == 0)
+    {
+        // Already inserted with the same change set
+        return true;
+    }
+
+    return InsertValues(obj, values);
+}
+
+bool Database::UpdateChangeSetObject(const std::shared_ptr<
+    DBStandardChangeSet>& changes, std::shared_ptr<PersistentObject>& obj)
+{
+    std::list<DatabaseBind*> values;
+    if(!changes->TakeValues(obj, values))
+    {
+        return UpdateSingleObject(obj);
+    }
+
+    if(values.size() == 0)
+    {
+        //Nothing updated, nothing to do
+        return true;
+    }
+
+    return UpdateValues(obj, values);
+}
+
 bool Database::ProcessChangeSet(const std::shared_ptr<DatabaseChangeSet>& changes)
 {
     auto opChanges = std::dynamic_pointer_cast<DBOperationalChangeSet>(changes);
+    auto standardChanges = std::dynamic_pointer_cast<DBStandardChangeSet>(changes);
 
-    if(opChanges)
+    if(!opChanges && !standardChanges)
     {
-        return ProcessOperationalChangeSet(opChanges);
+        return false;
     }
-    else
+
+    if(!tWritingChanges)
     {
-        auto standardChanges = std::dynamic_pointer_cast<DBStandardChangeSet>(changes);
-        if(standardChanges)
+        std::list<std::shared_ptr<PersistentObject>> objs;
+        if(opChanges)
+        {
+            for(auto op : opChanges->GetOperations())
+            {
+                objs.push_back(op->GetRecord());
+            }
+        }
+        else
         {
-            return ProcessStandardChangeSet(standardChanges);
+            objs = standardChanges->GetInserts();
+
+            auto updates = standardChanges->GetUpdates();
+            auto deletes = standardChanges->GetDeletes();
+            objs.splice(objs.end(), updates);
+            objs.splice(objs.end(), deletes);
         }
+
+        WaitForQueuedChanges(objs);
     }
 
-    return false;
+    // Writes made while processing the change set have already waited
+    bool wasWriting = tWritingChanges;
+    tWritingChanges = true;
+
+    bool result = opChanges ? ProcessOperationalChangeSet(opChanges)
+        : ProcessStandardChangeSet(standardChanges);
+
+    tWritingChanges = wasWriting;
+
+    return result;
 }
 
 bool Database::UsingDefaultDatabaseType()
@@ -34,6 +34,11 @@
 #include "DatabaseChangeSet.h"
 #include "PersistentObject.h"
 
+// Standard C++11 Includes
+#include <condition_variable>
+#include <functional>
+#include <thread>
+
 namespace libcomp
 {
 
@@ -145,22 +150,40 @@ public:
     virtual std::shared_ptr<PersistentObject> LoadSingleObject(
         size_t typeHash, DatabaseBind *pValue);
 
+    /**
+     * Load every @ref PersistentObject instance whose UUID column matches
+     * one of many values. The values are sent in batches of a few fixed
+     * sizes so each batch is one round trip and the prepared statements
+     * can be cached. This is how a graph of referenced objects should be
+     * loaded instead of one @ref LoadSingleObject call per object.
+     * @param typeHash C++ type hash representing the object type to load
+     * @param column Name of the UUID column to match
+     * @param values UUIDs to match, null and repeated values are skipped
+     * @return List of pointers to loaded objects from the query results
+     */
+    std::list<std::shared_ptr<PersistentObject>> LoadObjectsIn(
+        size_t typeHash, const String& column,
+        const std::list<libobjgen::UUID>& values);
+
     /**
      * Insert one @ref PersistentObject instance into the database.
+     * Queued changes to the object are written first.
      * @param obj Pointer to the object to insert
      * @return true on success, false on failure
      */
-    virtual bool InsertSingleObject(std::shared_ptr<PersistentObject>& obj) = 0;
+    virtual bool InsertSingleObject(std::shared_ptr<PersistentObject>& obj);
 
     /**
      * Update all fields on one @ref PersistentObject instance in the database.
+     * Queued changes to the object are written first.
      * @param obj Pointer to the object to update
      * @return true on success, false on failure
      */
-    virtual bool UpdateSingleObject(std::shared_ptr<PersistentObject>& obj) = 0;
+    virtual bool UpdateSingleObject(std::shared_ptr<PersistentObject>& obj);
 
     /**
      * Delete one @ref PersistentObject instance from the database.
+     * Queued changes to the object are written first.
      * @param obj Pointer to the object to delete
      * @return true on success, false on failure
      */
@@ -211,12 +234,78 @@ public:
 
     /**
      * Pop and process all transactions stored in the transaction queue.
+     * If the transaction writer is running, the queue is processed on the
+     * writer thread instead and this only collects the failures it has
+     * seen since the last call.
      * @return List of all transaction group UUIDs that failed to process
      */
     std::list<libobjgen::UUID> ProcessTransactionQueue();
 
+    /**
+     * Start a thread that processes the transaction queue in the
+     * background. Changes queued close together are written as one
+     * batch. If more objects than the configured WriteQueueLimit are
+     * queued, callers queueing more changes wait until the writer takes
+     * the next batch. Nothing is started if the backend does not support
+     * writing from another thread.
+     */
+    void StartTransactionWriter();
+
+    /**
+     * Write any queued changes and stop the transaction writer thread.
+     * Derived classes must call this before closing the connection.
+     */
+    void StopTransactionWriter();
+
+    /**
+     * Counters kept for the transaction queue. Times are in microseconds.
+     */
+    struct TransactionQueueStats
+    {
+        /// Number of objects currently queued
+        uint64_t QueueDepth;
+
+        /// Highest number of objects queued at once
+        uint64_t MaxQueueDepth;
+
+        /// Number of batches written
+        uint64_t Batches;
+
+        /// Number of change sets written successfully
+        uint64_t Committed;
+
+        /// Number of change sets that failed to write
+        uint64_t Failed;
+
+        /// Number of times a caller had to wait for the writer
+        uint64_t BackpressureWaits;
+
+        /// Time taken to write the last batch
+        uint64_t LastCommitTime;
+
+        /// Average time taken to write a batch
+        uint64_t AvgCommitTime;
+
+        /// Longest time taken to write a batch
+        uint64_t MaxCommitTime;
+    };
+
+    /**
+     * Get the transaction queue counters.
+     * @return Transaction queue counters
+     */
+    TransactionQueueStats GetTransactionQueueStats();
+
+    /**
+     * Get the counters of the prepared statement caches used for object
+     * loads, inserts and updates.
+     * @return Statement cache counters summed over every connection
+     */
+    virtual DatabaseStatementCache::Stats GetStatementCacheStats();
+
     /**
      * Process one or many database changes as a single transaction.
+     * Queued changes to the same objects are written first.
      * @param changes Grouping of changes to apply to the database
      * @return true on success, false on failure
      */
@@ -243,6 +332,34 @@ public:
     std::shared_ptr<objects::DatabaseConfig> GetConfig() const;
 
 protected:
+    /**
+     * Check if queued changes can be written from the transaction writer
+     * thread. Backends that share one connection between threads must
+     * return false so the queue is only written by
+     * ProcessTransactionQueue.
+     * @return true if the transaction writer can be started
+     */
+    virtual bool UsesTransactionWriter() const;
+
+    /**
+     * Get the prepared statement cache for the connection used by the
+     * calling thread.
+     * @return Pointer to the statement cache or nullptr if statements
+     *  are not cached
+     */
+    virtual DatabaseStatementCache* GetStatementCache();
+
+    /**
+     * Get a prepared statement from the statement cache or prepare and
+     * cache a new one.
+     * @param key Key of the statement in the cache
+     * @param getQuery Function that builds the query text, only called
+     *  when the statement needs to be prepared
+     * @return Prepared query
+     */
+    DatabaseQuery PrepareCached(const DatabaseStatementCache::Key& key,
+        const std::function<String()>& getQuery);
+
     /**
      * Get a pointer to a new @ref PersistentObject of the specified
      * type populated with the current row being read from a database
@@ -254,6 +371,45 @@ protected:
     std::shared_ptr<PersistentObject> LoadSingleObjectFromRow(
         size_t typeHash, DatabaseQuery& query);
 
+    /**
+     * Insert a row for one @ref PersistentObject instance.
+     * @param obj Pointer to the object to insert
+     * @param values Values of every field to insert, freed by this call
+     * @return true on success, false on failure
+     */
+    virtual bool InsertValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values) = 0;
+
+    /**
+     * Update the row of one @ref PersistentObject instance.
+     * @param obj Pointer to the object to update
+     * @param values Values of the fields to update (not empty), freed by
+     *  this call
+     * @return true on success, false on failure
+     */
+    virtual bool UpdateValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values) = 0;
+
+    /**
+     * Insert an object from a change set, using the field values copied
+     * when it was queued if there are any.
+     * @param changes Change set the object belongs to
+     * @param obj Pointer to the object to insert
+     * @return true on success, false on failure
+     */
+    bool InsertChangeSetObject(const std::shared_ptr<
+        DBStandardChangeSet>& changes, std::shared_ptr<PersistentObject>& obj);
+
+    /**
+     * Update an object from a change set, using the field values copied
+     * when it was queued if there are any.
+     * @param changes Change set the object belongs to
+     * @param obj Pointer to the object to update
+     * @return true on success, false on failure
+     */
+    bool UpdateChangeSetObject(const std::shared_ptr<
+        DBStandardChangeSet>& changes, std::shared_ptr<PersistentObject>& obj);
+
     /**
      * Process one or many standard database changes as a single transaction.
      * @param changes Grouping of changes to apply to the database
@@ -285,12 +441,86 @@ protected:
     std::shared_ptr<objects::DatabaseConfig> mConfig;
 
 private:
+    /**
+     * Process a set of queued transactions, general transactions first.
+     * @param queue Map of transaction pointers by UUID
+     * @return List of all transaction group UUIDs that failed to process
+     */
+    std::list<libobjgen::UUID> ProcessQueue(std::unordered_map<std::string,
+        std::shared_ptr<DBStandardChangeSet>>& queue);
+
+    /**
+     * Take the queued transactions and write them on the calling thread.
+     * Batches are written one at a time and in the order they were taken.
+     * @param lock Lock held on mTransactionLock, released while the batch
+     *  is written
+     * @return List of all transaction group UUIDs that failed to process
+     */
+    std::list<libobjgen::UUID> WriteQueue(std::unique_lock<std::mutex>& lock);
+
+    /**
+     * Wait until every queued change to the supplied objects has been
+     * written so a direct write is not overwritten by an older queued
+     * copy of the same object. If the transaction writer is not running
+     * the queue is written on the calling thread instead.
+     * @param objs Objects about to be written directly
+     */
+    void WaitForQueuedChanges(
+        const std::list<std::shared_ptr<PersistentObject>>& objs);
+
+    /**
+     * Main loop of the transaction writer thread.
+     */
+    void TransactionWriterMain();
+
     /// Map of transaction pointers by UUID
     std::unordered_map<std::string,
         std::shared_ptr<DBStandardChangeSet>> mTransactionQueue;
 
     /// Mutex to lock accessing the transaction queue
     std::mutex mTransactionLock;
+
+    /// Signaled when changes are queued or the writer should stop
+    std::condition_variable mTransactionQueued;
+
+    /// Signaled when the writer takes a batch from the queue
+    std::condition_variable mTransactionTaken;
+
+    /// Signaled when a batch taken from the queue has been written
+    std::condition_variable mTransactionWritten;
+
+    /// Generation each queued but unwritten object was last queued in
+    std::unordered_map<libobjgen::UUID, uint64_t> mQueuedObjects;
+
+    /// Generation of the last change set queued
+    uint64_t mQueuedGeneration;
+
+    /// Generation of the last change set taken from the queue
+    uint64_t mTakenGeneration;
+
+    /// Generation of the last change set written
+    uint64_t mWrittenGeneration;
+
+    /// true when a direct write is waiting on the writer to take the queue
+    bool mFlushRequested;
+
+    /// Thread that writes queued transactions in the background
+    std::thread mTransactionWriter;
+
+    /// true while the transaction writer thread is running
+    bool mWriterRunning;
+
+    /// true when the transaction writer thread should stop
+    bool mWriterStopping;
+
+    /// Transaction group UUIDs the writer failed to process
+    std::list<libobjgen::UUID> mWriterFailures;
+
+    /// Transaction queue counters and totals
+    TransactionQueueStats mQueueStats;
+
+    /// Total time spent writing batches in microseconds
+    uint64_t mTotalCommitTime;
 };
 
 } // namespace libcomp
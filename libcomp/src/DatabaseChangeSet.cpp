@@ -30,6 +30,9 @@
 // libcomp Includes
 #include "DatabaseBind.h"
 
+// Standard C++11 Includes
+#include <sstream>
+
 using namespace libcomp;
 
 DatabaseChangeSet::DatabaseChangeSet()
@@ -102,6 +105,113 @@ std::list<std::shared_ptr<PersistentObject>> DBStandardChangeSet::GetDeletes() c
     return mDeletes;
 }
 
+bool DBStandardChangeSet::InsertCopy(const std::shared_ptr<PersistentObject>& obj)
+{
+    Insert(obj);
+
+    std::stringstream objstream;
+    if(!obj->Save(objstream))
+    {
+        return false;
+    }
+
+    if(obj->GetUUID().IsNull() && !PersistentObject::Register(obj))
+    {
+        return false;
+    }
+
+    AddValues(obj.get(), obj->GetMemberBindValues(true));
+
+    return true;
+}
+
+bool DBStandardChangeSet::UpdateCopy(const std::shared_ptr<PersistentObject>& obj)
+{
+    Update(obj);
+
+    std::stringstream objstream;
+    if(!obj->Save(objstream) || obj->GetUUID().IsNull())
+    {
+        return false;
+    }
+
+    AddValues(obj.get(), obj->GetMemberBindValues());
+
+    return true;
+}
+
+void DBStandardChangeSet::Merge(DBStandardChangeSet& other)
+{
+    for(auto obj : other.mInserts)
+    {
+        Insert(obj);
+    }
+
+    for(auto obj : other.mUpdates)
+    {
+        Update(obj);
+    }
+
+    for(auto obj : other.mDeletes)
+    {
+        Delete(obj);
+    }
+
+    for(auto& pair : other.mValues)
+    {
+        std::list<DatabaseBind*> values;
+        for(auto& value : pair.second)
+        {
+            values.push_back(value.release());
+        }
+
+        AddValues(pair.first, values);
+    }
+
+    other.mInserts.clear();
+    other.mUpdates.clear();
+    other.mDeletes.clear();
+    other.mValues.clear();
+}
+
+bool DBStandardChangeSet::TakeValues(const std::shared_ptr<PersistentObject>& obj,
+    std::list<DatabaseBind*>& values)
+{
+    auto it = mValues.find(obj.get());
+    if(it == mValues.end())
+    {
+        return false;
+    }
+
+    // Leave the entry so a second use of the same object writes nothing
+    for(auto& value : it->second)
+    {
+        values.push_back(value.release());
+    }
+
+    it->second.clear();
+
+    return true;
+}
+
+void DBStandardChangeSet::AddValues(const PersistentObject* obj,
+    const std::list<DatabaseBind*>& values)
+{
+    auto& copied = mValues[obj];
+
+    for(auto value : values)
+    {
+        auto column = value->GetColumn();
+
+        copied.remove_if([&column](const std::unique_ptr<DatabaseBind>& c)
+            {
+                return c->GetColumn() == column;
+            });
+
+        copied.push_back(std::unique_ptr<DatabaseBind>(value));
+    }
+}
+
 DBOperationalChange::DBOperationalChange(const std::shared_ptr<PersistentObject>& record,
     DBOperationType type)
     : mType(type), mRecord(record)
@@ -35,10 +35,14 @@
 #include "MetaObject.h"
 #include "MetaVariable.h"
 
+// Standard C++11 Includes
+#include <unordered_map>
+
 namespace libcomp
 {
 
 class DataBind;
+class DatabaseBind;
 class PersistentObject;
 
 /**
@@ -173,7 +177,54 @@ public:
      */
     std::list<std::shared_ptr<PersistentObject>> GetDeletes() const;
 
+    /**
+     * Insert an object and copy its field values now. The copy is written
+     * instead of the object so the object can keep changing on other
+     * threads until the change set is processed.
+     * @param obj Pointer to the object to insert
+     * @return true if the values were copied, false if the object could
+     *  not be saved or registered and will be read when written instead
+     */
+    bool InsertCopy(const std::shared_ptr<PersistentObject>& obj);
+
+    /**
+     * Update an object and copy its changed field values now. Values
+     * copied earlier for the same object are kept unless the column
+     * changed again.
+     * @param obj Pointer to the object to update
+     * @return true if the values were copied, false if the object could
+     *  not be saved and will be read when written instead
+     */
+    bool UpdateCopy(const std::shared_ptr<PersistentObject>& obj);
+
+    /**
+     * Move every change and copied value from another change set into
+     * this one.
+     * @param other Change set to empty into this one
+     */
+    void Merge(DBStandardChangeSet& other);
+
+    /**
+     * Take the field values copied for an object by @ref InsertCopy or
+     * @ref UpdateCopy.
+     * @param obj Pointer to the object
+     * @param values Output list of values, the caller must delete them
+     * @return true if values were copied for the object, false if they
+     *  should be read from the object
+     */
+    bool TakeValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values);
+
 private:
+    /**
+     * Add copied values for an object, replacing any earlier value for
+     * the same column.
+     * @param obj Pointer to the object the values belong to
+     * @param values Values to add, ownership is taken
+     */
+    void AddValues(const PersistentObject* obj,
+        const std::list<DatabaseBind*>& values);
+
     /// Inserts associated to the change set
     std::list<std::shared_ptr<PersistentObject>> mInserts;
 
@@ -182,6 +233,10 @@ private:
 
     /// Deletes associated to the change set
     std::list<std::shared_ptr<PersistentObject>> mDeletes;
+
+    /// Field values copied when objects were added by object
+    std::unordered_map<const PersistentObject*,
+        std::list<std::unique_ptr<DatabaseBind>>> mValues;
 };
 
 /**
@@ -48,6 +48,7 @@ DatabaseMariaDB::DatabaseMariaDB(const std::shared_ptr<
 
 DatabaseMariaDB::~DatabaseMariaDB()
 {
+    StopTransactionWriter();
     Close();
 }
 
@@ -61,6 +62,14 @@ bool DatabaseMariaDB::Close()
     bool result = true;
 
     std::lock_guard<std::mutex> lock(mConnectionLock);
+
+    // Statements must be closed before their connections
+    for(auto kv : mStatementCaches)
+    {
+        kv.second->Clear();
+    }
+    mStatementCaches.clear();
+
     for(auto kv : mConnections)
     {
         result &= Close(kv.second);
@@ -193,17 +202,30 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
         return {};
     }
 
-    String sql = String("SELECT * FROM `%1`%2").Arg(
-        metaObject->GetName()).Arg(
-        (nullptr != pValue
-            ? String(" WHERE `%1` = :%1").Arg(pValue->GetColumn())
-            : ""));
+    auto getSQL = [&]()
+    {
+        return String("SELECT * FROM `%1`%2").Arg(
+            metaObject->GetName()).Arg(
+            (nullptr != pValue
+                ? String(" WHERE `%1` = :%1").Arg(pValue->GetColumn())
+                : ""));
+    };
 
-    DatabaseQuery query = Prepare(sql);
+    std::list<DatabaseBind*> columns;
+    if(nullptr != pValue)
+    {
+        columns.push_back(pValue);
+    }
+
+    DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+        metaObject->GetName(), DatabaseStatementCache::Operation::SELECT,
+        columns),
+        getSQL);
 
     if(!query.IsValid())
     {
-        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return {};
@@ -220,7 +242,8 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
 
     if(!query.Execute())
     {
-        LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return {};
@@ -251,46 +274,40 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseMariaDB::LoadObjects(
     return objects;
 }
 
-bool DatabaseMariaDB::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
+bool DatabaseMariaDB::InsertValues(const std::shared_ptr<PersistentObject>& obj,
+    std::list<DatabaseBind*>& values)
 {
     auto metaObject = obj->GetObjectMetadata();
 
-    std::stringstream objstream;
-    if(!obj->Save(objstream))
+    auto getSQL = [&]()
     {
-        return false;
-    }
-
-    if(obj->GetUUID().IsNull() && !obj->Register(obj))
-    {
-        return false;
-    }
+        std::list<String> columnNames;
+        columnNames.push_back("`UID`");
 
-    std::list<String> columnNames;
-    columnNames.push_back("`UID`");
+        std::list<String> columnBinds;
+        columnBinds.push_back(":UID");
 
-    std::list<String> columnBinds;
-    columnBinds.push_back(":UID");
-
-    auto values = obj->GetMemberBindValues(true);
-
-    for(auto value : values)
-    {
-        auto columnName = value->GetColumn();
-        columnNames.push_back(String("`%1`").Arg(columnName));
-        columnBinds.push_back(String(":%1").Arg(columnName));
-    }
+        for(auto value : values)
+        {
+            auto columnName = value->GetColumn();
+            columnNames.push_back(String("`%1`").Arg(columnName));
+            columnBinds.push_back(String(":%1").Arg(columnName));
+        }
 
-    String sql = String("INSERT INTO `%1` (%2) VALUES (%3);").Arg(
-        metaObject->GetName()).Arg(
-        String::Join(columnNames, ", ")).Arg(
-        String::Join(columnBinds, ", "));
+        return String("INSERT INTO `%1` (%2) VALUES (%3);").Arg(
+            metaObject->GetName()).Arg(
+            String::Join(columnNames, ", ")).Arg(
+            String::Join(columnBinds, ", "));
+    };
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+        metaObject->GetName(), DatabaseStatementCache::Operation::INSERT,
+        values), getSQL);
 
     if(!query.IsValid())
     {
-        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return false;
@@ -314,59 +331,55 @@ bool DatabaseMariaDB::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
 
             return false;
         }
-
-        delete value;
     }
 
-    if(!query.Execute())
+    // Values are freed after executing so the query text can still be
+    // built if it fails
+    bool result = query.Execute();
+
+    if(!result)
     {
-        LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+    }
 
-        return false;
+    for(auto value : values)
+    {
+        delete value;
     }
 
-    return true;
+    return result;
 }
 
-bool DatabaseMariaDB::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
+bool DatabaseMariaDB::UpdateValues(const std::shared_ptr<PersistentObject>& obj,
+    std::list<DatabaseBind*>& values)
 {
     auto metaObject = obj->GetObjectMetadata();
 
-    std::stringstream objstream;
-    if(!obj->Save(objstream))
-    {
-        return false;
-    }
-
-    if(obj->GetUUID().IsNull())
-    {
-        return false;
-    }
-
-    auto values = obj->GetMemberBindValues();
-    if(values.size() == 0)
+    auto getSQL = [&]()
     {
-        //Nothing updated, nothing to do
-        return true;
-    }
-
-    std::list<String> columnNames;
+        std::list<String> columnNames;
 
-    for(auto value : values)
-    {
-        columnNames.push_back(String("`%1` = :%1").Arg(value->GetColumn()));
-    }
+        for(auto value : values)
+        {
+            columnNames.push_back(String("`%1` = :%1").Arg(
+                value->GetColumn()));
+        }
 
-    String sql = String("UPDATE `%1` SET %2 WHERE `UID` = :UID;").Arg(
-        metaObject->GetName()).Arg(
-        String::Join(columnNames, ", "));
+        return String("UPDATE `%1` SET %2 WHERE `UID` = :UID;").Arg(
+            metaObject->GetName()).Arg(
+            String::Join(columnNames, ", "));
+    };
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+        metaObject->GetName(), DatabaseStatementCache::Operation::UPDATE,
+        values), getSQL);
 
     if(!query.IsValid())
     {
-        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return false;
@@ -390,19 +403,25 @@ bool DatabaseMariaDB::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
 
             return false;
         }
-
-        delete value;
     }
 
-    if(!query.Execute())
+    // Values are freed after executing so the query text can still be
+    // built if it fails
+    bool result = query.Execute();
+
+    if(!result)
     {
-        LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+    }
 
-        return false;
+    for(auto value : values)
+    {
+        delete value;
     }
 
-    return true;
+    return result;
 }
 
 bool DatabaseMariaDB::DeleteObjects(std::list<std::shared_ptr<PersistentObject>>& objs)
@@ -779,7 +798,7 @@ bool DatabaseMariaDB::ProcessStandardChangeSet(const std::shared_ptr<
     bool result = true;
     for(auto obj : changes->GetInserts())
     {
-        if(!InsertSingleObject(obj))
+        if(!InsertChangeSetObject(changes, obj))
         {
             result = false;
             break;
@@ -790,7 +809,7 @@ bool DatabaseMariaDB::ProcessStandardChangeSet(const std::shared_ptr<
     {
         for(auto obj : changes->GetUpdates())
         {
-            if(!UpdateSingleObject(obj))
+            if(!UpdateChangeSetObject(changes, obj))
             {
                 result = false;
                 break;
@@ -1055,6 +1074,39 @@ MYSQL*& DatabaseMariaDB::GetConnection(bool autoConnect)
     return mConnections[threadID];
 }
 
+DatabaseStatementCache::Stats DatabaseMariaDB::GetStatementCacheStats()
+{
+    DatabaseStatementCache::Stats stats = {};
+
+    std::lock_guard<std::mutex> lock(mConnectionLock);
+    for(auto kv : mStatementCaches)
+    {
+        auto cacheStats = kv.second->GetStats();
+        stats.Prepares += cacheStats.Prepares;
+        stats.Hits += cacheStats.Hits;
+        stats.Evictions += cacheStats.Evictions;
+        stats.Cached += cacheStats.Cached;
+    }
+
+    return stats;
+}
+
+DatabaseStatementCache* DatabaseMariaDB::GetStatementCache()
+{
+    auto threadID = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(mConnectionLock);
+
+    // Statements belong to a connection so each thread has its own cache
+    auto& cache = mStatementCaches[threadID];
+    if(!cache)
+    {
+        cache = std::make_shared<DatabaseStatementCache>(
+            (size_t)mConfig->GetStatementCacheSize());
+    }
+
+    return cache.get();
+}
+
 String DatabaseMariaDB::GetVariableType(const std::shared_ptr
     <libobjgen::MetaVariable> var)
 {
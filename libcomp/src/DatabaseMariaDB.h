@@ -93,8 +93,6 @@ public:
     virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
         size_t typeHash, DatabaseBind *pValue);
 
-    virtual bool InsertSingleObject(std::shared_ptr<PersistentObject>& obj);
-    virtual bool UpdateSingleObject(std::shared_ptr<PersistentObject>& obj);
     virtual bool DeleteObjects(std::list<std::shared_ptr<PersistentObject>>& objs);
 
     /**
@@ -116,7 +114,16 @@ public:
      */
     virtual String GetLastError();
 
+    virtual DatabaseStatementCache::Stats GetStatementCacheStats();
+
 protected:
+    virtual bool InsertValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values);
+    virtual bool UpdateValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values);
+
+    virtual DatabaseStatementCache* GetStatementCache();
+
     virtual bool ProcessStandardChangeSet(const std::shared_ptr<
         DBStandardChangeSet>& changes);
     virtual bool ProcessOperationalChangeSet(const std::shared_ptr<
@@ -163,6 +170,10 @@ private:
     /// throughout the class as they are not removed or modified until the database
     /// is closed.
     std::unordered_map<std::thread::id, MYSQL*> mConnections;
+
+    /// Prepared statement cache for each thread's connection
+    std::unordered_map<std::thread::id,
+        std::shared_ptr<DatabaseStatementCache>> mStatementCaches;
 };
 
 } // namespace libcomp
@@ -67,25 +67,53 @@ int64_t DatabaseQueryImpl::AffectedRowCount() const
     return mAffectedRowCount;
 }
 
-DatabaseQuery::DatabaseQuery(DatabaseQueryImpl *pImpl) : mImpl(pImpl)
+bool DatabaseQueryImpl::Reset()
+{
+    return false;
+}
+
+DatabaseQuery::DatabaseQuery(DatabaseQueryImpl *pImpl) : mImpl(pImpl),
+    mCache(nullptr), mCacheKey()
 {
 }
 
 DatabaseQuery::DatabaseQuery(DatabaseQueryImpl *pImpl, const String& query) :
-    mImpl(pImpl)
+    mImpl(pImpl), mCache(nullptr), mCacheKey()
 {
     Prepare(query);
 }
 
-DatabaseQuery::DatabaseQuery(DatabaseQuery&& other) : mImpl(other.mImpl)
+DatabaseQuery::DatabaseQuery(DatabaseQueryImpl *pImpl,
+    DatabaseStatementCache *pCache, const DatabaseStatementCache::Key& key) :
+    mImpl(pImpl), mCache(pCache), mCacheKey(key)
+{
+}
+
+DatabaseQuery::DatabaseQuery(DatabaseQuery&& other) : mImpl(other.mImpl),
+    mCache(other.mCache), mCacheKey(other.mCacheKey)
 {
     other.mImpl = nullptr;
+    other.mCache = nullptr;
 }
 
 DatabaseQuery::~DatabaseQuery()
 {
-    delete mImpl;
+    Release();
+}
+
+void DatabaseQuery::Release()
+{
+    if(nullptr != mImpl && nullptr != mCache)
+    {
+        mCache->Return(mCacheKey, mImpl);
+    }
+    else
+    {
+        delete mImpl;
+    }
+
     mImpl = nullptr;
+    mCache = nullptr;
 }
 
 bool DatabaseQuery::Prepare(const String& query)
@@ -571,12 +599,22 @@ int64_t DatabaseQuery::AffectedRowCount() const
     return result;
 }
 
+void DatabaseQuery::SetStatementCache(DatabaseStatementCache *pCache,
+    const DatabaseStatementCache::Key& key)
+{
+    mCache = pCache;
+    mCacheKey = key;
+}
+
 DatabaseQuery& DatabaseQuery::operator=(DatabaseQuery&& other)
 {
-    delete mImpl;
+    Release();
 
     mImpl = other.mImpl;
+    mCache = other.mCache;
+    mCacheKey = other.mCacheKey;
     other.mImpl = nullptr;
+    other.mCache = nullptr;
 
     return *this;
 }
@@ -32,6 +32,7 @@
 
 // libcomp Includes
 #include "CString.h"
+#include "DatabaseStatementCache.h"
 
 // Standard C++11 Includes
 #include <unordered_map>
@@ -369,6 +370,13 @@ public:
      */
     int64_t AffectedRowCount() const;
 
+    /**
+     * Reset an executed query so it can be bound and executed again
+     * without being prepared. Bindings and results are cleared.
+     * @return true if the query can be reused, false if it can not
+     */
+    virtual bool Reset();
+
     /**
      * Check current query state validity.
      * @return true on valid, false on invalid
@@ -404,6 +412,17 @@ public:
      */
     DatabaseQuery(DatabaseQueryImpl *pImpl, const String& query);
 
+    /**
+     * Create a database query around a statement from a statement cache.
+     * The implementation is returned to the cache instead of deleted.
+     * @param pImpl Pointer to a prepared database specific query
+     *  implementation
+     * @param pCache Cache to return the implementation to
+     * @param key Key of the statement in the cache
+     */
+    DatabaseQuery(DatabaseQueryImpl *pImpl, DatabaseStatementCache *pCache,
+        const DatabaseStatementCache::Key& key);
+
     /**
      * Disable the default copy constructor.
      * @param other The other query to copy
@@ -417,7 +436,8 @@ public:
     DatabaseQuery(DatabaseQuery&& other);
 
     /**
-     * Clean up the query and delete the implementation pointer.
+     * Clean up the query and delete the implementation pointer or
+     * return it to the statement cache it came from.
      */
     ~DatabaseQuery();
 
@@ -741,6 +761,15 @@ public:
      */
     int64_t AffectedRowCount() const;
 
+    /**
+     * Return the implementation to a statement cache instead of deleting
+     * it when the query is cleaned up.
+     * @param pCache Cache to return the implementation to
+     * @param key Key of the statement in the cache
+     */
+    void SetStatementCache(DatabaseStatementCache *pCache,
+        const DatabaseStatementCache::Key& key);
+
     /**
      * Copy operator implementation.
      * @param other The other query to copy
@@ -749,8 +778,19 @@ public:
     DatabaseQuery& operator=(DatabaseQuery&& other);
 
 protected:
+    /**
+     * Delete the implementation or return it to its statement cache.
+     */
+    void Release();
+
     /// Database specific implementation
     DatabaseQueryImpl *mImpl;
+
+    /// Statement cache the implementation is returned to, if any
+    DatabaseStatementCache *mCache;
+
+    /// Key of the implementation in the statement cache
+    DatabaseStatementCache::Key mCacheKey;
 };
 
 } // namespace libcomp
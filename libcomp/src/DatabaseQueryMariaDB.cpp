@@ -709,6 +709,43 @@ bool DatabaseQueryMariaDB::GetRows(std::list<std::unordered_map<
     return IsValid();
 }
 
+bool DatabaseQueryMariaDB::Reset()
+{
+    if(nullptr == mStatement)
+    {
+        return false;
+    }
+
+    mysql_stmt_free_result(mStatement);
+
+    if(mysql_stmt_reset(mStatement))
+    {
+        mStatus = -1;
+        return false;
+    }
+
+    // Parameter names come from the prepared text so they are kept, the
+    // bindings are rebuilt on the next Bind
+    mStatus = 0;
+    mAffectedRowCount = 0;
+
+    mBindings.clear();
+    mResultBindings.clear();
+    mResultColumnNames.clear();
+    mResultColumnTypes.clear();
+
+    mBufferInt.clear();
+    mBufferBigInt.clear();
+    mBufferFloat.clear();
+    mBufferDouble.clear();
+    mBufferBlob.clear();
+    mBufferBool.clear();
+    mBufferNulls.clear();
+    mBufferLengths.clear();
+
+    return true;
+}
+
 bool DatabaseQueryMariaDB::IsValid() const
 {
     return nullptr != mDatabase && nullptr != mStatement &&
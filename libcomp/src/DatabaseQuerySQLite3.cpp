@@ -586,6 +586,27 @@ bool DatabaseQuerySQLite3::GetRows(std::list<std::unordered_map<
     return IsValid();
 }
 
+bool DatabaseQuerySQLite3::Reset()
+{
+    if(nullptr == mStatement)
+    {
+        return false;
+    }
+
+    // The result of the reset is the status of the last step which does
+    // not matter here
+    (void)sqlite3_reset(mStatement);
+    mStatus = sqlite3_clear_bindings(mStatement);
+
+    mDidJustExecute = false;
+    mAffectedRowCount = 0;
+
+    mResultColumnNames.clear();
+    mResultColumnTypes.clear();
+
+    return IsValid();
+}
+
 bool DatabaseQuerySQLite3::IsValid() const
 {
     return nullptr != mDatabase && nullptr != mStatement &&
@@ -105,6 +105,7 @@ public:
     virtual bool GetRows(std::list<std::unordered_map<
         std::string, std::vector<char>>>& rows);
 
+    virtual bool Reset();
     virtual bool IsValid() const;
 
     /**
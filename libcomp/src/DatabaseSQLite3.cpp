@@ -39,12 +39,14 @@ using namespace libcomp;
 DatabaseSQLite3::DatabaseSQLite3(const std::shared_ptr<
     objects::DatabaseConfigSQLite3>& config) :
     Database(std::dynamic_pointer_cast<objects::DatabaseConfig>(config)),
-    mDatabase(nullptr)
+    mDatabase(nullptr), mStatementCache(std::make_shared<
+    DatabaseStatementCache>((size_t)config->GetStatementCacheSize()))
 {
 }
 
 DatabaseSQLite3::~DatabaseSQLite3()
 {
+    StopTransactionWriter();
     Close();
 }
 
@@ -73,6 +75,12 @@ bool DatabaseSQLite3::Close()
 
     if(nullptr != mDatabase)
     {
+        // Statements must be finalized before the connection is closed
+        if(mStatementCache)
+        {
+            mStatementCache->Clear();
+        }
+
         if(SQLITE_OK != sqlite3_close(mDatabase))
         {
             result = false;
@@ -188,17 +196,30 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
         return {};
     }
 
-    String sql = String("SELECT * FROM %1%2").Arg(
-        metaObject->GetName()).Arg(
-        (nullptr != pValue
-            ? String(" WHERE %1 = :%1").Arg(pValue->GetColumn())
-            : ""));
+    auto getSQL = [&]()
+    {
+        return String("SELECT * FROM %1%2").Arg(
+            metaObject->GetName()).Arg(
+            (nullptr != pValue
+                ? String(" WHERE %1 = :%1").Arg(pValue->GetColumn())
+                : ""));
+    };
+
+    std::list<DatabaseBind*> columns;
+    if(nullptr != pValue)
+    {
+        columns.push_back(pValue);
+    }
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+        metaObject->GetName(), DatabaseStatementCache::Operation::SELECT,
+        columns),
+        getSQL);
 
     if(!query.IsValid())
     {
-        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return {};
@@ -215,7 +236,8 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
 
     if(!query.Execute())
     {
-        LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return {};
@@ -246,46 +268,40 @@ std::list<std::shared_ptr<PersistentObject>> DatabaseSQLite3::LoadObjects(
     return objects;
 }
 
-bool DatabaseSQLite3::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
+bool DatabaseSQLite3::InsertValues(const std::shared_ptr<PersistentObject>& obj,
+    std::list<DatabaseBind*>& values)
 {
     auto metaObject = obj->GetObjectMetadata();
 
-    std::stringstream objstream;
-    if(!obj->Save(objstream))
-    {
-        return false;
-    }
-
-    if(obj->GetUUID().IsNull() && !obj->Register(obj))
+    auto getSQL = [&]()
     {
-        return false;
-    }
+        std::list<String> columnNames;
+        columnNames.push_back("UID");
 
-    std::list<String> columnNames;
-    columnNames.push_back("UID");
+        std::list<String> columnBinds;
+        columnBinds.push_back(":UID");
 
-    std::list<String> columnBinds;
-    columnBinds.push_back(":UID");
-
-    auto values = obj->GetMemberBindValues(true);
-
-    for(auto value : values)
-    {
-        auto columnName = value->GetColumn();
-        columnNames.push_back(columnName);
-        columnBinds.push_back(String(":%1").Arg(columnName));
-    }
+        for(auto value : values)
+        {
+            auto columnName = value->GetColumn();
+            columnNames.push_back(columnName);
+            columnBinds.push_back(String(":%1").Arg(columnName));
+        }
 
-    String sql = String("INSERT INTO %1 (%2) VALUES (%3);").Arg(
-        metaObject->GetName()).Arg(
-        String::Join(columnNames, ", ")).Arg(
-        String::Join(columnBinds, ", "));
+        return String("INSERT INTO %1 (%2) VALUES (%3);").Arg(
+            metaObject->GetName()).Arg(
+            String::Join(columnNames, ", ")).Arg(
+            String::Join(columnBinds, ", "));
+    };
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+        metaObject->GetName(), DatabaseStatementCache::Operation::INSERT,
+        values), getSQL);
 
     if(!query.IsValid())
     {
-        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return false;
@@ -309,59 +325,55 @@ bool DatabaseSQLite3::InsertSingleObject(std::shared_ptr<PersistentObject>& obj)
 
             return false;
         }
-
-        delete value;
     }
 
-    if(!query.Execute())
+    // Values are freed after executing so the query text can still be
+    // built if it fails
+    bool result = query.Execute();
+
+    if(!result)
     {
-        LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+    }
 
-        return false;
+    for(auto value : values)
+    {
+        delete value;
     }
 
-    return true;
+    return result;
 }
 
-bool DatabaseSQLite3::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
+bool DatabaseSQLite3::UpdateValues(const std::shared_ptr<PersistentObject>& obj,
+    std::list<DatabaseBind*>& values)
 {
     auto metaObject = obj->GetObjectMetadata();
 
-    std::stringstream objstream;
-    if(!obj->Save(objstream))
-    {
-        return false;
-    }
-
-    if(obj->GetUUID().IsNull())
+    auto getSQL = [&]()
     {
-        return false;
-    }
-
-    auto values = obj->GetMemberBindValues();
-    if(values.size() == 0)
-    {
-        //Nothing updated, nothing to do
-        return true;
-    }
-
-    std::list<String> columnNames;
+        std::list<String> columnNames;
 
-    for(auto value : values)
-    {
-        columnNames.push_back(String("%1 = :%1").Arg(value->GetColumn()));
-    }
+        for(auto value : values)
+        {
+            columnNames.push_back(String("%1 = :%1").Arg(
+                value->GetColumn()));
+        }
 
-    String sql = String("UPDATE %1 SET %2 WHERE UID = :UID;").Arg(
-        metaObject->GetName()).Arg(
-        String::Join(columnNames, ", "));
+        return String("UPDATE %1 SET %2 WHERE UID = :UID;").Arg(
+            metaObject->GetName()).Arg(
+            String::Join(columnNames, ", "));
+    };
 
-    DatabaseQuery query = Prepare(sql);
+    DatabaseQuery query = PrepareCached(DatabaseStatementCache::GetKey(
+        metaObject->GetName(), DatabaseStatementCache::Operation::UPDATE,
+        values), getSQL);
 
     if(!query.IsValid())
     {
-        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to prepare SQL query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
 
         return false;
@@ -385,19 +397,25 @@ bool DatabaseSQLite3::UpdateSingleObject(std::shared_ptr<PersistentObject>& obj)
 
             return false;
         }
-
-        delete value;
     }
 
-    if(!query.Execute())
+    // Values are freed after executing so the query text can still be
+    // built if it fails
+    bool result = query.Execute();
+
+    if(!result)
     {
-        LOG_ERROR(String("Failed to execute query: %1\n").Arg(sql));
+        LOG_ERROR(String("Failed to execute query: %1\n").Arg(
+            getSQL()));
         LOG_ERROR(String("Database said: %1\n").Arg(GetLastError()));
+    }
 
-        return false;
+    for(auto value : values)
+    {
+        delete value;
     }
 
-    return true;
+    return result;
 }
 
 bool DatabaseSQLite3::DeleteObjects(std::list<std::shared_ptr<PersistentObject>>& objs)
@@ -755,7 +773,7 @@ bool DatabaseSQLite3::ProcessStandardChangeSet(const std::shared_ptr<
     bool result = true;
     for(auto obj : changes->GetInserts())
     {
-        if(!InsertSingleObject(obj))
+        if(!InsertChangeSetObject(changes, obj))
         {
             result = false;
             break;
@@ -766,7 +784,7 @@ bool DatabaseSQLite3::ProcessStandardChangeSet(const std::shared_ptr<
     {
         for(auto obj : changes->GetUpdates())
         {
-            if(!UpdateSingleObject(obj))
+            if(!UpdateChangeSetObject(changes, obj))
             {
                 result = false;
                 break;
@@ -971,6 +989,28 @@ bool DatabaseSQLite3::ProcessExplicitUpdate(const std::shared_ptr<
     return query.AffectedRowCount() == 1;
 }
 
+DatabaseStatementCache::Stats DatabaseSQLite3::GetStatementCacheStats()
+{
+    DatabaseStatementCache::Stats stats = {};
+
+    if(mStatementCache)
+    {
+        stats = mStatementCache->GetStats();
+    }
+
+    return stats;
+}
+
+bool DatabaseSQLite3::UsesTransactionWriter() const
+{
+    return false;
+}
+
+DatabaseStatementCache* DatabaseSQLite3::GetStatementCache()
+{
+    return mStatementCache.get();
+}
+
 String DatabaseSQLite3::GetFilepath() const
 {
     auto config = std::dynamic_pointer_cast<objects::DatabaseConfigSQLite3>(mConfig);
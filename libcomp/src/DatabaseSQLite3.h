@@ -90,8 +90,6 @@ public:
     virtual std::list<std::shared_ptr<PersistentObject>> LoadObjects(
         size_t typeHash, DatabaseBind *pValue);
 
-    virtual bool InsertSingleObject(std::shared_ptr<PersistentObject>& obj);
-    virtual bool UpdateSingleObject(std::shared_ptr<PersistentObject>& obj);
     virtual bool DeleteObjects(std::list<std::shared_ptr<PersistentObject>>& objs);
 
     /**
@@ -107,7 +105,23 @@ public:
      */
     bool VerifyAndSetupSchema(bool recreateTables = false);
 
+    virtual DatabaseStatementCache::Stats GetStatementCacheStats();
+
 protected:
+    virtual bool InsertValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values);
+    virtual bool UpdateValues(const std::shared_ptr<PersistentObject>& obj,
+        std::list<DatabaseBind*>& values);
+
+    /**
+     * The SQLite3 connection is shared by every thread so a second thread
+     * writing the queue would nest transactions with the server thread.
+     * @return false, the queue is written by ProcessTransactionQueue
+     */
+    virtual bool UsesTransactionWriter() const;
+
+    virtual DatabaseStatementCache* GetStatementCache();
+
     virtual bool ProcessStandardChangeSet(const std::shared_ptr<
         DBStandardChangeSet>& changes);
     virtual bool ProcessOperationalChangeSet(const std::shared_ptr<
@@ -138,6 +152,9 @@ private:
 
     /// Pointer to the SQLite3 representation of the database file connection
     sqlite3 *mDatabase;
+
+    /// Prepared statement cache for the connection
+    std::shared_ptr<DatabaseStatementCache> mStatementCache;
 };
 
 } // namespace libcomp
@@ -0,0 +1,181 @@
+/**
+ * @file libcomp/src/DatabaseStatementCache.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Cache of prepared statements for a database connection.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DatabaseStatementCache.h"
+
+// libcomp Includes
+#include "DatabaseBind.h"
+#include "DatabaseQuery.h"
+
+using namespace libcomp;
+
+bool DatabaseStatementCache::Key::operator==(const Key& other) const
+{
+    return Hash == other.Hash && Op == other.Op && Table == other.Table &&
+        Columns == other.Columns;
+}
+
+size_t DatabaseStatementCache::KeyHash::operator()(const Key& key) const
+{
+    return (size_t)(key.Hash ^ (key.Hash >> 32));
+}
+
+DatabaseStatementCache::DatabaseStatementCache(size_t limit) : mLimit(limit),
+    mStats()
+{
+}
+
+DatabaseStatementCache::~DatabaseStatementCache()
+{
+    Clear();
+}
+
+DatabaseStatementCache::Key DatabaseStatementCache::GetKey(
+    const std::string& table, Operation op,
+    const std::list<DatabaseBind*>& columns)
+{
+    Key key;
+    key.Table = table;
+    key.Op = op;
+
+    for(auto pColumn : columns)
+    {
+        String name = pColumn->GetColumn();
+
+        key.Columns.append(name.C(), name.Size());
+        key.Columns.push_back('\0');
+    }
+
+    // FNV-1a over the table, the operation and the column names. The
+    // table is followed by a null too so it can not run into the columns.
+    uint64_t h = 14695981039346656037ULL;
+
+    for(char c : key.Table)
+    {
+        h = (h ^ (uint8_t)c) * 1099511628211ULL;
+    }
+
+    h *= 1099511628211ULL;
+    h = (h ^ (uint8_t)op) * 1099511628211ULL;
+
+    for(char c : key.Columns)
+    {
+        h = (h ^ (uint8_t)c) * 1099511628211ULL;
+    }
+
+    key.Hash = h;
+
+    return key;
+}
+
+DatabaseQueryImpl* DatabaseStatementCache::Take(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    auto it = mLookup.find(key);
+    if(it == mLookup.end())
+    {
+        mStats.Prepares++;
+
+        return nullptr;
+    }
+
+    DatabaseQueryImpl *pImpl = it->second->second;
+
+    mEntries.erase(it->second);
+    mLookup.erase(it);
+
+    mStats.Hits++;
+
+    return pImpl;
+}
+
+void DatabaseStatementCache::Return(const Key& key, DatabaseQueryImpl *pImpl)
+{
+    if(0 == mLimit || !pImpl->Reset())
+    {
+        delete pImpl;
+
+        return;
+    }
+
+    DatabaseQueryImpl *pEvicted = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        if(mLookup.find(key) != mLookup.end())
+        {
+            // Another query with the same key was prepared while this one
+            // was out, one copy is enough
+            pEvicted = pImpl;
+        }
+        else
+        {
+            mEntries.push_front(std::make_pair(key, pImpl));
+            mLookup[key] = mEntries.begin();
+
+            if(mEntries.size() > mLimit)
+            {
+                pEvicted = mEntries.back().second;
+
+                mLookup.erase(mEntries.back().first);
+                mEntries.pop_back();
+
+                mStats.Evictions++;
+            }
+        }
+    }
+
+    delete pEvicted;
+}
+
+void DatabaseStatementCache::Clear()
+{
+    std::list<Entry> entries;
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        entries.swap(mEntries);
+        mLookup.clear();
+    }
+
+    for(auto& entry : entries)
+    {
+        delete entry.second;
+    }
+}
+
+DatabaseStatementCache::Stats DatabaseStatementCache::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    Stats stats = mStats;
+    stats.Cached = (uint64_t)mEntries.size();
+
+    return stats;
+}
@@ -0,0 +1,184 @@
+/**
+ * @file libcomp/src/DatabaseStatementCache.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Cache of prepared statements for a database connection.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_DATABASESTATEMENTCACHE_H
+#define LIBCOMP_SRC_DATABASESTATEMENTCACHE_H
+
+// Standard C++11 Includes
+#include <list>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+namespace libcomp
+{
+
+class DatabaseBind;
+class DatabaseQueryImpl;
+
+/**
+ * Cache of prepared statements for the object operations of one database
+ * connection. Statements are keyed by the table, the operation and the
+ * names of the columns bound, which is everything the SQL text is built
+ * from, so the SQL does not need to be built again when the same
+ * operation repeats. A statement is removed from the
+ * cache while a @ref DatabaseQuery is using it and reset before it is
+ * returned so it can never be used by two queries at once. The least
+ * recently used statements are finalized once the cache is full.
+ */
+class DatabaseStatementCache
+{
+public:
+    /**
+     * Object operation a statement performs.
+     */
+    enum class Operation : uint8_t
+    {
+        SELECT = 0,
+        INSERT,
+        UPDATE,
+    };
+
+    /**
+     * Identifies a cached statement.
+     */
+    struct Key
+    {
+        /// Table the statement works on
+        std::string Table;
+
+        /// Operation the statement performs
+        Operation Op;
+
+        /// Names of the bound columns in order, each followed by a null
+        std::string Columns;
+
+        /// Hash of every other member, only used to find the statement
+        uint64_t Hash;
+
+        bool operator==(const Key& other) const;
+    };
+
+    /**
+     * Counters kept for the cache.
+     */
+    struct Stats
+    {
+        /// Number of statements prepared because the cache missed
+        uint64_t Prepares;
+
+        /// Number of statements reused from the cache
+        uint64_t Hits;
+
+        /// Number of statements finalized because the cache was full
+        uint64_t Evictions;
+
+        /// Number of statements currently cached
+        uint64_t Cached;
+    };
+
+    /**
+     * Create the cache.
+     * @param limit Maximum number of statements to keep, 0 disables
+     *  the cache
+     */
+    explicit DatabaseStatementCache(size_t limit);
+
+    /**
+     * Finalize every cached statement.
+     */
+    ~DatabaseStatementCache();
+
+    /**
+     * Build the key for a statement.
+     * @param table Table the statement works on
+     * @param op Operation the statement performs
+     * @param columns Values bound to the statement excluding the UID
+     * @return Key for the statement
+     */
+    static Key GetKey(const std::string& table, Operation op,
+        const std::list<DatabaseBind*>& columns);
+
+    /**
+     * Take a statement out of the cache. The caller must prepare a new
+     * statement if nothing is cached for the key.
+     * @param key Key of the statement
+     * @return Pointer to the prepared statement or nullptr
+     */
+    DatabaseQueryImpl* Take(const Key& key);
+
+    /**
+     * Reset a statement and put it back in the cache. Statements that
+     * can't be reset or are not needed are deleted.
+     * @param key Key of the statement
+     * @param pImpl Statement to return
+     */
+    void Return(const Key& key, DatabaseQueryImpl *pImpl);
+
+    /**
+     * Finalize every cached statement. This must be done before the
+     * connection the statements belong to is closed.
+     */
+    void Clear();
+
+    /**
+     * Get the cache counters.
+     * @return Cache counters
+     */
+    Stats GetStats();
+
+private:
+    /**
+     * Hash function for statement keys.
+     */
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const;
+    };
+
+    /// Cached statement and its key
+    typedef std::pair<Key, DatabaseQueryImpl*> Entry;
+
+    /// Maximum number of statements to keep
+    size_t mLimit;
+
+    /// Cached statements, most recently used first
+    std::list<Entry> mEntries;
+
+    /// Position of each cached statement in mEntries
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mLookup;
+
+    /// Cache counters
+    Stats mStats;
+
+    /// Lock for every member
+    std::mutex mLock;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_DATABASESTATEMENTCACHE_H
@@ -25,6 +25,7 @@
  */
 
 #include "Decrypt.h"
+#include "BlowfishEcb.h"
 #include "Config.h"
 #include "Exception.h"
 #include "Packet.h"
@@ -500,15 +501,9 @@ void Decrypt::Encrypt(const BF_KEY& key, void *pVoidData, uint32_t dataSize)
     // Make room for the padded block.
     if(0 == (dataSize % BLOWFISH_BLOCK_SIZE))
     {
-        char *pData = reinterpret_cast<char*>(pVoidData);
-
         // Encrypt each full block.
-        while(BLOWFISH_BLOCK_SIZE <= dataSize)
-        {
-            BF_encrypt(reinterpret_cast<BF_LONG*>(pData), &key);
-            pData += BLOWFISH_BLOCK_SIZE;
-            dataSize -= static_cast<uint32_t>(BLOWFISH_BLOCK_SIZE);
-        }
+        BlowfishEcb::Encrypt(key, pVoidData, dataSize /
+            static_cast<uint32_t>(BLOWFISH_BLOCK_SIZE));
     }
 }
 
@@ -527,15 +522,9 @@ void Decrypt::Encrypt(const BF_KEY& key, std::vector<char>& data)
         data.resize(size, 0);
     }
 
-    char *pData = &data[0];
-
     // Encrypt each full block.
-    while(BLOWFISH_BLOCK_SIZE <= size)
-    {
-        BF_encrypt(reinterpret_cast<BF_LONG*>(pData), &key);
-        pData += BLOWFISH_BLOCK_SIZE;
-        size -= BLOWFISH_BLOCK_SIZE;
-    }
+    BlowfishEcb::Encrypt(key, data.data(), static_cast<uint32_t>(
+        size / BLOWFISH_BLOCK_SIZE));
 }
 
 void Decrypt::Encrypt(std::vector<char>& data)
@@ -548,15 +537,9 @@ void Decrypt::Decrypt(const BF_KEY& key, void *pVoidData, uint32_t dataSize)
     // Make room for the padded block.
     if(0 == (dataSize % BLOWFISH_BLOCK_SIZE))
     {
-        char *pData = reinterpret_cast<char*>(pVoidData);
-
         // Decrypt each full block.
-        while(BLOWFISH_BLOCK_SIZE <= dataSize)
-        {
-            BF_decrypt(reinterpret_cast<BF_LONG*>(pData), &key);
-            pData += BLOWFISH_BLOCK_SIZE;
-            dataSize -= static_cast<uint32_t>(BLOWFISH_BLOCK_SIZE);
-        }
+        BlowfishEcb::Decrypt(key, pVoidData, dataSize /
+            static_cast<uint32_t>(BLOWFISH_BLOCK_SIZE));
     }
 }
 
@@ -564,18 +547,13 @@ void Decrypt::Decrypt(const BF_KEY& key, std::vector<char>& data,
     std::vector<char>::size_type realSize)
 {
     std::vector<char>::size_type size = data.size();
-    char *pData = &data[0];
 
     if((0 == realSize || realSize <= size) &&
         0 == (size % BLOWFISH_BLOCK_SIZE))
     {
         // Decrypt each full block.
-        while(BLOWFISH_BLOCK_SIZE <= size)
-        {
-            BF_decrypt(reinterpret_cast<BF_LONG*>(pData), &key);
-            pData += BLOWFISH_BLOCK_SIZE;
-            size -= BLOWFISH_BLOCK_SIZE;
-        }
+        BlowfishEcb::Decrypt(key, data.data(), static_cast<uint32_t>(
+            size / BLOWFISH_BLOCK_SIZE));
     }
 
     // Resize the data if requested.
@@ -28,6 +28,7 @@
 
 // libcomp Includes
 #include "Log.h"
+#include "WorkStealingPool.h"
 
 // object Includes
 #include <EnchantSetData.h>
@@ -78,8 +79,26 @@
 #include <QmpFile.h>
 #include <Tokusei.h>
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
 using namespace libcomp;
 
+#ifndef DEFINITION_SCHEMA_HASH
+#error DEFINITION_SCHEMA_HASH must be defined by the build
+#endif // DEFINITION_SCHEMA_HASH
+
+namespace
+{
+
+/// Layout key of saved definition snapshots. Only snapshots saved from
+/// the same objgen schema are loaded.
+const char SNAPSHOT_LAYOUT[] = DEFINITION_SCHEMA_HASH;
+
+} // namespace
+
 DefinitionManager::DefinitionManager()
 {
 }
@@ -120,6 +139,12 @@ const std::shared_ptr<objects::MiDevilData> DefinitionManager::GetDevilData(cons
     return nullptr;
 }
 
+std::unordered_map<uint32_t, std::shared_ptr<objects::MiDevilData>>
+    DefinitionManager::GetAllDevilData()
+{
+    return mDevilData;
+}
+
 const std::shared_ptr<objects::MiDevilLVUpRateData> DefinitionManager::GetDevilLVUpRateData(uint32_t id)
 {
     return GetRecordByID(id, mDevilLVUpRateData);
@@ -417,6 +442,12 @@ const std::list<std::shared_ptr<objects::MiTriUnionSpecialData>>
     return result;
 }
 
+std::unordered_map<uint32_t, std::shared_ptr<objects::MiTriUnionSpecialData>>
+    DefinitionManager::GetAllTriUnionSpecialData()
+{
+    return mTriUnionSpecialData;
+}
+
 const std::shared_ptr<objects::MiWarpPointData> DefinitionManager::GetWarpPointData(uint32_t id)
 {
     return GetRecordByID(id, mWarpPointData);
@@ -504,6 +535,109 @@ const std::unordered_map<int32_t,
 bool DefinitionManager::LoadAllData(gsl::not_null<DataStore*> pDataStore)
 {
     LOG_INFO("Loading binary data definitions...\n");
+
+    if(!mSnapshotPath.IsEmpty())
+    {
+        mSnapshot.Load(mSnapshotPath, SNAPSHOT_LAYOUT);
+    }
+
+    // Read, decrypt and parse every file in parallel first. The
+    // definitions and lookups are then built from the parsed records one
+    // file at a time on this thread below.
+    std::vector<std::function<void()>> tasks;
+    PreloadBinaryData<objects::MiAIData>(pDataStore,
+        "Shield/AIData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiCItemData>(pDataStore,
+        "Shield/CItemData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiDevilData>(pDataStore,
+        "Shield/DevilData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiDevilBookData>(pDataStore,
+        "Shield/DevilBookData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiDevilLVUpRateData>(pDataStore,
+        "Shield/DevilLVUpRateData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiDisassemblyData>(pDataStore,
+        "Shield/DisassemblyData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiDisassemblyTriggerData>(pDataStore,
+        "Shield/DisassemblyTriggerData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiDynamicMapData>(pDataStore,
+        "Client/DynamicMapData.bin", false, 0, tasks);
+    PreloadBinaryData<objects::MiEnchantData>(pDataStore,
+        "Shield/EnchantData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiEquipmentSetData>(pDataStore,
+        "Shield/EquipmentSetData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiExchangeData>(pDataStore,
+        "Shield/ExchangeData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiExpertData>(pDataStore,
+        "Shield/ExpertClassData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiHNPCData>(pDataStore,
+        "Shield/hNPCData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiItemData>(pDataStore,
+        "Shield/ItemData.sbin", true, 2, tasks);
+    PreloadBinaryData<objects::MiModificationData>(pDataStore,
+        "Shield/ModificationData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiModificationExtEffectData>(pDataStore,
+        "Shield/ModificationExtEffectData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiModificationExtRecipeData>(pDataStore,
+        "Shield/ModificationExtRecipeData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiModificationTriggerData>(pDataStore,
+        "Shield/ModificationTriggerData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiModifiedEffectData>(pDataStore,
+        "Shield/ModifiedEffectData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiNPCBarterData>(pDataStore,
+        "Shield/NPCBarterData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiONPCData>(pDataStore,
+        "Shield/oNPCData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiQuestData>(pDataStore,
+        "Shield/QuestData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiShopProductData>(pDataStore,
+        "Shield/ShopProductData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiSItemData>(pDataStore,
+        "Shield/SItemData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiSkillData>(pDataStore,
+        "Shield/SkillData.sbin", true, 4, tasks);
+    PreloadBinaryData<objects::MiStatusData>(pDataStore,
+        "Shield/StatusData.sbin", true, 1, tasks);
+    PreloadBinaryData<objects::MiTriUnionSpecialData>(pDataStore,
+        "Shield/TriUnionSpecialData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiWarpPointData>(pDataStore,
+        "Shield/WarpPointData.sbin", true, 0, tasks);
+    PreloadBinaryData<objects::MiZoneData>(pDataStore,
+        "Shield/ZoneData.sbin", true, 0, tasks);
+
+    {
+        // The calling thread parses files too so one less is needed
+        size_t threadCount = std::thread::hardware_concurrency() > 1
+            ? (size_t)(std::thread::hardware_concurrency() - 1) : 0;
+
+        WorkStealingPool pool(std::min(threadCount, tasks.size()),
+            "definitions");
+        pool.Run(tasks);
+    }
+
+    if(!mSnapshotPath.IsEmpty())
+    {
+        size_t fromSnapshot = 0;
+        bool preloaded = true;
+        for(auto& pair : mPreloaded)
+        {
+            preloaded &= pair.second.Success;
+            fromSnapshot += pair.second.FromSnapshot ? 1 : 0;
+        }
+
+        LOG_DEBUG(libcomp::String("Loaded %1/%2 binary data files from the"
+            " definition snapshot.\n").Arg((uint32_t)fromSnapshot)
+            .Arg((uint32_t)mPreloaded.size()));
+
+        // Every record has been copied out of the snapshot now so the
+        // mapping is not needed past this point
+        mSnapshot.Close();
+
+        if(preloaded && fromSnapshot != mPreloaded.size())
+        {
+            SaveSnapshot();
+        }
+    }
+
     bool success = true;
     success &= LoadAIData(pDataStore);
     success &= LoadCItemData(pDataStore);
@@ -535,6 +669,9 @@ bool DefinitionManager::LoadAllData(gsl::not_null<DataStore*> pDataStore)
     success &= LoadWarpPointData(pDataStore);
     success &= LoadZoneData(pDataStore);
 
+    // Drop anything that was parsed but not used
+    mPreloaded.clear();
+
     if(success)
     {
         LOG_INFO("Definition loading complete.\n");
@@ -547,6 +684,11 @@ bool DefinitionManager::LoadAllData(gsl::not_null<DataStore*> pDataStore)
     return success;
 }
 
+void DefinitionManager::SetSnapshotPath(const libcomp::String& path)
+{
+    mSnapshotPath = path;
+}
+
 bool DefinitionManager::LoadAIData(gsl::not_null<DataStore*> pDataStore)
 {
     std::list<std::shared_ptr<objects::MiAIData>> records;
@@ -1186,6 +1328,42 @@ bool DefinitionManager::LoadBinaryDataHeader(libcomp::ObjectInStream& ois,
     return true;
 }
 
+bool DefinitionManager::SaveSnapshot()
+{
+    // Keep the saved records alive until the snapshot is written
+    std::list<std::string> data;
+    DefinitionSnapshot::Entries entries;
+
+    for(auto& pair : mPreloaded)
+    {
+        auto& preloaded = pair.second;
+
+        std::stringstream ss;
+        for(auto record : preloaded.Records)
+        {
+            if(!record->Save(ss))
+            {
+                LOG_ERROR(libcomp::String("Failed to save %1 to the"
+                    " definition snapshot.\n").Arg(pair.first));
+                return false;
+            }
+        }
+
+        data.push_back(ss.str());
+
+        DefinitionSnapshot::Entry& entry = entries[pair.first];
+        entry.TypeName = preloaded.TypeName;
+        entry.SourceSize = preloaded.SourceSize;
+        entry.SourceTime = preloaded.SourceTime;
+        entry.Count = (uint32_t)preloaded.Records.size();
+        entry.pData = data.back().data();
+        entry.Size = data.back().size();
+    }
+
+    return DefinitionSnapshot::Save(mSnapshotPath, SNAPSHOT_LAYOUT,
+        entries);
+}
+
 void DefinitionManager::PrintLoadResult(const libcomp::String& binaryFile,
     bool success, uint16_t entriesExpected, size_t loadedEntries)
 {
@@ -34,11 +34,19 @@
 #include "CString.h"
 #include "DataStore.h"
 #include "Decrypt.h"
+#include "DefinitionSnapshot.h"
+#include "MappedFile.h"
 #include "MiCorrectTbl.h"
 #include "Object.h"
+#include "VectorStream.h"
 
 // Standard C++11 Includes
+#include <functional>
+#include <istream>
+#include <list>
+#include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 namespace objects
 {
@@ -135,6 +143,13 @@ public:
      */
     const std::shared_ptr<objects::MiDevilData> GetDevilData(const libcomp::String& name);
 
+    /**
+     * Get a map of all devil definitions by ID
+     * @return Map of all devil definitions by ID
+     */
+    std::unordered_map<uint32_t,
+        std::shared_ptr<objects::MiDevilData>> GetAllDevilData();
+
     /**
      * Get the devil level up information corresponding to an ID
      * @param id Devil level up information ID to retrieve
@@ -416,6 +431,13 @@ public:
     const std::list<std::shared_ptr<objects::MiTriUnionSpecialData>>
         GetTriUnionSpecialData(uint32_t sourceDemonTypeID);
 
+    /**
+     * Get a map of all special fusion definitions by ID
+     * @return Map of all special fusion definitions by ID
+     */
+    std::unordered_map<uint32_t, std::shared_ptr<
+        objects::MiTriUnionSpecialData>> GetAllTriUnionSpecialData();
+
     /**
      * Get the warp point corresponding to an ID
      * @param id Warp point ID to retrieve
@@ -497,6 +519,14 @@ public:
      */
     bool LoadAllData(gsl::not_null<DataStore*> pDataStore);
 
+    /**
+     * Set the snapshot file @ref LoadAllData saves parsed binary data to
+     * and loads it back from while the data files are unchanged.
+     * @param path Path of the snapshot file on disk or blank to not use
+     *  a snapshot
+     */
+    void SetSnapshotPath(const libcomp::String& path);
+
     /**
      * Load the client-side AI binary data definitions
      * @param pDataStore Pointer to the datastore to load binary file from
@@ -727,7 +757,37 @@ public:
 
 private:
     /**
-     * Load a binary file from the specified data store location
+     * Records of a binary file parsed ahead of time by
+     * @ref LoadAllData.
+     */
+    struct PreloadedBinaryData
+    {
+        /// Hash of the record type the file was parsed as
+        size_t TypeHash;
+
+        /// Name of the record type the file was parsed as
+        std::string TypeName;
+
+        /// Size of the data file
+        int64_t SourceSize;
+
+        /// Modification time of the data file
+        int64_t SourceTime;
+
+        /// true if every record in the file was parsed
+        bool Success;
+
+        /// true if the records were parsed from the snapshot
+        bool FromSnapshot;
+
+        /// Records parsed from the file
+        std::list<std::shared_ptr<libcomp::Object>> Records;
+    };
+
+    /**
+     * Load a binary file from the specified data store location. If
+     * @ref LoadAllData already parsed the file its records are used
+     * instead of reading the file again.
      * @param pDataStore Pointer to a data store location to check
      *  for the file
      * @param binaryFile Relative file path to a binary file
@@ -745,6 +805,135 @@ private:
         const libcomp::String& binaryFile, bool decrypt,
         uint16_t tablesExpected, std::list<std::shared_ptr<T>>& records,
         bool printResults = true)
+    {
+        auto it = mPreloaded.find(binaryFile.C());
+        if(it != mPreloaded.end() &&
+            it->second.TypeHash == typeid(T).hash_code())
+        {
+            for(auto record : it->second.Records)
+            {
+                records.push_back(std::static_pointer_cast<T>(record));
+            }
+
+            bool success = it->second.Success;
+            mPreloaded.erase(it);
+
+            return success;
+        }
+
+        return ParseBinaryData<T>(pDataStore, binaryFile, decrypt,
+            tablesExpected, records, printResults);
+    }
+
+    /**
+     * Queue a binary file to be parsed by @ref LoadAllData before the
+     * definitions are built from it. The records are picked up by the
+     * next call to @ref LoadBinaryData for the same file and type.
+     * @param pDataStore Pointer to a data store location to check
+     *  for the file
+     * @param binaryFile Relative file path to a binary file
+     * @param decrypt true if the file is encrypted and must be
+     *  decrypted first, false if it can just be loaded
+     * @param tablesExpected Number of tables expected in the file
+     *  format
+     * @param tasks List of tasks to add the parse task to
+     */
+    template <class T>
+    void PreloadBinaryData(gsl::not_null<DataStore*> pDataStore,
+        const libcomp::String& binaryFile, bool decrypt,
+        uint16_t tablesExpected, std::vector<std::function<void()>>& tasks)
+    {
+        // Each task only writes to its own entry which is created here
+        // so the map is not modified while the tasks run.
+        PreloadedBinaryData *pPreloaded = &mPreloaded[binaryFile.C()];
+        pPreloaded->TypeHash = typeid(T).hash_code();
+        pPreloaded->Success = false;
+
+        pPreloaded->TypeName = typeid(T).name();
+        pPreloaded->FromSnapshot = false;
+
+        tasks.push_back([this, pDataStore, binaryFile, decrypt,
+            tablesExpected, pPreloaded]()
+        {
+            std::list<std::shared_ptr<T>> records;
+
+            auto path = libcomp::String("/BinaryData/") + binaryFile;
+            pPreloaded->SourceSize = pDataStore->FileSize(path);
+            pPreloaded->SourceTime = pDataStore->LastModified(path);
+
+            // Use the snapshot if it was saved from the same file
+            auto& entries = mSnapshot.GetEntries();
+            auto it = entries.find(binaryFile.C());
+            if(it != entries.end() && 0 <= pPreloaded->SourceTime &&
+                it->second.TypeName == pPreloaded->TypeName &&
+                it->second.SourceSize == pPreloaded->SourceSize &&
+                it->second.SourceTime == pPreloaded->SourceTime &&
+                ParseSnapshotData<T>(it->second, records))
+            {
+                pPreloaded->Success = true;
+                pPreloaded->FromSnapshot = true;
+            }
+            else
+            {
+                records.clear();
+                pPreloaded->Success = ParseBinaryData<T>(pDataStore,
+                    binaryFile, decrypt, tablesExpected, records);
+            }
+
+            pPreloaded->Records.assign(records.begin(), records.end());
+        });
+    }
+
+    /**
+     * Parse the records of a binary file saved in the snapshot.
+     * @param entry Snapshot entry of the file
+     * @param records Output list to load records into
+     * @return true if every record was parsed, false if the entry is
+     *  damaged
+     */
+    template <class T>
+    bool ParseSnapshotData(const DefinitionSnapshot::Entry& entry,
+        std::list<std::shared_ptr<T>>& records)
+    {
+        libcomp::MemoryStreamBuf buffer(entry.pData, entry.Size);
+        std::istream in(&buffer);
+
+        for(uint32_t i = 0; i < entry.Count; i++)
+        {
+            auto record = std::shared_ptr<T>(new T);
+
+            if(!record->Load(in) || in.fail())
+            {
+                return false;
+            }
+
+            records.push_back(record);
+        }
+
+        return true;
+    }
+
+    /**
+     * Read and parse a binary file from the specified data store
+     * location. This does not modify the manager so it may be called
+     * from several threads at once.
+     * @param pDataStore Pointer to a data store location to check
+     *  for the file
+     * @param binaryFile Relative file path to a binary file
+     * @param decrypt true if the file is encrypted and must be
+     *  decrypted first, false if it can just be loaded
+     * @param tablesExpected Number of tables expected in the file
+     *  format
+     * @param records Output list to load records into
+     * @param printResults Optional parameter to disable success/fail
+     *  debug messages
+     * @return true if the file was loaded, false if it was not
+     */
+    template <class T>
+    bool ParseBinaryData(gsl::not_null<DataStore*> pDataStore,
+        const libcomp::String& binaryFile, bool decrypt,
+        uint16_t tablesExpected, std::list<std::shared_ptr<T>>& records,
+        bool printResults = true)
     {
         std::vector<char> data;
 
@@ -768,7 +957,9 @@ private:
             return false;
         }
 
-        std::stringstream ss(std::string(data.begin(), data.end()));
+        // Parse straight out of the file buffer instead of copying it
+        libcomp::VectorStream<char> buffer(data);
+        std::istream ss(&buffer);
         libcomp::ObjectInStream ois(ss);
 
         uint16_t entryCount, tableCount;
@@ -829,6 +1020,12 @@ private:
         const libcomp::String& binaryFile, uint16_t tablesExpected,
         uint16_t& entryCount, uint16_t& tableCount);
 
+    /**
+     * Save every preloaded binary file to the snapshot file.
+     * @return true if the snapshot was written, false if it was not
+     */
+    bool SaveSnapshot();
+
     /**
      * Utility function to print the result of loading a binary file
      * @param binaryFile Relative file path to a binary file
@@ -1040,6 +1237,18 @@ private:
     /// Map of tokusei definitions by ID
     std::unordered_map<int32_t,
         std::shared_ptr<objects::Tokusei>> mTokuseiData;
+
+    /// Binary files parsed by @ref LoadAllData that have not been built
+    /// into definitions yet, by relative file path
+    std::unordered_map<std::string, PreloadedBinaryData> mPreloaded;
+
+    /// Path of the snapshot file or blank if none is used
+    libcomp::String mSnapshotPath;
+
+    /// Snapshot file mapped while @ref LoadAllData runs. The records are
+    /// copied out of it by the preload tasks and it is closed before the
+    /// definitions are built.
+    libcomp::DefinitionSnapshot mSnapshot;
 };
 
 } // namspace libcomp
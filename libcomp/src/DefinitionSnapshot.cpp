@@ -0,0 +1,313 @@
+/**
+ * @file libcomp/src/DefinitionSnapshot.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief File of binary data records saved by a previous start.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DefinitionSnapshot.h"
+
+// libcomp Includes
+#include "Decrypt.h"
+#include "Log.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+// zlib Includes
+#include <zlib.h>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Identifies a definition snapshot file
+const char SNAPSHOT_MAGIC[8] = { 'C', 'O', 'M', 'P', 'D', 'E', 'F', 'S' };
+
+/// Version of the snapshot layout. This must change along with the way
+/// objgen saves records as the layout key only covers the schema.
+const uint32_t SNAPSHOT_VERSION = 2;
+
+/**
+ * Fixed header at the start of a definition snapshot file.
+ */
+struct SnapshotHeader_t
+{
+    /// Must match @ref SNAPSHOT_MAGIC
+    char magic[8];
+
+    /// Must match @ref SNAPSHOT_VERSION
+    uint32_t version;
+
+    /// CRC-32 of everything after the header
+    uint32_t checksum;
+
+    /// Number of bytes after the header
+    uint64_t bodySize;
+};
+
+/**
+ * Bounds checked reader over the body of a mapped snapshot.
+ */
+class SnapshotReader
+{
+public:
+    SnapshotReader(const char *pData, size_t size) : mData(pData),
+        mSize(size), mOffset(0)
+    {
+    }
+
+    template <class T>
+    bool Read(T& value)
+    {
+        if(sizeof(value) > (mSize - mOffset))
+        {
+            return false;
+        }
+
+        memcpy(&value, mData + mOffset, sizeof(value));
+        mOffset += sizeof(value);
+
+        return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+        uint32_t length = 0;
+        const char *pValue = nullptr;
+
+        if(!Read(length) || !Skip((size_t)length, pValue))
+        {
+            return false;
+        }
+
+        value.assign(pValue, (size_t)length);
+
+        return true;
+    }
+
+    bool Skip(size_t size, const char*& pStart)
+    {
+        if(size > (mSize - mOffset))
+        {
+            return false;
+        }
+
+        pStart = mData + mOffset;
+        mOffset += size;
+
+        return true;
+    }
+
+private:
+    const char *mData;
+    size_t mSize;
+    size_t mOffset;
+};
+
+template <class T>
+void AppendSnapshotValue(std::vector<char>& body, T value)
+{
+    const char *pValue = reinterpret_cast<const char*>(&value);
+    body.insert(body.end(), pValue, pValue + sizeof(value));
+}
+
+void AppendSnapshotString(std::vector<char>& body, const std::string& value)
+{
+    AppendSnapshotValue(body, (uint32_t)value.size());
+    body.insert(body.end(), value.begin(), value.end());
+}
+
+uint32_t SnapshotChecksum(const char *pData, size_t size)
+{
+    uLong crc = crc32(0L, Z_NULL, 0);
+
+    // Feed zlib in pieces that fit its 32-bit length
+    while(size > 0)
+    {
+        uInt chunk = (uInt)std::min(size, (size_t)0x40000000);
+
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(pData), chunk);
+
+        pData += chunk;
+        size -= chunk;
+    }
+
+    return (uint32_t)crc;
+}
+
+} // namespace
+
+bool DefinitionSnapshot::Load(const String& path, const std::string& layout)
+{
+    Close();
+
+    if(!mFile.Open(path))
+    {
+        LOG_DEBUG(String("No definition snapshot found at %1\n").Arg(path));
+        return false;
+    }
+
+    const char *pData = mFile.GetData();
+    size_t size = mFile.GetSize();
+
+    SnapshotHeader_t header;
+    if(size < sizeof(header))
+    {
+        LOG_WARNING(String("Ignoring damaged definition snapshot: %1\n")
+            .Arg(path));
+        mFile.Close();
+        return false;
+    }
+
+    memcpy(&header, pData, sizeof(header));
+
+    if(0 != memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) ||
+        SNAPSHOT_VERSION != header.version ||
+        (uint64_t)(size - sizeof(header)) != header.bodySize ||
+        header.checksum != SnapshotChecksum(pData + sizeof(header),
+            size - sizeof(header)))
+    {
+        LOG_WARNING(String("Ignoring damaged or outdated definition"
+            " snapshot: %1\n").Arg(path));
+        mFile.Close();
+        return false;
+    }
+
+    SnapshotReader reader(pData + sizeof(header), size - sizeof(header));
+
+    std::string savedLayout;
+    uint32_t fileCount = 0;
+    if(!reader.ReadString(savedLayout) || savedLayout != layout ||
+        !reader.Read(fileCount))
+    {
+        LOG_INFO(String("Definition snapshot %1 was saved with a different"
+            " record layout and will be replaced.\n").Arg(path));
+        mFile.Close();
+        return false;
+    }
+
+    for(uint32_t i = 0; i < fileCount; i++)
+    {
+        std::string file;
+        Entry entry;
+        uint64_t dataSize = 0;
+
+        if(!reader.ReadString(file) || !reader.ReadString(entry.TypeName) ||
+            !reader.Read(entry.SourceSize) || !reader.Read(entry.SourceTime) ||
+            !reader.Read(entry.Count) || !reader.Read(dataSize) ||
+            !reader.Skip((size_t)dataSize, entry.pData))
+        {
+            LOG_WARNING(String("Ignoring damaged definition snapshot: %1\n")
+                .Arg(path));
+            Close();
+            return false;
+        }
+
+        entry.Size = (size_t)dataSize;
+        mEntries[file] = entry;
+    }
+
+    return true;
+}
+
+void DefinitionSnapshot::Close()
+{
+    mEntries.clear();
+    mFile.Close();
+}
+
+const DefinitionSnapshot::Entries& DefinitionSnapshot::GetEntries() const
+{
+    return mEntries;
+}
+
+bool DefinitionSnapshot::Save(const String& path, const std::string& layout,
+    const Entries& entries)
+{
+    std::vector<char> body;
+
+    AppendSnapshotString(body, layout);
+    AppendSnapshotValue(body, (uint32_t)entries.size());
+
+    for(auto& pair : entries)
+    {
+        auto& entry = pair.second;
+
+        AppendSnapshotString(body, pair.first);
+        AppendSnapshotString(body, entry.TypeName);
+        AppendSnapshotValue(body, entry.SourceSize);
+        AppendSnapshotValue(body, entry.SourceTime);
+        AppendSnapshotValue(body, entry.Count);
+        AppendSnapshotValue(body, (uint64_t)entry.Size);
+        body.insert(body.end(), entry.pData, entry.pData + entry.Size);
+    }
+
+    SnapshotHeader_t header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.checksum = SnapshotChecksum(body.data(), body.size());
+    header.bodySize = (uint64_t)body.size();
+
+    // Several channels may share the snapshot and save it at the same
+    // time so each one writes its own temporary file.
+    String tempPath = String("%1.%2.tmp").Arg(path).Arg(
+        Decrypt::GenerateRandom(16));
+
+    {
+        std::ofstream out(tempPath.C(), std::ios::out |
+            std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(body.data(), (std::streamsize)body.size());
+        out.close();
+
+        if(!out.good())
+        {
+            LOG_ERROR(String("Failed to write definition snapshot: %1\n")
+                .Arg(tempPath));
+            std::remove(tempPath.C());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // Windows will not rename over an existing file.
+    std::remove(path.C());
+#endif // _WIN32
+
+    if(0 != std::rename(tempPath.C(), path.C()))
+    {
+        LOG_ERROR(String("Failed to replace definition snapshot: %1\n")
+            .Arg(path));
+        std::remove(tempPath.C());
+        return false;
+    }
+
+    LOG_INFO(String("Saved definition snapshot: %1\n").Arg(path));
+
+    return true;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file libcomp/src/DefinitionSnapshot.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief File of binary data records saved by a previous start.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_DEFINITIONSNAPSHOT_H
+#define LIBCOMP_SRC_DEFINITIONSNAPSHOT_H
+
+// libcomp Includes
+#include "CString.h"
+#include "MappedFile.h"
+
+// Standard C++11 Includes
+#include <string>
+#include <unordered_map>
+
+namespace libcomp
+{
+
+/**
+ * Snapshot file holding the saved records of each binary data file along
+ * with the size and modification time of the data file they were parsed
+ * from. The file is mapped while it is read and every entry points into
+ * the mapping, so the entries are only valid until @ref Close is called.
+ */
+class DefinitionSnapshot
+{
+public:
+    /**
+     * Records of one binary data file stored in the snapshot.
+     */
+    struct Entry
+    {
+        /// Name of the record type the records were saved as
+        std::string TypeName;
+
+        /// Size of the data file the records were parsed from
+        int64_t SourceSize;
+
+        /// Modification time of the data file the records were parsed
+        /// from
+        int64_t SourceTime;
+
+        /// Number of records saved
+        uint32_t Count;
+
+        /// Saved records
+        const char *pData;
+
+        /// Size of the saved records
+        size_t Size;
+    };
+
+    /// Entries by relative path of the binary data file
+    typedef std::unordered_map<std::string, Entry> Entries;
+
+    /**
+     * Map a snapshot file and index the entries saved in it. A snapshot
+     * that fails its checksum or was saved with a different record layout
+     * is ignored.
+     * @param path Path of the snapshot file on disk
+     * @param layout Key of the record layout of this build
+     * @return true if the snapshot was mapped, false if there is no
+     *  usable snapshot
+     */
+    bool Load(const String& path, const std::string& layout);
+
+    /**
+     * Unmap the snapshot and remove every entry.
+     */
+    void Close();
+
+    /**
+     * Get the entries of the mapped snapshot.
+     * @return Entries by relative path of the binary data file
+     */
+    const Entries& GetEntries() const;
+
+    /**
+     * Save a snapshot file. The file is written under a name unique to
+     * the call first and then renamed so processes sharing the snapshot
+     * never map or write over a partial snapshot.
+     * @param path Path of the snapshot file on disk
+     * @param layout Key of the record layout of this build
+     * @param entries Entries to save by relative path of the binary
+     *  data file
+     * @return true if the snapshot was written, false if it was not
+     */
+    static bool Save(const String& path, const std::string& layout,
+        const Entries& entries);
+
+private:
+    /// Mapped snapshot file
+    MappedFile mFile;
+
+    /// Entries inside the mapped snapshot file
+    Entries mEntries;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_DEFINITIONSNAPSHOT_H
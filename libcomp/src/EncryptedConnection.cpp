@@ -30,6 +30,7 @@
 #include "Constants.h"
 #include "Decrypt.h"
 #include "Exception.h"
+#include "HandshakePool.h"
 #include "Log.h"
 #include "MessageConnectionClosed.h"
 #include "MessageEncrypted.h"
@@ -40,6 +41,7 @@
 #include <ServerConfig.h>
 
 // Standard C++11 Includes
+#include <algorithm>
 #include <ctime>
 
 using namespace libcomp;
@@ -122,6 +124,7 @@ void EncryptedConnection::ConnectionSuccess()
     else
     {
         mPacketParser = &EncryptedConnection::ParseServerEncryptionStart;
+        mHandshakeStart = std::chrono::steady_clock::now();
 
         // Read the first packet.
         if(!RequestPacket(2 * sizeof(uint32_t)))
@@ -401,28 +404,21 @@ void EncryptedConnection::ParseServerEncryptionStart(libcomp::Packet& packet)
         {
             mStatus = STATUS_WAITING_ENCRYPTION;
 
-            libcomp::Packet reply;
-
-            reply.WriteBlank(4);
-            reply.WriteString32Big(libcomp::Convert::ENCODING_UTF8,
-                DH_BASE_STRING);
-            reply.WriteString32Big(libcomp::Convert::ENCODING_UTF8,
-                GetDiffieHellmanPrime(mDiffieHellman));
-            reply.WriteString32Big(libcomp::Convert::ENCODING_UTF8,
-                GenerateDiffieHellmanPublic(mDiffieHellman).RightJustified(
-                DH_KEY_HEX_SIZE, '0'));
-
-            SendPacket(reply);
-
-            mPacketParser = &EncryptedConnection::ParseServerEncryptionFinish;
-
             // Get ready for the next packet.
             packet.Clear();
 
-            // Wait for the client public size (then the public).
-            if(!RequestPacket(sizeof(uint32_t)))
+            // Use a key pair generated ahead of time if one is ready.
+            mHandshakePublic = HandshakePool::GetSingletonPtr()->TakeKeyPair(
+                mDiffieHellman);
+
+            if(mHandshakePublic.IsEmpty())
             {
-                SocketError("Failed to request more data.");
+                RunHandshakeStep(&EncryptedConnection::GenerateServerPublic,
+                    &EncryptedConnection::SendServerPublic);
+            }
+            else
+            {
+                SendServerPublic();
             }
         }
         else
@@ -485,33 +481,13 @@ void EncryptedConnection::ParseServerEncryptionFinish(libcomp::Packet& packet)
         // Make sure we read the entire packet.
         if(status && 0 == packet.Left())
         {
-            std::vector<char> sharedData = GenerateDiffieHellmanSharedData(
-                mDiffieHellman, clientPublic);
-
-            if(BF_NET_KEY_BYTE_SIZE != sharedData.size())
-            {
-                // Get ready for the next packet.
-                packet.Clear();
-
-                SocketError("Failed to generate shared data.");
-            }
-            else
-            {
-                // Set the encryption key.
-                SetEncryptionKey(sharedData);
+            mHandshakeClientPublic = clientPublic;
 
-                // We are now encrypted.
-                mStatus = STATUS_ENCRYPTED;
-
-                // Use this packet parser now.
-                mPacketParser = &EncryptedConnection::ParsePacket;
-
-                // Get ready for the next packet.
-                packet.Clear();
+            // Get ready for the next packet.
+            packet.Clear();
 
-                // Callback.
-                ConnectionEncrypted();
-            }
+            RunHandshakeStep(&EncryptedConnection::GenerateServerSharedData,
+                &EncryptedConnection::FinishServerEncryption);
         }
         else if(status)
         {
@@ -523,6 +499,108 @@ void EncryptedConnection::ParseServerEncryptionFinish(libcomp::Packet& packet)
     }
 }
 
+void EncryptedConnection::RunHandshakeStep(HandshakeStep_t work,
+    HandshakeStep_t finish)
+{
+    auto self = std::static_pointer_cast<EncryptedConnection>(
+        shared_from_this());
+
+    bool queued = HandshakePool::GetSingletonPtr()->Queue(
+        [self, work, finish]()
+        {
+            ((*self).*work)();
+
+            self->PostCallback([self, finish]()
+            {
+                // Skip the rest if the connection closed in the mean time.
+                if(STATUS_NOT_CONNECTED != self->GetStatus())
+                {
+                    ((*self).*finish)();
+                }
+            });
+        });
+
+    if(!queued)
+    {
+        (this->*work)();
+        (this->*finish)();
+    }
+}
+
+void EncryptedConnection::GenerateServerPublic()
+{
+    if(mHandshakePublic.IsEmpty())
+    {
+        mHandshakePublic = GenerateDiffieHellmanPublic(mDiffieHellman);
+    }
+}
+
+void EncryptedConnection::SendServerPublic()
+{
+    if(mHandshakePublic.IsEmpty())
+    {
+        SocketError("Failed to generate the server public.");
+
+        return;
+    }
+
+    libcomp::Packet reply;
+
+    reply.WriteBlank(4);
+    reply.WriteString32Big(libcomp::Convert::ENCODING_UTF8,
+        DH_BASE_STRING);
+    reply.WriteString32Big(libcomp::Convert::ENCODING_UTF8,
+        GetDiffieHellmanPrime(mDiffieHellman));
+    reply.WriteString32Big(libcomp::Convert::ENCODING_UTF8,
+        mHandshakePublic.RightJustified(DH_KEY_HEX_SIZE, '0'));
+
+    SendPacket(reply);
+
+    mPacketParser = &EncryptedConnection::ParseServerEncryptionFinish;
+
+    // Wait for the client public size (then the public).
+    if(!RequestPacket(sizeof(uint32_t)))
+    {
+        SocketError("Failed to request more data.");
+    }
+}
+
+void EncryptedConnection::GenerateServerSharedData()
+{
+    mHandshakeSharedData = GenerateDiffieHellmanSharedData(mDiffieHellman,
+        mHandshakeClientPublic);
+}
+
+void EncryptedConnection::FinishServerEncryption()
+{
+    if(BF_NET_KEY_BYTE_SIZE != mHandshakeSharedData.size())
+    {
+        SocketError("Failed to generate shared data.");
+
+        return;
+    }
+
+    // Set the encryption key.
+    SetEncryptionKey(mHandshakeSharedData);
+
+    // We are now encrypted.
+    mStatus = STATUS_ENCRYPTED;
+
+    // Use this packet parser now.
+    mPacketParser = &EncryptedConnection::ParsePacket;
+
+    HandshakePool::GetSingletonPtr()->RecordHandshake(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - mHandshakeStart).count()));
+
+    mHandshakePublic.Clear();
+    mHandshakeClientPublic.Clear();
+    mHandshakeSharedData.clear();
+
+    // Callback.
+    ConnectionEncrypted();
+}
+
 void EncryptedConnection::ParsePacket(libcomp::Packet& packet)
 {
     (void)packet;
@@ -582,6 +660,8 @@ void EncryptedConnection::ParsePacket(libcomp::Packet& packet)
 void EncryptedConnection::ParsePacket(libcomp::Packet& packet,
     uint32_t paddedSize, uint32_t realSize)
 {
+    CountReceivedFrame();
+
     // Decrypt the packet
     Decrypt::DecryptPacket(mEncryptionKey, packet);
 
@@ -779,6 +859,22 @@ void EncryptedConnection::PreparePackets(std::list<ReadOnlyPacket>& packets)
     {
         Packet finalPacket;
 
+        // Take one pooled buffer big enough for the padded frame so the
+        // packet is built and encrypted in place without growing.
+        uint32_t bodySize = 0;
+
+        for(auto& packet : packets)
+        {
+            bodySize += packet.Size() + 2 *
+                static_cast<uint32_t>(sizeof(uint16_t));
+        }
+
+        bodySize = (bodySize + (uint32_t)BLOWFISH_BLOCK_SIZE - 1) &
+            ~((uint32_t)BLOWFISH_BLOCK_SIZE - 1);
+
+        finalPacket.Reserve(std::min<uint32_t>(MAX_PACKET_SIZE,
+            GetHeaderSize() + bodySize));
+
         // Reserve space for the sizes.
         finalPacket.WriteBlank(GetHeaderSize());
 
@@ -787,7 +883,11 @@ void EncryptedConnection::PreparePackets(std::list<ReadOnlyPacket>& packets)
         {
             finalPacket.WriteU16Big((uint16_t)(packet.Size() + 2));
             finalPacket.WriteU16Little((uint16_t)(packet.Size() + 2));
+            uint32_t dataStart = finalPacket.Tell();
             finalPacket.WriteArray(packet.ConstData(), packet.Size());
+
+            // Fill in any per-connection values of a shared packet.
+            packet.ApplyPatches(finalPacket.Data() + dataStart);
         }
 
         // Encrypt the packet
@@ -815,7 +915,7 @@ std::list<ReadOnlyPacket> EncryptedConnection::GetCombinedPackets()
 
     std::lock_guard<std::mutex> guard(mOutgoingMutex);
 
-    if(!mSendingPacket)
+    if(SendBudgetAvailable())
     {
         uint32_t totalSize = GetHeaderSize();
 
@@ -838,8 +938,6 @@ std::list<ReadOnlyPacket> EncryptedConnection::GetCombinedPackets()
                 break;
             }
         }
-
-        mSendingPacket = !packets.empty();
     }
 
     return packets;
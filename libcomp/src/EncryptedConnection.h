@@ -32,8 +32,10 @@
 #include "TcpConnection.h"
 
 // Standard C++11 Includes
+#include <chrono>
 #include <fstream>
 #include <functional>
+#include <vector>
 
 namespace objects
 {
@@ -191,6 +193,11 @@ protected:
     typedef void (EncryptedConnection::*PacketParser_t)(
         libcomp::Packet& packet);
 
+    /**
+     * Type for one step of the server side of the encryption handshake.
+     */
+    typedef void (EncryptedConnection::*HandshakeStep_t)();
+
     /**
      * Parse the initial encryption packet from the server. This is used when
      * in the client role. This parser will take the reply from the server and
@@ -243,6 +250,40 @@ protected:
      */
     void ParseServerEncryptionFinish(libcomp::Packet& packet);
 
+    /**
+     * Run the math of a handshake step on the @ref HandshakePool and then
+     * finish the step back on the network thread of the connection. If the
+     * pool is not running both parts run right away. The connection does
+     * not read while the math is running so nothing else touches the DH
+     * object or the handshake members.
+     * @param work Part of the step to run on the pool.
+     * @param finish Part of the step to run on the network thread.
+     */
+    void RunHandshakeStep(HandshakeStep_t work, HandshakeStep_t finish);
+
+    /**
+     * Generate the server public unless a key pair generated ahead of time
+     * was already used.
+     */
+    void GenerateServerPublic();
+
+    /**
+     * Send the base, prime and server public to the client and wait for
+     * the client public.
+     */
+    void SendServerPublic();
+
+    /**
+     * Generate the shared data from the client public.
+     */
+    void GenerateServerSharedData();
+
+    /**
+     * Set the shared data as the encryption key and move to the encrypted
+     * state.
+     */
+    void FinishServerEncryption();
+
     /**
      * Parse incoming encrypted packet data. This will buffer all incoming
      * data. It will then peek at the first 8 bytes to determine the size of
@@ -340,6 +381,18 @@ protected:
 
     /// File to save a capture to.
     std::ofstream *mCaptureFile;
+
+    /// Server public sent to the client during the handshake.
+    libcomp::String mHandshakePublic;
+
+    /// Client public received during the handshake.
+    libcomp::String mHandshakeClientPublic;
+
+    /// Shared data generated during the handshake.
+    std::vector<char> mHandshakeSharedData;
+
+    /// Time the server side of the handshake started.
+    std::chrono::steady_clock::time_point mHandshakeStart;
 };
 
 } // namespace libcomp
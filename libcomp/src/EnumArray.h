@@ -0,0 +1,403 @@
+/**
+ * @file libcomp/src/EnumArray.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Fixed size map from a small contiguous enum to a value.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_ENUMARRAY_H
+#define LIBCOMP_SRC_ENUMARRAY_H
+
+// Standard C++11 Includes
+#include <cstddef>
+#include <initializer_list>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+
+namespace libcomp
+{
+
+/**
+ * Replacement for @ref EnumMap when every key of the enum is below Count.
+ * Values are stored in a plain array indexed by the key along with a flag
+ * for each key that has been set, so lookups never hash or allocate. The
+ * map style functions only see keys that have been set, the same as the
+ * map they replace. Keys that are not set always hold a value initialized
+ * T so the bulk functions can run over the whole array without branches
+ * and be vectorized by the compiler.
+ */
+template<typename Key, typename T, std::size_t Count>
+class EnumArray
+{
+    static_assert(std::is_enum<Key>::value,
+        "EnumArray keys must be an enum");
+
+public:
+    /// Key and value pair returned when iterating
+    typedef std::pair<Key, T> value_type;
+
+    /**
+     * Iterator over the keys that have been set. Dereferencing returns a
+     * copy of the key and value.
+     */
+    class const_iterator
+    {
+    public:
+        /**
+         * Create an iterator at the first set key at or after an index.
+         * @param pArray Array to iterate over
+         * @param index Index to start searching from
+         */
+        const_iterator(const EnumArray *pArray, std::size_t index) :
+            mArray(pArray), mIndex(index)
+        {
+            Skip();
+        }
+
+        /**
+         * Get the key and value the iterator is at.
+         * @return Copy of the key and value
+         */
+        value_type operator*() const
+        {
+            return value_type(static_cast<Key>(mIndex),
+                mArray->mValues[mIndex]);
+        }
+
+        /**
+         * Holds the pair for @ref operator-> since no pair is stored.
+         */
+        struct Arrow
+        {
+            /// Key and value the iterator was at
+            value_type Pair;
+
+            /**
+             * Get the key and value.
+             * @return Pointer to the key and value
+             */
+            const value_type* operator->() const
+            {
+                return &Pair;
+            }
+        };
+
+        /**
+         * Access the key and value the iterator is at.
+         * @return Copy of the key and value
+         */
+        Arrow operator->() const
+        {
+            return Arrow{ **this };
+        }
+
+        /**
+         * Move to the next set key.
+         * @return Reference to this iterator
+         */
+        const_iterator& operator++()
+        {
+            mIndex++;
+            Skip();
+
+            return *this;
+        }
+
+        /**
+         * Check if two iterators are at the same key.
+         * @param other Iterator to compare to
+         * @return true if both are at the same key
+         */
+        bool operator==(const const_iterator& other) const
+        {
+            return mIndex == other.mIndex;
+        }
+
+        /**
+         * Check if two iterators are at different keys.
+         * @param other Iterator to compare to
+         * @return true if the iterators are at different keys
+         */
+        bool operator!=(const const_iterator& other) const
+        {
+            return mIndex != other.mIndex;
+        }
+
+    private:
+        /**
+         * Move forward until a set key or the end is reached.
+         */
+        void Skip()
+        {
+            while(mIndex < Count && !mArray->mSet[mIndex])
+            {
+                mIndex++;
+            }
+        }
+
+        /// Array being iterated over
+        const EnumArray *mArray;
+
+        /// Index of the current key
+        std::size_t mIndex;
+    };
+
+    /// Iterators never allow the value to be changed
+    typedef const_iterator iterator;
+
+    /**
+     * Create an array with no keys set.
+     */
+    EnumArray() : mValues(), mSet()
+    {
+    }
+
+    /**
+     * Create an array with the specified keys set.
+     * @param values Keys and values to set
+     */
+    EnumArray(std::initializer_list<value_type> values) : mValues(), mSet()
+    {
+        for(auto& pair : values)
+        {
+            (*this)[pair.first] = pair.second;
+        }
+    }
+
+    /**
+     * Get the value of a key, setting it to a value initialized T if the
+     * key was not set. The key must be less than Count.
+     * @param key Key to get the value of
+     * @return Reference to the value
+     */
+    T& operator[](Key key)
+    {
+        std::size_t idx = static_cast<std::size_t>(key);
+        mSet[idx] = 1;
+
+        return mValues[idx];
+    }
+
+    /**
+     * Find a key that has been set.
+     * @param key Key to find
+     * @return Iterator at the key or @ref end if it is not set
+     */
+    const_iterator find(Key key) const
+    {
+        std::size_t idx = static_cast<std::size_t>(key);
+
+        return (idx < Count && mSet[idx]) ? const_iterator(this, idx) : end();
+    }
+
+    /**
+     * Count how many times a key is set.
+     * @param key Key to check
+     * @return 1 if the key is set, otherwise 0
+     */
+    std::size_t count(Key key) const
+    {
+        std::size_t idx = static_cast<std::size_t>(key);
+
+        return (idx < Count && mSet[idx]) ? 1 : 0;
+    }
+
+    /**
+     * Unset a key.
+     * @param key Key to unset
+     * @return 1 if the key was set, otherwise 0
+     */
+    std::size_t erase(Key key)
+    {
+        std::size_t idx = static_cast<std::size_t>(key);
+        if(idx >= Count || !mSet[idx])
+        {
+            return 0;
+        }
+
+        mSet[idx] = 0;
+        mValues[idx] = T();
+
+        return 1;
+    }
+
+    /**
+     * Unset every key.
+     */
+    void clear()
+    {
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            mSet[i] = 0;
+            mValues[i] = T();
+        }
+    }
+
+    /**
+     * Get the number of keys that are set.
+     * @return Number of keys that are set
+     */
+    std::size_t size() const
+    {
+        std::size_t result = 0;
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            result += mSet[i];
+        }
+
+        return result;
+    }
+
+    /**
+     * Check if no keys are set.
+     * @return true if no keys are set
+     */
+    bool empty() const
+    {
+        return 0 == size();
+    }
+
+    /**
+     * Get an iterator at the first key that is set.
+     * @return Iterator at the first set key
+     */
+    const_iterator begin() const
+    {
+        return const_iterator(this, 0);
+    }
+
+    /**
+     * Get the iterator past the last key.
+     * @return End iterator
+     */
+    const_iterator end() const
+    {
+        return const_iterator(this, Count);
+    }
+
+    /**
+     * Set every key to the same value.
+     * @param value Value to set
+     */
+    void Fill(const T& value)
+    {
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            mSet[i] = 1;
+            mValues[i] = value;
+        }
+    }
+
+    /**
+     * Add the value of every key set in another array, setting the key
+     * here if it was not already.
+     * @param other Array of values to add
+     */
+    void Add(const EnumArray& other)
+    {
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            mSet[i] = (uint8_t)(mSet[i] | other.mSet[i]);
+            mValues[i] = (T)(mValues[i] + other.mValues[i]);
+        }
+    }
+
+    /**
+     * Raise every key set both here and in the minimums to at least the
+     * minimum value.
+     * @param mins Minimum value of each key
+     */
+    void ClampMin(const EnumArray& mins)
+    {
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            T value = mValues[i] < mins.mValues[i]
+                ? mins.mValues[i] : mValues[i];
+            mValues[i] = (mSet[i] & mins.mSet[i]) ? value : mValues[i];
+        }
+    }
+
+    /**
+     * Lower every key set both here and in the maximums to at most the
+     * maximum value.
+     * @param maxs Maximum value of each key
+     */
+    void ClampMax(const EnumArray& maxs)
+    {
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            T value = maxs.mValues[i] < mValues[i]
+                ? maxs.mValues[i] : mValues[i];
+            mValues[i] = (mSet[i] & maxs.mSet[i]) ? value : mValues[i];
+        }
+    }
+
+    /**
+     * Check if the same keys are set to the same values.
+     * @param other Array to compare to
+     * @return true if both arrays hold the same keys and values
+     */
+    bool operator==(const EnumArray& other) const
+    {
+        uint8_t different = 0;
+        for(std::size_t i = 0; i < Count; i++)
+        {
+            different = (uint8_t)(different |
+                (mSet[i] != other.mSet[i]) |
+                (mValues[i] != other.mValues[i]));
+        }
+
+        return 0 == different;
+    }
+
+    /**
+     * Check if the arrays differ in any key or value.
+     * @param other Array to compare to
+     * @return true if the arrays hold different keys or values
+     */
+    bool operator!=(const EnumArray& other) const
+    {
+        return !(*this == other);
+    }
+
+    /**
+     * Get the value array indexed by key. Keys that are not set hold a
+     * value initialized T.
+     * @return Pointer to Count values
+     */
+    const T* GetValues() const
+    {
+        return mValues;
+    }
+
+private:
+    /// Value of each key
+    T mValues[Count];
+
+    /// 1 for each key that has been set
+    uint8_t mSet[Count];
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_ENUMARRAY_H
@@ -0,0 +1,353 @@
+/**
+ * @file libcomp/src/HandshakePool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Threads that run the Diffie-Hellman math of new connections.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "HandshakePool.h"
+
+// libcomp Includes
+#include "Log.h"
+#include "TcpServer.h"
+
+// OpenSSL Includes
+#include <openssl/bn.h>
+#include <openssl/crypto.h>
+
+using namespace libcomp;
+
+/// Upper limit (in microseconds) of each latency bucket but the last
+static const uint64_t LATENCY_BUCKET_LIMITS[
+    HandshakePool::LATENCY_BUCKET_COUNT - 1] = {
+    500, 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000, 500000,
+    1000000,
+};
+
+/// Pointer to the pool
+static HandshakePool *gHandshakePoolInst = nullptr;
+
+/// Lock to create the pool once
+static std::mutex gHandshakePoolLock;
+
+HandshakePool::HandshakePool() : mDiffieHellman(nullptr), mKeyPairTarget(0),
+    mRunning(false), mKeyPairHits(0), mKeyPairMisses(0), mJobCount(0),
+    mLatencyMax(0)
+{
+    for(auto& bucket : mLatency)
+    {
+        bucket = 0;
+    }
+}
+
+HandshakePool* HandshakePool::GetSingletonPtr()
+{
+    std::lock_guard<std::mutex> lock(gHandshakePoolLock);
+
+    if(nullptr == gHandshakePoolInst)
+    {
+        gHandshakePoolInst = new HandshakePool;
+    }
+
+    return gHandshakePoolInst;
+}
+
+bool HandshakePool::Start(uint32_t threadCount, uint32_t keyPairCount,
+    const DH *pDiffieHellman)
+{
+    if(0 == threadCount || nullptr == pDiffieHellman)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+
+    if(mRunning)
+    {
+        return false;
+    }
+
+    mDiffieHellman = TcpServer::CopyDiffieHellman(pDiffieHellman);
+
+    if(nullptr == mDiffieHellman)
+    {
+        return false;
+    }
+
+    mKeyPairTarget = keyPairCount;
+    mRunning = true;
+
+    for(uint32_t i = 0; i < threadCount; i++)
+    {
+        mThreads.push_back(std::thread([this](std::string threadName)
+        {
+#if !defined(_WIN32)
+            pthread_setname_np(pthread_self(), threadName.c_str());
+#else
+            (void)threadName;
+#endif // !defined(_WIN32)
+
+            Run();
+        }, String("handshake%1").Arg(i).ToUtf8()));
+    }
+
+    LOG_DEBUG(String("Running %1 handshake thread(s) with %2 key pair(s)"
+        " ready.\n").Arg(threadCount).Arg(keyPairCount));
+
+    return true;
+}
+
+void HandshakePool::Stop()
+{
+    std::vector<std::thread> threads;
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        mRunning = false;
+        threads.swap(mThreads);
+    }
+
+    mCondition.notify_all();
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+
+    mJobs.clear();
+
+    for(auto pKeyPair : mKeyPairs)
+    {
+        DH_free(pKeyPair);
+    }
+
+    mKeyPairs.clear();
+
+    if(nullptr != mDiffieHellman)
+    {
+        DH_free(mDiffieHellman);
+        mDiffieHellman = nullptr;
+    }
+}
+
+bool HandshakePool::IsRunning()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    return mRunning;
+}
+
+String HandshakePool::TakeKeyPair(DH *pDiffieHellman)
+{
+    DH *pKeyPair = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        // Without the pool no key pairs are ever made so this is not a miss.
+        if(!mRunning || 0 == mKeyPairTarget)
+        {
+            return String();
+        }
+
+        if(!mKeyPairs.empty())
+        {
+            pKeyPair = mKeyPairs.front();
+            mKeyPairs.pop_front();
+        }
+    }
+
+    if(nullptr == pKeyPair)
+    {
+        mKeyPairMisses++;
+
+        return String();
+    }
+
+    // Wake a thread to replace the key pair.
+    mCondition.notify_one();
+
+    String publicKey;
+
+    if(nullptr != pDiffieHellman && nullptr != pDiffieHellman->p &&
+        0 == BN_cmp(pDiffieHellman->p, pKeyPair->p))
+    {
+        char *pHexResult = BN_bn2hex(pKeyPair->pub_key);
+
+        if(nullptr != pHexResult)
+        {
+            publicKey = pHexResult;
+
+            OPENSSL_free(pHexResult);
+
+            if(nullptr != pDiffieHellman->pub_key)
+            {
+                BN_free(pDiffieHellman->pub_key);
+            }
+
+            if(nullptr != pDiffieHellman->priv_key)
+            {
+                BN_clear_free(pDiffieHellman->priv_key);
+            }
+
+            pDiffieHellman->pub_key = pKeyPair->pub_key;
+            pDiffieHellman->priv_key = pKeyPair->priv_key;
+            pKeyPair->pub_key = nullptr;
+            pKeyPair->priv_key = nullptr;
+        }
+    }
+
+    DH_free(pKeyPair);
+
+    if(publicKey.IsEmpty())
+    {
+        mKeyPairMisses++;
+    }
+    else
+    {
+        mKeyPairHits++;
+    }
+
+    return publicKey;
+}
+
+bool HandshakePool::Queue(const std::function<void()>& job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        if(!mRunning)
+        {
+            return false;
+        }
+
+        mJobs.push_back(job);
+    }
+
+    mCondition.notify_one();
+
+    return true;
+}
+
+void HandshakePool::RecordHandshake(uint64_t micros)
+{
+    size_t bucket = 0;
+
+    while(bucket < (LATENCY_BUCKET_COUNT - 1) &&
+        micros >= LATENCY_BUCKET_LIMITS[bucket])
+    {
+        bucket++;
+    }
+
+    mLatency[bucket]++;
+
+    uint64_t latencyMax = mLatencyMax;
+
+    while(micros > latencyMax &&
+        !mLatencyMax.compare_exchange_weak(latencyMax, micros))
+    {
+    }
+}
+
+HandshakePool::Stats HandshakePool::GetStats()
+{
+    Stats stats;
+    stats.Handshakes = 0;
+    stats.KeyPairHits = mKeyPairHits;
+    stats.KeyPairMisses = mKeyPairMisses;
+    stats.Jobs = mJobCount;
+    stats.LatencyMax = mLatencyMax;
+
+    for(size_t i = 0; i < LATENCY_BUCKET_COUNT; i++)
+    {
+        stats.Latency[i] = mLatency[i];
+        stats.Handshakes += stats.Latency[i];
+    }
+
+    std::lock_guard<std::mutex> lock(mLock);
+
+    stats.KeyPairsReady = mKeyPairs.size();
+
+    return stats;
+}
+
+uint64_t HandshakePool::GetLatencyBucketLimit(size_t bucket)
+{
+    return bucket < (LATENCY_BUCKET_COUNT - 1)
+        ? LATENCY_BUCKET_LIMITS[bucket] : 0;
+}
+
+void HandshakePool::Run()
+{
+    std::unique_lock<std::mutex> lock(mLock);
+
+    while(mRunning)
+    {
+        if(!mJobs.empty())
+        {
+            // Handshakes that are waiting come first.
+            auto job = mJobs.front();
+            mJobs.pop_front();
+
+            lock.unlock();
+
+            job();
+            mJobCount++;
+
+            lock.lock();
+        }
+        else if(mKeyPairs.size() < mKeyPairTarget)
+        {
+            DH *pKeyPair = TcpServer::CopyDiffieHellman(mDiffieHellman);
+
+            lock.unlock();
+
+            if(nullptr != pKeyPair && (1 != DH_generate_key(pKeyPair) ||
+                nullptr == pKeyPair->pub_key))
+            {
+                DH_free(pKeyPair);
+                pKeyPair = nullptr;
+            }
+
+            lock.lock();
+
+            if(nullptr == pKeyPair)
+            {
+                LOG_ERROR("Failed to generate a DH key pair ahead of time."
+                    " Key pairs will be generated for each handshake.\n");
+
+                mKeyPairTarget = 0;
+            }
+            else
+            {
+                mKeyPairs.push_back(pKeyPair);
+            }
+        }
+        else
+        {
+            mCondition.wait(lock);
+        }
+    }
+}
@@ -0,0 +1,208 @@
+/**
+ * @file libcomp/src/HandshakePool.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Threads that run the Diffie-Hellman math of new connections.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_HANDSHAKEPOOL_H
+#define LIBCOMP_SRC_HANDSHAKEPOOL_H
+
+// libcomp Includes
+#include "CString.h"
+
+// OpenSSL Includes
+#include <openssl/dh.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Pool of threads for the modular exponentiation of the encryption
+ * handshake so a wave of new connections does not stall the network
+ * threads. While there is nothing else to do the threads generate server
+ * key pairs ahead of time so most connections can send their public right
+ * away. Only one pool exists for the process; get it with
+ * @ref GetSingletonPtr. When the pool is not running the handshake math is
+ * done on the network thread like before.
+ */
+class HandshakePool
+{
+public:
+    /// Number of buckets in the handshake latency histogram
+    static const size_t LATENCY_BUCKET_COUNT = 12;
+
+    /**
+     * Counters of the handshakes done by every connection.
+     */
+    struct Stats
+    {
+        /// Number of handshakes completed
+        uint64_t Handshakes;
+
+        /// Number of handshakes that used a key pair generated ahead of time
+        uint64_t KeyPairHits;
+
+        /// Number of handshakes that had to generate a key pair
+        uint64_t KeyPairMisses;
+
+        /// Number of jobs run on the pool threads
+        uint64_t Jobs;
+
+        /// Number of key pairs ready to be used
+        uint64_t KeyPairsReady;
+
+        /// Slowest handshake in microseconds
+        uint64_t LatencyMax;
+
+        /// Number of handshakes in each latency bucket
+        uint64_t Latency[LATENCY_BUCKET_COUNT];
+    };
+
+    /**
+     * Get the pool, creating it on the first call.
+     * @return Pointer to the pool.
+     */
+    static HandshakePool* GetSingletonPtr();
+
+    /**
+     * Start the pool threads. Key pairs are generated ahead of time for the
+     * prime and base of the DH object passed in.
+     * @param threadCount Number of threads to run.
+     * @param keyPairCount Number of key pairs to keep ready.
+     * @param pDiffieHellman Prime and base the server uses.
+     * @return true if the pool was started; false otherwise.
+     */
+    bool Start(uint32_t threadCount, uint32_t keyPairCount,
+        const DH *pDiffieHellman);
+
+    /**
+     * Stop the pool threads. Jobs that have not started are dropped.
+     */
+    void Stop();
+
+    /**
+     * Check if the pool threads are running.
+     * @return true if the pool is running; false otherwise.
+     */
+    bool IsRunning();
+
+    /**
+     * Move a key pair generated ahead of time into a DH object. This only
+     * works if the DH object has the same prime the pool was started with.
+     * Only calls made while the pool keeps key pairs ready count as a hit
+     * or a miss.
+     * @param pDiffieHellman Object to store the key pair in.
+     * @return Public key in hex or an empty string if none was ready.
+     */
+    String TakeKeyPair(DH *pDiffieHellman);
+
+    /**
+     * Run a job on one of the pool threads.
+     * @param job Job to run.
+     * @return true if the job was queued; false if the pool is not running.
+     */
+    bool Queue(const std::function<void()>& job);
+
+    /**
+     * Add a completed handshake to the latency histogram.
+     * @param micros Time taken by the handshake in microseconds.
+     */
+    void RecordHandshake(uint64_t micros);
+
+    /**
+     * Get the handshake counters.
+     * @return Handshake counters since the process started.
+     */
+    Stats GetStats();
+
+    /**
+     * Get the upper limit of a latency bucket.
+     * @param bucket Index of the bucket.
+     * @return Upper limit in microseconds or 0 for the last bucket which
+     *   has no limit.
+     */
+    static uint64_t GetLatencyBucketLimit(size_t bucket);
+
+private:
+    /**
+     * Create the pool. Use @ref GetSingletonPtr instead.
+     */
+    HandshakePool();
+
+    /**
+     * Run jobs and generate key pairs until the pool is stopped.
+     */
+    void Run();
+
+    /// Lock for the jobs and key pairs
+    std::mutex mLock;
+
+    /// Signaled when a job is queued, a key pair is taken or the pool stops
+    std::condition_variable mCondition;
+
+    /// Jobs waiting for a thread
+    std::list<std::function<void()>> mJobs;
+
+    /// Key pairs generated ahead of time (each with the prime and base)
+    std::list<DH*> mKeyPairs;
+
+    /// Prime and base to generate key pairs for
+    DH *mDiffieHellman;
+
+    /// Number of key pairs to keep ready
+    size_t mKeyPairTarget;
+
+    /// Threads of the pool
+    std::vector<std::thread> mThreads;
+
+    /// Indicates if the threads should keep running
+    bool mRunning;
+
+    /// Number of handshakes that used a key pair generated ahead of time
+    std::atomic<uint64_t> mKeyPairHits;
+
+    /// Number of handshakes that had to generate a key pair
+    std::atomic<uint64_t> mKeyPairMisses;
+
+    /// Number of jobs run on the pool threads
+    std::atomic<uint64_t> mJobCount;
+
+    /// Slowest handshake in microseconds
+    std::atomic<uint64_t> mLatencyMax;
+
+    /// Number of handshakes in each latency bucket
+    std::atomic<uint64_t> mLatency[LATENCY_BUCKET_COUNT];
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_HANDSHAKEPOOL_H
@@ -26,9 +26,12 @@
 
 #include "Log.h"
 
+#include <algorithm>
 #include <iostream>
 #include <cassert>
 #include <chrono>
+#include <cstdlib>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -43,6 +46,138 @@ using namespace libcomp;
  */
 static Log *gLogInst = nullptr;
 
+/// Time the background writer waits between writing queued messages
+static const std::chrono::milliseconds LOG_WRITE_INTERVAL(10);
+
+/// Prepend these to messages. These are constructed before main so they
+/// are still around when the queue is written at exit.
+static const String gLogMessages[Log::LOG_LEVEL_COUNT] = {
+    "DEBUG: %1",
+    "%1",
+    "WARNING: %1",
+    "ERROR: %1",
+    "CRITICAL: %1",
+};
+
+/**
+ * @internal
+ * Fixed size ring of messages with a single producer (the thread that owns
+ * it) and a single consumer (the background writer). Neither side takes a
+ * lock.
+ */
+class libcomp::LogQueue
+{
+public:
+    /**
+     * Message waiting to be written.
+     */
+    struct Entry
+    {
+        /// Logging level of the message
+        Log::Level_t Level;
+
+        /// The message to log
+        String Message;
+
+        /// Time the message was logged
+        std::chrono::system_clock::time_point Time;
+    };
+
+    /**
+     * Create the queue.
+     * @param size Minimum number of messages the queue can hold
+     */
+    explicit LogQueue(size_t size) : mHead(0), mTail(0)
+    {
+        size_t capacity = 16;
+        while(capacity < size)
+        {
+            capacity <<= 1;
+        }
+
+        mEntries.resize(capacity);
+        mMask = capacity - 1;
+    }
+
+    /**
+     * Add a message to the queue. Only the owning thread may call this.
+     * @param level Logging level of the message
+     * @param msg The message to log
+     * @returns false if the queue is full
+     */
+    bool Push(Log::Level_t level, const String& msg)
+    {
+        size_t tail = mTail.load(std::memory_order_relaxed);
+
+        if(tail - mHead.load(std::memory_order_acquire) > mMask)
+        {
+            return false;
+        }
+
+        Entry& entry = mEntries[tail & mMask];
+        entry.Level = level;
+        entry.Message = msg;
+        entry.Time = std::chrono::system_clock::now();
+
+        mTail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * Move every queued message to a list. Only the writer may call this.
+     * @param entries List to add the messages to
+     */
+    void PopAll(std::vector<Entry>& entries)
+    {
+        size_t head = mHead.load(std::memory_order_relaxed);
+        size_t tail = mTail.load(std::memory_order_acquire);
+
+        for(; head != tail; head++)
+        {
+            Entry& entry = mEntries[head & mMask];
+            entries.push_back(entry);
+
+            // Release the message now instead of when the slot is reused
+            entry.Message = String();
+        }
+
+        mHead.store(head, std::memory_order_release);
+    }
+
+private:
+    /// Ring of messages
+    std::vector<Entry> mEntries;
+
+    /// Capacity of the ring minus one
+    size_t mMask;
+
+    /// Index of the next message to write, only changed by the writer
+    std::atomic<size_t> mHead;
+
+    /// Index of the next free slot, only changed by the owning thread
+    std::atomic<size_t> mTail;
+};
+
+/**
+ * @internal
+ * Message queue of the calling thread. The writer keeps another reference
+ * so messages left when the thread exits are still written.
+ */
+static thread_local std::shared_ptr<LogQueue> tLogQueue;
+
+/**
+ * @internal
+ * Write any queued messages when the process exits.
+ */
+static void StopAsyncLog()
+{
+    if(nullptr != gLogInst)
+    {
+        gLogInst->StopAsync();
+    }
+}
+
 /*
  * Black       0;30     Dark Gray     1;30
  * Blue        0;34     Light Blue    1;34
@@ -81,7 +216,7 @@ static void LogToStandardOutput(Log::Level_t level,
         FOREGROUND_RED | FOREGROUND_INTENSITY,
     };
 #else
-    static const String gLogColors[Log::LOG_LEVEL_COUNT] = {
+    static const char *gLogColors[Log::LOG_LEVEL_COUNT] = {
         "\e[1;32;40m", // Debug
         "\e[37;40m",   // Info
         "\e[1;33;40m", // Warning
@@ -143,7 +278,8 @@ static void LogToStandardOutput(Log::Level_t level,
     std::cout.flush();
 }
 
-Log::Log() : mLogFile(nullptr)
+Log::Log() : mLogFile(nullptr), mAsync(false), mQueueSize(0),
+    mWriterStopping(false), mPushing(0), mDropped(0), mDroppedReported(0)
 {
 #ifdef _WIN32
     CONSOLE_SCREEN_BUFFER_INFO consoleInfo;
@@ -166,7 +302,7 @@ Log::Log() : mLogFile(nullptr)
     // Default all log levels to enabled.
     for(int i = 0; i < LOG_LEVEL_COUNT; ++i)
     {
-        mLogEnables[i] = true;
+        mLogEnables[i].store(true);
     }
 
     mLogFileTimestampEnabled = false;
@@ -174,6 +310,9 @@ Log::Log() : mLogFile(nullptr)
 
 Log::~Log()
 {
+    // Write anything still queued.
+    StopAsync();
+
     // Lock the muxtex.
     std::lock_guard<std::mutex> lock(mLock);
 
@@ -209,15 +348,6 @@ Log* Log::GetSingletonPtr()
 
 void Log::LogMessage(Log::Level_t level, const String& msg)
 {
-    // Prepend these to messages.
-    static const String gLogMessages[Log::LOG_LEVEL_COUNT] = {
-        "DEBUG: %1",
-        "%1",
-        "WARNING: %1",
-        "ERROR: %1",
-        "CRITICAL: %1",
-    };
-
     // Log a critical error message. If the configuration option is true, log
     // the message to the log file. Regardless, pass the message to all the
     // log hooks for processing. Critical messages have the text "CRITICAL: "
@@ -225,17 +355,67 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
     if(0 > level || LOG_LEVEL_COUNT <= level || !mLogEnables[level])
         return;
 
-    String final = String(gLogMessages[level]).Arg(msg);
+    // Errors are never queued so they can not be dropped.
+    if(LOG_LEVEL_WARNING >= level && mAsync.load())
+    {
+        // StopAsync clears mAsync before it waits for mPushing to reach
+        // zero so either it waits for this message or the check below
+        // sees the log is no longer async.
+        mPushing++;
+
+        if(mAsync.load())
+        {
+            if(!tLogQueue)
+            {
+                std::lock_guard<std::mutex> lock(mQueueLock);
+
+                tLogQueue = std::make_shared<LogQueue>(mQueueSize);
+                mQueues.push_back(tLogQueue);
+            }
+
+            if(!tLogQueue->Push(level, msg))
+            {
+                mDropped++;
+            }
+
+            mPushing--;
+
+            return;
+        }
+
+        mPushing--;
+    }
+
+    // Write anything queued before this message first so the log stays
+    // in order.
+    std::lock_guard<std::mutex> drainLock(mDrainLock);
+
+    if(mAsync.load())
+    {
+        WriteQueuedMessages();
+    }
 
     // Lock the muxtex.
     std::lock_guard<std::mutex> lock(mLock);
 
+    WriteMessage(level, msg, std::chrono::system_clock::now());
+
+    if(nullptr != mLogFile)
+    {
+        mLogFile->flush();
+    }
+}
+
+void Log::WriteMessage(Log::Level_t level, const String& msg,
+    const std::chrono::system_clock::time_point& time)
+{
+    String final = String(gLogMessages[level]).Arg(msg);
+
     if(nullptr != mLogFile)
     {
         if(mLogFileTimestampEnabled)
         {
-            auto currentTime = std::chrono::system_clock::to_time_t(
-                std::chrono::system_clock::now());
+            auto currentTime = std::chrono::system_clock::to_time_t(time);
 
             std::stringstream ss;
             ss << std::put_time(std::localtime(&currentTime), "%Y/%m/%d %T");
@@ -248,7 +428,6 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
 
         mLogFile->write(final.C(),
             (std::streamsize)(final.Length() * sizeof(char)));
-        mLogFile->flush();
     }
 
     // Call all hooks.
@@ -264,6 +443,169 @@ void Log::LogMessage(Log::Level_t level, const String& msg)
     }
 }
 
+void Log::StartAsync(size_t queueSize)
+{
+    std::lock_guard<std::mutex> lock(mQueueLock);
+
+    if(mWriter.joinable())
+    {
+        return;
+    }
+
+    static std::once_flag registerExit;
+    std::call_once(registerExit, []()
+    {
+        std::atexit(&StopAsyncLog);
+    });
+
+    mQueueSize = queueSize;
+    mWriterStopping = false;
+
+    mWriter = std::thread([this]()
+    {
+#if !defined(_WIN32)
+        pthread_setname_np(pthread_self(), "log");
+#endif // !defined(_WIN32)
+
+        AsyncWriterMain();
+    });
+
+    mAsync.store(true);
+}
+
+void Log::StopAsync()
+{
+    {
+        std::lock_guard<std::mutex> lock(mQueueLock);
+
+        if(!mWriter.joinable())
+        {
+            return;
+        }
+
+        mWriterStopping = true;
+    }
+
+    mWriterCondition.notify_one();
+    mWriter.join();
+
+    // Messages are written right away once mAsync is cleared. Those
+    // writes wait on mDrainLock so they stay behind the queued messages.
+    // Wait for any thread still adding one to its queue and then write
+    // what is left.
+    std::lock_guard<std::mutex> drainLock(mDrainLock);
+
+    mAsync.store(false);
+
+    while(0 != mPushing.load())
+    {
+        std::this_thread::yield();
+    }
+
+    WriteQueuedMessages();
+}
+
+bool Log::IsAsync() const
+{
+    return mAsync.load();
+}
+
+uint64_t Log::GetDroppedCount() const
+{
+    return mDropped.load();
+}
+
+bool Log::WriteQueuedMessages()
+{
+    std::list<std::shared_ptr<LogQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock(mQueueLock);
+
+        // A queue only referenced here belongs to a thread that exited so
+        // it can be removed once it is empty. This has to be checked before
+        // the final read below.
+        std::list<std::shared_ptr<LogQueue>> finished;
+        for(auto it = mQueues.begin(); it != mQueues.end();)
+        {
+            if(1 == it->use_count())
+            {
+                finished.push_back(*it);
+                it = mQueues.erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+
+        queues = mQueues;
+        queues.splice(queues.end(), finished);
+    }
+
+    std::vector<LogQueue::Entry> entries;
+    for(auto& queue : queues)
+    {
+        queue->PopAll(entries);
+    }
+
+    uint64_t dropped = mDropped.load();
+
+    if(entries.empty() && dropped == mDroppedReported)
+    {
+        return false;
+    }
+
+    // Each queue is in order already, merge them by time.
+    std::stable_sort(entries.begin(), entries.end(), [](
+        const LogQueue::Entry& a, const LogQueue::Entry& b)
+        {
+            return a.Time < b.Time;
+        });
+
+    std::lock_guard<std::mutex> lock(mLock);
+
+    for(auto& entry : entries)
+    {
+        WriteMessage(entry.Level, entry.Message, entry.Time);
+    }
+
+    if(dropped != mDroppedReported)
+    {
+        WriteMessage(LOG_LEVEL_WARNING, String("%1 log messages were "
+            "dropped because the log could not keep up.\n").Arg(
+            dropped - mDroppedReported), std::chrono::system_clock::now());
+
+        mDroppedReported = dropped;
+    }
+
+    if(nullptr != mLogFile)
+    {
+        mLogFile->flush();
+    }
+
+    return true;
+}
+
+void Log::AsyncWriterMain()
+{
+    std::unique_lock<std::mutex> lock(mQueueLock);
+
+    while(!mWriterStopping)
+    {
+        (void)mWriterCondition.wait_for(lock, LOG_WRITE_INTERVAL);
+
+        lock.unlock();
+
+        {
+            std::lock_guard<std::mutex> drainLock(mDrainLock);
+
+            WriteQueuedMessages();
+        }
+
+        lock.lock();
+    }
+}
+
 String Log::GetLogPath() const
 {
     return mLogPath;
@@ -29,15 +29,22 @@
 
 #include "CString.h"
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <fstream>
 #include <functional>
+#include <thread>
 #include <unordered_map>
 
 namespace libcomp
 {
 
+class LogQueue;
+
 /**
  * Logging interface capable of logging messages to the terminal or a file.
  * The Log class is implemented as a singleton. The constructor should not be
@@ -64,6 +71,17 @@ namespace libcomp
  * log level, the message, and the user data provided by the @ref AddLogHook
  * method. For more information on the function prototype, see the docs for
  * @ref Log::Hook_t and @ref AddLogHook.
+ *
+ * By default each message is written and flushed by the thread that logs it.
+ * Calling @ref StartAsync moves the file writes and hooks to a background
+ * thread. Each thread that logs gets its own fixed size queue that only it
+ * writes to so logging never waits on a lock or on the disk. If a queue is
+ * full the message is dropped and counted instead of stalling the thread.
+ * Errors and critical messages are never queued. They are written right
+ * away, after everything queued before them, so they can not be dropped and
+ * are on disk even if the process dies right after logging them.
+ * The logging macros check if the level is enabled before the message is
+ * built so disabled levels cost almost nothing.
  */
 class Log
 {
@@ -110,6 +128,33 @@ public:
      */
     void LogMessage(Level_t level, const String& msg);
 
+    /**
+     * Start writing messages on a background thread. Anything still queued
+     * is written by @ref StopAsync which is also called when the process
+     * exits.
+     * @param queueSize Number of messages each thread can have waiting
+     *  to be written before new ones are dropped
+     */
+    void StartAsync(size_t queueSize = 8192);
+
+    /**
+     * Write every queued message and go back to writing each message on
+     * the thread that logs it.
+     */
+    void StopAsync();
+
+    /**
+     * Check if messages are written on a background thread.
+     * @returns true if messages are written on a background thread
+     */
+    bool IsAsync() const;
+
+    /**
+     * Get the number of messages dropped because a thread's queue was full.
+     * @returns Number of messages dropped
+     */
+    uint64_t GetDroppedCount() const;
+
     /**
      * Get the path to the log file.
      * @returns Path to the log file.
@@ -192,6 +237,31 @@ protected:
      */
     Log();
 
+    /**
+     * @internal
+     * Write a message to the log file and pass it to the hooks. The lock
+     * must be held by the caller.
+     * @param level Logging level of the message.
+     * @param msg The message to log.
+     * @param time Time the message was logged.
+     */
+    void WriteMessage(Level_t level, const String& msg,
+        const std::chrono::system_clock::time_point& time);
+
+    /**
+     * @internal
+     * Write every message queued by each thread in the order they were
+     * logged. @ref mDrainLock must be held by the caller.
+     * @returns true if anything was written
+     */
+    bool WriteQueuedMessages();
+
+    /**
+     * @internal
+     * Main loop of the background writer thread.
+     */
+    void AsyncWriterMain();
+
     /**
      * @internal
      * Path to the log file.
@@ -202,7 +272,7 @@ protected:
      * @internal
      * Whether to log messages for each level.
      */
-    bool mLogEnables[LOG_LEVEL_COUNT];
+    std::atomic<bool> mLogEnables[LOG_LEVEL_COUNT];
 
     /**
      * @internal
@@ -235,6 +305,77 @@ protected:
      */
     std::mutex mLock;
 
+    /**
+     * @internal
+     * Indicates if messages are queued for the background writer.
+     */
+    std::atomic<bool> mAsync;
+
+    /**
+     * @internal
+     * Number of messages each new thread queue can hold.
+     */
+    size_t mQueueSize;
+
+    /**
+     * @internal
+     * Message queue of every thread that has logged in async mode.
+     */
+    std::list<std::shared_ptr<LogQueue>> mQueues;
+
+    /**
+     * @internal
+     * Lock for the queue list and the writer thread state.
+     */
+    std::mutex mQueueLock;
+
+    /**
+     * @internal
+     * Signaled when the background writer should stop.
+     */
+    std::condition_variable mWriterCondition;
+
+    /**
+     * @internal
+     * Indicates if the background writer should stop.
+     */
+    bool mWriterStopping;
+
+    /**
+     * @internal
+     * Background writer thread.
+     */
+    std::thread mWriter;
+
+    /**
+     * @internal
+     * Held while the queues are read so only one thread reads them at a
+     * time and while a message is written by the thread that logs it so
+     * it comes after everything queued before it. This is locked before
+     * @ref mQueueLock and @ref mLock.
+     */
+    std::mutex mDrainLock;
+
+    /**
+     * @internal
+     * Number of threads adding a message to their queue right now.
+     * @ref StopAsync waits for this to reach zero before the last read
+     * of the queues so no message is queued after it.
+     */
+    std::atomic<uint32_t> mPushing;
+
+    /**
+     * @internal
+     * Number of messages dropped because a thread's queue was full.
+     */
+    std::atomic<uint64_t> mDropped;
+
+    /**
+     * @internal
+     * Number of dropped messages already reported in the log.
+     */
+    uint64_t mDroppedReported;
+
 #ifdef _WIN32
     /**
      * @internal
@@ -246,14 +387,29 @@ protected:
 
 } // namespace libcomp
 
+/**
+ * %Log a message if the level is enabled. The message expression is only
+ * evaluated when the level is enabled.
+ * @param level Logging level of the message.
+ * @param msg The message to log.
+ * @sa Log::LogMessage
+ * @relates Log
+ */
+#define LOG_MESSAGE(level, msg) do { \
+        libcomp::Log *pLogInstance = libcomp::Log::GetSingletonPtr(); \
+        if(pLogInstance->GetLogLevelEnabled(level)) \
+        { \
+            pLogInstance->LogMessage(level, msg); \
+        } \
+    } while(0)
+
 /**
  * %Log a critical error message.
  * @param msg The message to log.
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_CRITICAL(msg) libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_CRITICAL, msg)
+#define LOG_CRITICAL(msg) LOG_MESSAGE(libcomp::Log::LOG_LEVEL_CRITICAL, msg)
 
 /**
  * %Log an error message.
@@ -261,8 +417,7 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_ERROR(msg)    libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_ERROR, msg)
+#define LOG_ERROR(msg)    LOG_MESSAGE(libcomp::Log::LOG_LEVEL_ERROR, msg)
 
 /**
  * %Log a warning message.
@@ -270,8 +425,7 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_WARNING(msg)  libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_WARNING, msg)
+#define LOG_WARNING(msg)  LOG_MESSAGE(libcomp::Log::LOG_LEVEL_WARNING, msg)
 
 /**
  * %Log a informational message.
@@ -279,8 +433,7 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_INFO(msg)     libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_INFO, msg)
+#define LOG_INFO(msg)     LOG_MESSAGE(libcomp::Log::LOG_LEVEL_INFO, msg)
 
 /**
  * %Log a debug message.
@@ -288,7 +441,6 @@ protected:
  * @sa Log::LogMessage
  * @relates Log
  */
-#define LOG_DEBUG(msg)    libcomp::Log::GetSingletonPtr()->LogMessage( \
-    libcomp::Log::LOG_LEVEL_DEBUG, msg)
+#define LOG_DEBUG(msg)    LOG_MESSAGE(libcomp::Log::LOG_LEVEL_DEBUG, msg)
 
 #endif // LIBCOMP_SRC_LOG_H
@@ -0,0 +1,160 @@
+/**
+ * @file libcomp/src/MappedFile.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Read-only memory mapping of a file.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+using namespace libcomp;
+
+MappedFile::MappedFile() : mData(nullptr), mSize(0)
+#ifdef _WIN32
+    , mMapping(nullptr)
+#endif // _WIN32
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const String& path)
+{
+    Close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.C(), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if(INVALID_HANDLE_VALUE == file)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if(!GetFileSizeEx(file, &size) || 0 >= size.QuadPart)
+    {
+        CloseHandle(file);
+
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY,
+        0, 0, NULL);
+
+    // The mapping keeps its own reference to the file.
+    CloseHandle(file);
+
+    if(NULL == mapping)
+    {
+        return false;
+    }
+
+    void *pData = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if(NULL == pData)
+    {
+        CloseHandle(mapping);
+
+        return false;
+    }
+
+    mMapping = mapping;
+    mData = static_cast<const char*>(pData);
+    mSize = (size_t)size.QuadPart;
+#else // _WIN32
+    int fd = open(path.C(), O_RDONLY);
+
+    if(0 > fd)
+    {
+        return false;
+    }
+
+    struct stat st;
+
+    if(0 != fstat(fd, &st) || 0 >= st.st_size)
+    {
+        close(fd);
+
+        return false;
+    }
+
+    void *pData = mmap(nullptr, (size_t)st.st_size, PROT_READ,
+        MAP_SHARED, fd, 0);
+
+    // The mapping keeps its own reference to the file.
+    close(fd);
+
+    if(MAP_FAILED == pData)
+    {
+        return false;
+    }
+
+    mData = static_cast<const char*>(pData);
+    mSize = (size_t)st.st_size;
+#endif // _WIN32
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(nullptr == mData)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(mData);
+    CloseHandle(mMapping);
+
+    mMapping = nullptr;
+#else // _WIN32
+    munmap(const_cast<char*>(mData), mSize);
+#endif // _WIN32
+
+    mData = nullptr;
+    mSize = 0;
+}
+
+const char* MappedFile::GetData() const
+{
+    return mData;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return mSize;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file libcomp/src/MappedFile.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Read-only memory mapping of a file.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_MAPPEDFILE_H
+#define LIBCOMP_SRC_MAPPEDFILE_H
+
+// libcomp Includes
+#include "CString.h"
+
+// Standard C++11 Includes
+#include <streambuf>
+
+namespace libcomp
+{
+
+/**
+ * Read-only, shared memory mapping of a file on disk. Every process that
+ * maps the same file reads the same pages of the page cache while it is
+ * mapped. Anything built from the contents is private to the process.
+ */
+class MappedFile
+{
+public:
+    /**
+     * Create an empty mapping.
+     */
+    MappedFile();
+
+    /**
+     * Unmap the file if one is mapped.
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Map a file, unmapping the previous file if there was one.
+     * @param path Path to the file on disk
+     * @return true if the file was mapped, false if it could not be
+     *  opened or is empty
+     */
+    bool Open(const String& path);
+
+    /**
+     * Unmap the file.
+     */
+    void Close();
+
+    /**
+     * Get the contents of the file.
+     * @return Pointer to the mapped contents or nullptr if no file is
+     *  mapped
+     */
+    const char* GetData() const;
+
+    /**
+     * Get the size of the file.
+     * @return Size of the file in bytes
+     */
+    size_t GetSize() const;
+
+private:
+    /// Start of the mapped file
+    const char *mData;
+
+    /// Size of the mapped file
+    size_t mSize;
+
+#ifdef _WIN32
+    /// Handle of the file mapping object
+    void *mMapping;
+#endif // _WIN32
+};
+
+/**
+ * Stream buffer that reads from a block of memory without copying it.
+ */
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+    /**
+     * Create a stream buffer over a block of memory.
+     * @param pData Start of the memory
+     * @param size Size of the memory in bytes
+     */
+    MemoryStreamBuf(const char *pData, size_t size)
+    {
+        // The get area is never written through.
+        char *pStart = const_cast<char*>(pData);
+
+        setg(pStart, pStart, pStart + size);
+    }
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_MAPPEDFILE_H
@@ -27,9 +27,20 @@
 #ifndef LIBCOMP_SRC_MESSAGEQUEUE_H
 #define LIBCOMP_SRC_MESSAGEQUEUE_H
 
+#include <atomic>
 #include <list>
-#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else // defined(__linux__)
 #include <condition_variable>
+#include <mutex>
+#endif // defined(__linux__)
 
 namespace libcomp
 {
@@ -39,27 +50,58 @@ namespace libcomp
  * handled by a server. Messages queues are shared by both server
  * @ref Worker instances as well as each @ref EncryptedConnection that
  * connects to the server but is not limited to this usage.
+ *
+ * The queue is lock free for any number of producers and exactly one
+ * consumer. Producers link a node onto the head with a single atomic
+ * exchange and never wait on each other or on the consumer. Only the
+ * thread that owns the queue (the one calling @ref Dequeue,
+ * @ref DequeueAll or @ref DequeueAny) may remove messages. A consumer
+ * that finds the queue empty sleeps on a futex (or a condition variable
+ * on platforms without one) that producers only signal when the consumer
+ * has announced it is waiting so the uncontended path never enters the
+ * kernel.
  */
 template<class T>
 class MessageQueue
 {
 public:
+    /**
+     * Create an empty message queue.
+     */
+    MessageQueue() : mSleeping(false), mSignal(0)
+    {
+        Node *pStub = new Node;
+        mHead.store(pStub, std::memory_order_relaxed);
+        mTail = pStub;
+    }
+
+    /**
+     * Free any messages left in the queue. No producer or consumer may
+     * still be using the queue.
+     */
+    ~MessageQueue()
+    {
+        while(nullptr != mTail)
+        {
+            Node *pNext = mTail->next.load(std::memory_order_relaxed);
+            delete mTail;
+            mTail = pNext;
+        }
+    }
+
+    MessageQueue(const MessageQueue&) = delete;
+    MessageQueue& operator=(const MessageQueue&) = delete;
+
     /**
      * Enqueue a message.
      * @param Message to add
      */
     void Enqueue(T item)
     {
-        mQueueLock.lock();
-        bool wasEmpty = mQueue.empty();
-        mQueue.push_back(item);
-        mQueueLock.unlock();
+        Node *pNode = new Node;
+        pNode->value = std::move(item);
 
-        if(wasEmpty)
-        {
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mEmptyCondition.notify_one();
-        }
+        Push(pNode, pNode);
     }
 
     /**
@@ -68,16 +110,36 @@ public:
      */
     void Enqueue(std::list<T>& items)
     {
-        mQueueLock.lock();
-        bool wasEmpty = mQueue.empty();
-        mQueue.splice(mQueue.end(), items);
-        mQueueLock.unlock();
+        if(items.empty())
+        {
+            return;
+        }
 
-        if(wasEmpty)
+        // Build the chain privately so it can be published with one
+        // exchange and stays contiguous in the queue.
+        Node *pFirst = nullptr;
+        Node *pLast = nullptr;
+
+        for(auto& item : items)
         {
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mEmptyCondition.notify_one();
+            Node *pNode = new Node;
+            pNode->value = std::move(item);
+
+            if(nullptr == pLast)
+            {
+                pFirst = pNode;
+            }
+            else
+            {
+                pLast->next.store(pNode, std::memory_order_relaxed);
+            }
+
+            pLast = pNode;
         }
+
+        items.clear();
+
+        Push(pFirst, pLast);
     }
 
     /**
@@ -86,20 +148,13 @@ public:
      */
     T Dequeue()
     {
-        mQueueLock.lock();
+        T item;
 
-        if(mQueue.empty())
+        while(!TryPop(item))
         {
-            mQueueLock.unlock();
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mEmptyCondition.wait(uniqueLock);
-            mQueueLock.lock();
+            Wait();
         }
 
-        T item = mQueue.front();
-        mQueue.pop_front();
-        mQueueLock.unlock();
-
         return item;
     }
 
@@ -109,51 +164,185 @@ public:
      */
     void DequeueAll(std::list<T>& destinationQueue)
     {
-        std::list<T> tempQueue;
+        while(!PopAll(destinationQueue))
+        {
+            Wait();
+        }
+    }
+
+    /**
+     * Dequeue all the current messages.
+     * @param List to add the messages to
+     */
+    void DequeueAny(std::list<T>& destinationQueue)
+    {
+        (void)PopAll(destinationQueue);
+    }
+
+private:
+    /**
+     * Link in the queue. The node at the tail of the queue is always a
+     * placeholder whose value has already been consumed.
+     */
+    struct Node
+    {
+        /// Create an unlinked node.
+        Node() : next(nullptr)
+        {
+        }
+
+        /// Next (newer) node in the queue
+        std::atomic<Node*> next;
+
+        /// Message stored in the node
+        T value;
+    };
+
+    /**
+     * Publish a pre-linked chain of nodes and wake the consumer if it is
+     * sleeping.
+     * @param pFirst Oldest node of the chain
+     * @param pLast Newest node of the chain (its next must be null)
+     */
+    void Push(Node *pFirst, Node *pLast)
+    {
+        Node *pPrev = mHead.exchange(pLast, std::memory_order_acq_rel);
 
-        mQueueLock.lock();
+        // Until this store the consumer sees the queue as empty at pPrev.
+        pPrev->next.store(pFirst, std::memory_order_release);
 
-        if(mQueue.empty())
+        // Pairs with the fence in Wait so that either the consumer sees
+        // the new node or we see that it is (about to go) to sleep.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Only the first producer to see the consumer asleep wakes it.
+        if(mSleeping.load(std::memory_order_relaxed) &&
+            mSleeping.exchange(false, std::memory_order_relaxed))
         {
-            mQueueLock.unlock();
-            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
-            mEmptyCondition.wait(uniqueLock);
-            mQueueLock.lock();
+            mSignal.fetch_add(1, std::memory_order_release);
+            Wake();
         }
+    }
 
-        mQueue.swap(tempQueue);
-        mQueueLock.unlock();
+    /**
+     * Remove the oldest message (consumer only).
+     * @param item Set to the removed message
+     * @return true if a message was removed, false if the queue is empty
+     */
+    bool TryPop(T& item)
+    {
+        Node *pNext = mTail->next.load(std::memory_order_acquire);
 
-        destinationQueue.splice(destinationQueue.end(), tempQueue);
+        if(nullptr == pNext)
+        {
+            return false;
+        }
+
+        item = std::move(pNext->value);
+        pNext->value = T();
+
+        delete mTail;
+        mTail = pNext;
+
+        return true;
     }
 
     /**
-     * Dequeue all the current messages.
-     * @param List to add the messages to
+     * Remove every message currently linked (consumer only).
+     * @param destinationQueue List to add the messages to
+     * @return true if at least one message was removed
      */
-    void DequeueAny(std::list<T>& destinationQueue)
+    bool PopAll(std::list<T>& destinationQueue)
     {
-        std::list<T> tempQueue;
+        bool removed = false;
+        T item;
 
-        mQueueLock.lock();
-        mQueue.swap(tempQueue);
-        mQueueLock.unlock();
+        while(TryPop(item))
+        {
+            destinationQueue.push_back(std::move(item));
+            removed = true;
+        }
 
-        destinationQueue.splice(destinationQueue.end(), tempQueue);
+        return removed;
     }
 
-private:
-    /// The list of messages
-    std::list<T> mQueue;
+    /**
+     * Block the consumer until a producer signals or the queue is seen to
+     * be non-empty.
+     */
+    void Wait()
+    {
+        // A burst of messages usually arrives close together so check
+        // again for a short while before paying for a system call.
+        for(int i = 0; i < SPIN_COUNT; ++i)
+        {
+            if(nullptr != mTail->next.load(std::memory_order_acquire))
+            {
+                return;
+            }
+
+            std::this_thread::yield();
+        }
+
+        uint32_t key = mSignal.load(std::memory_order_acquire);
+
+        mSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if(nullptr == mTail->next.load(std::memory_order_acquire))
+        {
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&mSignal),
+                FUTEX_WAIT_PRIVATE, key, nullptr, nullptr, 0);
+#else // defined(__linux__)
+            std::unique_lock<std::mutex> uniqueLock(mWaitLock);
+
+            while(key == mSignal.load(std::memory_order_acquire))
+            {
+                mWaitCondition.wait(uniqueLock);
+            }
+#endif // defined(__linux__)
+        }
+
+        mSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wake the consumer after @ref mSignal has been changed.
+     */
+    void Wake()
+    {
+#if defined(__linux__)
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&mSignal),
+            FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#else // defined(__linux__)
+        std::lock_guard<std::mutex> guard(mWaitLock);
+        mWaitCondition.notify_all();
+#endif // defined(__linux__)
+    }
+
+    /// Number of times to re-check the queue before sleeping
+    static const int SPIN_COUNT = 64;
+
+    /// Newest node in the queue (shared by all producers)
+    std::atomic<Node*> mHead;
+
+    /// Placeholder node before the oldest message (consumer only)
+    Node *mTail;
+
+    /// Set while the consumer is (about to be) blocked in @ref Wait
+    std::atomic<bool> mSleeping;
 
-    /// Mutex lock to use when modifying the queue
-    std::mutex mQueueLock;
+    /// Futex word bumped by producers that need to wake the consumer
+    std::atomic<uint32_t> mSignal;
 
-    /// Mutix lock to use when waiting for a message to be queued
-    std::mutex mEmptyConditionLock;
+#if !defined(__linux__)
+    /// Mutex used to wait for a message to be queued
+    std::mutex mWaitLock;
 
     /// Blocking condition to wait for when no messages are queued
-    std::condition_variable mEmptyCondition;
+    std::condition_variable mWaitCondition;
+#endif // !defined(__linux__)
 };
 
 } // namespace libcomp
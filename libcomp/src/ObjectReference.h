@@ -241,10 +241,8 @@ public:
      */
     static bool Unload(const libobjgen::UUID& uuid)
     {
-        std::string uuidStr = uuid.ToString();
-
         std::lock_guard<std::mutex> lock(mReferenceLock);
-        auto iter = sData.find(uuidStr);
+        auto iter = sData.find(uuid);
         if(iter != sData.end())
         {
             bool loaded = iter->second->mRef != nullptr;
@@ -341,26 +339,25 @@ protected:
 
         if(!uuid.IsNull())
         {
-            std::string uuidStr = uuid.ToString();
-
             std::lock_guard<std::mutex> lock(mReferenceLock);
-            auto iter = sData.find(uuidStr);
+            auto iter = sData.find(uuid);
             if(iter == sData.end())
             {
-                sData[uuidStr] = std::shared_ptr<ObjectReferenceData>(
-                    new ObjectReferenceData(ref, uuid));
+                iter = sData.emplace(uuid, std::shared_ptr<
+                    ObjectReferenceData>(new ObjectReferenceData(ref,
+                    uuid))).first;
             }
-            else if(sData[uuidStr]->mRef == nullptr)
+            else if(iter->second->mRef == nullptr)
             {
-                sData[uuidStr]->mRef = ref;
+                iter->second->mRef = ref;
             }
 
             if(ref == nullptr && setLoadFailure)
             {
-                sData[uuidStr]->mLoadFailed = true;
+                iter->second->mLoadFailed = true;
             }
 
-            mData = sData[uuidStr];
+            mData = iter->second;
         }
         else
         {
@@ -385,14 +382,15 @@ protected:
     {
         if(mData != nullptr && !mData->mUUID.IsNull())
         {
-            std::string uuidStr = mData->mUUID.ToString();
+            libobjgen::UUID uuid = mData->mUUID;
 
             std::lock_guard<std::mutex> lock(mReferenceLock);
             mData = sNull;
 
-            if(sData[uuidStr].use_count() == 1)
+            auto iter = sData.find(uuid);
+            if(iter != sData.end() && iter->second.use_count() == 1)
             {
-                sData.erase(uuidStr);
+                sData.erase(iter);
             }
         }
         else
@@ -405,7 +403,7 @@ protected:
     std::shared_ptr<ObjectReferenceData> mData;
 
     /// Static cache of non-null UUIDs to persistent objects
-    static std::unordered_map<std::string,
+    static std::unordered_map<libobjgen::UUID,
         std::shared_ptr<ObjectReferenceData>> sData;
 
     /// Default value of mData instantiated once to avoid newing up
@@ -417,7 +415,7 @@ protected:
 };
 
 template<class T>
-std::unordered_map<std::string, std::shared_ptr<ObjectReferenceData>>
+std::unordered_map<libobjgen::UUID, std::shared_ptr<ObjectReferenceData>>
     ObjectReference<T>::sData;
 
 template<class T>
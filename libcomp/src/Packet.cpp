@@ -29,6 +29,7 @@
 #include "Compress.h"
 #include "Endian.h"
 #include "Log.h"
+#include "PacketBufferPool.h"
 #include "PacketException.h"
 #include "ScriptEngine.h"
 
@@ -52,9 +53,10 @@ Packet::Packet() : ReadOnlyPacket()
 }
 
 Packet::Packet(const Packet& other) : ReadOnlyPacket(other.mPosition,
-    other.mSize, nullptr, nullptr)
+    other.mSize, 0, nullptr, nullptr)
 {
-    Allocate();
+    // Only take a buffer big enough for the data being copied.
+    Reserve(other.mSize);
 
     // Make sure the data pointer is valid first.
     if(nullptr != mData)
@@ -64,10 +66,11 @@ Packet::Packet(const Packet& other) : ReadOnlyPacket(other.mPosition,
 }
 
 Packet::Packet(Packet&& other) : ReadOnlyPacket(other.mPosition, other.mSize,
-    other.mData, other.mDataRef)
+    other.mCapacity, other.mData, other.mDataRef)
 {
     other.mPosition = 0;
     other.mSize = 0;
+    other.mCapacity = 0;
     other.mDataRef.reset();
     other.mData = nullptr;
 
@@ -84,7 +87,7 @@ Packet::Packet(const std::vector<char>& data) : ReadOnlyPacket()
     if(!data.empty())
     {
         // Allocate the packet data.
-        Allocate();
+        Reserve((uint32_t)data.size());
 
         // Write the data.
         WriteArray(data);
@@ -103,7 +106,7 @@ Packet::Packet(const void *pData, uint32_t sz) : ReadOnlyPacket()
     if(0 < sz)
     {
         // Allocate the packet data.
-        Allocate();
+        Reserve(sz);
 
         // Write the data.
         WriteArray(pData, sz);
@@ -117,11 +120,39 @@ Packet::~Packet()
 {
 }
 
-void Packet::GrowPacket(uint32_t sz)
+void Packet::Reserve(uint32_t sz)
 {
-    // Allocate the packet data (if needed).
-    Allocate();
+    if(MAX_PACKET_SIZE < sz)
+    {
+        PACKET_EXCEPTION(String("Attempted to reserve %1 bytes for the "
+            "packet; however, this size exceeds the MAX_PACKET_SIZE").Arg(sz),
+            this);
+    }
+
+    if(nullptr == mData)
+    {
+        mDataRef = PacketBufferPool::Acquire(sz, mCapacity);
+        mData = mDataRef.get();
+    }
+    else if(mCapacity < sz)
+    {
+        uint32_t capacity = 0;
+        auto dataRef = PacketBufferPool::Acquire(sz, capacity);
+
+        // Bytes past the size may have been written through Data() before a
+        // call to Direct() so keep the whole old buffer.
+        memcpy(dataRef.get(), mData, mCapacity);
 
+        mDataRef = dataRef;
+        mData = mDataRef.get();
+        mCapacity = capacity;
+
+        PacketBufferPool::RecordGrow();
+    }
+}
+
+void Packet::GrowPacket(uint32_t sz)
+{
     // Make sure the packet is growing.
     if(0 == sz)
     {
@@ -151,6 +182,9 @@ void Packet::GrowPacket(uint32_t sz)
         // The new packet size is valid, set it.
         mSize = newSize;
     }
+
+    // Allocate (or enlarge) the packet data if needed.
+    Reserve(mPosition + sz);
 }
 
 void Packet::WriteBlank(uint32_t count)
@@ -439,7 +473,7 @@ void Packet::Clear()
     uint32_t deadbeef = 0xEFBEADDE;
 
     // Fill the buffer with "dead beef" so you can see what is and isn't data.
-    for(uint32_t i = 0; i < MAX_PACKET_SIZE; i += 4)
+    for(uint32_t i = 0; i < mCapacity; i += 4)
     {
         memcpy(mData + i, &deadbeef, 4);
     }
@@ -478,6 +512,9 @@ char* Packet::Direct(uint32_t sz)
             "size of the packet").Arg(sz), this);
     }
 
+    // Make sure the buffer can hold the new size.
+    Reserve(sz);
+
     // Set the new size of the packet.
     mSize = sz;
 
@@ -538,6 +575,9 @@ int32_t Packet::Decompress(int32_t sz)
     // Copy the data to decompress.
     memcpy(pData, mData + mPosition, (size_t)sz);
 
+    // The decompressed size is not known so allow for the largest packet.
+    Reserve(MAX_PACKET_SIZE);
+
     // Update the size of the packet.
     mSize = mPosition;
 
@@ -582,6 +622,10 @@ int32_t Packet::Compress(int32_t sz)
     // Copy the data to compress.
     memcpy(pData, mData + mPosition, (size_t)sz);
 
+    // Compressed data can be larger than the input so allow for the largest
+    // packet.
+    Reserve(MAX_PACKET_SIZE);
+
     // Update the size.
     mSize = mPosition;
 
@@ -602,11 +646,13 @@ Packet& Packet::operator=(Packet&& other)
 {
     mPosition = other.mPosition;
     mSize = other.mSize;
+    mCapacity = other.mCapacity;
     mDataRef = other.mDataRef;
     mData = other.mData;
 
     other.mPosition = 0;
     other.mSize = 0;
+    other.mCapacity = 0;
     other.mDataRef.reset();
     other.mData = nullptr;
 
@@ -497,12 +497,22 @@ public:
      */
     void Split(Packet& other, uint32_t sz);
 
+    /**
+     * Make sure the packet buffer can hold at least @em sz bytes, moving the
+     * data into a larger pooled buffer if needed. Call this before writing
+     * through @ref Data() past the current size of the packet. If @em sz
+     * exceeds MAX_PACKET_SIZE a PacketException will be thrown.
+     * @param sz Number of bytes the buffer must be able to hold.
+     */
+    void Reserve(uint32_t sz);
+
     /**
      * Return direct access to the underlying packet buffer. Avoid using this
      * function as modifying or deleting the buffer can cause bugs. With
      * direct access, you must do your own bounds checking. An alternative
      * is to use @ref seek() or @ref rewind() and then call @ref readArray()
-     * to copy the data out of the packet.
+     * to copy the data out of the packet. Only @ref Capacity() bytes may be
+     * accessed; see @ref Reserve().
      * @returns Pointer to the packet data.
      */
     char* Data() const;
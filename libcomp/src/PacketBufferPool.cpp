@@ -0,0 +1,206 @@
+/**
+ * @file libcomp/src/PacketBufferPool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Size classed pool of packet data buffers.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PacketBufferPool.h"
+
+// libcomp Includes
+#include "Constants.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+/// Capacity of each size class. The last class must be MAX_PACKET_SIZE.
+const uint32_t CLASS_CAPACITY[PacketBufferPool::SIZE_CLASS_COUNT] = {
+    256, 1024, 4096, MAX_PACKET_SIZE
+};
+
+/// Most buffers of each class a single thread will keep for reuse.
+const std::size_t CLASS_CACHE_LIMIT[PacketBufferPool::SIZE_CLASS_COUNT] = {
+    1024, 256, 64, 64
+};
+
+/**
+ * Global counters for one size class.
+ */
+struct ClassCounters
+{
+    std::atomic<uint64_t> Allocated;
+    std::atomic<uint64_t> Reused;
+    std::atomic<uint64_t> Recycled;
+    std::atomic<uint64_t> Freed;
+};
+
+/// Counters for all size classes.
+ClassCounters gClassCounters[PacketBufferPool::SIZE_CLASS_COUNT] = {};
+
+/// Number of times a packet moved to a larger buffer.
+std::atomic<uint64_t> gGrown(0);
+
+class ThreadCache;
+
+/// Cache of the current thread (null once the thread is shutting down).
+thread_local ThreadCache *tCache = nullptr;
+
+/**
+ * Free lists owned by a single thread.
+ */
+class ThreadCache
+{
+public:
+    ThreadCache()
+    {
+        tCache = this;
+    }
+
+    ~ThreadCache()
+    {
+        tCache = nullptr;
+
+        for(std::size_t i = 0; i < PacketBufferPool::SIZE_CLASS_COUNT; ++i)
+        {
+            for(auto pBuffer : mFree[i])
+            {
+                delete[] pBuffer;
+            }
+
+            gClassCounters[i].Freed += mFree[i].size();
+        }
+    }
+
+    /// Free buffers for each size class
+    std::vector<uint8_t*> mFree[PacketBufferPool::SIZE_CLASS_COUNT];
+};
+
+/**
+ * Get the cache for the current thread.
+ * @return Cache for the thread or null if it was already destroyed
+ */
+ThreadCache* GetThreadCache()
+{
+    static thread_local ThreadCache cache;
+
+    return tCache;
+}
+
+/**
+ * Returns a buffer to the pool when the last packet referencing it is
+ * destroyed.
+ */
+struct BufferRecycler
+{
+    /// Size class of the buffer
+    std::size_t SizeClass;
+
+    void operator()(uint8_t *pBuffer) const
+    {
+        ThreadCache *pCache = GetThreadCache();
+
+        if(nullptr != pCache &&
+            pCache->mFree[SizeClass].size() < CLASS_CACHE_LIMIT[SizeClass])
+        {
+            pCache->mFree[SizeClass].push_back(pBuffer);
+            gClassCounters[SizeClass].Recycled.fetch_add(1,
+                std::memory_order_relaxed);
+        }
+        else
+        {
+            delete[] pBuffer;
+            gClassCounters[SizeClass].Freed.fetch_add(1,
+                std::memory_order_relaxed);
+        }
+    }
+};
+
+} // namespace
+
+std::shared_ptr<uint8_t> PacketBufferPool::Acquire(uint32_t minimumSize,
+    uint32_t& capacity)
+{
+    std::size_t sizeClass = 0;
+
+    while(sizeClass < (SIZE_CLASS_COUNT - 1) &&
+        CLASS_CAPACITY[sizeClass] < minimumSize)
+    {
+        sizeClass++;
+    }
+
+    capacity = CLASS_CAPACITY[sizeClass];
+
+    uint8_t *pBuffer = nullptr;
+    ThreadCache *pCache = GetThreadCache();
+
+    if(nullptr != pCache && !pCache->mFree[sizeClass].empty())
+    {
+        pBuffer = pCache->mFree[sizeClass].back();
+        pCache->mFree[sizeClass].pop_back();
+
+        gClassCounters[sizeClass].Reused.fetch_add(1,
+            std::memory_order_relaxed);
+    }
+    else
+    {
+        pBuffer = new uint8_t[capacity];
+
+        gClassCounters[sizeClass].Allocated.fetch_add(1,
+            std::memory_order_relaxed);
+    }
+
+    return std::shared_ptr<uint8_t>(pBuffer, BufferRecycler{ sizeClass });
+}
+
+void PacketBufferPool::RecordGrow()
+{
+    gGrown.fetch_add(1, std::memory_order_relaxed);
+}
+
+PacketBufferPool::Stats PacketBufferPool::GetStats()
+{
+    Stats stats;
+
+    for(std::size_t i = 0; i < SIZE_CLASS_COUNT; ++i)
+    {
+        auto& counters = gClassCounters[i];
+        auto& classStats = stats.Classes[i];
+
+        classStats.Capacity = CLASS_CAPACITY[i];
+        classStats.Allocated = counters.Allocated.load(
+            std::memory_order_relaxed);
+        classStats.Reused = counters.Reused.load(std::memory_order_relaxed);
+        classStats.Recycled = counters.Recycled.load(
+            std::memory_order_relaxed);
+        classStats.Freed = counters.Freed.load(std::memory_order_relaxed);
+    }
+
+    stats.Grown = gGrown.load(std::memory_order_relaxed);
+
+    return stats;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file libcomp/src/PacketBufferPool.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Size classed pool of packet data buffers.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_PACKETBUFFERPOOL_H
+#define LIBCOMP_SRC_PACKETBUFFERPOOL_H
+
+// Standard C++11 Includes
+#include <array>
+#include <memory>
+
+#include <stdint.h>
+
+namespace libcomp
+{
+
+/**
+ * Thread local, size classed pool of the raw buffers behind
+ * @ref ReadOnlyPacket and @ref Packet. Buffers come in a small number of
+ * fixed capacities (the largest being MAX_PACKET_SIZE) so small replies
+ * do not hold a full size buffer. Each thread keeps its own free lists
+ * that grow on demand; a buffer is returned to the free list of the
+ * thread that drops the last reference to it. Every thread caches at most
+ * a fixed number of buffers per size class and frees the rest.
+ */
+class PacketBufferPool
+{
+public:
+    /// Number of buffer size classes.
+    static const std::size_t SIZE_CLASS_COUNT = 4;
+
+    /**
+     * Counters for one size class (totals for all threads).
+     */
+    struct ClassStats
+    {
+        /// Capacity of buffers in this class
+        uint32_t Capacity;
+
+        /// Buffers allocated from the heap
+        uint64_t Allocated;
+
+        /// Buffers handed out from a free list
+        uint64_t Reused;
+
+        /// Buffers returned to a free list
+        uint64_t Recycled;
+
+        /// Buffers freed because the free list was full
+        uint64_t Freed;
+    };
+
+    /**
+     * Counters for every size class.
+     */
+    struct Stats
+    {
+        /// Counters for each size class from smallest to largest
+        std::array<ClassStats, SIZE_CLASS_COUNT> Classes;
+
+        /// Number of times a packet had to move to a larger buffer
+        uint64_t Grown;
+    };
+
+    /**
+     * Get a buffer that can hold at least the requested number of bytes.
+     * The buffer is recycled once the last shared reference is released.
+     * The contents of the buffer are undefined.
+     * @param minimumSize Minimum number of bytes the buffer must hold
+     *  (clamped to MAX_PACKET_SIZE)
+     * @param capacity Set to the actual capacity of the buffer
+     * @return Shared reference to the buffer
+     */
+    static std::shared_ptr<uint8_t> Acquire(uint32_t minimumSize,
+        uint32_t& capacity);
+
+    /**
+     * Record that a packet moved its data into a larger buffer.
+     */
+    static void RecordGrow();
+
+    /**
+     * Get a snapshot of the pool counters.
+     * @return Pool counters
+     */
+    static Stats GetStats();
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_PACKETBUFFERPOOL_H
@@ -59,8 +59,7 @@
 
 using namespace libcomp;
 
-std::unordered_map<std::string, std::weak_ptr<PersistentObject>> PersistentObject::sCached;
-std::mutex PersistentObject::mCacheLock;
+PersistentObjectCache PersistentObject::sCache;
 PersistentObject::TypeMap PersistentObject::sTypeMap;
 std::unordered_map<std::string, size_t> PersistentObject::sTypeNames;
 std::unordered_map<size_t, std::function<PersistentObject*()>> PersistentObject::sFactory;
@@ -82,13 +81,10 @@ PersistentObject::~PersistentObject()
 {
     if(!mUUID.IsNull() && !IsDeleted())
     {
-        std::lock_guard<std::mutex> lock(mCacheLock);
-
-        std::string strUUID = mUUID.ToString();
-        if(sCached.find(strUUID) != sCached.end())
-        {
-            sCached.erase(strUUID);
-        }
+        // Only remove the entry if it belongs to this object which has
+        // expired by now. A duplicate that failed to register must not
+        // remove the object that did.
+        sCache.RemoveExpired(mUUID);
     }
 }
 
@@ -102,19 +98,12 @@ bool PersistentObject::Register(const std::shared_ptr<PersistentObject>& self,
 {
     if(!self->IsDeleted())
     {
-        bool registered = false;
-
         libobjgen::UUID& uuid = self->mUUID;
 
-        std::lock_guard<std::mutex> lock(mCacheLock);
         if(!pUuid.IsNull() && !uuid.IsNull())
         {
             // Unregister old UUID, keep if making a copy
-            auto it = sCached.find(uuid.ToString());
-            if(it != sCached.end() && it->second.lock() == self)
-            {
-                sCached.erase(it);
-            }
+            sCache.Remove(uuid, self);
         }
 
         if(!pUuid.IsNull())
@@ -124,27 +113,18 @@ bool PersistentObject::Register(const std::shared_ptr<PersistentObject>& self,
         else if(uuid.IsNull())
         {
             uuid = libobjgen::UUID::Random();
-            registered = true;
         }
 
-        if(!registered && sCached.find(uuid.ToString()) == sCached.end())
-        {
-            registered = true;
-        }
-
-        std::string uuidString = uuid.ToString();
-
-        if(registered)
+        if(sCache.Add(uuid, self))
         {
             self->mSelf = self;
-            sCached[uuidString] = self;
 
             return true;
         }
         else
         {
             LOG_ERROR(String("Duplicate object detected: %1\n").Arg(
-                uuidString));
+                uuid.ToString()));
         }
     }
 
@@ -155,13 +135,7 @@ void PersistentObject::Unregister()
 {
     mDeleted = true;
 
-    std::lock_guard<std::mutex> lock(mCacheLock);
-
-    auto iter = sCached.find(mUUID.ToString());
-    if(iter != sCached.end())
-    {
-        sCached.erase(iter);
-    }
+    sCache.Remove(mUUID);
 }
 
 bool PersistentObject::IsDeleted()
@@ -171,15 +145,17 @@ bool PersistentObject::IsDeleted()
 
 std::shared_ptr<PersistentObject> PersistentObject::GetObjectByUUID(const libobjgen::UUID& uuid)
 {
-    std::lock_guard<std::mutex> lock(mCacheLock);
+    return sCache.Get(uuid);
+}
 
-    auto iter = sCached.find(uuid.ToString());
-    if(iter != sCached.end())
-    {
-        return iter->second.lock();
-    }
+PersistentObjectCache::Stats PersistentObject::GetCacheStats()
+{
+    return sCache.GetStats();
+}
 
-    return nullptr;
+size_t PersistentObject::SweepCache()
+{
+    return sCache.Sweep();
 }
 
 std::shared_ptr<PersistentObject> PersistentObject::LoadObjectByUUID(size_t typeHash,
@@ -205,6 +181,37 @@ std::shared_ptr<PersistentObject> PersistentObject::LoadObjectByUUID(size_t type
     return obj;
 }
 
+std::list<std::shared_ptr<PersistentObject>>
+    PersistentObject::LoadObjectsByUUID(size_t typeHash,
+    const std::shared_ptr<Database>& db,
+    const std::list<libobjgen::UUID>& uuids, bool reload)
+{
+    std::list<std::shared_ptr<PersistentObject>> objects;
+    std::list<libobjgen::UUID> missing;
+
+    for(auto& uuid : uuids)
+    {
+        auto obj = !reload ? GetObjectByUUID(uuid) : nullptr;
+
+        if(nullptr != obj)
+        {
+            objects.push_back(obj);
+        }
+        else if(!uuid.IsNull())
+        {
+            missing.push_back(uuid);
+        }
+    }
+
+    if(!missing.empty() && nullptr != db)
+    {
+        objects.splice(objects.end(), db->LoadObjectsIn(typeHash, "UID",
+            missing));
+    }
+
+    return objects;
+}
+
 std::shared_ptr<PersistentObject> PersistentObject::LoadObject(
     size_t typeHash, const std::shared_ptr<Database>& db,
     DatabaseBind *pValue)
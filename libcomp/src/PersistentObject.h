@@ -30,6 +30,7 @@
 // libcomp Includes
 #include <CString.h>
 #include <Object.h>
+#include <PersistentObjectCache.h>
 
 // libobjgen Includes
 #include <MetaObject.h>
@@ -144,6 +145,18 @@ public:
     static std::shared_ptr<PersistentObject> GetObjectByUUID(
         const libobjgen::UUID& uuid);
 
+    /**
+     * Get the usage counters of the object cache.
+     * @return Object cache statistics
+     */
+    static PersistentObjectCache::Stats GetCacheStats();
+
+    /**
+     * Remove every destroyed object still listed in the object cache.
+     * @return Number of entries removed
+     */
+    static size_t SweepCache();
+
     /**
      * Retrieve all objects of the specified type by its UUID from the
      * database.  Use sparingly.
@@ -199,6 +212,46 @@ public:
         size_t typeHash, const std::shared_ptr<Database>& db,
         const libobjgen::UUID& uuid, bool reload = false);
 
+    /**
+     * Retrieve many objects of the specified type by their UUIDs from the
+     * cache or database. Every object not already cached is loaded with as
+     * few queries as possible instead of one query per object. Objects
+     * that do not exist are left out of the result.
+     * @param db Database to load from
+     * @param uuids UUIDs of the objects to load
+     * @param reload Forces a reload from the DB if true
+     * @return List of pointers to the objects found
+     */
+    template<class T> static std::list<std::shared_ptr<T>> LoadObjectsByUUID(
+        const std::shared_ptr<Database>& db,
+        const std::list<libobjgen::UUID>& uuids, bool reload = false)
+    {
+        std::list<std::shared_ptr<T>> retval;
+        if(std::is_base_of<PersistentObject, T>::value)
+        {
+            for(auto obj : LoadObjectsByUUID(typeid(T).hash_code(), db,
+                uuids, reload))
+            {
+                retval.push_back(std::dynamic_pointer_cast<T>(obj));
+            }
+        }
+
+        return retval;
+    }
+
+    /**
+     * Retrieve many objects of the specified type ID by their UUIDs from
+     * the cache or database.
+     * @param typeHash C++ type hash representing the object type to load
+     * @param db Database to load from
+     * @param uuids UUIDs of the objects to load
+     * @param reload Forces a reload from the DB if true
+     * @return List of pointers to the objects found
+     */
+    static std::list<std::shared_ptr<PersistentObject>> LoadObjectsByUUID(
+        size_t typeHash, const std::shared_ptr<Database>& db,
+        const std::list<libobjgen::UUID>& uuids, bool reload = false);
+
     /**
      * Get all PersistentObject derived class MetaObject definitions.
      * @return Map of MetaObject definitions by the source object's C++ type
@@ -359,12 +412,8 @@ protected:
     std::set<std::string> mDirtyFields;
 
 private:
-    /// Map of intantiated objects listed by their UUID
-    static std::unordered_map<std::string,
-        std::weak_ptr<PersistentObject>> sCached;
-
-    /// Mutex to lock accessing the cache
-    static std::mutex mCacheLock;
+    /// Cache of intantiated objects listed by their UUID
+    static PersistentObjectCache sCache;
 
     /// Static map of MetaObject definitions by the source object's C++ type hash
     static TypeMap sTypeMap;
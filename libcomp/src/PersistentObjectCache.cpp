@@ -0,0 +1,213 @@
+/**
+ * @file libcomp/src/PersistentObjectCache.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Sharded cache of persistent objects by UUID.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "PersistentObjectCache.h"
+
+// Standard C++11 Includes
+#include <algorithm>
+
+using namespace libcomp;
+
+const size_t PersistentObjectCache::SHARD_COUNT;
+const size_t PersistentObjectCache::MIN_SWEEP_SIZE;
+
+std::shared_ptr<PersistentObject> PersistentObjectCache::Get(
+    const libobjgen::UUID& uuid)
+{
+    Shard& shard = GetShard(uuid);
+
+    std::lock_guard<std::mutex> lock(shard.Lock);
+
+    auto it = shard.Objects.find(uuid);
+    if(it == shard.Objects.end())
+    {
+        shard.Misses++;
+
+        return nullptr;
+    }
+
+    auto obj = it->second.lock();
+    if(obj)
+    {
+        shard.Hits++;
+    }
+    else
+    {
+        shard.Expired++;
+    }
+
+    return obj;
+}
+
+bool PersistentObjectCache::Add(const libobjgen::UUID& uuid,
+    const std::shared_ptr<PersistentObject>& obj)
+{
+    Shard& shard = GetShard(uuid);
+
+    std::lock_guard<std::mutex> lock(shard.Lock);
+
+    auto it = shard.Objects.find(uuid);
+    if(it != shard.Objects.end())
+    {
+        if(!it->second.expired())
+        {
+            return false;
+        }
+
+        it->second = obj;
+
+        return true;
+    }
+
+    shard.Objects.emplace(uuid, obj);
+
+    if(shard.Objects.size() >= shard.SweepAt)
+    {
+        shard.Swept += SweepShard(shard);
+        shard.SweepAt = std::max(MIN_SWEEP_SIZE, shard.Objects.size() * 2);
+    }
+
+    return true;
+}
+
+bool PersistentObjectCache::Contains(const libobjgen::UUID& uuid)
+{
+    Shard& shard = GetShard(uuid);
+
+    std::lock_guard<std::mutex> lock(shard.Lock);
+
+    auto it = shard.Objects.find(uuid);
+
+    return it != shard.Objects.end() && !it->second.expired();
+}
+
+bool PersistentObjectCache::Remove(const libobjgen::UUID& uuid)
+{
+    Shard& shard = GetShard(uuid);
+
+    std::lock_guard<std::mutex> lock(shard.Lock);
+
+    return 0 != shard.Objects.erase(uuid);
+}
+
+bool PersistentObjectCache::Remove(const libobjgen::UUID& uuid,
+    const std::shared_ptr<PersistentObject>& obj)
+{
+    Shard& shard = GetShard(uuid);
+
+    std::lock_guard<std::mutex> lock(shard.Lock);
+
+    auto it = shard.Objects.find(uuid);
+    if(it != shard.Objects.end() && it->second.lock() == obj)
+    {
+        shard.Objects.erase(it);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool PersistentObjectCache::RemoveExpired(const libobjgen::UUID& uuid)
+{
+    Shard& shard = GetShard(uuid);
+
+    std::lock_guard<std::mutex> lock(shard.Lock);
+
+    auto it = shard.Objects.find(uuid);
+    if(it != shard.Objects.end() && it->second.expired())
+    {
+        shard.Objects.erase(it);
+
+        return true;
+    }
+
+    return false;
+}
+
+size_t PersistentObjectCache::Sweep()
+{
+    size_t removed = 0;
+
+    for(Shard& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.Lock);
+
+        size_t count = SweepShard(shard);
+
+        shard.Swept += count;
+        removed += count;
+    }
+
+    return removed;
+}
+
+PersistentObjectCache::Stats PersistentObjectCache::GetStats()
+{
+    Stats stats = {};
+
+    for(Shard& shard : mShards)
+    {
+        std::lock_guard<std::mutex> lock(shard.Lock);
+
+        stats.Hits += shard.Hits;
+        stats.Misses += shard.Misses;
+        stats.Expired += shard.Expired;
+        stats.Swept += shard.Swept;
+        stats.Cached += shard.Objects.size();
+    }
+
+    return stats;
+}
+
+PersistentObjectCache::Shard& PersistentObjectCache::GetShard(
+    const libobjgen::UUID& uuid)
+{
+    // Use the high bits for the shard so the low bits the map buckets on
+    // still vary inside each shard. The full 64-bit hash is used as the
+    // map hash is only the low 32 bits on 32-bit builds.
+    return mShards[(size_t)(uuid.Hash64() >> 32) % SHARD_COUNT];
+}
+
+size_t PersistentObjectCache::SweepShard(Shard& shard)
+{
+    size_t removed = 0;
+
+    for(auto it = shard.Objects.begin(); it != shard.Objects.end();)
+    {
+        if(it->second.expired())
+        {
+            it = shard.Objects.erase(it);
+            removed++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return removed;
+}
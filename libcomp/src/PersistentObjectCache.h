@@ -0,0 +1,199 @@
+/**
+ * @file libcomp/src/PersistentObjectCache.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Sharded cache of persistent objects by UUID.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_PERSISTENTOBJECTCACHE_H
+#define LIBCOMP_SRC_PERSISTENTOBJECTCACHE_H
+
+// libobjgen Includes
+#include <UUID.h>
+
+// Standard C++11 Includes
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <unordered_map>
+
+namespace libcomp
+{
+
+class PersistentObject;
+
+/**
+ * Cache of every registered @ref PersistentObject by its UUID. Objects are
+ * held by weak pointer so the cache never keeps an object alive. The cache
+ * is split into shards picked from the UUID hash, each with its own lock,
+ * so threads looking up different objects rarely wait on each other. The
+ * UUID is used as the key directly instead of being formatted as a string.
+ * Entries left behind by objects that have been destroyed are swept out of
+ * a shard whenever it grows to twice the size it had after its last sweep.
+ */
+class PersistentObjectCache
+{
+public:
+    /**
+     * Counters describing how the cache has been used.
+     */
+    struct Stats
+    {
+        /// Lookups that found a live object
+        uint64_t Hits;
+
+        /// Lookups that found nothing
+        uint64_t Misses;
+
+        /// Lookups that found an object that had already been destroyed
+        uint64_t Expired;
+
+        /// Entries of destroyed objects removed by a sweep
+        uint64_t Swept;
+
+        /// Number of entries currently cached
+        uint64_t Cached;
+    };
+
+    /// Number of independently locked shards
+    static const size_t SHARD_COUNT = 64;
+
+    /**
+     * Get the object cached for a UUID.
+     * @param uuid UUID of the object
+     * @return Pointer to the object or nullptr if it is not cached or has
+     *  been destroyed
+     */
+    std::shared_ptr<PersistentObject> Get(const libobjgen::UUID& uuid);
+
+    /**
+     * Cache an object under a UUID unless another live object already
+     * has it.
+     * @param uuid UUID of the object
+     * @param obj Object to cache
+     * @return true if the object was cached, false if the UUID belongs to
+     *  another live object
+     */
+    bool Add(const libobjgen::UUID& uuid,
+        const std::shared_ptr<PersistentObject>& obj);
+
+    /**
+     * Check if a live object is cached for a UUID. This does not count
+     * towards the lookup statistics.
+     * @param uuid UUID of the object
+     * @return true if a live object is cached for the UUID
+     */
+    bool Contains(const libobjgen::UUID& uuid);
+
+    /**
+     * Remove whatever is cached for a UUID.
+     * @param uuid UUID of the object
+     * @return true if an entry was removed
+     */
+    bool Remove(const libobjgen::UUID& uuid);
+
+    /**
+     * Remove the entry for a UUID only if it points to the specified
+     * object.
+     * @param uuid UUID of the object
+     * @param obj Object that must be cached for the entry to be removed
+     * @return true if an entry was removed
+     */
+    bool Remove(const libobjgen::UUID& uuid,
+        const std::shared_ptr<PersistentObject>& obj);
+
+    /**
+     * Remove the entry for a UUID only if the object it points to has been
+     * destroyed. This is used by objects being destroyed so they do not
+     * remove a live object that was registered with the same UUID.
+     * @param uuid UUID of the object
+     * @return true if an entry was removed
+     */
+    bool RemoveExpired(const libobjgen::UUID& uuid);
+
+    /**
+     * Remove the entries of every destroyed object from all shards.
+     * @return Number of entries removed
+     */
+    size_t Sweep();
+
+    /**
+     * Get the usage counters summed over all shards.
+     * @return Cache statistics
+     */
+    Stats GetStats();
+
+private:
+    /// Fewest entries a shard holds before it is swept
+    static const size_t MIN_SWEEP_SIZE = 256;
+
+    /**
+     * One independently locked part of the cache. Each shard is kept on
+     * its own cache line so the locks do not share one.
+     */
+    struct alignas(64) Shard
+    {
+        /// Lock for everything in the shard
+        std::mutex Lock;
+
+        /// Cached objects by UUID
+        std::unordered_map<libobjgen::UUID,
+            std::weak_ptr<PersistentObject>> Objects;
+
+        /// Size the shard must reach before it is swept again
+        size_t SweepAt = MIN_SWEEP_SIZE;
+
+        /// Lookups that found a live object
+        uint64_t Hits = 0;
+
+        /// Lookups that found nothing
+        uint64_t Misses = 0;
+
+        /// Lookups that found a destroyed object
+        uint64_t Expired = 0;
+
+        /// Entries removed by sweeps
+        uint64_t Swept = 0;
+    };
+
+    /**
+     * Get the shard a UUID belongs to.
+     * @param uuid UUID to look up
+     * @return Shard holding the UUID
+     */
+    Shard& GetShard(const libobjgen::UUID& uuid);
+
+    /**
+     * Remove the entries of destroyed objects from a shard. The shard lock
+     * must be held by the caller.
+     * @param shard Shard to sweep
+     * @return Number of entries removed
+     */
+    static size_t SweepShard(Shard& shard);
+
+    /// Shards of the cache
+    Shard mShards[SHARD_COUNT];
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_PERSISTENTOBJECTCACHE_H
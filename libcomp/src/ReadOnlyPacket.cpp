@@ -28,11 +28,10 @@
 
 #include "Endian.h"
 #include "Log.h"
+#include "PacketBufferPool.h"
 #include "PacketException.h"
 #include "ScriptEngine.h"
 
-#include <array>
-
 #ifdef _WIN32
 #include <windows.h>
 #else // _WIN32
@@ -44,7 +43,8 @@
 
 using namespace libcomp;
 
-ReadOnlyPacket::ReadOnlyPacket() : mPosition(0), mSize(0), mData(nullptr)
+ReadOnlyPacket::ReadOnlyPacket() : mPosition(0), mSize(0), mCapacity(0),
+    mData(nullptr)
 {
     // The max packet size should be evenly divisible by 4 bytes.
     static_assert(0 == (MAX_PACKET_SIZE % 4),
@@ -52,34 +52,51 @@ ReadOnlyPacket::ReadOnlyPacket() : mPosition(0), mSize(0), mData(nullptr)
 }
 
 ReadOnlyPacket::ReadOnlyPacket(uint32_t position, uint32_t size,
-    uint8_t *pData, std::shared_ptr<PacketArray> dataRef) :
-    mPosition(position), mSize(size), mData(pData), mDataRef(dataRef)
+    uint32_t capacity, uint8_t *pData, std::shared_ptr<uint8_t> dataRef) :
+    mPosition(position), mSize(size), mCapacity(capacity), mData(pData),
+    mDataRef(dataRef)
 {
 }
 
 ReadOnlyPacket::ReadOnlyPacket(const ReadOnlyPacket& other) :
-    mPosition(other.mPosition), mSize(other.mSize), mData(other.mData),
-    mDataRef(other.mDataRef)
+    mPosition(other.mPosition), mSize(other.mSize),
+    mCapacity(other.mCapacity), mData(other.mData), mDataRef(other.mDataRef),
+    mPatches(other.mPatches)
 {
 }
 
 ReadOnlyPacket::ReadOnlyPacket(const ReadOnlyPacket& other,
     uint32_t start, uint32_t size) : mPosition(0), mSize(size),
-    mData(&other.mData[start]), mDataRef(other.mDataRef)
+    mCapacity(other.mCapacity - start), mData(&other.mData[start]),
+    mDataRef(other.mDataRef)
 {
     if((start + size) > other.mSize)
     {
         PACKET_EXCEPTION("Attempted to copy part of a packet that does "
             "not exist.", this);
     }
+
+    // Keep the patches that fall inside the part that was copied.
+    for(auto& patch : other.mPatches)
+    {
+        if(patch.Offset >= start &&
+            (patch.Offset + sizeof(patch.Value)) <= (start + size))
+        {
+            PacketPatch adjusted = patch;
+            adjusted.Offset -= start;
+
+            mPatches.push_back(adjusted);
+        }
+    }
 }
 
 ReadOnlyPacket::ReadOnlyPacket(Packet&& other) :
-    mPosition(other.mPosition), mSize(other.mSize), mData(other.mData),
-    mDataRef(other.mDataRef)
+    mPosition(other.mPosition), mSize(other.mSize),
+    mCapacity(other.mCapacity), mData(other.mData), mDataRef(other.mDataRef)
 {
     other.mPosition = 0;
     other.mSize = 0;
+    other.mCapacity = 0;
     other.mDataRef.reset();
     other.mData = nullptr;
 
@@ -96,11 +113,45 @@ void ReadOnlyPacket::Allocate()
     // Ensure the packet data buffer is allocated.
     if(nullptr == mData)
     {
-        mDataRef = std::shared_ptr<PacketArray>(new PacketArray);
-        mData = mDataRef.get()->data();
+        mDataRef = PacketBufferPool::Acquire(0, mCapacity);
+        mData = mDataRef.get();
     }
 }
 
+void ReadOnlyPacket::SetPatches(std::vector<PacketPatch>&& patches)
+{
+    for(auto& patch : patches)
+    {
+        if((patch.Offset + sizeof(patch.Value)) > mSize)
+        {
+            PACKET_EXCEPTION(String("Attempted to patch the packet at %1; "
+                "however, this is past the end of the packet").Arg(
+                patch.Offset), this);
+        }
+    }
+
+    mPatches = std::move(patches);
+}
+
+const std::vector<PacketPatch>& ReadOnlyPacket::GetPatches() const
+{
+    return mPatches;
+}
+
+void ReadOnlyPacket::ApplyPatches(char *pDestination) const
+{
+    for(auto& patch : mPatches)
+    {
+        memcpy(pDestination + patch.Offset, patch.Value,
+            sizeof(patch.Value));
+    }
+}
+
+uint32_t ReadOnlyPacket::Capacity() const
+{
+    return mCapacity;
+}
+
 void ReadOnlyPacket::Seek(uint32_t pos)
 {
     // If the position is past the max ReadOnlypacket size, thrown an exception.
@@ -905,8 +956,10 @@ ReadOnlyPacket& ReadOnlyPacket::operator=(ReadOnlyPacket& other)
 {
     mPosition = other.mPosition;
     mSize = other.mSize;
+    mCapacity = other.mCapacity;
     mDataRef = other.mDataRef;
     mData = other.mData;
+    mPatches = other.mPatches;
 
     return *this;
 }
@@ -52,6 +52,21 @@ class Packet;
 // This class is thrown when an error occurs in the Packet class.
 class PacketException;
 
+/**
+ * Replacement of 4 bytes of packet data that only applies to one copy of a
+ * packet sharing its buffer with other copies. This lets the same payload
+ * be queued for many connections with only a few per-connection values
+ * (such as client relative timestamps) differing between them.
+ */
+struct PacketPatch
+{
+    /// Offset of the bytes to replace from the start of the packet data.
+    uint32_t Offset;
+
+    /// Replacement bytes in the same layout they would be written with.
+    uint8_t Value[4];
+};
+
 /**
  * Convenience class to read and write packet data. This class is designed to
  * make it easy to read and write packet data. Strings can be converted between
@@ -84,9 +99,6 @@ class PacketException;
  */
 class ReadOnlyPacket
 {
-private:
-    typedef std::array<uint8_t, MAX_PACKET_SIZE> PacketArray;
-
 public:
     /// This class needs to directly access data in the Packet class.
     friend class PacketException;
@@ -727,6 +739,32 @@ public:
      */
     void Allocate();
 
+    /**
+     * Set the patches to apply over the shared packet data when this packet
+     * is written out. The shared buffer itself is never modified.
+     * @param patches Patches for this copy of the packet.
+     */
+    void SetPatches(std::vector<PacketPatch>&& patches);
+
+    /**
+     * Get the patches to apply over the packet data of this copy.
+     * @returns Patches for this copy of the packet.
+     */
+    const std::vector<PacketPatch>& GetPatches() const;
+
+    /**
+     * Apply the patches of this packet to a copy of the packet data.
+     * @param pDestination Start of the copied packet data.
+     */
+    void ApplyPatches(char *pDestination) const;
+
+    /**
+     * Get the number of bytes the current packet buffer can hold without
+     * moving to a larger buffer.
+     * @returns Capacity of the packet buffer or 0 if none is allocated.
+     */
+    uint32_t Capacity() const;
+
     /**
      * @brief Copy the packet data from another ReadOnlyPacket object.
      * @param other ReadOnlyPacket object to move the data from.
@@ -742,7 +780,7 @@ public:
 protected:
     /// Protected constructor for use by subclasses.
     explicit ReadOnlyPacket(uint32_t position, uint32_t size,
-        uint8_t *pData, std::shared_ptr<PacketArray> dataRef);
+        uint32_t capacity, uint8_t *pData, std::shared_ptr<uint8_t> dataRef);
 
     /// Current position in the packet.
     uint32_t mPosition;
@@ -750,12 +788,18 @@ protected:
     /// Size of the packet.
     uint32_t mSize;
 
+    /// Number of bytes available from mData in the underlying buffer.
+    uint32_t mCapacity;
+
     /// Pointer to the packet data.
     uint8_t *mData;
 
-    /// Reference to the underlying buffer (which could be shared between
-    /// read only packets).
-    std::shared_ptr<PacketArray> mDataRef;
+    /// Reference to the underlying pooled buffer (which could be shared
+    /// between read only packets).
+    std::shared_ptr<uint8_t> mDataRef;
+
+    /// Per copy patches applied over the shared data when sent.
+    std::vector<PacketPatch> mPatches;
 };
 
 } // namespace libcomp
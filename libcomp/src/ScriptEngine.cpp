@@ -31,6 +31,7 @@
 
 #include <cstdio>
 #include <cstdarg>
+#include <cstring>
 
 #include <sqstdaux.h>
 
@@ -206,11 +207,95 @@ bool ScriptEngine::Eval(const String& source, const String& sourceName)
     return result;
 }
 
+bool ScriptEngine::Compile(const String& source, std::vector<char>& bytecode,
+    const String& sourceName)
+{
+    bool result = false;
+
+    SQInteger top = sq_gettop(mVM);
+
+    bytecode.clear();
+
+    if(SQ_SUCCEEDED(sq_compilebuffer(mVM, source.C(),
+        (SQInteger)source.Size(), sourceName.C(), 1)))
+    {
+        result = SQ_SUCCEEDED(sq_writeclosure(mVM,
+            [](SQUserPointer up, SQUserPointer data, SQInteger size)
+            -> SQInteger
+            {
+                auto pBytecode = reinterpret_cast<std::vector<char>*>(up);
+                auto pData = reinterpret_cast<const char*>(data);
+
+                pBytecode->insert(pBytecode->end(), pData,
+                    pData + size);
+
+                return size;
+            }, &bytecode));
+    }
+
+    sq_settop(mVM, top);
+
+    if(!result)
+    {
+        bytecode.clear();
+    }
+
+    return result;
+}
+
+bool ScriptEngine::EvalBytecode(const std::vector<char>& bytecode)
+{
+    bool result = false;
+
+    SQInteger top = sq_gettop(mVM);
+
+    // Read position followed by the bytecode being read.
+    std::pair<size_t, const std::vector<char>*> reader(0, &bytecode);
+
+    if(SQ_SUCCEEDED(sq_readclosure(mVM,
+        [](SQUserPointer up, SQUserPointer data, SQInteger size)
+        -> SQInteger
+        {
+            auto pReader = reinterpret_cast<std::pair<size_t,
+                const std::vector<char>*>*>(up);
+            size_t left = pReader->second->size() - pReader->first;
+
+            if(size < 0 || (size_t)size > left)
+            {
+                return -1;
+            }
+
+            memcpy(data, pReader->second->data() + pReader->first,
+                (size_t)size);
+            pReader->first += (size_t)size;
+
+            return size;
+        }, &reader)))
+    {
+        sq_pushroottable(mVM);
+
+        if(SQ_SUCCEEDED(sq_call(mVM, ONE_PARAM,
+            NO_RETURN_VALUE, RAISE_ERROR)))
+        {
+            result = true;
+        }
+    }
+
+    sq_settop(mVM, top);
+
+    return result;
+}
+
 HSQUIRRELVM ScriptEngine::GetVM()
 {
     return mVM;
 }
 
+std::recursive_mutex& ScriptEngine::GetLock()
+{
+    return mLock;
+}
+
 bool ScriptEngine::BindingExists(const std::string& name, bool lockBinding)
 {
     bool result = mBindings.find(name) != mBindings.end();
@@ -40,7 +40,9 @@
 #include "PopIgnore.h"
 
 // Standard C++11 Includes
+#include <mutex>
 #include <set>
+#include <vector>
 
 namespace libcomp
 {
@@ -78,6 +80,14 @@ public:
      */
     HSQUIRRELVM GetVM();
 
+    /**
+     * Get the lock that must be held to run code in the VM from more than
+     * one thread. The lock is recursive so a script may call back into
+     * code that runs the same VM.
+     * @return Lock for the VM
+     */
+    std::recursive_mutex& GetLock();
+
     /**
      * Evaluate a Squirrel script block as a string.
      * @param source Squirrel script block as a string
@@ -85,6 +95,25 @@ public:
      */
     bool Eval(const String& source, const String& sourceName = String());
 
+    /**
+     * Compile a Squirrel script block to bytecode without running it. The
+     * bytecode can be run in any other engine with @ref EvalBytecode to
+     * skip parsing the source again.
+     * @param source Squirrel script block as a string
+     * @param bytecode Output buffer for the compiled script
+     * @param sourceName Name of the source to report errors with
+     * @return true on success, false on failure
+     */
+    bool Compile(const String& source, std::vector<char>& bytecode,
+        const String& sourceName = String());
+
+    /**
+     * Evaluate a Squirrel script block compiled with @ref Compile.
+     * @param bytecode Compiled script block
+     * @return true on success, false on failure
+     */
+    bool EvalBytecode(const std::vector<char>& bytecode);
+
 private:
     /**
      * Utility function to complete the binding of an object via @ref ScriptEngine::Using.
@@ -112,6 +141,9 @@ private:
 
     /// Bindings that have already been made to objects via @ref ScriptEngine::Using
     std::set<std::string> mBindings;
+
+    /// Lock for running the VM from more than one thread
+    std::recursive_mutex mLock;
 };
 
 } // namespace libcomp
@@ -522,9 +522,14 @@ namespace libcomp
 bool ServerDataManager::LoadScript(const libcomp::String& path,
     const libcomp::String& source)
 {
+    // Compile the script once and run the same bytecode every engine will
+    // load to read the definition
+    std::vector<char> bytecode;
+
     ScriptEngine engine;
     engine.Using<ServerScript>();
-    if(!engine.Eval(source))
+    if(!engine.Compile(source, bytecode, path) ||
+        !engine.EvalBytecode(bytecode))
     {
         LOG_ERROR(libcomp::String("Improperly formatted script encountered: %1\n")
             .Arg(path));
@@ -549,6 +554,7 @@ bool ServerDataManager::LoadScript(const libcomp::String& path,
 
     script->Path = path;
     script->Source = source;
+    script->Bytecode = std::move(bytecode);
 
     if(script->Type.ToLower() == "ai")
     {
@@ -43,6 +43,7 @@
 // Standard C++11 Includes
 #include <set>
 #include <unordered_map>
+#include <vector>
 
 namespace objects
 {
@@ -68,6 +69,9 @@ struct ServerScript
     String Path;
     String Source;
     String Type;
+
+    /// Source compiled once at load so engines do not parse it again
+    std::vector<char> Bytecode;
 };
 
 /**
@@ -0,0 +1,433 @@
+/**
+ * @file libcomp/src/SpatialGrid.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Uniform grid used to index objects by their 2D position.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_SPATIALGRID_H
+#define LIBCOMP_SRC_SPATIALGRID_H
+
+// Standard C++11 Includes
+#include <cmath>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Uniform grid that buckets values by the cell their position falls in so
+ * radius, rectangle and cone queries only need to look at the cells that
+ * overlap the query area instead of every value. Each value is keyed by a
+ * unique ID and its last known position is stored alongside it in the cell
+ * so the exact distance checks never have to touch the value itself. The
+ * grid is not thread safe; the owner is expected to lock around it.
+ */
+template<typename T>
+class SpatialGrid
+{
+public:
+    /// Default width and height of a cell
+    static constexpr float DEFAULT_CELL_SIZE = 1000.0f;
+
+    /**
+     * Create an empty grid.
+     * @param cellSize Width and height of each cell. Queries are cheapest
+     *  when this is close to the most common query radius.
+     */
+    explicit SpatialGrid(float cellSize = DEFAULT_CELL_SIZE) :
+        mCellSize(cellSize > 0.0f ? cellSize : DEFAULT_CELL_SIZE)
+    {
+    }
+
+    /**
+     * Add a value to the grid or move it if the ID is already indexed.
+     * @param id Unique ID of the value
+     * @param x X coordinate of the value
+     * @param y Y coordinate of the value
+     * @param value Value to store
+     */
+    void Insert(int32_t id, float x, float y, const T& value)
+    {
+        if(Update(id, x, y))
+        {
+            auto loc = mLocations.find(id);
+            mCells[loc->second.Cell][loc->second.Slot].Value = value;
+            return;
+        }
+
+        uint64_t key = GetCellKey(x, y);
+        auto& cell = mCells[key];
+
+        Location& loc = mLocations[id];
+        loc.Cell = key;
+        loc.Slot = cell.size();
+
+        cell.push_back(Item{ id, x, y, value });
+    }
+
+    /**
+     * Update the position of a value already in the grid.
+     * @param id Unique ID of the value
+     * @param x New X coordinate of the value
+     * @param y New Y coordinate of the value
+     * @return true if the ID is indexed, false if it is not
+     */
+    bool Update(int32_t id, float x, float y)
+    {
+        auto locIter = mLocations.find(id);
+        if(locIter == mLocations.end())
+        {
+            return false;
+        }
+
+        Location& loc = locIter->second;
+
+        uint64_t key = GetCellKey(x, y);
+        if(key == loc.Cell)
+        {
+            // Same cell, only the stored position changes
+            Item& item = mCells[key][loc.Slot];
+            item.X = x;
+            item.Y = y;
+            return true;
+        }
+
+        Item item = std::move(mCells[loc.Cell][loc.Slot]);
+        item.X = x;
+        item.Y = y;
+
+        RemoveFromCell(loc);
+
+        auto& cell = mCells[key];
+        loc.Cell = key;
+        loc.Slot = cell.size();
+
+        cell.push_back(std::move(item));
+
+        return true;
+    }
+
+    /**
+     * Remove a value from the grid.
+     * @param id Unique ID of the value
+     * @return true if the ID was indexed, false if it was not
+     */
+    bool Remove(int32_t id)
+    {
+        auto locIter = mLocations.find(id);
+        if(locIter == mLocations.end())
+        {
+            return false;
+        }
+
+        RemoveFromCell(locIter->second);
+        mLocations.erase(locIter);
+
+        return true;
+    }
+
+    /**
+     * Remove every value from the grid.
+     */
+    void Clear()
+    {
+        mCells.clear();
+        mLocations.clear();
+    }
+
+    /**
+     * Get the number of values in the grid.
+     * @return Number of values in the grid
+     */
+    size_t Count() const
+    {
+        return mLocations.size();
+    }
+
+    /**
+     * Get the number of cells that currently hold at least one value.
+     * @return Number of occupied cells
+     */
+    size_t CellCount() const
+    {
+        return mCells.size();
+    }
+
+    /**
+     * Visit every value within a radius of a point.
+     * @param x X coordinate of the center of the circle
+     * @param y Y coordinate of the center of the circle
+     * @param radius Radius of the circle
+     * @param visitor Callable invoked as visitor(value, x, y) for each
+     *  value whose stored position is inside the circle
+     */
+    template<typename Visitor>
+    void QueryRadius(float x, float y, float radius, Visitor visitor) const
+    {
+        float rSquared = radius * radius;
+
+        VisitCells(x - radius, y - radius, x + radius, y + radius,
+            [&](const Item& item)
+            {
+                float dx = item.X - x;
+                float dy = item.Y - y;
+
+                if(rSquared >= (dx * dx) + (dy * dy))
+                {
+                    visitor(item.Value, item.X, item.Y);
+                }
+            });
+    }
+
+    /**
+     * Visit every value inside an axis aligned rectangle.
+     * @param x1 X coordinate of one corner
+     * @param y1 Y coordinate of one corner
+     * @param x2 X coordinate of the opposite corner
+     * @param y2 Y coordinate of the opposite corner
+     * @param visitor Callable invoked as visitor(value, x, y) for each
+     *  value whose stored position is inside the rectangle
+     */
+    template<typename Visitor>
+    void QueryRect(float x1, float y1, float x2, float y2,
+        Visitor visitor) const
+    {
+        float minX = x1 < x2 ? x1 : x2;
+        float maxX = x1 < x2 ? x2 : x1;
+        float minY = y1 < y2 ? y1 : y2;
+        float maxY = y1 < y2 ? y2 : y1;
+
+        VisitCells(minX, minY, maxX, maxY,
+            [&](const Item& item)
+            {
+                if(item.X >= minX && item.X <= maxX &&
+                    item.Y >= minY && item.Y <= maxY)
+                {
+                    visitor(item.Value, item.X, item.Y);
+                }
+            });
+    }
+
+    /**
+     * Visit every value within a radius of a point that is also inside a
+     * field of view. Angles use the same convention as entity rotations:
+     * the angle of a value is atan2(y - valueY, x - valueX).
+     * @param x X coordinate of the FoV origin
+     * @param y Y coordinate of the FoV origin
+     * @param radius Maximum distance from the origin
+     * @param rot Rotation in radians for the center of the FoV
+     * @param maxAngle Maximum angle in radians for either side of the FoV
+     * @param visitor Callable invoked as visitor(value, x, y) for each
+     *  value whose stored position is inside the cone
+     */
+    template<typename Visitor>
+    void QueryCone(float x, float y, float radius, float rot,
+        float maxAngle, Visitor visitor) const
+    {
+        float maxRotL = rot + maxAngle;
+        float maxRotR = rot - maxAngle;
+
+        QueryRadius(x, y, radius, [&](const T& value, float vX, float vY)
+            {
+                float vRot = (float)std::atan2(y - vY, x - vX);
+
+                if(maxRotL >= vRot && maxRotR <= vRot)
+                {
+                    visitor(value, vX, vY);
+                }
+            });
+    }
+
+private:
+    /**
+     * Value stored in a cell with the position it was last indexed at.
+     */
+    struct Item
+    {
+        /// Unique ID of the value
+        int32_t ID;
+
+        /// Last indexed X coordinate
+        float X;
+
+        /// Last indexed Y coordinate
+        float Y;
+
+        /// Stored value
+        T Value;
+    };
+
+    /**
+     * Where an indexed value currently lives.
+     */
+    struct Location
+    {
+        /// Key of the cell holding the value
+        uint64_t Cell;
+
+        /// Index of the value in the cell
+        size_t Slot;
+    };
+
+    /**
+     * Convert a coordinate to the index of the cell along that axis.
+     * @param v Coordinate to convert
+     * @return Cell index along the axis
+     */
+    int32_t GetCellIndex(float v) const
+    {
+        float idx = std::floor(v / mCellSize);
+
+        // Clamp so far away or invalid positions still map to a cell
+        if(!(idx > -1073741824.0f))
+        {
+            return -1073741824;
+        }
+        else if(idx > 1073741824.0f)
+        {
+            return 1073741824;
+        }
+
+        return (int32_t)idx;
+    }
+
+    /**
+     * Pack a pair of cell indexes into a cell key.
+     * @param cx Cell index along the X axis
+     * @param cy Cell index along the Y axis
+     * @return Cell key
+     */
+    static uint64_t MakeCellKey(int32_t cx, int32_t cy)
+    {
+        return ((uint64_t)(uint32_t)cx << 32) | (uint64_t)(uint32_t)cy;
+    }
+
+    /**
+     * Get the key of the cell a position falls in.
+     * @param x X coordinate
+     * @param y Y coordinate
+     * @return Cell key
+     */
+    uint64_t GetCellKey(float x, float y) const
+    {
+        return MakeCellKey(GetCellIndex(x), GetCellIndex(y));
+    }
+
+    /**
+     * Swap-remove a value from the cell it is stored in and fix up the
+     * location of the value that took its slot.
+     * @param loc Location of the value to remove
+     */
+    void RemoveFromCell(const Location& loc)
+    {
+        auto cellIter = mCells.find(loc.Cell);
+        auto& cell = cellIter->second;
+
+        if(loc.Slot + 1 != cell.size())
+        {
+            cell[loc.Slot] = std::move(cell.back());
+            mLocations[cell[loc.Slot].ID].Slot = loc.Slot;
+        }
+
+        cell.pop_back();
+
+        if(cell.empty())
+        {
+            mCells.erase(cellIter);
+        }
+    }
+
+    /**
+     * Call a function for every item in the cells overlapping a bounding
+     * box. If the box covers more cells than are occupied, every occupied
+     * cell is visited instead.
+     * @param minX Minimum X coordinate of the box
+     * @param minY Minimum Y coordinate of the box
+     * @param maxX Maximum X coordinate of the box
+     * @param maxY Maximum Y coordinate of the box
+     * @param func Function to call with each item
+     */
+    template<typename Func>
+    void VisitCells(float minX, float minY, float maxX, float maxY,
+        Func func) const
+    {
+        if(mCells.empty())
+        {
+            return;
+        }
+
+        int32_t minCX = GetCellIndex(minX);
+        int32_t minCY = GetCellIndex(minY);
+        int32_t maxCX = GetCellIndex(maxX);
+        int32_t maxCY = GetCellIndex(maxY);
+
+        uint64_t spanX = (uint64_t)((int64_t)maxCX - (int64_t)minCX + 1);
+        uint64_t spanY = (uint64_t)((int64_t)maxCY - (int64_t)minCY + 1);
+
+        if(spanX * spanY > (uint64_t)mCells.size())
+        {
+            for(auto& cellPair : mCells)
+            {
+                for(auto& item : cellPair.second)
+                {
+                    func(item);
+                }
+            }
+
+            return;
+        }
+
+        for(int32_t cx = minCX; cx <= maxCX; cx++)
+        {
+            for(int32_t cy = minCY; cy <= maxCY; cy++)
+            {
+                auto cellIter = mCells.find(MakeCellKey(cx, cy));
+                if(cellIter != mCells.end())
+                {
+                    for(auto& item : cellIter->second)
+                    {
+                        func(item);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Width and height of each cell
+    float mCellSize;
+
+    /// Occupied cells by cell key
+    std::unordered_map<uint64_t, std::vector<Item>> mCells;
+
+    /// Cell and slot of each indexed value by ID
+    std::unordered_map<int32_t, Location> mLocations;
+};
+
+template<typename T>
+constexpr float SpatialGrid<T>::DEFAULT_CELL_SIZE;
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_SPATIALGRID_H
@@ -0,0 +1,123 @@
+/**
+ * @file libcomp/src/StringFormat.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pre-parsed format string for String::Format.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "StringFormat.h"
+
+// Standard C++11 Includes
+#include <iostream>
+
+using namespace libcomp;
+
+StringFormat::StringFormat(const String& format) : mFormat(format.ToUtf8())
+{
+    size_t literal = 0;
+    size_t i = 0;
+
+    while(std::string::npos != (i = mFormat.find('%', i)))
+    {
+        size_t end = i + 1;
+        size_t argument = 0;
+
+        while(end < mFormat.size() && '0' <= mFormat[end] &&
+            '9' >= mFormat[end])
+        {
+            argument = argument * 10 + (size_t)(mFormat[end] - '0');
+            end++;
+        }
+
+        // A % without a number or with one too large to be an argument
+        // is left as literal text
+        if(0 == argument || (end - i) > 7)
+        {
+            i = end;
+            continue;
+        }
+
+        if(i > literal)
+        {
+            mSegments.push_back({ literal, i - literal, 0 });
+        }
+
+        mSegments.push_back({ i, 0, argument });
+
+        literal = i = end;
+    }
+
+    if(mFormat.size() > literal)
+    {
+        mSegments.push_back({ literal, mFormat.size() - literal, 0 });
+    }
+}
+
+String StringFormat::Apply(const String *pValues, size_t count) const
+{
+    size_t size = mFormat.size();
+
+    for(size_t i = 0; i < count; i++)
+    {
+        size += pValues[i].Size();
+    }
+
+    std::string s;
+    s.reserve(size);
+
+    std::vector<bool> used(count, false);
+
+    for(auto& segment : mSegments)
+    {
+        if(0 == segment.Argument)
+        {
+            s.append(mFormat, segment.Offset, segment.Length);
+        }
+        else if(segment.Argument <= count)
+        {
+            auto& value = pValues[segment.Argument - 1];
+
+            s.append(value.C(), value.Size());
+            used[segment.Argument - 1] = true;
+        }
+        else
+        {
+            // Shift the remaining arguments down as if by String::Arg
+            s.push_back('%');
+            s.append(std::to_string(segment.Argument - count));
+        }
+    }
+
+    if(String::IsReportingBadArguments())
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(!used[i])
+            {
+                std::cerr << "Argument " << (i + 1) << " not found in "
+                    "string: " << s << std::endl;
+            }
+        }
+    }
+
+    return String(s);
+}
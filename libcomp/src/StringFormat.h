@@ -0,0 +1,99 @@
+/**
+ * @file libcomp/src/StringFormat.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pre-parsed format string for String::Format.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_STRINGFORMAT_H
+#define LIBCOMP_SRC_STRINGFORMAT_H
+
+// libcomp Includes
+#include "CString.h"
+
+namespace libcomp
+{
+
+/**
+ * Format string split into literal text and arguments (%1, %2, ...) once
+ * so it can be filled in many times without searching it again. A hot
+ * path can keep one of these in a static and call @ref Format instead of
+ * chaining @ref String::Arg.
+ */
+class StringFormat
+{
+public:
+    /**
+     * Parse a format string.
+     * @param format Format string with the arguments to replace.
+     */
+    explicit StringFormat(const String& format);
+
+    /**
+     * Replace every argument with the values given.
+     * @param args Values to place into the arguments.
+     * @returns Formatted string.
+     * @sa String::Format
+     */
+    template<typename... Args>
+    String Format(Args&&... args) const
+    {
+        const std::array<String, sizeof...(Args)> values = {{
+            String::FormatValue(std::forward<Args>(args))... }};
+
+        return Apply(values.data(), values.size());
+    }
+
+    /**
+     * Replace every argument with a list of values.
+     * @param pValues Values to place into the arguments.
+     * @param count Number of values.
+     * @returns Formatted string.
+     */
+    String Apply(const String *pValues, size_t count) const;
+
+private:
+    /**
+     * Part of the format string.
+     */
+    struct Segment
+    {
+        /// Offset of the literal text in the format string
+        size_t Offset;
+
+        /// Length of the literal text, 0 for an argument
+        size_t Length;
+
+        /// Argument number or 0 for literal text
+        size_t Argument;
+    };
+
+    /// UTF-8 encoded format string
+    std::string mFormat;
+
+    /// Literal text and arguments in order
+    std::vector<Segment> mSegments;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_STRINGFORMAT_H
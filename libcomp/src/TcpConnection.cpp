@@ -30,23 +30,64 @@
 #include "Log.h"
 #include "Object.h"
 
+// Standard C++11 Includes
+#include <atomic>
+#include <cstring>
+#include <vector>
+
 using namespace libcomp;
 
 // I don't care to see these anymore.
 #undef COMP_HACK_DEBUG
 
+/// Size of the receive buffer for new connections (0 for none)
+static std::atomic<uint32_t> gReceiveBufferSize(0);
+
+/// Number of receive requests made on a socket
+static std::atomic<uint64_t> gReceiveCount(0);
+
+/// Number of bytes received
+static std::atomic<uint64_t> gReceiveBytes(0);
+
+/// Number of complete frames parsed
+static std::atomic<uint64_t> gReceiveFrames(0);
+
+/// Bytes of prepared frames each connection may have waiting to be sent
+static std::atomic<uint32_t> gSendBudget(65536);
+
+/// Number of writes made on a socket
+static std::atomic<uint64_t> gSendWrites(0);
+
+/// Number of frames sent
+static std::atomic<uint64_t> gSendFrames(0);
+
+/// Number of bytes sent
+static std::atomic<uint64_t> gSendBytes(0);
+
+/// Number of times packets had to wait for the send budget
+static std::atomic<uint64_t> gSendBudgetWaits(0);
+
 TcpConnection::TcpConnection(asio::io_service& io_service) :
     mSocket(io_service), mDiffieHellman(nullptr), mStatus(
     TcpConnection::STATUS_NOT_CONNECTED), mRole(TcpConnection::ROLE_CLIENT),
-    mRemoteAddress("0.0.0.0"), mSendingPacket(false)
+    mBufferedRequest(0), mBufferedReceiving(false),
+    mBufferedDelivering(false), mRemoteAddress("0.0.0.0"),
+    mSendingPacket(false), mSendQueueBytes(0), mQueuedPackets(0),
+    mPreparedPackets(0), mPreparedFrames(0), mSentFrames(0),
+    mCloseAfterSend(false), mClosePacket(0), mCloseFramePrepared(false),
+    mCloseFrame(0), mPrepareAgain(false)
 {
 }
 
 TcpConnection::TcpConnection(asio::ip::tcp::socket& socket,
     DH *pDiffieHellman) : mSocket(std::move(socket)),
     mDiffieHellman(pDiffieHellman), mStatus(TcpConnection::STATUS_CONNECTED),
-    mRole(TcpConnection::ROLE_SERVER), mRemoteAddress("0.0.0.0"),
-    mSendingPacket(false)
+    mRole(TcpConnection::ROLE_SERVER), mBufferedRequest(0),
+    mBufferedReceiving(false), mBufferedDelivering(false),
+    mRemoteAddress("0.0.0.0"), mSendingPacket(false), mSendQueueBytes(0),
+    mQueuedPackets(0), mPreparedPackets(0), mPreparedFrames(0),
+    mSentFrames(0), mCloseAfterSend(false), mClosePacket(0),
+    mCloseFramePrepared(false), mCloseFrame(0), mPrepareAgain(false)
 {
     // Cache the remote address.
     try
@@ -123,6 +164,7 @@ void TcpConnection::QueuePacket(ReadOnlyPacket& packet)
     std::lock_guard<std::mutex> guard(mOutgoingMutex);
 
     mOutgoingPackets.push_back(std::move(packet));
+    mQueuedPackets++;
 }
 
 void TcpConnection::QueuePacketCopy(libcomp::Packet& packet)
@@ -179,10 +221,38 @@ bool TcpConnection::SendObject(const Object& obj, bool closeConnection)
 
 bool TcpConnection::RequestPacket(size_t size)
 {
+    // Create the receive buffer on the first request (if one is used).
+    uint32_t bufferSize = gReceiveBufferSize;
+
+    if(!mReceiveBuffer && 0 != bufferSize)
+    {
+        try
+        {
+            mReceiveBuffer.reset(new RingBuffer((int32_t)bufferSize));
+        }
+        catch(RingBuffer::Exception& e)
+        {
+            LOG_WARNING(String("Failed to create a receive buffer, reading"
+                " packets directly instead: %1\n").Arg(e.Message()));
+
+            // Don't try again for every other connection.
+            gReceiveBufferSize = 0;
+        }
+    }
+
+    if(mReceiveBuffer)
+    {
+        return RequestBufferedPacket(size);
+    }
+
     bool result = false;
 
-    // Make sure the buffer is there.
-    mReceivedPacket.Allocate();
+    // Make sure the buffer is there and can hold the requested data.
+    if(0 != size && MAX_PACKET_SIZE >= (mReceivedPacket.Size() + size))
+    {
+        mReceivedPacket.Reserve(mReceivedPacket.Size() +
+            static_cast<uint32_t>(size));
+    }
 
 #ifdef COMP_HACK_DEBUG
     if(0 < mReceivedPacket.Size())
@@ -204,6 +274,8 @@ bool TcpConnection::RequestPacket(size_t size)
         // Get a shared pointer to the connection so it outlives the callback.
         auto self = shared_from_this();
 
+        gReceiveCount++;
+
         // Request packet data from the socket.
         mSocket.async_receive(asio::buffer(pDestination, size), 0,
             [self](asio::error_code errorCode, std::size_t length)
@@ -219,6 +291,8 @@ bool TcpConnection::RequestPacket(size_t size)
                 }
                 else
                 {
+                    gReceiveBytes += length;
+
                     // Adjust the size of the packet.
                     (void)self->mReceivedPacket.Direct(
                         self->mReceivedPacket.Size() +
@@ -247,6 +321,153 @@ bool TcpConnection::RequestPacket(size_t size)
     return result;
 }
 
+bool TcpConnection::RequestBufferedPacket(size_t size)
+{
+    // Make sure the packet can hold the requested data.
+    if(0 == size || MAX_PACKET_SIZE < (mReceivedPacket.Size() + size))
+    {
+        return false;
+    }
+
+    mReceivedPacket.Reserve(mReceivedPacket.Size() +
+        static_cast<uint32_t>(size));
+
+    mBufferedRequest = size;
+
+    // If this was requested from inside PacketReceived the loop in
+    // DeliverBufferedPacket will serve it once the callback returns.
+    if(!mBufferedDelivering)
+    {
+        DeliverBufferedPacket();
+    }
+
+    return true;
+}
+
+void TcpConnection::DeliverBufferedPacket()
+{
+    mBufferedDelivering = true;
+
+    // Serve every request the buffered data can. Each request takes what
+    // is available up to the size requested, just like a read of the
+    // socket would, so several frames are parsed for each read.
+    while(0 != mBufferedRequest && 0 < mReceiveBuffer->Available() &&
+        mSocket.is_open())
+    {
+        int32_t size = static_cast<int32_t>(mBufferedRequest);
+        const void *pSource = mReceiveBuffer->BeginRead(size);
+
+        uint32_t packetSize = mReceivedPacket.Size();
+
+        std::memcpy(mReceivedPacket.Data() + packetSize, pSource,
+            static_cast<size_t>(size));
+
+        (void)mReceiveBuffer->EndRead(size);
+
+        mBufferedRequest = 0;
+
+        // Adjust the size of the packet.
+        (void)mReceivedPacket.Direct(packetSize +
+            static_cast<uint32_t>(size));
+        mReceivedPacket.Rewind();
+
+        // It's up to this callback to remove the data from the packet and
+        // request more.
+        PacketReceived(mReceivedPacket);
+    }
+
+    mBufferedDelivering = false;
+
+    // The buffer is empty so read more if a request is still waiting.
+    if(0 != mBufferedRequest && !mBufferedReceiving && mSocket.is_open())
+    {
+        ReceiveBufferedData();
+    }
+}
+
+void TcpConnection::ReceiveBufferedData()
+{
+    int32_t size = mReceiveBuffer->Capacity();
+    void *pDestination = mReceiveBuffer->BeginWrite(size);
+
+    if(nullptr == pDestination)
+    {
+        SocketError("Receive buffer is full.");
+
+        return;
+    }
+
+    // Get a shared pointer to the connection so it outlives the callback.
+    auto self = shared_from_this();
+
+    mBufferedReceiving = true;
+
+    gReceiveCount++;
+
+    // Read whatever is available (up to the free space in the buffer).
+    mSocket.async_receive(asio::buffer(pDestination,
+        static_cast<size_t>(size)), 0,
+        [self](asio::error_code errorCode, std::size_t length)
+        {
+            self->mBufferedReceiving = false;
+
+            if(errorCode)
+            {
+                self->SocketError();
+            }
+            else
+            {
+                gReceiveBytes += length;
+
+                int32_t written = static_cast<int32_t>(length);
+                (void)self->mReceiveBuffer->EndWrite(written);
+
+                self->DeliverBufferedPacket();
+            }
+        });
+}
+
+void TcpConnection::SetReceiveBufferSize(uint32_t size)
+{
+    gReceiveBufferSize = size;
+}
+
+TcpConnection::ReceiveStats TcpConnection::GetReceiveStats()
+{
+    ReceiveStats stats;
+    stats.Receives = gReceiveCount;
+    stats.Bytes = gReceiveBytes;
+    stats.Frames = gReceiveFrames;
+
+    return stats;
+}
+
+void TcpConnection::CountReceivedFrame()
+{
+    gReceiveFrames++;
+}
+
+void TcpConnection::PostCallback(const std::function<void()>& callback)
+{
+    mSocket.get_io_service().post(callback);
+}
+
+void TcpConnection::SetSendBudget(uint32_t size)
+{
+    gSendBudget = size;
+}
+
+TcpConnection::SendStats TcpConnection::GetSendStats()
+{
+    SendStats stats;
+    stats.Writes = gSendWrites;
+    stats.Frames = gSendFrames;
+    stats.Bytes = gSendBytes;
+    stats.BudgetWaits = gSendBudgetWaits;
+
+    return stats;
+}
+
 TcpConnection::Role_t TcpConnection::GetRole() const
 {
     return mRole;
@@ -315,19 +536,105 @@ void TcpConnection::HandleConnection(asio::error_code errorCode)
 
 void TcpConnection::FlushOutgoing(bool closeConnection)
 {
-    std::list<ReadOnlyPacket> packets = GetCombinedPackets();
+    if(closeConnection)
+    {
+        std::lock_guard<std::mutex> guard(mOutgoingMutex);
+
+        // Close right after the packets queued so far are sent. Anything
+        // queued after this is dropped along with the connection.
+        if(!mCloseAfterSend)
+        {
+            mCloseAfterSend = true;
+            mClosePacket = mQueuedPackets;
+
+            UpdateCloseFrame();
+        }
+    }
+
+    {
+        // Prepare one frame at a time so they are sent in the order the
+        // packets were queued. This may happen while a write is active.
+        std::unique_lock<std::mutex> prepareLock(mPrepareMutex);
+
+        PrepareFrames(prepareLock);
+    }
+
+    FlushOutgoingInside();
+}
+
+void TcpConnection::PrepareFrames(std::unique_lock<std::mutex>& prepareLock)
+{
+    ReadOnlyPacket empty;
 
-    if(!packets.empty())
+    while(true)
     {
-        PreparePackets(packets);
+        std::list<ReadOnlyPacket> packets = GetCombinedPackets();
+
+        while(!packets.empty())
+        {
+            uint64_t packetCount = (uint64_t)packets.size();
+
+            mOutgoing = empty;
+
+            PreparePackets(packets);
+
+            {
+                std::lock_guard<std::mutex> guard(mOutgoingMutex);
+
+                if(0 != mOutgoing.Size())
+                {
+                    mOutgoing.Rewind();
+                    mSendQueueBytes += mOutgoing.Size();
+                    mReadyFrames.push_back(mOutgoing);
+                    mPreparedFrames++;
+                }
 
-        mOutgoing.Rewind();
+                mPreparedPackets += packetCount;
 
-        FlushOutgoingInside(closeConnection);
+                UpdateCloseFrame();
+
+                if(mCloseFramePrepared)
+                {
+                    // Nothing after the close request is sent.
+                    packets.clear();
+                    break;
+                }
+            }
+
+            mOutgoing = empty;
+
+            packets = GetCombinedPackets();
+        }
+
+        mOutgoing = empty;
+
+        // A write that finished while this ran may have freed up budget.
+        // The lock is only released with mOutgoingMutex held so a write
+        // completion either sees it free or leaves the request here.
+        std::lock_guard<std::mutex> guard(mOutgoingMutex);
+
+        if(!mPrepareAgain || mCloseFramePrepared)
+        {
+            mPrepareAgain = false;
+            prepareLock.unlock();
+            break;
+        }
+
+        mPrepareAgain = false;
     }
 }
 
-void TcpConnection::FlushOutgoingInside(bool closeConnection)
+void TcpConnection::UpdateCloseFrame()
+{
+    if(mCloseAfterSend && !mCloseFramePrepared &&
+        mPreparedPackets >= mClosePacket)
+    {
+        mCloseFramePrepared = true;
+        mCloseFrame = mPreparedFrames;
+    }
+}
+
+void TcpConnection::FlushOutgoingInside()
 {
     // Don't send anything if we are not connected.
     if(STATUS_NOT_CONNECTED == mStatus)
@@ -335,88 +642,131 @@ void TcpConnection::FlushOutgoingInside(bool closeConnection)
         return;
     }
 
-    // Get a shared pointer to the connection so it outlives the callback.
-    auto self = shared_from_this();
+    std::vector<asio::const_buffer> buffers;
+    bool closeNow = false;
 
-    mSocket.async_send(asio::buffer(mOutgoing.ConstData() +
-        mOutgoing.Tell(), mOutgoing.Left()), 0, [closeConnection,
-        self](asio::error_code errorCode, std::size_t length)
     {
-        bool sendSame = false;
-        bool sendAnother = false;
-        bool packetOk = false;
+        std::lock_guard<std::mutex> guard(mOutgoingMutex);
 
-        ReadOnlyPacket readOnlyPacket;
+        // Only one write may be active on the socket; the frames prepared
+        // in the mean time go out together once it is done.
+        if(mSendingPacket)
+        {
+            return;
+        }
 
-        // Ignore errors and everything else, just close the connection.
-        if(closeConnection && self->mOutgoing.Left() == length)
+        if(mCloseFramePrepared && mSentFrames >= mCloseFrame)
+        {
+            closeNow = true;
+        }
+        else if(!mReadyFrames.empty())
         {
+            // Stop at the frame holding the close request so the
+            // connection closes as soon as it is sent.
+            auto last = mReadyFrames.end();
+            if(mCloseFramePrepared && (mCloseFrame - mSentFrames) <
+                (uint64_t)mReadyFrames.size())
+            {
+                last = mReadyFrames.begin();
+                std::advance(last, (long)(mCloseFrame - mSentFrames));
+            }
+
+            mSendingFrames.splice(mSendingFrames.end(), mReadyFrames,
+                mReadyFrames.begin(), last);
+            mSendingPacket = true;
+
+            buffers.reserve(mSendingFrames.size());
+
+            for(auto& frame : mSendingFrames)
+            {
+                buffers.push_back(asio::buffer(frame.ConstData(),
+                    frame.Size()));
+            }
+        }
+    }
+
+    if(closeNow)
+    {
 #ifdef COMP_HACK_DEBUG
-            LOG_DEBUG("Closing connection after sending packet.\n");
+        LOG_DEBUG("Closing connection after sending packet.\n");
 #endif // COMP_HACK_DEBUG
 
-            std::lock_guard<std::mutex> outgoingGuard(
-                self->mOutgoingMutex);
+        SocketError();
+        return;
+    }
 
-            self->mSendingPacket = false;
+    if(buffers.empty())
+    {
+        return;
+    }
 
-            self->SocketError();
-            return;
-        }
+    gSendWrites++;
 
-        if(errorCode)
-        {
-            std::lock_guard<std::mutex> outgoingGuard(
-                self->mOutgoingMutex);
+    // Get a shared pointer to the connection so it outlives the callback.
+    auto self = shared_from_this();
 
-            self->mSendingPacket = false;
+    // Write every frame with one gathered write. This only completes once
+    // all of the data is sent or there is an error.
+    asio::async_write(mSocket, buffers, [self](asio::error_code errorCode,
+        std::size_t length)
+    {
+        std::list<ReadOnlyPacket> sent;
 
-            self->SocketError();
-        }
-        else
         {
             std::lock_guard<std::mutex> outgoingGuard(self->mOutgoingMutex);
 
-            uint32_t outgoingSize = self->mOutgoing.Size();
+            sent.swap(self->mSendingFrames);
 
-            if(0 == outgoingSize || length > self->mOutgoing.Left())
+            for(auto& frame : sent)
             {
-                self->SocketError();
+                self->mSendQueueBytes -= frame.Size();
             }
-            else
-            {
-                self->mOutgoing.Skip((uint32_t)length);
 
-                if(0 != self->mOutgoing.Left())
-                {
-                    sendSame = true;
-                }
-                else
-                {
-                    self->mOutgoing.Rewind();
+            self->mSentFrames += (uint64_t)sent.size();
 
-                    readOnlyPacket = self->mOutgoing;
-                    sendAnother = !self->mOutgoingPackets.empty();
-                    packetOk = true;
-                }
-            }
+            self->mSendingPacket = false;
+        }
 
-            self->mSendingPacket = sendSame;
+        if(errorCode)
+        {
+            self->SocketError();
+            return;
         }
 
-        if(sendSame)
+        gSendFrames += sent.size();
+        gSendBytes += length;
+
+        for(auto& frame : sent)
         {
-            self->FlushOutgoingInside(closeConnection);
+            self->PacketSent(frame);
         }
-        else if(packetOk)
+
+        // Prepare anything that was waiting on the budget unless another
+        // thread is already preparing frames. Waiting for it here would
+        // stall every connection on this thread, so it is asked to check
+        // the budget again before it is done instead.
+        std::unique_lock<std::mutex> prepareLock;
+
         {
-            self->PacketSent(readOnlyPacket);
+            std::lock_guard<std::mutex> outgoingGuard(self->mOutgoingMutex);
+
+            prepareLock = std::unique_lock<std::mutex>(self->mPrepareMutex,
+                std::try_to_lock);
 
-            if(sendAnother)
+            if(!prepareLock.owns_lock())
             {
-                self->FlushOutgoing();
+                self->mPrepareAgain = true;
             }
         }
+
+        if(prepareLock.owns_lock())
+        {
+            self->PrepareFrames(prepareLock);
+        }
+
+        // Send the frames that were prepared during the write. This closes
+        // the connection instead if the close request was just sent.
+        self->FlushOutgoingInside();
     });
 }
 
@@ -571,9 +921,24 @@ void TcpConnection::PreparePackets(std::list<ReadOnlyPacket>& packets)
         LOG_CRITICAL("Critical packet error.\n");
     }
 
-    ReadOnlyPacket finalPacket(packets.front());
+    ReadOnlyPacket& packet = packets.front();
+
+    if(!packet.GetPatches().empty())
+    {
+        // The shared data can't be sent as is; send a patched copy.
+        Packet copy(packet.ConstData(), packet.Size());
+        packet.ApplyPatches(copy.Data());
+
+        ReadOnlyPacket finalPacket(std::move(copy));
 
-    mOutgoing = finalPacket;
+        mOutgoing = finalPacket;
+    }
+    else
+    {
+        ReadOnlyPacket finalPacket(packet);
+
+        mOutgoing = finalPacket;
+    }
 }
 
 std::list<ReadOnlyPacket> TcpConnection::GetCombinedPackets()
@@ -582,17 +947,31 @@ std::list<ReadOnlyPacket> TcpConnection::GetCombinedPackets()
 
     std::lock_guard<std::mutex> guard(mOutgoingMutex);
 
-    if(!mSendingPacket && !mOutgoingPackets.empty())
+    if(!mOutgoingPackets.empty() && SendBudgetAvailable())
     {
         packets.push_back(mOutgoingPackets.front());
         mOutgoingPackets.pop_front();
-
-        mSendingPacket = true;
     }
 
     return packets;
 }
 
+bool TcpConnection::SendBudgetAvailable()
+{
+    // Always allow one frame so a budget smaller than a frame still works.
+    if(0 == mSendQueueBytes || mSendQueueBytes < gSendBudget)
+    {
+        return true;
+    }
+
+    if(!mOutgoingPackets.empty())
+    {
+        gSendBudgetWaits++;
+    }
+
+    return false;
+}
+
 String TcpConnection::GetName() const
 {
     return mName;
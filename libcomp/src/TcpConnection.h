@@ -30,6 +30,7 @@
 // libcomp Includes
 #include "CString.h"
 #include "Packet.h"
+#include "RingBuffer.h"
 
 // Boost ASIO Includes
 #include "PushIgnore.h"
@@ -41,6 +42,8 @@
 #include <openssl/blowfish.h>
 
 // Standard C++11 Includes
+#include <functional>
+#include <memory>
 #include <mutex>
 
 namespace libcomp
@@ -56,6 +59,39 @@ class Object;
 class TcpConnection : public std::enable_shared_from_this<TcpConnection>
 {
 public:
+    /**
+     * Counters for data received by every connection in the process.
+     */
+    struct ReceiveStats
+    {
+        /// Number of receive requests made on a socket
+        uint64_t Receives;
+
+        /// Number of bytes received
+        uint64_t Bytes;
+
+        /// Number of complete frames parsed by derived classes
+        uint64_t Frames;
+    };
+
+    /**
+     * Counters for data sent by every connection in the process.
+     */
+    struct SendStats
+    {
+        /// Number of writes made on a socket
+        uint64_t Writes;
+
+        /// Number of frames sent
+        uint64_t Frames;
+
+        /// Number of bytes sent
+        uint64_t Bytes;
+
+        /// Number of times packets had to wait for the send budget
+        uint64_t BudgetWaits;
+    };
+
     /**
      * Role the server is operating in.
      */
@@ -214,11 +250,45 @@ public:
     /**
      * Start a receive request for more packet data. The @ref PacketReceived
      *   function will be called but it may return less bytes than requested.
+     *   If a receive buffer is used the data may already be buffered and
+     *   @ref PacketReceived is called without another read of the socket.
      * @param size Number of bytes requested.
      * @return true on success; false otherwise.
      */
     bool RequestPacket(size_t size);
 
+    /**
+     * Set the size of the receive buffer used by connections that start
+     *   receiving after this call. With a buffer each read of the socket
+     *   takes as much data as is available and requests are served from the
+     *   buffer until it is empty. A size of 0 reads only the requested
+     *   number of bytes straight into the packet.
+     * @param size Minimum size of the buffer in bytes or 0 to disable it.
+     */
+    static void SetReceiveBufferSize(uint32_t size);
+
+    /**
+     * Get the receive counters of every connection.
+     * @return Receive counters since the process started.
+     */
+    static ReceiveStats GetReceiveStats();
+
+    /**
+     * Set how many bytes of prepared frames each connection may have
+     *   waiting to be sent or being sent. Frames are prepared (and
+     *   encrypted) while a write is active and every frame that is ready
+     *   goes out in the next write. Packets stay queued once the budget is
+     *   used up. At least one frame is always allowed.
+     * @param size Budget in bytes for each connection.
+     */
+    static void SetSendBudget(uint32_t size);
+
+    /**
+     * Get the send counters of every connection.
+     * @return Send counters since the process started.
+     */
+    static SendStats GetSendStats();
+
     /**
      * Get the role the connection is operating in.
      * @return Role the connection is operating in.
@@ -326,13 +396,51 @@ protected:
      */
     void SetEncryptionKey(const void *pData, size_t dataSize);
 
+    /**
+     * Count a complete frame parsed out of the received data.
+     */
+    static void CountReceivedFrame();
+
+    /**
+     * Check if another frame may be prepared without going over the send
+     *   budget. This must be called with mOutgoingMutex locked.
+     * @return true if another frame may be prepared.
+     */
+    bool SendBudgetAvailable();
+
+    /**
+     * Run a callback on the network thread that handles this connection.
+     * Use this to hand back work that was done on another thread.
+     * @param callback Callback to run.
+     */
+    void PostCallback(const std::function<void()>& callback);
+
 private:
     /**
-     * Send all queued packets to the remote host.
-     * @param closeConnection If the connection should be closed after the
-     *   send queue has been emptied.
+     * Serve a receive request from the receive buffer.
+     * @param size Number of bytes requested.
+     * @return true on success; false otherwise.
+     */
+    bool RequestBufferedPacket(size_t size);
+
+    /**
+     * Pass buffered data to @ref PacketReceived for as long as there is a
+     *   request and data to serve it, then read the socket if a request
+     *   is still waiting.
+     */
+    void DeliverBufferedPacket();
+
+    /**
+     * Read as much as is available from the socket into the receive
+     *   buffer.
      */
-    void FlushOutgoingInside(bool closeConnection = false);
+    void ReceiveBufferedData();
+
+    /**
+     * Write every prepared frame to the remote host if a write is not
+     *   already active.
+     */
+    void FlushOutgoingInside();
 
     /**
      * Used to handle a connection error code.
@@ -365,6 +473,18 @@ private:
     /// Last received packet.
     Packet mReceivedPacket;
 
+    /// Data read from the socket that has not been requested yet.
+    std::unique_ptr<RingBuffer> mReceiveBuffer;
+
+    /// Size of the request waiting on the receive buffer.
+    size_t mBufferedRequest;
+
+    /// Indicates if a read of the socket into the receive buffer is active.
+    bool mBufferedReceiving;
+
+    /// Indicates if buffered data is being passed to @ref PacketReceived.
+    bool mBufferedDelivering;
+
     /// Cached address of the remote host.
     String mRemoteAddress;
 
@@ -378,11 +498,67 @@ protected:
     /// List of packets to be sent to the remote host.
     std::list<ReadOnlyPacket> mOutgoingPackets;
 
-    /// Indicates if an outgoing packet is being sent.
+    /// Indicates if a write to the socket is active.
     bool mSendingPacket;
 
-    /// Packet being sent to the remote host.
+    /// Frame set by @ref PreparePackets to be sent to the remote host.
     ReadOnlyPacket mOutgoing;
+
+private:
+    /**
+     * Record which frame holds the close request once every packet queued
+     * before it has been prepared. mOutgoingMutex must be locked.
+     */
+    void UpdateCloseFrame();
+
+    /**
+     * Prepare frames from the queued packets until the queue is empty or
+     * the send budget is used up.
+     * @param prepareLock Lock on mPrepareMutex. It is released when done.
+     */
+    void PrepareFrames(std::unique_lock<std::mutex>& prepareLock);
+
+    /// Mutex to ensure frames are prepared one at a time and in order.
+    std::mutex mPrepareMutex;
+
+    /// Frames prepared but not yet being sent.
+    std::list<ReadOnlyPacket> mReadyFrames;
+
+    /// Frames being sent by the active write.
+    std::list<ReadOnlyPacket> mSendingFrames;
+
+    /// Bytes in mReadyFrames and mSendingFrames.
+    uint32_t mSendQueueBytes;
+
+    /// Number of packets ever added to mOutgoingPackets.
+    uint64_t mQueuedPackets;
+
+    /// Number of packets ever prepared into frames.
+    uint64_t mPreparedPackets;
+
+    /// Number of frames ever added to mReadyFrames.
+    uint64_t mPreparedFrames;
+
+    /// Number of frames ever written to the socket.
+    uint64_t mSentFrames;
+
+    /// Indicates if the connection should close after mClosePacket.
+    bool mCloseAfterSend;
+
+    /// Number of packets queued when the close was requested. The
+    /// connection closes once the frame holding the last of them is sent.
+    uint64_t mClosePacket;
+
+    /// Indicates if the frame holding the close request is prepared.
+    bool mCloseFramePrepared;
+
+    /// Number of frames up to and including the one holding the close
+    /// request.
+    uint64_t mCloseFrame;
+
+    /// Indicates if a write finished while frames were being prepared so
+    /// the thread preparing them should check the send budget again.
+    bool mPrepareAgain;
 };
 
 } // namespace libcomp
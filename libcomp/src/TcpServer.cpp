@@ -27,27 +27,101 @@
 #include "TcpServer.h"
 
 #include "Constants.h"
+#include "HandshakePool.h"
 #include "Log.h"
 #include "TcpConnection.h"
 #include "WindowsService.h"
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
+
 #ifdef HAVE_SYSTEMD
 #include <systemd/sd-daemon.h>
 #endif // HAVE_SYSTEMD
 
 using namespace libcomp;
 
+/// Time between each reactor latency sample
+static const std::chrono::milliseconds REACTOR_PROBE_INTERVAL(100);
+
+/**
+ * ASIO service with its own thread that connections can be bound to.
+ */
+struct TcpServer::Reactor
+{
+    /**
+     * Create a reactor.
+     * @param pService Service to run or nullptr to create one.
+     */
+    explicit Reactor(asio::io_service *pService) :
+        OwnedService(nullptr == pService ? new asio::io_service : nullptr),
+        Service(nullptr == pService ? *OwnedService : *pService),
+        Work(Service), Probe(Service), Connections(0), Accepted(0),
+        Samples(0), LatencyTotal(0), LatencyLast(0), LatencyMax(0)
+    {
+    }
+
+    /// Service created for this reactor if it was not given one
+    std::unique_ptr<asio::io_service> OwnedService;
+
+    /// Service the reactor runs
+    asio::io_service& Service;
+
+    /// Keeps the service running while it has nothing to do
+    asio::io_service::work Work;
+
+    /// Timer used to sample the latency of the service
+    asio::steady_timer Probe;
+
+    /// Thread running the service
+    std::thread Thread;
+
+    /// Number of connections bound to the reactor (connection lock)
+    uint32_t Connections;
+
+    /// Number of connections ever bound to the reactor (connection lock)
+    uint64_t Accepted;
+
+    /// Lock for the latency samples
+    std::mutex LatencyLock;
+
+    /// Number of latency samples taken
+    uint64_t Samples;
+
+    /// Sum of every latency sample
+    uint64_t LatencyTotal;
+
+    /// Most recent latency sample
+    uint64_t LatencyLast;
+
+    /// Highest latency sample
+    uint64_t LatencyMax;
+};
+
 TcpServer::TcpServer(const String& listenAddress, uint16_t port) :
-    mAcceptor(mService), mDiffieHellman(nullptr),
+    mAcceptor(mService), mAcceptReactor(0), mLastReactor(0),
+    mLeastLoaded(true), mHandshakeThreads(0), mHandshakeKeyPairs(0),
+    mDiffieHellman(nullptr),
     mListenAddress(listenAddress), mPort(port)
 {
 #if !defined(_WIN32)
     pthread_setname_np(pthread_self(), "server");
 #endif // !defined(_WIN32)
+
+    mReactors.push_back(std::unique_ptr<Reactor>(new Reactor(&mService)));
 }
 
 TcpServer::~TcpServer()
 {
+    // Drop the server's references before the reactor services go away.
+    mAcceptSocket.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(mConnectionsLock);
+        mConnections.clear();
+    }
+
     if(nullptr != mDiffieHellman)
     {
         DH_free(mDiffieHellman);
@@ -97,28 +171,52 @@ int TcpServer::Start()
     mAcceptor.bind(endpoint);
     mAcceptor.listen();
 
-    asio::ip::tcp::socket socket(mService);
+    {
+        std::lock_guard<std::mutex> lock(mConnectionsLock);
 
-    mAcceptor.async_accept(socket,
-        [this, &socket](asio::error_code errorCode)
-        {
-            AcceptHandler(errorCode, socket);
-        });
+        AsyncAccept();
+    }
+
+    if(0 != mHandshakeThreads && nullptr != mDiffieHellman)
+    {
+        HandshakePool::GetSingletonPtr()->Start(mHandshakeThreads,
+            mHandshakeKeyPairs, mDiffieHellman);
+    }
 
-    mServiceThread = std::thread([this]()
+    for(size_t i = 0; i < mReactors.size(); i++)
     {
+        Reactor *pReactor = mReactors[i].get();
+
+        ScheduleLatencyProbe(pReactor);
+
+        String name = 0 == i ? String("asio") : String("asio%1").Arg(
+            (uint32_t)i);
+
+        pReactor->Thread = std::thread([pReactor](std::string threadName)
+        {
 #if !defined(_WIN32)
-        pthread_setname_np(pthread_self(), "asio");
+            pthread_setname_np(pthread_self(), threadName.c_str());
+#else
+            (void)threadName;
 #endif // !defined(_WIN32)
 
-        mService.run();
-    });
+            pReactor->Service.run();
+        }, name.ToUtf8());
+    }
+
+    LOG_DEBUG(String("Running %1 network reactor(s).\n").Arg(
+        (uint32_t)mReactors.size()));
 
     ServerReady();
 
     int returnCode = Run();
 
-    mServiceThread.join();
+    for(auto& reactor : mReactors)
+    {
+        reactor->Thread.join();
+    }
+
+    HandshakePool::GetSingletonPtr()->Stop();
 
     return returnCode;
 }
@@ -133,6 +231,139 @@ void TcpServer::RemoveConnection(std::shared_ptr<TcpConnection>& connection)
     {
         mConnections.remove(connection);
     }
+
+    auto reactorIter = mConnectionReactors.find(connection.get());
+    if(reactorIter != mConnectionReactors.end())
+    {
+        mReactors[reactorIter->second]->Connections--;
+        mConnectionReactors.erase(reactorIter);
+    }
+}
+
+void TcpServer::SetReactorCount(uint32_t count, bool leastLoaded)
+{
+    mLeastLoaded = leastLoaded;
+
+    while(mReactors.size() < (size_t)count)
+    {
+        mReactors.push_back(std::unique_ptr<Reactor>(new Reactor(nullptr)));
+    }
+}
+
+void TcpServer::SetHandshakeThreads(uint32_t threadCount,
+    uint32_t keyPairCount)
+{
+    mHandshakeThreads = threadCount;
+    mHandshakeKeyPairs = keyPairCount;
+}
+
+std::vector<TcpServer::ReactorStats> TcpServer::GetReactorStats()
+{
+    std::vector<ReactorStats> result;
+
+    std::lock_guard<std::mutex> lock(mConnectionsLock);
+
+    for(auto& reactor : mReactors)
+    {
+        ReactorStats stats;
+        stats.Connections = reactor->Connections;
+        stats.Accepted = reactor->Accepted;
+
+        {
+            std::lock_guard<std::mutex> latencyLock(reactor->LatencyLock);
+
+            stats.Samples = reactor->Samples;
+            stats.LatencyLast = reactor->LatencyLast;
+            stats.LatencyAvg = reactor->Samples
+                ? reactor->LatencyTotal / reactor->Samples : 0;
+            stats.LatencyMax = reactor->LatencyMax;
+        }
+
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+void TcpServer::StopReactors()
+{
+    for(auto& reactor : mReactors)
+    {
+        reactor->Service.stop();
+    }
+}
+
+size_t TcpServer::GetNextReactor()
+{
+    size_t count = mReactors.size();
+    size_t next = (mLastReactor + 1) % count;
+
+    if(mLeastLoaded)
+    {
+        // Start after the last reactor used so ties are spread evenly.
+        for(size_t i = 1; i < count; i++)
+        {
+            size_t idx = (mLastReactor + 1 + i) % count;
+
+            if(mReactors[idx]->Connections < mReactors[next]->Connections)
+            {
+                next = idx;
+            }
+        }
+    }
+
+    mLastReactor = next;
+
+    return next;
+}
+
+void TcpServer::AsyncAccept()
+{
+    mAcceptReactor = GetNextReactor();
+    mAcceptSocket.reset(new asio::ip::tcp::socket(
+        mReactors[mAcceptReactor]->Service));
+
+    // The acceptor runs on mService but the socket (and every handler of
+    // the connection made from it) runs on the reactor it was created with.
+    asio::ip::tcp::socket& socket = *mAcceptSocket;
+
+    mAcceptor.async_accept(socket,
+        [this, &socket](asio::error_code errorCode)
+        {
+            AcceptHandler(errorCode, socket);
+        });
+}
+
+void TcpServer::ScheduleLatencyProbe(Reactor *pReactor)
+{
+    pReactor->Probe.expires_from_now(REACTOR_PROBE_INTERVAL);
+    pReactor->Probe.async_wait([this, pReactor](asio::error_code errorCode)
+    {
+        if(errorCode)
+        {
+            return;
+        }
+
+        auto late = std::chrono::steady_clock::now() -
+            pReactor->Probe.expires_at();
+        auto latency = std::chrono::duration_cast<
+            std::chrono::microseconds>(late).count();
+
+        {
+            std::lock_guard<std::mutex> lock(pReactor->LatencyLock);
+
+            pReactor->LatencyLast = latency > 0 ? (uint64_t)latency : 0;
+            pReactor->LatencyTotal += pReactor->LatencyLast;
+            pReactor->Samples++;
+
+            if(pReactor->LatencyLast > pReactor->LatencyMax)
+            {
+                pReactor->LatencyMax = pReactor->LatencyLast;
+            }
+        }
+
+        ScheduleLatencyProbe(pReactor);
+    });
 }
 
 int TcpServer::Run()
@@ -187,17 +418,15 @@ void TcpServer::AcceptHandler(asio::error_code errorCode,
                 std::lock_guard<std::mutex> lock(mConnectionsLock);
 
                 mConnections.push_back(connection);
-            }
 
-            // This is actually using a different socket because the
-            // CreateConnection() call will use std::move on the socket which
-            // will reset this socket (which is a reference to the local
-            // variable in the Start() function).
-            mAcceptor.async_accept(socket,
-                [this, &socket](asio::error_code acceptErrorCode)
-                {
-                    AcceptHandler(acceptErrorCode, socket);
-                });
+                // CreateConnection() moved the socket into the connection
+                // so it stays on the reactor the socket was created with.
+                mConnectionReactors[connection.get()] = mAcceptReactor;
+                mReactors[mAcceptReactor]->Connections++;
+                mReactors[mAcceptReactor]->Accepted++;
+
+                AsyncAccept();
+            }
         }
         else
         {
@@ -39,6 +39,8 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 // OpenSSL Includes
 #include <openssl/dh.h>
@@ -54,10 +56,39 @@ class TcpConnection;
  * or "any" it will listen for connections on all network devices. The
  * @ref CreateConnection function should be overridden if a subclass of
  * @ref TcpConnection is required or additional setup should be performed.
+ * Network operations run on one or more reactors, each an ASIO service with
+ * its own thread. New connections are bound to a single reactor for their
+ * lifetime so the handlers for one socket never run concurrently.
  */
 class TcpServer
 {
 public:
+    /**
+     * Counters and timings for one reactor. Latency is how late the
+     * reactor ran a timer it was waiting on which is the time a ready
+     * handler may wait for the reactor thread. Times are in microseconds.
+     */
+    struct ReactorStats
+    {
+        /// Number of connections currently bound to the reactor
+        uint32_t Connections;
+
+        /// Number of connections ever bound to the reactor
+        uint64_t Accepted;
+
+        /// Number of latency samples taken
+        uint64_t Samples;
+
+        /// Latency of the most recent sample
+        uint64_t LatencyLast;
+
+        /// Average latency over every sample
+        uint64_t LatencyAvg;
+
+        /// Highest latency sampled
+        uint64_t LatencyMax;
+    };
+
     /**
      * Create a TCP server to listen on a specific address and port.
      * @param listenAddress Listen on the specified IP address. If blank or
@@ -88,6 +119,31 @@ public:
      */
     void RemoveConnection(std::shared_ptr<TcpConnection>& connection);
 
+    /**
+     * Set how many reactors handle network operations. This must be called
+     * before @ref Start and defaults to a single reactor.
+     * @param count Number of reactors (and threads) to run, at least 1.
+     * @param leastLoaded If true new connections are bound to the reactor
+     *  with the fewest connections, otherwise they are assigned in turn.
+     */
+    void SetReactorCount(uint32_t count, bool leastLoaded);
+
+    /**
+     * Get the counters and timings of each reactor.
+     * @return Stats of each reactor in the order they were created.
+     */
+    std::vector<ReactorStats> GetReactorStats();
+
+    /**
+     * Set how many threads run the Diffie-Hellman math of new connections
+     * on the @ref HandshakePool. This must be called before @ref Start and
+     * defaults to 0 which does the math on the reactor threads.
+     * @param threadCount Number of handshake threads to run.
+     * @param keyPairCount Number of server key pairs to generate ahead of
+     *  time.
+     */
+    void SetHandshakeThreads(uint32_t threadCount, uint32_t keyPairCount);
+
     /**
      * Generate a Diffie-Hellman key pair.
      * @return Generated key pair or nullptr on failure.
@@ -143,6 +199,12 @@ protected:
      */
     virtual void ServerReady();
 
+    /**
+     * Stop every reactor. This will kill any existing connections and
+     * allow @ref Start to return once @ref Run is done.
+     */
+    void StopReactors();
+
     /**
      * Create a connection to a newly active socket.
      * @param socket A new socket connection.
@@ -178,15 +240,57 @@ protected:
     /// List of connections managed by this server.
     std::list<std::shared_ptr<TcpConnection>> mConnections;
 
-    /// ASIO service used to handle network operations.
+    /// ASIO service used to accept connections and by the first reactor.
     asio::io_service mService;
 
 private:
+    struct Reactor;
+
+    /**
+     * Pick the reactor the next accepted connection will be bound to. The
+     * connection lock must be held when calling this.
+     * @return Index of the reactor to use.
+     */
+    size_t GetNextReactor();
+
+    /**
+     * Start a new asynchronous accept with a socket bound to the next
+     * reactor.
+     */
+    void AsyncAccept();
+
+    /**
+     * Wait on the latency timer of a reactor and record how late it ran.
+     * @param pReactor Reactor to sample.
+     */
+    void ScheduleLatencyProbe(Reactor *pReactor);
+
     /// Asynchronous acceptor for new connections.
     asio::ip::tcp::acceptor mAcceptor;
 
-    /// Thread that runs the ASIO service.
-    std::thread mServiceThread;
+    /// Reactors running the network operations, the first uses mService.
+    std::vector<std::unique_ptr<Reactor>> mReactors;
+
+    /// Reactor each connection is bound to.
+    std::unordered_map<TcpConnection*, size_t> mConnectionReactors;
+
+    /// Socket the pending accept will bind a new connection to.
+    std::unique_ptr<asio::ip::tcp::socket> mAcceptSocket;
+
+    /// Reactor mAcceptSocket belongs to.
+    size_t mAcceptReactor;
+
+    /// Reactor the last connection was bound to.
+    size_t mLastReactor;
+
+    /// Bind connections to the reactor with the fewest connections.
+    bool mLeastLoaded;
+
+    /// Number of threads to run on the handshake pool.
+    uint32_t mHandshakeThreads;
+
+    /// Number of key pairs the handshake pool keeps ready.
+    uint32_t mHandshakeKeyPairs;
 
     /// Diffie-Hellman key pair used to encrypt connections.
     DH *mDiffieHellman;
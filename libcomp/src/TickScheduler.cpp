@@ -0,0 +1,199 @@
+/**
+ * @file libcomp/src/TickScheduler.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Fixed timestep scheduler for a server tick.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TickScheduler.h"
+
+using namespace libcomp;
+
+TickScheduler::TickScheduler(Clock::duration period) : mPeriod(period),
+    mTickQueued(false), mStats(), mJitterTotal(0), mDurations()
+{
+    if(mPeriod <= Clock::duration::zero())
+    {
+        mPeriod = std::chrono::milliseconds(1);
+    }
+}
+
+TickScheduler::Clock::duration TickScheduler::GetPeriod() const
+{
+    return mPeriod;
+}
+
+TickScheduler::Clock::time_point TickScheduler::Start(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    mNextDeadline = now + mPeriod;
+    mDeadline = now;
+
+    return mNextDeadline;
+}
+
+TickScheduler::Clock::time_point TickScheduler::GetNextDeadline()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    return mNextDeadline;
+}
+
+bool TickScheduler::Advance(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    if(now < mNextDeadline)
+    {
+        // Woke up early
+        return false;
+    }
+
+    // Stay on the original grid of deadlines, skipping any that were
+    // missed entirely
+    auto missed = (uint64_t)((now - mNextDeadline) / mPeriod);
+    mStats.Skipped += missed;
+
+    auto deadline = mNextDeadline + mPeriod * (Clock::rep)missed;
+    mNextDeadline = deadline + mPeriod;
+
+    if(mTickQueued)
+    {
+        // The last tick is still waiting to run so it covers this one
+        mStats.Coalesced++;
+        return false;
+    }
+
+    mDeadline = deadline;
+    mTickQueued = true;
+
+    return true;
+}
+
+void TickScheduler::TickStarted(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    mTickQueued = false;
+    mTickStart = now;
+
+    uint64_t jitter = now > mDeadline ? (uint64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(now - mDeadline).count() : 0;
+
+    mJitterTotal += jitter;
+
+    if(jitter > mStats.JitterMax)
+    {
+        mStats.JitterMax = jitter;
+    }
+}
+
+void TickScheduler::TickFinished(Clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    auto elapsed = now - mTickStart;
+    uint64_t duration = (uint64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(elapsed).count();
+
+    mStats.Ticks++;
+    mDurations[GetBucket(duration)]++;
+
+    if(duration > mStats.DurationMax)
+    {
+        mStats.DurationMax = duration;
+    }
+
+    if(elapsed > mPeriod)
+    {
+        mStats.Overruns++;
+    }
+}
+
+TickScheduler::Stats TickScheduler::GetStats()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    Stats stats = mStats;
+
+    if(stats.Ticks > 0)
+    {
+        stats.JitterAvg = mJitterTotal / stats.Ticks;
+        stats.DurationP50 = GetPercentile(50);
+        stats.DurationP99 = GetPercentile(99);
+    }
+
+    return stats;
+}
+
+uint32_t TickScheduler::GetBucket(uint64_t value)
+{
+    if(value < 16)
+    {
+        return (uint32_t)value;
+    }
+
+    uint32_t exponent = 63;
+    while(0 == (value & (1ULL << exponent)))
+    {
+        exponent--;
+    }
+
+    uint32_t sub = (uint32_t)(value >> (exponent - 3)) & (SUB_BUCKETS - 1);
+    uint32_t bucket = 16 + (exponent - 4) * SUB_BUCKETS + sub;
+
+    return bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1;
+}
+
+uint64_t TickScheduler::GetBucketLimit(uint32_t bucket)
+{
+    if(bucket < 16)
+    {
+        return bucket;
+    }
+
+    uint32_t exponent = 4 + (bucket - 16) / SUB_BUCKETS;
+    uint64_t sub = (bucket - 16) % SUB_BUCKETS;
+
+    return ((SUB_BUCKETS + sub + 1) << (exponent - 3)) - 1;
+}
+
+uint64_t TickScheduler::GetPercentile(uint64_t percent) const
+{
+    // Smallest bucket that covers the percentile of all ticks
+    uint64_t target = (mStats.Ticks * percent + 99) / 100;
+    uint64_t count = 0;
+
+    for(uint32_t i = 0; i < BUCKET_COUNT; i++)
+    {
+        count += mDurations[i];
+        if(count >= target)
+        {
+            // The bucket limit may be larger than anything recorded
+            uint64_t limit = GetBucketLimit(i);
+            return limit < mStats.DurationMax ? limit : mStats.DurationMax;
+        }
+    }
+
+    return mStats.DurationMax;
+}
@@ -0,0 +1,201 @@
+/**
+ * @file libcomp/src/TickScheduler.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Fixed timestep scheduler for a server tick.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_TICKSCHEDULER_H
+#define LIBCOMP_SRC_TICKSCHEDULER_H
+
+// Standard C++11 Includes
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <stdint.h>
+
+namespace libcomp
+{
+
+/**
+ * Schedules a tick on absolute deadlines spaced one period apart so the
+ * tick rate does not drift by the time spent processing each tick. The
+ * thread generating ticks sleeps until @ref GetNextDeadline and calls
+ * @ref Advance when it wakes. If the previous tick has not started yet
+ * the new one is coalesced into it and if whole periods were missed
+ * (e.g. the process was suspended) they are skipped instead of being
+ * run back to back. The thread processing the tick reports when it
+ * starts and finishes so the scheduler can track how late each tick
+ * started (jitter) and how long it took. All functions are thread safe.
+ */
+class TickScheduler
+{
+public:
+    /// Clock used for every deadline
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     * Counters and timings collected by the scheduler. Times are in
+     * microseconds.
+     */
+    struct Stats
+    {
+        /// Number of ticks that have been processed
+        uint64_t Ticks;
+
+        /// Number of deadlines skipped because a whole period was missed
+        uint64_t Skipped;
+
+        /// Number of deadlines merged into a tick that had not started
+        uint64_t Coalesced;
+
+        /// Number of ticks that took longer than the period
+        uint64_t Overruns;
+
+        /// Average delay between a deadline and its tick starting
+        uint64_t JitterAvg;
+
+        /// Longest delay between a deadline and its tick starting
+        uint64_t JitterMax;
+
+        /// Median tick duration
+        uint64_t DurationP50;
+
+        /// 99th percentile tick duration
+        uint64_t DurationP99;
+
+        /// Longest tick duration
+        uint64_t DurationMax;
+    };
+
+    /**
+     * Create the scheduler.
+     * @param period Time between the start of each tick
+     */
+    explicit TickScheduler(Clock::duration period);
+
+    /**
+     * Get the time between the start of each tick.
+     * @return Time between the start of each tick
+     */
+    Clock::duration GetPeriod() const;
+
+    /**
+     * Set the first deadline one period from now.
+     * @param now Current time
+     * @return First deadline
+     */
+    Clock::time_point Start(Clock::time_point now);
+
+    /**
+     * Get the deadline the tick thread should sleep until.
+     * @return Next deadline
+     */
+    Clock::time_point GetNextDeadline();
+
+    /**
+     * Move past every deadline that has elapsed.
+     * @param now Current time
+     * @return true if a tick should be queued, false if no deadline has
+     *  elapsed or the tick was coalesced into one that has not started
+     */
+    bool Advance(Clock::time_point now);
+
+    /**
+     * Report that the queued tick has started processing.
+     * @param now Current time
+     */
+    void TickStarted(Clock::time_point now);
+
+    /**
+     * Report that the tick has finished processing.
+     * @param now Current time
+     */
+    void TickFinished(Clock::time_point now);
+
+    /**
+     * Get the current counters and timings.
+     * @return Counters and timings since the scheduler was created
+     */
+    Stats GetStats();
+
+private:
+    /// Number of histogram buckets per power of two
+    static const uint32_t SUB_BUCKETS = 8;
+
+    /// Number of histogram buckets (values up to 2^40 microseconds)
+    static const uint32_t BUCKET_COUNT = 16 + (40 - 4) * SUB_BUCKETS;
+
+    /**
+     * Get the histogram bucket a duration falls in. Buckets are exact
+     * below 16 and grow with the value above that so each bucket is
+     * within 12.5% of the values it holds.
+     * @param value Duration in microseconds
+     * @return Bucket index
+     */
+    static uint32_t GetBucket(uint64_t value);
+
+    /**
+     * Get the largest duration that falls in a histogram bucket.
+     * @param bucket Bucket index
+     * @return Duration in microseconds
+     */
+    static uint64_t GetBucketLimit(uint32_t bucket);
+
+    /**
+     * Get a percentile of the recorded tick durations.
+     * @param percent Percentile to get in the range (0, 100]
+     * @return Duration in microseconds
+     */
+    uint64_t GetPercentile(uint64_t percent) const;
+
+    /// Time between the start of each tick
+    Clock::duration mPeriod;
+
+    /// Deadline the tick thread is waiting for
+    Clock::time_point mNextDeadline;
+
+    /// Most recent elapsed deadline
+    Clock::time_point mDeadline;
+
+    /// Time the current tick started processing
+    Clock::time_point mTickStart;
+
+    /// true if a tick has been queued but not started
+    bool mTickQueued;
+
+    /// Counters and timings, percentiles are filled in on request
+    Stats mStats;
+
+    /// Total delay between deadlines and their ticks starting
+    uint64_t mJitterTotal;
+
+    /// Tick duration histogram
+    std::array<uint64_t, BUCKET_COUNT> mDurations;
+
+    /// Lock for every member
+    std::mutex mLock;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_TICKSCHEDULER_H
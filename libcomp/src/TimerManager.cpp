@@ -26,12 +26,15 @@
 
 #include "TimerManager.h"
 
+// Standard C++11 Includes
+#include <algorithm>
+#include <limits>
+
 namespace libcomp
 {
 
 class TimerEvent
 {
-    friend class TimerEventComp;
     friend class TimerManager;
 
 protected:
@@ -42,13 +45,34 @@ protected:
     std::chrono::milliseconds period;
     libcomp::Message::Execute *msg;
     bool mIsPeriodic;
+
+    /// Wheel tick the event expires on
+    uint64_t mTick;
+
+    /// Previous event in the same wheel slot
+    TimerEvent *mPrev;
+
+    /// Next event in the same wheel slot or in the free list
+    TimerEvent *mNext;
+
+    /// Head of the wheel slot the event is in or null if it is not in
+    /// the wheel
+    TimerEvent **mSlot;
+
+    /// true once the event has expired and is waiting to run or running
+    bool mExpired;
+
+    /// true if the event was cancelled after it expired
+    bool mCancelled;
 };
 
 } // namespace libcomp
 
 using namespace libcomp;
 
-TimerEvent::TimerEvent() : msg(nullptr), mIsPeriodic(false)
+TimerEvent::TimerEvent() : msg(nullptr), mIsPeriodic(false), mTick(0),
+    mPrev(nullptr), mNext(nullptr), mSlot(nullptr), mExpired(false),
+    mCancelled(false)
 {
 }
 
@@ -57,13 +81,9 @@ TimerEvent::~TimerEvent()
     delete msg;
 }
 
-bool TimerEventComp::operator()(const TimerEvent *lhs,
-    const TimerEvent *rhs) const
-{
-    return lhs->time < rhs->time;
-}
-
-TimerManager::TimerManager() : mRunning(true), mProcessingEvents(false)
+TimerManager::TimerManager() : mRunning(true),
+    mStart(std::chrono::steady_clock::now()), mCurrentTick(0), mWakeTick(0),
+    mPendingCount(0), mWheel(), mFreeEvents(nullptr)
 {
     mRunThread = std::thread([&]()
     {
@@ -83,41 +103,115 @@ TimerManager::TimerManager() : mRunning(true), mProcessingEvents(false)
 
 TimerManager::~TimerManager()
 {
-    mRunning = false;
+    {
+        std::unique_lock<std::mutex> lock(mEventLock);
+        mRunning = false;
+    }
 
     mEventCondition.notify_all();
 
     mRunThread.join();
 
-    for(TimerEvent *pEvent : mEvents)
+    for(auto& level : mWheel)
+    {
+        for(TimerEvent *pEvent : level)
+        {
+            while(nullptr != pEvent)
+            {
+                TimerEvent *pNext = pEvent->mNext;
+                delete pEvent->msg;
+                pEvent->msg = nullptr;
+                pEvent = pNext;
+            }
+        }
+    }
+
+    for(TimerEvent *pBlock : mEventBlocks)
     {
-        delete pEvent;
+        delete[] pBlock;
     }
 }
 
 void TimerManager::ProcessEvents(std::unique_lock<std::mutex>& lock)
 {
-    auto now = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::now() - mStart;
+    uint64_t nowTick = (uint64_t)std::chrono::duration_cast<
+        std::chrono::milliseconds>(elapsed).count();
 
-    std::list<TimerEvent*> periodicals;
+    std::vector<TimerEvent*> expired;
 
-    mProcessingEvents = true;
-
-    while(!mEvents.empty())
+    while(mCurrentTick <= nowTick)
     {
-        auto it = mEvents.begin();
+        if(0 == mPendingCount)
+        {
+            // Nothing left to find, skip ahead
+            mCurrentTick = nowTick + 1;
+            break;
+        }
 
-        TimerEvent *pEvent = *it;
+        uint64_t slot = mCurrentTick & WHEEL_MASK;
 
-        if(pEvent->time > now)
+        if(0 == slot)
         {
-            break;
+            // The lowest level wrapped so pull the events for the next
+            // WHEEL_SIZE ticks down from the levels above
+            for(uint32_t level = 1; level < WHEEL_LEVELS; level++)
+            {
+                uint64_t levelSlot = (mCurrentTick >> (level * WHEEL_BITS)) &
+                    WHEEL_MASK;
+
+                Cascade(level, levelSlot);
+
+                if(0 != levelSlot)
+                {
+                    break;
+                }
+            }
         }
-        else
+
+        TimerEvent *pEvent = mWheel[0][slot];
+        mWheel[0][slot] = nullptr;
+
+        while(nullptr != pEvent)
+        {
+            TimerEvent *pNext = pEvent->mNext;
+
+            pEvent->mSlot = nullptr;
+            pEvent->mExpired = true;
+            mPendingCount--;
+
+            expired.push_back(pEvent);
+
+            pEvent = pNext;
+        }
+
+        mCurrentTick++;
+    }
+
+    if(expired.empty())
+    {
+        return;
+    }
+
+    // Slots are not ordered so run the events in the order they were
+    // scheduled for
+    std::stable_sort(expired.begin(), expired.end(), [](
+        const TimerEvent *pLeft, const TimerEvent *pRight)
         {
-            mEvents.erase(it++);
+            return pLeft->time < pRight->time;
+        });
 
-            if(pEvent->msg)
+    for(TimerEvent *pEvent : expired)
+    {
+        if(pEvent->msg && !pEvent->mCancelled)
+        {
+            if(mMessageQueue && !pEvent->mIsPeriodic)
+            {
+                // The queue owns the message now
+                mMessageQueue->Enqueue(pEvent->msg);
+                pEvent->msg = nullptr;
+            }
+            else
             {
                 // Unlock the mutex in the case the callback waits on another
                 // mutex that waits on the timer or the callback tries to
@@ -126,93 +220,269 @@ void TimerManager::ProcessEvents(std::unique_lock<std::mutex>& lock)
                 pEvent->msg->Run();
                 lock.lock();
             }
+        }
 
-            if(pEvent->mIsPeriodic)
-            {
-                pEvent->time += pEvent->period;
+        if(pEvent->mIsPeriodic && !pEvent->mCancelled)
+        {
+            pEvent->time += pEvent->period;
+            pEvent->mTick = GetTick(pEvent->time);
+            pEvent->mExpired = false;
 
-                periodicals.push_back(pEvent);
-            }
-            else
+            InsertEvent(pEvent);
+        }
+        else
+        {
+            FreeEvent(pEvent);
+        }
+    }
+}
+
+void TimerManager::WaitForEvent(std::unique_lock<std::mutex>& lock)
+{
+    if(!mRunning)
+    {
+        return;
+    }
+
+    if(0 == mPendingCount)
+    {
+        // Wait for at least one event.
+        mWakeTick = std::numeric_limits<uint64_t>::max();
+        mEventCondition.wait(lock);
+    }
+    else
+    {
+        // Wake for the next event in the lowest level or when it wraps
+        // and the next level needs to cascade
+        uint64_t wakeTick = (mCurrentTick + WHEEL_MASK) & ~WHEEL_MASK;
+
+        for(uint64_t tick = mCurrentTick; tick < wakeTick; tick++)
+        {
+            if(nullptr != mWheel[0][tick & WHEEL_MASK])
             {
-                delete pEvent;
+                wakeTick = tick;
+                break;
             }
         }
+
+        mWakeTick = wakeTick;
+
+        // We don't care why we wake we'll check everything anyway.
+        (void)mEventCondition.wait_until(lock, mStart +
+            std::chrono::milliseconds(wakeTick));
     }
 
-    for(TimerEvent *pEvent : periodicals)
+    // Registering events does not need to wake the thread while it is
+    // already awake
+    mWakeTick = 0;
+}
+
+uint64_t TimerManager::GetTick(
+    const std::chrono::steady_clock::time_point& time) const
+{
+    if(time <= mStart)
     {
-        mEvents.insert(pEvent);
+        return 0;
     }
 
-    mProcessingEvents = false;
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        time - mStart).count();
+
+    return ((uint64_t)ns + 999999) / 1000000;
 }
 
-void TimerManager::WaitForEvent(std::unique_lock<std::mutex>& lock)
+TimerEvent* TimerManager::AllocateEvent()
 {
-    if(mEvents.empty())
+    if(nullptr == mFreeEvents)
     {
-        // Wait for at least one event.
-        mEventCondition.wait(lock);
+        TimerEvent *pBlock = new TimerEvent[EVENT_BLOCK_SIZE];
+        mEventBlocks.push_back(pBlock);
+
+        for(size_t i = 0; i < EVENT_BLOCK_SIZE; i++)
+        {
+            pBlock[i].mNext = mFreeEvents;
+            mFreeEvents = &pBlock[i];
+        }
+    }
+
+    TimerEvent *pEvent = mFreeEvents;
+    mFreeEvents = pEvent->mNext;
+
+    pEvent->mNext = nullptr;
+
+    return pEvent;
+}
+
+void TimerManager::FreeEvent(TimerEvent *pEvent)
+{
+    delete pEvent->msg;
+
+    pEvent->msg = nullptr;
+    pEvent->mIsPeriodic = false;
+    pEvent->mSlot = nullptr;
+    pEvent->mPrev = nullptr;
+    pEvent->mExpired = false;
+    pEvent->mCancelled = false;
+
+    pEvent->mNext = mFreeEvents;
+    mFreeEvents = pEvent;
+}
+
+void TimerManager::InsertEvent(TimerEvent *pEvent)
+{
+    uint64_t expires = std::max(pEvent->mTick, mCurrentTick);
+    uint64_t delta = expires - mCurrentTick;
+
+    uint32_t level = 0;
+    while(level + 1 < WHEEL_LEVELS &&
+        delta >= (1ULL << ((level + 1) * WHEEL_BITS)))
+    {
+        level++;
+    }
+
+    uint64_t maxDelta = (1ULL << (WHEEL_LEVELS * WHEEL_BITS)) - 1;
+    if(delta > maxDelta)
+    {
+        // Park it as far out as the wheel reaches, it will be placed
+        // again when that slot cascades
+        expires = mCurrentTick + maxDelta;
+    }
+
+    TimerEvent **pSlot = &mWheel[level][(expires >> (level * WHEEL_BITS)) &
+        WHEEL_MASK];
+
+    pEvent->mSlot = pSlot;
+    pEvent->mPrev = nullptr;
+    pEvent->mNext = *pSlot;
+
+    if(nullptr != *pSlot)
+    {
+        (*pSlot)->mPrev = pEvent;
+    }
+
+    *pSlot = pEvent;
+
+    mPendingCount++;
+}
+
+void TimerManager::UnlinkEvent(TimerEvent *pEvent)
+{
+    if(nullptr != pEvent->mPrev)
+    {
+        pEvent->mPrev->mNext = pEvent->mNext;
     }
     else
     {
-        // We don't care why we wake we'll check everything anyway.
-        (void)mEventCondition.wait_until(lock, (*mEvents.begin())->time);
+        *pEvent->mSlot = pEvent->mNext;
     }
 
+    if(nullptr != pEvent->mNext)
+    {
+        pEvent->mNext->mPrev = pEvent->mPrev;
+    }
+
+    pEvent->mSlot = nullptr;
+    pEvent->mPrev = nullptr;
+    pEvent->mNext = nullptr;
+
+    mPendingCount--;
 }
 
-TimerEvent* TimerManager::RegisterEvent(const std::chrono::steady_clock::time_point& time, libcomp::Message::Execute *pMessage)
+void TimerManager::Cascade(uint32_t level, uint64_t slot)
 {
-    TimerEvent *pEvent = new TimerEvent;
-    pEvent->time = time;
-    pEvent->msg = pMessage;
+    TimerEvent *pEvent = mWheel[level][slot];
+    mWheel[level][slot] = nullptr;
 
-    std::unique_lock<std::mutex> lock(mEventLock);
+    while(nullptr != pEvent)
+    {
+        TimerEvent *pNext = pEvent->mNext;
 
-    mEvents.insert(pEvent);
-    mEventCondition.notify_all();
+        mPendingCount--;
+        InsertEvent(pEvent);
 
-    return pEvent;
+        pEvent = pNext;
+    }
+}
+
+TimerEvent* TimerManager::RegisterEvent(const std::chrono::steady_clock::time_point& time, libcomp::Message::Execute *pMessage)
+{
+    return AddEvent(time, std::chrono::milliseconds(0), false, pMessage);
 }
 
 TimerEvent* TimerManager::RegisterPeriodicEvent(const std::chrono::milliseconds& period, libcomp::Message::Execute *pMessage)
 {
-    TimerEvent *pEvent = new TimerEvent;
-    pEvent->time = std::chrono::steady_clock::now() + period;
+    return AddEvent(std::chrono::steady_clock::now() + period, period, true,
+        pMessage);
+}
+
+TimerEvent* TimerManager::AddEvent(
+    const std::chrono::steady_clock::time_point& time,
+    const std::chrono::milliseconds& period, bool periodic,
+    libcomp::Message::Execute *pMessage)
+{
+    std::unique_lock<std::mutex> lock(mEventLock);
+
+    if(0 == mPendingCount)
+    {
+        // The thread stops advancing the wheel while it is empty
+        uint64_t nowTick = (uint64_t)std::chrono::duration_cast<
+            std::chrono::milliseconds>(std::chrono::steady_clock::now() -
+            mStart).count();
+        mCurrentTick = std::max(mCurrentTick, nowTick);
+    }
+
+    TimerEvent *pEvent = AllocateEvent();
+    pEvent->time = time;
     pEvent->period = period;
-    pEvent->mIsPeriodic = true;
+    pEvent->mIsPeriodic = periodic;
+    pEvent->mTick = GetTick(time);
     pEvent->msg = pMessage;
 
-    std::unique_lock<std::mutex> lock(mEventLock);
+    InsertEvent(pEvent);
 
-    mEvents.insert(pEvent);
-    mEventCondition.notify_all();
+    if(pEvent->mTick < mWakeTick)
+    {
+        mEventCondition.notify_all();
+    }
 
     return pEvent;
 }
 
 void TimerManager::CancelEvent(TimerEvent *pEvent)
 {
-    std::unique_lock<std::mutex> lock(mEventLock);
-
-    // If the event is being processed we can't cancel but if the event
-    // is periodic we can keep it from happening next time.
-    if(mProcessingEvents)
+    if(nullptr == pEvent)
     {
-        pEvent->mIsPeriodic = false;
         return;
     }
 
-    auto it = mEvents.find(pEvent);
+    std::unique_lock<std::mutex> lock(mEventLock);
 
-    if(mEvents.end() != it)
+    // If the event has expired it is being processed so we can't cancel
+    // it here but we can keep it from happening (again).
+    if(pEvent->mExpired)
     {
-        mEvents.erase(it);
+        pEvent->mCancelled = true;
+        return;
+    }
 
-        delete pEvent;
+    if(nullptr != pEvent->mSlot)
+    {
+        UnlinkEvent(pEvent);
+        FreeEvent(pEvent);
     }
+}
 
-    mEventCondition.notify_all();
+void TimerManager::SetMessageQueue(const std::shared_ptr<MessageQueue<
+    libcomp::Message::Message*>>& messageQueue)
+{
+    std::unique_lock<std::mutex> lock(mEventLock);
+
+    mMessageQueue = messageQueue;
+}
+
+size_t TimerManager::GetPendingCount()
+{
+    std::unique_lock<std::mutex> lock(mEventLock);
+
+    return mPendingCount;
 }
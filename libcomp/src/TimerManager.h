@@ -29,10 +29,12 @@
 
 // libcomp Includes
 #include "MessageExecute.h"
+#include "MessageQueue.h"
 
 #include <chrono>
 #include <list>
 #include <set>
+#include <vector>
 
 #include <condition_variable>
 #include <thread>
@@ -42,12 +44,15 @@ namespace libcomp
 
 class TimerEvent;
 
-class TimerEventComp
-{
-public:
-    bool operator()(const TimerEvent *lhs, const TimerEvent *rhs) const;
-};
-
+/**
+ * Runs timed events on a dedicated thread. Events are kept in a
+ * hierarchical timing wheel with a resolution of one millisecond so
+ * registering and cancelling an event takes constant time no matter how
+ * many events are pending. Event nodes are pooled and reused. By default
+ * callbacks run on the timer thread; if a message queue is set, one-shot
+ * events are handed to that queue instead so the timer thread is never
+ * blocked by a slow callback.
+ */
 class TimerManager
 {
 public:
@@ -60,8 +65,31 @@ public:
     TimerEvent* RegisterPeriodicEvent(
         const std::chrono::milliseconds& period,
         libcomp::Message::Execute *pMessage);
+
+    /**
+     * Cancel a pending event. An event that is running has its period
+     * cleared so it does not run again. A one-shot event must not be
+     * cancelled after it has run as its node may have been reused.
+     * @param pEvent Event to cancel
+     */
     void CancelEvent(TimerEvent *pEvent);
 
+    /**
+     * Set the queue that expired one-shot events are sent to instead of
+     * running them on the timer thread. The queue takes ownership of the
+     * message. Periodic events always run on the timer thread.
+     * @param messageQueue Queue to send expired events to or null to run
+     *  them on the timer thread
+     */
+    void SetMessageQueue(const std::shared_ptr<MessageQueue<
+        libcomp::Message::Message*>>& messageQueue);
+
+    /**
+     * Get the number of events waiting to run.
+     * @return Number of pending events
+     */
+    size_t GetPendingCount();
+
     /**
      * Executes code in the worker thread.
      * @param f Function (lambda) to execute in the worker thread.
@@ -114,12 +142,103 @@ public:
     }
 
 private:
+    /// Number of bits of the expiration tick each wheel level covers
+    static const uint32_t WHEEL_BITS = 8;
+
+    /// Number of slots in each wheel level
+    static const uint32_t WHEEL_SIZE = 1 << WHEEL_BITS;
+
+    /// Mask of the slot index within a wheel level
+    static const uint64_t WHEEL_MASK = WHEEL_SIZE - 1;
+
+    /// Number of wheel levels, events further out than the last level
+    /// covers are parked in its furthest slot until they get closer
+    static const uint32_t WHEEL_LEVELS = 4;
+
+    /// Number of event nodes allocated at once
+    static const size_t EVENT_BLOCK_SIZE = 256;
+
     void ProcessEvents(std::unique_lock<std::mutex>& lock);
     void WaitForEvent(std::unique_lock<std::mutex>& lock);
 
+    /**
+     * Get the wheel tick a time falls in, rounded up so an event never
+     * runs early.
+     * @param time Time to convert
+     * @return Wheel tick
+     */
+    uint64_t GetTick(const std::chrono::steady_clock::time_point& time) const;
+
+    /**
+     * Add a new event to the wheel.
+     * @param time Time the event should first run
+     * @param period Time between runs of a periodic event
+     * @param periodic true if the event should run every period
+     * @param pMessage Message to run, owned by the event
+     * @return Pointer to the new event
+     */
+    TimerEvent* AddEvent(const std::chrono::steady_clock::time_point& time,
+        const std::chrono::milliseconds& period, bool periodic,
+        libcomp::Message::Execute *pMessage);
+
+    /**
+     * Take an event node from the pool.
+     * @return Unused event node
+     */
+    TimerEvent* AllocateEvent();
+
+    /**
+     * Return an event node to the pool, deleting its message.
+     * @param pEvent Event node to return
+     */
+    void FreeEvent(TimerEvent *pEvent);
+
+    /**
+     * Add an event to the wheel slot matching its expiration.
+     * @param pEvent Event to add
+     */
+    void InsertEvent(TimerEvent *pEvent);
+
+    /**
+     * Remove an event from the wheel slot it is in.
+     * @param pEvent Event to remove
+     */
+    void UnlinkEvent(TimerEvent *pEvent);
+
+    /**
+     * Move every event in a slot of a higher wheel level down to the
+     * level matching its remaining time.
+     * @param level Wheel level
+     * @param slot Slot index within the level
+     */
+    void Cascade(uint32_t level, uint64_t slot);
+
     volatile bool mRunning;
-    volatile bool mProcessingEvents;
-    std::multiset<TimerEvent*, TimerEventComp> mEvents;
+
+    /// Time wheel tick 0 starts at
+    std::chrono::steady_clock::time_point mStart;
+
+    /// Next wheel tick to process
+    uint64_t mCurrentTick;
+
+    /// Wheel tick the timer thread is sleeping until
+    uint64_t mWakeTick;
+
+    /// Number of events in the wheel
+    size_t mPendingCount;
+
+    /// Head of the event list of each wheel slot
+    TimerEvent *mWheel[WHEEL_LEVELS][WHEEL_SIZE];
+
+    /// Unused event nodes
+    TimerEvent *mFreeEvents;
+
+    /// Every block of event nodes allocated
+    std::vector<TimerEvent*> mEventBlocks;
+
+    /// Queue to send expired one-shot events to
+    std::shared_ptr<MessageQueue<libcomp::Message::Message*>> mMessageQueue;
+
     std::condition_variable mEventCondition;
     std::mutex mEventLock;
     std::thread mRunThread;
@@ -0,0 +1,231 @@
+/**
+ * @file libcomp/src/WorkStealingPool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of threads that run batches of independent tasks.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "WorkStealingPool.h"
+
+using namespace libcomp;
+
+WorkStealingPool::WorkStealingPool(size_t threadCount,
+    const libcomp::String& name) : mBatch(0), mRemaining(0),
+    mStopping(false)
+{
+    for(size_t i = 0; i <= threadCount; ++i)
+    {
+        mQueues.emplace_back(new TaskQueue);
+    }
+
+    for(size_t i = 0; i < threadCount; ++i)
+    {
+        mThreads.emplace_back([this, i](const libcomp::String& _name)
+        {
+            (void)_name;
+
+#if !defined(_WIN32)
+            pthread_setname_np(pthread_self(), _name.C());
+#endif // !defined(_WIN32)
+
+            ThreadMain(i);
+        }, name);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mBatchLock);
+        mStopping = true;
+    }
+
+    mBatchStarted.notify_all();
+
+    for(auto& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+size_t WorkStealingPool::GetConcurrency() const
+{
+    return mQueues.size();
+}
+
+void WorkStealingPool::Run(std::vector<std::function<void()>>& tasks)
+{
+    if(tasks.empty())
+    {
+        return;
+    }
+
+    if(mThreads.empty() || 1 == tasks.size())
+    {
+        for(auto& task : tasks)
+        {
+            RunTask(task);
+        }
+    }
+    else
+    {
+        RunParallel(tasks);
+    }
+
+    tasks.clear();
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mBatchLock);
+        error = mError;
+        mError = nullptr;
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingPool::RunParallel(std::vector<std::function<void()>>& tasks)
+{
+    mRemaining = tasks.size();
+
+    // Deal the tasks out so each thread starts with its own share
+    for(size_t i = 0; i < tasks.size(); ++i)
+    {
+        auto& queue = mQueues[i % mQueues.size()];
+
+        std::lock_guard<std::mutex> lock(queue->Lock);
+        queue->Tasks.push_back(&tasks[i]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mBatchLock);
+        mBatch++;
+    }
+
+    mBatchStarted.notify_all();
+
+    // The caller works on the batch too
+    Drain(mQueues.size() - 1);
+
+    {
+        std::unique_lock<std::mutex> lock(mBatchLock);
+        mBatchFinished.wait(lock, [this]()
+            {
+                return 0 == mRemaining.load();
+            });
+    }
+}
+
+void WorkStealingPool::ThreadMain(size_t index)
+{
+    uint64_t lastBatch = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mBatchLock);
+            mBatchStarted.wait(lock, [this, lastBatch]()
+                {
+                    return mStopping || mBatch != lastBatch;
+                });
+
+            if(mStopping)
+            {
+                return;
+            }
+
+            lastBatch = mBatch;
+        }
+
+        Drain(index);
+    }
+}
+
+void WorkStealingPool::Drain(size_t index)
+{
+    std::function<void()> *pTask;
+
+    while(nullptr != (pTask = Take(index)))
+    {
+        RunTask(*pTask);
+
+        // Always count the task so Run can't wait forever
+        if(1 == mRemaining.fetch_sub(1))
+        {
+            // Take the lock so the caller can't miss the notification
+            // between checking the count and waiting
+            std::lock_guard<std::mutex> lock(mBatchLock);
+            mBatchFinished.notify_all();
+        }
+    }
+}
+
+void WorkStealingPool::RunTask(std::function<void()>& task)
+{
+    try
+    {
+        task();
+    }
+    catch(...)
+    {
+        std::lock_guard<std::mutex> lock(mBatchLock);
+        if(!mError)
+        {
+            mError = std::current_exception();
+        }
+    }
+}
+
+std::function<void()>* WorkStealingPool::Take(size_t index)
+{
+    {
+        auto& own = mQueues[index];
+
+        std::lock_guard<std::mutex> lock(own->Lock);
+        if(!own->Tasks.empty())
+        {
+            auto pTask = own->Tasks.back();
+            own->Tasks.pop_back();
+
+            return pTask;
+        }
+    }
+
+    for(size_t i = 1; i < mQueues.size(); ++i)
+    {
+        auto& other = mQueues[(index + i) % mQueues.size()];
+
+        std::lock_guard<std::mutex> lock(other->Lock);
+        if(!other->Tasks.empty())
+        {
+            auto pTask = other->Tasks.front();
+            other->Tasks.pop_front();
+
+            return pTask;
+        }
+    }
+
+    return nullptr;
+}
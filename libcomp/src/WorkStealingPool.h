@@ -0,0 +1,165 @@
+/**
+ * @file libcomp/src/WorkStealingPool.h
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Pool of threads that run batches of independent tasks.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LIBCOMP_SRC_WORKSTEALINGPOOL_H
+#define LIBCOMP_SRC_WORKSTEALINGPOOL_H
+
+// libcomp Includes
+#include "CString.h"
+
+// Standard C++11 Includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libcomp
+{
+
+/**
+ * Fixed set of threads that run a batch of independent tasks and return
+ * once all of them are done. Tasks are dealt out evenly to one queue per
+ * thread (including the calling thread). A thread takes tasks from the
+ * back of its own queue and, once that is empty, steals from the front
+ * of the other queues so a few long tasks do not leave the rest of the
+ * threads idle. If a task throws, the rest of the batch still runs and the
+ * first exception is thrown again by @ref Run.
+ */
+class WorkStealingPool
+{
+public:
+    /**
+     * Create the pool and start its threads.
+     * @param threadCount Number of threads to start in addition to the
+     *  thread calling @ref Run. If 0, every task runs on the caller.
+     * @param name Name to give each thread
+     */
+    WorkStealingPool(size_t threadCount, const libcomp::String& name);
+
+    /**
+     * Stop and join every thread.
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * Get the number of threads that can run tasks including the caller.
+     * @return Number of threads that can run tasks
+     */
+    size_t GetConcurrency() const;
+
+    /**
+     * Run every task and wait until they are all complete. Only one batch
+     * may run at a time.
+     * @param tasks Tasks to run, cleared once complete
+     * @throws The first exception thrown by a task once every task is
+     *  complete
+     */
+    void Run(std::vector<std::function<void()>>& tasks);
+
+private:
+    /**
+     * Tasks assigned to one thread.
+     */
+    struct TaskQueue
+    {
+        /// Lock for the task list
+        std::mutex Lock;
+
+        /// Tasks waiting to run
+        std::deque<std::function<void()>*> Tasks;
+    };
+
+    /**
+     * Deal a batch of tasks out to the threads and wait for them.
+     * @param tasks Tasks to run
+     */
+    void RunParallel(std::vector<std::function<void()>>& tasks);
+
+    /**
+     * Main loop of a pool thread.
+     * @param index Index of the thread's task queue
+     */
+    void ThreadMain(size_t index);
+
+    /**
+     * Run tasks from the thread's own queue then steal from the other
+     * queues until no tasks are left.
+     * @param index Index of the thread's task queue
+     */
+    void Drain(size_t index);
+
+    /**
+     * Run one task and keep the first exception of the batch.
+     * @param task Task to run
+     */
+    void RunTask(std::function<void()>& task);
+
+    /**
+     * Take the next task for a thread.
+     * @param index Index of the thread's task queue
+     * @return Task to run or null if every queue is empty
+     */
+    std::function<void()>* Take(size_t index);
+
+    /// One task queue per thread, the last one is for the caller
+    std::vector<std::unique_ptr<TaskQueue>> mQueues;
+
+    /// Pool threads
+    std::vector<std::thread> mThreads;
+
+    /// Lock used to start and finish a batch
+    std::mutex mBatchLock;
+
+    /// Signaled when a new batch starts or the pool is stopping
+    std::condition_variable mBatchStarted;
+
+    /// Signaled when the last task of a batch completes
+    std::condition_variable mBatchFinished;
+
+    /// Incremented for each batch so threads know when to wake
+    uint64_t mBatch;
+
+    /// Number of tasks left to complete in the current batch
+    std::atomic<size_t> mRemaining;
+
+    /// First exception thrown by a task in the current batch (batch lock)
+    std::exception_ptr mError;
+
+    /// Set when the pool is being destroyed
+    bool mStopping;
+};
+
+} // namespace libcomp
+
+#endif // LIBCOMP_SRC_WORKSTEALINGPOOL_H
@@ -155,7 +155,7 @@ void Worker::Shutdown()
 
 void Worker::Join()
 {
-    if(nullptr != mThread)
+    if(nullptr != mThread && mThread->joinable())
     {
         mThread->join();
     }
@@ -0,0 +1,123 @@
+/**
+ * @file libcomp/tests/DatabaseStatementCache.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the DatabaseStatementCache class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <DatabaseBind.h>
+#include <DatabaseStatementCache.h>
+
+#include <list>
+#include <memory>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+typedef DatabaseStatementCache::Operation Operation;
+
+DatabaseStatementCache::Key GetKey(const std::string& table, Operation op,
+    const std::vector<String>& columnNames)
+{
+    std::list<std::unique_ptr<DatabaseBind>> binds;
+    std::list<DatabaseBind*> columns;
+
+    for(auto& name : columnNames)
+    {
+        binds.emplace_back(new DatabaseBindInt(name, 0));
+        columns.push_back(binds.back().get());
+    }
+
+    return DatabaseStatementCache::GetKey(table, op, columns);
+}
+
+} // namespace
+
+TEST(DatabaseStatementCache, SameStatementSameKey)
+{
+    auto a = GetKey("Character", Operation::UPDATE, { "Name", "LV" });
+    auto b = GetKey("Character", Operation::UPDATE, { "Name", "LV" });
+
+    EXPECT_EQ(a.Hash, b.Hash);
+    EXPECT_TRUE(a == b);
+
+    // Only the column names matter, not the values bound
+    std::list<DatabaseBind*> columns;
+    DatabaseBindText name("Name", "other");
+    DatabaseBindBool lv("LV", true);
+    columns.push_back(&name);
+    columns.push_back(&lv);
+
+    EXPECT_TRUE(a == DatabaseStatementCache::GetKey("Character",
+        Operation::UPDATE, columns));
+}
+
+TEST(DatabaseStatementCache, DifferentStatementDifferentKey)
+{
+    auto key = GetKey("Character", Operation::UPDATE, { "Name", "LV" });
+
+    std::vector<DatabaseStatementCache::Key> others = {
+        GetKey("Demon", Operation::UPDATE, { "Name", "LV" }),
+        GetKey("Character", Operation::INSERT, { "Name", "LV" }),
+        GetKey("Character", Operation::UPDATE, { "LV", "Name" }),
+        GetKey("Character", Operation::UPDATE, { "Name" }),
+        GetKey("Character", Operation::UPDATE, { "NameLV" }),
+        GetKey("Character", Operation::UPDATE, { "Nam", "eLV" }),
+        GetKey("Character", Operation::UPDATE, { "Name", "LV", "" }),
+        GetKey("CharacterName", Operation::UPDATE, { "LV" }),
+    };
+
+    for(auto& other : others)
+    {
+        EXPECT_FALSE(key == other);
+    }
+
+    // Keys must not be equal just because the hashes are
+    auto copy = key;
+    copy.Columns = others[2].Columns;
+    EXPECT_FALSE(key == copy);
+
+    copy = key;
+    copy.Table = "Demon";
+    EXPECT_FALSE(key == copy);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
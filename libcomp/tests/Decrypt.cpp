@@ -28,6 +28,7 @@
 #include <gtest/gtest.h>
 #include <PopIgnore.h>
 
+#include <BlowfishEcb.h>
 #include <Config.h>
 #include <Decrypt.h>
 #include <Exception.h>
@@ -255,3 +256,66 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 }
+
+TEST(BlowfishEcb, EnginesMatchOpenSsl)
+{
+    static const BlowfishEcb::Engine_t engines[] = {
+        BlowfishEcb::Engine_t::LANES_4,
+        BlowfishEcb::Engine_t::LANES_8,
+        BlowfishEcb::Engine_t::AVX2,
+    };
+
+    static const unsigned char keyData[] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+        0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87
+    };
+
+    BF_KEY key;
+    BF_set_key(&key, (int)sizeof(keyData), keyData);
+
+    auto original = BlowfishEcb::GetEngine();
+
+    for(auto engine : engines)
+    {
+        if(!BlowfishEcb::IsSupported(engine))
+        {
+            continue;
+        }
+
+        ASSERT_TRUE(BlowfishEcb::SetEngine(engine));
+
+        // Cover the full lanes and every size of leftover blocks.
+        for(uint32_t blockCount = 0; blockCount < 40; blockCount++)
+        {
+            std::vector<char> data(blockCount * BLOWFISH_BLOCK_SIZE);
+
+            for(size_t i = 0; i < data.size(); i++)
+            {
+                data[i] = (char)(i * 31 + blockCount);
+            }
+
+            std::vector<char> expected = data;
+            std::vector<char> actual = data;
+
+            for(uint32_t i = 0; i < blockCount; i++)
+            {
+                BF_encrypt(reinterpret_cast<BF_LONG*>(&expected[
+                    i * BLOWFISH_BLOCK_SIZE]), &key);
+            }
+
+            BlowfishEcb::Encrypt(key, actual.data(), blockCount);
+
+            EXPECT_EQ(expected, actual) << "Encrypt with the "
+                << BlowfishEcb::GetEngineName(engine) << " engine does not "
+                "match OpenSSL for " << blockCount << " blocks.";
+
+            BlowfishEcb::Decrypt(key, actual.data(), blockCount);
+
+            EXPECT_EQ(data, actual) << "Decrypt with the "
+                << BlowfishEcb::GetEngineName(engine) << " engine does not "
+                "match OpenSSL for " << blockCount << " blocks.";
+        }
+    }
+
+    BlowfishEcb::SetEngine(original);
+}
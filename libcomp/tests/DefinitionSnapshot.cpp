@@ -0,0 +1,198 @@
+/**
+ * @file libcomp/tests/DefinitionSnapshot.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the DefinitionSnapshot class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <DefinitionSnapshot.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+const char TEST_PATH[] = "DefinitionSnapshotTest.snap";
+const char TEST_LAYOUT[] = "layout";
+
+const std::string ITEM_DATA("item\0records", 12);
+const std::string ZONE_DATA("zone records");
+
+DefinitionSnapshot::Entry MakeEntry(const std::string& typeName,
+    int64_t sourceTime, uint32_t count, const std::string& data)
+{
+    DefinitionSnapshot::Entry entry;
+    entry.TypeName = typeName;
+    entry.SourceSize = (int64_t)data.size() * 10;
+    entry.SourceTime = sourceTime;
+    entry.Count = count;
+    entry.pData = data.data();
+    entry.Size = data.size();
+
+    return entry;
+}
+
+bool SaveTestSnapshot()
+{
+    DefinitionSnapshot::Entries entries;
+    entries["Shield/ItemData.sbin"] = MakeEntry("MiItemData", 1234, 2,
+        ITEM_DATA);
+    entries["Shield/ZoneData.sbin"] = MakeEntry("MiZoneData", -1, 1,
+        ZONE_DATA);
+
+    return DefinitionSnapshot::Save(TEST_PATH, TEST_LAYOUT, entries);
+}
+
+std::vector<char> ReadTestFile()
+{
+    std::ifstream in(TEST_PATH, std::ios::in | std::ios::binary);
+
+    return std::vector<char>(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+}
+
+void WriteTestFile(const std::vector<char>& data)
+{
+    std::ofstream out(TEST_PATH, std::ios::out |
+        std::ios::binary | std::ios::trunc);
+    out.write(data.data(), (std::streamsize)data.size());
+}
+
+} // namespace
+
+TEST(DefinitionSnapshot, RoundTrip)
+{
+    ASSERT_TRUE(SaveTestSnapshot());
+
+    DefinitionSnapshot snapshot;
+    ASSERT_TRUE(snapshot.Load(TEST_PATH, TEST_LAYOUT));
+
+    auto& entries = snapshot.GetEntries();
+    ASSERT_EQ((size_t)2, entries.size());
+
+    auto it = entries.find("Shield/ItemData.sbin");
+    ASSERT_NE(entries.end(), it);
+    EXPECT_EQ(std::string("MiItemData"), it->second.TypeName);
+    EXPECT_EQ((int64_t)ITEM_DATA.size() * 10, it->second.SourceSize);
+    EXPECT_EQ((int64_t)1234, it->second.SourceTime);
+    EXPECT_EQ((uint32_t)2, it->second.Count);
+    EXPECT_EQ(ITEM_DATA, std::string(it->second.pData, it->second.Size));
+
+    it = entries.find("Shield/ZoneData.sbin");
+    ASSERT_NE(entries.end(), it);
+    EXPECT_EQ(std::string("MiZoneData"), it->second.TypeName);
+    EXPECT_EQ((int64_t)-1, it->second.SourceTime);
+    EXPECT_EQ((uint32_t)1, it->second.Count);
+    EXPECT_EQ(ZONE_DATA, std::string(it->second.pData, it->second.Size));
+
+    snapshot.Close();
+    EXPECT_TRUE(snapshot.GetEntries().empty());
+
+    // Saving again replaces the file
+    ASSERT_TRUE(DefinitionSnapshot::Save(TEST_PATH, TEST_LAYOUT,
+        DefinitionSnapshot::Entries()));
+
+    ASSERT_TRUE(snapshot.Load(TEST_PATH, TEST_LAYOUT));
+    EXPECT_TRUE(snapshot.GetEntries().empty());
+
+    snapshot.Close();
+    std::remove(TEST_PATH);
+}
+
+TEST(DefinitionSnapshot, IgnoresOtherLayout)
+{
+    ASSERT_TRUE(SaveTestSnapshot());
+
+    DefinitionSnapshot snapshot;
+    EXPECT_FALSE(snapshot.Load(TEST_PATH, "other layout"));
+    EXPECT_TRUE(snapshot.GetEntries().empty());
+
+    // A failed load drops the entries of the previous snapshot
+    ASSERT_TRUE(snapshot.Load(TEST_PATH, TEST_LAYOUT));
+    EXPECT_FALSE(snapshot.Load(TEST_PATH, "other layout"));
+    EXPECT_TRUE(snapshot.GetEntries().empty());
+
+    std::remove(TEST_PATH);
+}
+
+TEST(DefinitionSnapshot, IgnoresDamagedFile)
+{
+    DefinitionSnapshot snapshot;
+
+    std::remove(TEST_PATH);
+    EXPECT_FALSE(snapshot.Load(TEST_PATH, TEST_LAYOUT));
+
+    ASSERT_TRUE(SaveTestSnapshot());
+    auto data = ReadTestFile();
+    ASSERT_FALSE(data.empty());
+
+    // Any changed byte fails the header or checksum checks
+    for(size_t i = 0; i < data.size(); i++)
+    {
+        auto damaged = data;
+        damaged[i] = (char)(damaged[i] ^ 0x5A);
+        WriteTestFile(damaged);
+
+        EXPECT_FALSE(snapshot.Load(TEST_PATH, TEST_LAYOUT)) << i;
+        EXPECT_TRUE(snapshot.GetEntries().empty());
+    }
+
+    // So does a partial file
+    for(size_t size = 1; size < data.size(); size += 7)
+    {
+        WriteTestFile(std::vector<char>(data.begin(),
+            data.begin() + (std::ptrdiff_t)size));
+
+        EXPECT_FALSE(snapshot.Load(TEST_PATH, TEST_LAYOUT)) << size;
+        EXPECT_TRUE(snapshot.GetEntries().empty());
+    }
+
+    WriteTestFile(data);
+    EXPECT_TRUE(snapshot.Load(TEST_PATH, TEST_LAYOUT));
+
+    snapshot.Close();
+    std::remove(TEST_PATH);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
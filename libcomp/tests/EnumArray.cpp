@@ -0,0 +1,157 @@
+/**
+ * @file libcomp/tests/EnumArray.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the EnumArray class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <EnumArray.h>
+
+#include <vector>
+
+using namespace libcomp;
+
+enum class TestKey_t : uint8_t
+{
+    A = 0,
+    B = 1,
+    C = 5,
+    D = 7,
+};
+
+typedef EnumArray<TestKey_t, int16_t, 8> TestArray;
+
+TEST(EnumArray, MapFunctions)
+{
+    TestArray values;
+
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(values.find(TestKey_t::B), values.end());
+
+    values[TestKey_t::C] = 3;
+    values[TestKey_t::A] = -2;
+
+    // Reading an unset key sets it to zero like a map
+    EXPECT_EQ(values[TestKey_t::D], 0);
+
+    EXPECT_EQ(values.size(), 3);
+    EXPECT_EQ(values.count(TestKey_t::C), 1);
+    EXPECT_EQ(values.count(TestKey_t::B), 0);
+
+    auto it = values.find(TestKey_t::C);
+    ASSERT_NE(it, values.end());
+    EXPECT_EQ(it->first, TestKey_t::C);
+    EXPECT_EQ(it->second, 3);
+
+    // Only set keys are visited, in key order
+    std::vector<TestKey_t> keys;
+    for(auto pair : values)
+    {
+        keys.push_back(pair.first);
+    }
+
+    EXPECT_EQ(keys, std::vector<TestKey_t>({ TestKey_t::A, TestKey_t::C,
+        TestKey_t::D }));
+
+    EXPECT_EQ(values.erase(TestKey_t::C), 1);
+    EXPECT_EQ(values.erase(TestKey_t::C), 0);
+    EXPECT_EQ(values.size(), 2);
+
+    values.clear();
+    EXPECT_TRUE(values.empty());
+    EXPECT_EQ(values.begin(), values.end());
+}
+
+TEST(EnumArray, BulkFunctions)
+{
+    TestArray values = {
+        { TestKey_t::A, 5 },
+        { TestKey_t::B, -3 },
+        { TestKey_t::C, 100 },
+    };
+
+    TestArray other = {
+        { TestKey_t::B, 4 },
+        { TestKey_t::D, 2 },
+    };
+
+    values.Add(other);
+    EXPECT_EQ(values.size(), 4);
+    EXPECT_EQ(values[TestKey_t::B], 1);
+    EXPECT_EQ(values[TestKey_t::D], 2);
+
+    // Only keys set in both are clamped
+    TestArray mins = {
+        { TestKey_t::A, 10 },
+        { TestKey_t::B, 0 },
+    };
+
+    values.ClampMin(mins);
+    EXPECT_EQ(values[TestKey_t::A], 10);
+    EXPECT_EQ(values[TestKey_t::B], 1);
+    EXPECT_EQ(values[TestKey_t::D], 2);
+
+    TestArray maxs = {
+        { TestKey_t::C, 50 },
+    };
+
+    values.ClampMax(maxs);
+    EXPECT_EQ(values[TestKey_t::C], 50);
+
+    TestArray copy = values;
+    EXPECT_TRUE(copy == values);
+
+    copy[TestKey_t::C] = 51;
+    EXPECT_TRUE(copy != values);
+
+    copy[TestKey_t::C] = 50;
+    EXPECT_TRUE(copy == values);
+
+    // A key set to zero differs from a key that is not set
+    copy.erase(TestKey_t::D);
+    copy[TestKey_t::D] = 0;
+    values[TestKey_t::D] = 0;
+    EXPECT_TRUE(copy == values);
+    copy.erase(TestKey_t::D);
+    EXPECT_TRUE(copy != values);
+
+    values.Fill(7);
+    EXPECT_EQ(values.size(), 8);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,126 @@
+/**
+ * @file libcomp/tests/MappedFile.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the MappedFile class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <MappedFile.h>
+
+#include <cstdio>
+#include <fstream>
+#include <istream>
+#include <string>
+
+using namespace libcomp;
+
+namespace
+{
+
+const char TEST_PATH[] = "MappedFileTest.bin";
+
+void WriteTestFile(const std::string& data)
+{
+    std::ofstream out(TEST_PATH, std::ios::out |
+        std::ios::binary | std::ios::trunc);
+    out.write(data.data(), (std::streamsize)data.size());
+}
+
+} // namespace
+
+TEST(MappedFile, MapsContents)
+{
+    std::string data("mapped\0file", 11);
+    WriteTestFile(data);
+
+    MappedFile file;
+    ASSERT_TRUE(file.Open(TEST_PATH));
+    ASSERT_NE(nullptr, file.GetData());
+    EXPECT_EQ(data.size(), file.GetSize());
+    EXPECT_EQ(data, std::string(file.GetData(), file.GetSize()));
+
+    file.Close();
+    EXPECT_EQ(nullptr, file.GetData());
+    EXPECT_EQ((size_t)0, file.GetSize());
+
+    // Opening again maps the new contents
+    WriteTestFile("other");
+
+    ASSERT_TRUE(file.Open(TEST_PATH));
+    EXPECT_EQ(std::string("other"), std::string(file.GetData(),
+        file.GetSize()));
+
+    file.Close();
+    std::remove(TEST_PATH);
+}
+
+TEST(MappedFile, MissingOrEmpty)
+{
+    std::remove(TEST_PATH);
+
+    MappedFile file;
+    EXPECT_FALSE(file.Open(TEST_PATH));
+    EXPECT_EQ(nullptr, file.GetData());
+
+    WriteTestFile("");
+    EXPECT_FALSE(file.Open(TEST_PATH));
+    EXPECT_EQ(nullptr, file.GetData());
+    EXPECT_EQ((size_t)0, file.GetSize());
+
+    std::remove(TEST_PATH);
+}
+
+TEST(MappedFile, MemoryStreamBuf)
+{
+    const char data[] = "12 34";
+
+    MemoryStreamBuf buffer(data, sizeof(data) - 1);
+    std::istream in(&buffer);
+
+    int a = 0, b = 0;
+    in >> a >> b;
+
+    EXPECT_EQ(12, a);
+    EXPECT_EQ(34, b);
+    EXPECT_TRUE(in.eof());
+
+    in >> a;
+    EXPECT_TRUE(in.fail());
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
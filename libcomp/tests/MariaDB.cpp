@@ -32,6 +32,9 @@
 #include <Account.h>
 #include <DatabaseMariaDB.h>
 
+// Standard C++11 Includes
+#include <algorithm>
+
 using namespace libcomp;
 
 class MariaDBAccount : public objects::Account
@@ -359,6 +362,101 @@ TEST(MariaDB, ChangeSet)
     EXPECT_FALSE(db.IsOpen());
 }
 
+TEST(MariaDB, LoadObjectsIn)
+{
+    auto config = GetConfig();
+    MariaDBAccount::RegisterPersistentType();
+
+    DatabaseMariaDB db(config);
+
+    EXPECT_TRUE(db.Open());
+    EXPECT_TRUE(db.Setup());
+
+    // Enough to need a large and a small batch
+    std::list<libobjgen::UUID> uuids;
+    std::list<std::shared_ptr<MariaDBAccount>> accounts;
+    for(int i = 0; i < 70; i++)
+    {
+        auto account = std::make_shared<MariaDBAccount>();
+        account->Register(account);
+        account->SetUsername(String("bulk%1").Arg(i));
+        account->SetCP(i);
+
+        std::shared_ptr<PersistentObject> obj = account;
+        EXPECT_TRUE(db.InsertSingleObject(obj));
+
+        uuids.push_back(account->GetUUID());
+        accounts.push_back(account);
+    }
+
+    // Repeated, null and unknown values are skipped
+    uuids.push_back(uuids.front());
+    uuids.push_back(NULLUUID);
+    uuids.push_back(libobjgen::UUID::Random());
+
+    auto loaded = db.LoadObjectsIn(typeid(MariaDBAccount).hash_code(),
+        "UID", uuids);
+    EXPECT_EQ(loaded.size(), accounts.size());
+
+    // Already cached objects are refreshed rather than duplicated
+    for(auto account : accounts)
+    {
+        EXPECT_NE(std::find(loaded.begin(), loaded.end(),
+            std::dynamic_pointer_cast<PersistentObject>(account)),
+            loaded.end());
+    }
+
+    EXPECT_TRUE(db.Execute("DROP DATABASE IF EXISTS comp_hack_test;"));
+
+    EXPECT_TRUE(db.Close());
+    EXPECT_FALSE(db.IsOpen());
+}
+
+TEST(MariaDB, QueuedThenDirectUpdate)
+{
+    auto config = GetConfig();
+    MariaDBAccount::RegisterPersistentType();
+
+    auto db = std::make_shared<DatabaseMariaDB>(config);
+
+    EXPECT_TRUE(db->Open());
+    EXPECT_TRUE(db->Setup());
+
+    auto account = std::make_shared<MariaDBAccount>();
+    account->Register(account);
+    account->SetUsername("queued");
+    account->SetCP(0);
+    EXPECT_TRUE(account->Insert(db));
+
+    db->StartTransactionWriter();
+
+    // The queued copy must not overwrite the later direct update
+    account->SetCP(1);
+    db->QueueUpdate(account);
+
+    account->SetCP(2);
+    EXPECT_TRUE(account->Update(db));
+
+    db->StopTransactionWriter();
+    EXPECT_TRUE(db->ProcessTransactionQueue().empty());
+
+    DatabaseQuery q = db->Prepare("SELECT `CP` FROM `Account` "
+        "WHERE `UID` = :UID;");
+    EXPECT_TRUE(q.IsValid());
+    EXPECT_TRUE(q.Bind("UID", account->GetUUID()));
+    EXPECT_TRUE(q.Execute());
+    EXPECT_TRUE(q.Next());
+
+    int64_t cp = 0;
+    EXPECT_TRUE(q.GetValue("CP", cp));
+    EXPECT_EQ(cp, 2);
+
+    EXPECT_TRUE(db->Execute("DROP DATABASE IF EXISTS comp_hack_test;"));
+
+    EXPECT_TRUE(db->Close());
+    EXPECT_FALSE(db->IsOpen());
+}
+
 int main(int argc, char *argv[])
 {
     try
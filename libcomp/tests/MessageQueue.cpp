@@ -0,0 +1,146 @@
+/**
+ * @file libcomp/tests/MessageQueue.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the MessageQueue class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <MessageQueue.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace libcomp;
+
+TEST(MessageQueue, Order)
+{
+    MessageQueue<int> queue;
+
+    std::list<int> msgs;
+    queue.DequeueAny(msgs);
+    EXPECT_TRUE(msgs.empty());
+
+    queue.Enqueue(1);
+
+    std::list<int> batch = { 2, 3, 4 };
+    queue.Enqueue(batch);
+    EXPECT_TRUE(batch.empty());
+
+    queue.Enqueue(5);
+
+    EXPECT_EQ(queue.Dequeue(), 1);
+
+    queue.DequeueAll(msgs);
+    ASSERT_EQ(msgs.size(), 4);
+    EXPECT_EQ(msgs.front(), 2);
+    EXPECT_EQ(msgs.back(), 5);
+}
+
+TEST(MessageQueue, ReleaseOnDestroy)
+{
+    auto value = std::make_shared<int>(7);
+
+    {
+        MessageQueue<std::shared_ptr<int>> queue;
+        queue.Enqueue(value);
+        queue.Enqueue(value);
+
+        EXPECT_EQ(value.use_count(), 3);
+
+        EXPECT_EQ(*queue.Dequeue(), 7);
+        EXPECT_EQ(value.use_count(), 2);
+    }
+
+    EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MessageQueue, MultipleProducers)
+{
+    static const int PRODUCERS = 8;
+    static const int COUNT = 20000;
+
+    MessageQueue<std::pair<int, int>> queue;
+    std::vector<std::thread> producers;
+
+    for(int p = 0; p < PRODUCERS; ++p)
+    {
+        producers.emplace_back([&queue, p]()
+        {
+            for(int i = 0; i < COUNT; ++i)
+            {
+                queue.Enqueue(std::make_pair(p, i));
+            }
+        });
+    }
+
+    std::vector<int> next(PRODUCERS, 0);
+    int received = 0;
+    bool ordered = true;
+
+    // Keep draining even if the order is wrong so the producers can be
+    // joined before the test fails.
+    while(received < PRODUCERS * COUNT)
+    {
+        std::list<std::pair<int, int>> msgs;
+        queue.DequeueAll(msgs);
+
+        for(auto& msg : msgs)
+        {
+            // Messages from one producer must keep their order.
+            if(next[(std::size_t)msg.first] != msg.second)
+            {
+                ordered = false;
+            }
+
+            next[(std::size_t)msg.first] = msg.second + 1;
+        }
+
+        received += (int)msgs.size();
+    }
+
+    for(auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(received, PRODUCERS * COUNT);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -29,6 +29,9 @@
 #include <PopIgnore.h>
 
 #include <Packet.h>
+#include <PacketBufferPool.h>
+
+#include <cstring>
 
 using namespace libcomp;
 
@@ -74,6 +77,74 @@ TEST(Packet, MoveAssignment)
     EXPECT_EQ(String(&a.ReadArray(1)[0], 1), "z");
 }
 
+TEST(Packet, PooledBuffers)
+{
+    auto before = PacketBufferPool::GetStats();
+
+    Packet a;
+    a.WriteU32Little(0xCAFEBABE);
+
+    // Small packets should not take a full size buffer.
+    EXPECT_LT(a.Capacity(), (uint32_t)MAX_PACKET_SIZE);
+
+    // Growing past the buffer must keep the existing data.
+    std::vector<char> big(5000, 'x');
+    a.WriteArray(big);
+
+    EXPECT_EQ(a.Size(), 5004);
+    EXPECT_GE(a.Capacity(), a.Size());
+
+    a.Rewind();
+    EXPECT_EQ(a.ReadU32Little(), 0xCAFEBABE);
+    EXPECT_EQ(a.ReadU8(), 'x');
+
+    // A copy only needs a buffer for the data it holds.
+    Packet small;
+    small.WriteU16Little(1);
+
+    Packet copy(small);
+    EXPECT_EQ(copy.Size(), 2);
+    EXPECT_EQ(copy.Capacity(), small.Capacity());
+
+    // Direct access must make room for the requested size.
+    Packet direct;
+    memset(direct.Direct(MAX_PACKET_SIZE), 0, MAX_PACKET_SIZE);
+    EXPECT_EQ(direct.Capacity(), (uint32_t)MAX_PACKET_SIZE);
+
+    auto after = PacketBufferPool::GetStats();
+    EXPECT_GT(after.Grown, before.Grown);
+}
+
+TEST(Packet, SharedPatches)
+{
+    Packet a;
+    a.WriteU32Little(0x11111111);
+    a.WriteU32Little(0x22222222);
+
+    ReadOnlyPacket shared(std::move(a));
+
+    PacketPatch patch;
+    patch.Offset = 4;
+    memcpy(patch.Value, "\x01\x02\x03\x04", 4);
+
+    ReadOnlyPacket copy(shared);
+    copy.SetPatches({ patch });
+
+    // The shared data must not change.
+    EXPECT_EQ(shared.PeekU32Little(), 0x11111111);
+    EXPECT_TRUE(shared.GetPatches().empty());
+    EXPECT_EQ(copy.GetPatches().size(), 1);
+
+    std::vector<char> out(copy.ConstData(), copy.ConstData() + copy.Size());
+    copy.ApplyPatches(&out[0]);
+
+    EXPECT_EQ(memcmp(&out[0], "\x11\x11\x11\x11\x01\x02\x03\x04", 8), 0);
+
+    // Patches past the end of the packet are rejected.
+    patch.Offset = 6;
+    EXPECT_ANY_THROW(copy.SetPatches({ patch }));
+}
+
 int main(int argc, char *argv[])
 {
     try
@@ -0,0 +1,165 @@
+/**
+ * @file libcomp/tests/PersistentObjectCache.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the PersistentObjectCache class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <Account.h>
+#include <PersistentObjectCache.h>
+
+#include <thread>
+#include <vector>
+
+using namespace libcomp;
+
+TEST(PersistentObjectCache, AddGetRemove)
+{
+    PersistentObjectCache cache;
+
+    auto a = std::make_shared<objects::Account>();
+    auto b = std::make_shared<objects::Account>();
+
+    auto uuid = libobjgen::UUID::Random();
+
+    EXPECT_TRUE(cache.Add(uuid, a));
+    EXPECT_FALSE(cache.Add(uuid, b));
+    EXPECT_EQ(cache.Get(uuid), a);
+    EXPECT_EQ(cache.Get(libobjgen::UUID::Random()), nullptr);
+
+    // Only removed when it belongs to the object given
+    EXPECT_FALSE(cache.Remove(uuid, b));
+    EXPECT_TRUE(cache.Contains(uuid));
+    EXPECT_FALSE(cache.RemoveExpired(uuid));
+
+    // An expired entry can be looked up and replaced
+    a.reset();
+    EXPECT_EQ(cache.Get(uuid), nullptr);
+    EXPECT_TRUE(cache.Add(uuid, b));
+    EXPECT_TRUE(cache.Remove(uuid, b));
+    EXPECT_FALSE(cache.Contains(uuid));
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.Hits, 1);
+    EXPECT_EQ(stats.Misses, 1);
+    EXPECT_EQ(stats.Expired, 1);
+    EXPECT_EQ(stats.Cached, 0);
+}
+
+TEST(PersistentObjectCache, Sweep)
+{
+    PersistentObjectCache cache;
+
+    std::vector<std::shared_ptr<objects::Account>> live;
+
+    // Enough short lived objects that every shard sweeps on its own
+    for(int i = 0; i < 100000; i++)
+    {
+        auto obj = std::make_shared<objects::Account>();
+        cache.Add(libobjgen::UUID::Random(), obj);
+
+        if(0 == (i % 100))
+        {
+            live.push_back(obj);
+        }
+    }
+
+    auto stats = cache.GetStats();
+    EXPECT_GT(stats.Swept, 0);
+    EXPECT_EQ(stats.Cached + stats.Swept, 100000);
+
+    cache.Sweep();
+
+    stats = cache.GetStats();
+    EXPECT_EQ(stats.Cached, live.size());
+    EXPECT_EQ(stats.Swept, 100000 - live.size());
+}
+
+TEST(PersistentObjectCache, Register)
+{
+    auto a = std::make_shared<objects::Account>();
+    ASSERT_TRUE(PersistentObject::Register(a));
+
+    auto uuid = a->GetUUID();
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), a);
+
+    // A duplicate fails to register and must not remove the original
+    // when it is destroyed
+    {
+        auto b = std::make_shared<objects::Account>();
+        EXPECT_FALSE(PersistentObject::Register(b, uuid));
+    }
+
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), a);
+
+    a.reset();
+    EXPECT_EQ(PersistentObject::GetObjectByUUID(uuid), nullptr);
+}
+
+TEST(PersistentObjectCache, Threads)
+{
+    PersistentObjectCache cache;
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; t++)
+    {
+        threads.emplace_back([&cache]()
+        {
+            for(int i = 0; i < 10000; i++)
+            {
+                auto obj = std::make_shared<objects::Account>();
+                auto uuid = libobjgen::UUID::Random();
+
+                EXPECT_TRUE(cache.Add(uuid, obj));
+                EXPECT_EQ(cache.Get(uuid), obj);
+                EXPECT_TRUE(cache.Remove(uuid));
+            }
+        });
+    }
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    auto stats = cache.GetStats();
+    EXPECT_EQ(stats.Hits, 80000);
+    EXPECT_EQ(stats.Cached, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
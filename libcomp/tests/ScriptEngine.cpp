@@ -104,6 +104,41 @@ TEST(ScriptEngine, EvalPrint)
     Log::GetSingletonPtr()->ClearHooks();
 }
 
+TEST(ScriptEngine, Bytecode)
+{
+    std::vector<char> bytecode;
+
+    {
+        ScriptEngine engine;
+
+        EXPECT_TRUE(engine.Compile(
+            "function check(a, b)\n"
+            "{\n"
+            "    return a + b;\n"
+            "}\n", bytecode));
+
+        // Compiling must not run the script
+        EXPECT_TRUE(Sqrat::RootTable(engine.GetVM()).GetFunction(
+            "check").IsNull());
+    }
+
+    ASSERT_FALSE(bytecode.empty());
+
+    ScriptEngine engine;
+
+    EXPECT_TRUE(engine.EvalBytecode(bytecode));
+
+    auto result = Sqrat::RootTable(engine.GetVM()).GetFunction(
+        "check").Evaluate<int32_t>(2, 3);
+
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, 5);
+
+    // Truncated bytecode is rejected
+    bytecode.resize(bytecode.size() / 2);
+    EXPECT_FALSE(engine.EvalBytecode(bytecode));
+}
+
 TEST(ScriptEngine, ReadOnlyPacket)
 {
     String scriptMessages;
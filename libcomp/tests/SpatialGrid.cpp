@@ -0,0 +1,184 @@
+/**
+ * @file libcomp/tests/SpatialGrid.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the SpatialGrid class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <SpatialGrid.h>
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace libcomp;
+
+namespace
+{
+
+struct Position
+{
+    float x;
+    float y;
+};
+
+std::set<int32_t> Radius(const SpatialGrid<int32_t>& grid, float x, float y,
+    float radius)
+{
+    std::set<int32_t> ids;
+
+    grid.QueryRadius(x, y, radius, [&ids](int32_t id, float, float)
+        {
+            ids.insert(id);
+        });
+
+    return ids;
+}
+
+} // namespace
+
+TEST(SpatialGrid, InsertUpdateRemove)
+{
+    SpatialGrid<int32_t> grid(100.0f);
+
+    grid.Insert(1, 0.0f, 0.0f, 1);
+    grid.Insert(2, 50.0f, 50.0f, 2);
+    grid.Insert(3, 1000.0f, -1000.0f, 3);
+
+    EXPECT_EQ(grid.Count(), 3);
+    EXPECT_EQ(grid.CellCount(), 2);
+
+    EXPECT_EQ(Radius(grid, 0.0f, 0.0f, 100.0f), std::set<int32_t>({ 1, 2 }));
+
+    // Move to another cell and back into range
+    EXPECT_TRUE(grid.Update(3, 10.0f, -10.0f));
+    EXPECT_EQ(grid.CellCount(), 2);
+    EXPECT_EQ(Radius(grid, 0.0f, 0.0f, 100.0f),
+        std::set<int32_t>({ 1, 2, 3 }));
+
+    // Re-inserting an ID moves it instead of adding it twice
+    grid.Insert(2, 5000.0f, 5000.0f, 2);
+    EXPECT_EQ(grid.Count(), 3);
+    EXPECT_EQ(Radius(grid, 0.0f, 0.0f, 100.0f), std::set<int32_t>({ 1, 3 }));
+
+    EXPECT_TRUE(grid.Remove(1));
+    EXPECT_FALSE(grid.Remove(1));
+    EXPECT_FALSE(grid.Update(1, 0.0f, 0.0f));
+    EXPECT_EQ(Radius(grid, 0.0f, 0.0f, 100.0f), std::set<int32_t>({ 3 }));
+
+    grid.Clear();
+    EXPECT_EQ(grid.Count(), 0);
+    EXPECT_EQ(grid.CellCount(), 0);
+}
+
+TEST(SpatialGrid, MatchesFullScan)
+{
+    static const int32_t COUNT = 2000;
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> coord(-5000.0f, 5000.0f);
+
+    SpatialGrid<int32_t> grid(500.0f);
+    std::vector<Position> positions((size_t)COUNT);
+
+    for(int32_t i = 0; i < COUNT; ++i)
+    {
+        positions[(size_t)i] = { coord(rng), coord(rng) };
+        grid.Insert(i, positions[(size_t)i].x, positions[(size_t)i].y, i);
+    }
+
+    // Move half of them
+    for(int32_t i = 0; i < COUNT; i += 2)
+    {
+        positions[(size_t)i] = { coord(rng), coord(rng) };
+        grid.Update(i, positions[(size_t)i].x, positions[(size_t)i].y);
+    }
+
+    for(int q = 0; q < 50; ++q)
+    {
+        float x = coord(rng);
+        float y = coord(rng);
+        float radius = (float)(q * 200);
+
+        std::set<int32_t> radiusExpected, rectExpected, coneExpected;
+        for(int32_t i = 0; i < COUNT; ++i)
+        {
+            auto& p = positions[(size_t)i];
+            float dx = p.x - x;
+            float dy = p.y - y;
+
+            if(radius * radius >= (dx * dx) + (dy * dy))
+            {
+                radiusExpected.insert(i);
+
+                float rot = (float)std::atan2(y - p.y, x - p.x);
+                if(rot <= 1.0f && rot >= 0.0f)
+                {
+                    coneExpected.insert(i);
+                }
+            }
+
+            if(p.x >= x - radius && p.x <= x + radius &&
+                p.y >= y && p.y <= y + radius)
+            {
+                rectExpected.insert(i);
+            }
+        }
+
+        EXPECT_EQ(Radius(grid, x, y, radius), radiusExpected);
+
+        std::set<int32_t> rect;
+        grid.QueryRect(x + radius, y + radius, x - radius, y,
+            [&rect](int32_t id, float, float)
+            {
+                rect.insert(id);
+            });
+        EXPECT_EQ(rect, rectExpected);
+
+        std::set<int32_t> cone;
+        grid.QueryCone(x, y, radius, 0.5f, 0.5f,
+            [&cone](int32_t id, float, float)
+            {
+                cone.insert(id);
+            });
+        EXPECT_EQ(cone, coneExpected);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -29,6 +29,7 @@
 #include <PopIgnore.h>
 
 #include <CString.h>
+#include <StringFormat.h>
 
 using namespace libcomp;
 
@@ -269,6 +270,33 @@ TEST(String, ArgInt)
     EXPECT_EQ("0x00ff", String("0x%1").Arg(255, 4, 16, '0'));
 }
 
+TEST(String, Format)
+{
+    EXPECT_EQ("Arguments: a1, b2, c3", String::Format(
+        "Arguments: %2, %1, %3", "b2", "a1", "c3"));
+    EXPECT_EQ("a b a", String::Format("%1 %2 %1", "a", String("b")));
+    EXPECT_EQ("123 -5 7", String::Format("%1 %2 %3", 123, (int16_t)-5,
+        (uint64_t)7));
+    EXPECT_EQ("100% %", String::Format("%1% %", 100));
+
+    // Values are not searched for arguments
+    EXPECT_EQ("%2 b", String::Format("%1 %2", "%2", "b"));
+
+    // Arguments past the values are shifted down like Arg does
+    EXPECT_EQ(String("%1 %2 %3").Arg("a"), String::Format("%1 %2 %3",
+        "a"));
+
+    StringFormat format("idx_%1_%2");
+    EXPECT_EQ("idx_a_b", format.Format("a", std::string("b")));
+    EXPECT_EQ("idx_1_2", format.Format(1, 2));
+
+    bool reporting = String::IsReportingBadArguments();
+    String::SetBadArgumentReporting(false);
+    EXPECT_EQ("Argument 1 is missing: b", String::Format(
+        "Argument 1 is missing: %2", "a", "b"));
+    String::SetBadArgumentReporting(reporting);
+}
+
 TEST(String, ToUpperLower)
 {
     EXPECT_EQ("ABCDEF", String("aBcDeF").ToUpper());
@@ -0,0 +1,139 @@
+/**
+ * @file libcomp/tests/TickScheduler.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the TickScheduler class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <TickScheduler.h>
+
+using namespace libcomp;
+
+typedef std::chrono::milliseconds ms;
+typedef std::chrono::microseconds us;
+
+TEST(TickScheduler, FixedDeadlines)
+{
+    TickScheduler scheduler(ms(100));
+
+    auto start = TickScheduler::Clock::now();
+    EXPECT_EQ(scheduler.Start(start), start + ms(100));
+
+    // Early wakeups do nothing
+    EXPECT_FALSE(scheduler.Advance(start + ms(99)));
+
+    // Waking late does not push the following deadlines back
+    EXPECT_TRUE(scheduler.Advance(start + ms(130)));
+    EXPECT_EQ(scheduler.GetNextDeadline(), start + ms(200));
+
+    scheduler.TickStarted(start + ms(140));
+    scheduler.TickFinished(start + ms(150));
+
+    EXPECT_TRUE(scheduler.Advance(start + ms(200)));
+    scheduler.TickStarted(start + ms(200));
+    scheduler.TickFinished(start + ms(210));
+
+    auto stats = scheduler.GetStats();
+    EXPECT_EQ(stats.Ticks, 2);
+    EXPECT_EQ(stats.Skipped, 0);
+    EXPECT_EQ(stats.Coalesced, 0);
+    EXPECT_EQ(stats.Overruns, 0);
+    EXPECT_EQ(stats.JitterMax, 40000);
+    EXPECT_EQ(stats.JitterAvg, 20000);
+    EXPECT_EQ(stats.DurationMax, 10000);
+}
+
+TEST(TickScheduler, SkipAndCoalesce)
+{
+    TickScheduler scheduler(ms(100));
+
+    auto start = TickScheduler::Clock::now();
+    scheduler.Start(start);
+
+    // Three whole periods missed
+    EXPECT_TRUE(scheduler.Advance(start + ms(450)));
+    EXPECT_EQ(scheduler.GetNextDeadline(), start + ms(500));
+
+    // The queued tick has not started yet
+    EXPECT_FALSE(scheduler.Advance(start + ms(500)));
+    EXPECT_EQ(scheduler.GetNextDeadline(), start + ms(600));
+
+    scheduler.TickStarted(start + ms(550));
+    scheduler.TickFinished(start + ms(800));
+
+    // The long tick missed two more deadlines
+    EXPECT_TRUE(scheduler.Advance(start + ms(800)));
+    EXPECT_EQ(scheduler.GetNextDeadline(), start + ms(900));
+
+    auto stats = scheduler.GetStats();
+    EXPECT_EQ(stats.Ticks, 1);
+    EXPECT_EQ(stats.Skipped, 5);
+    EXPECT_EQ(stats.Coalesced, 1);
+    EXPECT_EQ(stats.Overruns, 1);
+    EXPECT_EQ(stats.JitterMax, 150000);
+}
+
+TEST(TickScheduler, Percentiles)
+{
+    TickScheduler scheduler(ms(100));
+
+    auto now = TickScheduler::Clock::now();
+    scheduler.Start(now);
+
+    // 98 fast ticks and 2 slow ones
+    for(int i = 0; i < 100; i++)
+    {
+        now += ms(100);
+
+        ASSERT_TRUE(scheduler.Advance(now));
+        scheduler.TickStarted(now);
+        scheduler.TickFinished(now + (i < 98 ? us(1000) : us(50000)));
+    }
+
+    auto stats = scheduler.GetStats();
+    EXPECT_EQ(stats.Ticks, 100);
+    EXPECT_EQ(stats.DurationMax, 50000);
+
+    // Buckets are within 12.5% of the recorded values
+    EXPECT_GE(stats.DurationP50, 1000);
+    EXPECT_LE(stats.DurationP50, 1125);
+    EXPECT_GE(stats.DurationP99, 50000 * 7 / 8);
+    EXPECT_LE(stats.DurationP99, 50000);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
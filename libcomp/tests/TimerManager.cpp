@@ -0,0 +1,153 @@
+/**
+ * @file libcomp/tests/TimerManager.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the TimerManager class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <TimerManager.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace libcomp;
+
+typedef std::chrono::steady_clock Clock;
+typedef std::chrono::milliseconds ms;
+
+TEST(TimerManager, RunsInOrder)
+{
+    TimerManager timers;
+
+    std::mutex lock;
+    std::vector<int> order;
+
+    auto now = Clock::now();
+
+    // Spread across several wheel levels and cascades
+    int delays[] = { 600, 5, 300, 0, 257, 40, 255, 256 };
+    for(int delay : delays)
+    {
+        timers.ScheduleEvent(now + ms(delay), [&lock, &order, now](int d)
+            {
+                // Never early and not held back until a later cascade
+                EXPECT_GE(Clock::now(), now + ms(d));
+                EXPECT_LT(Clock::now(), now + ms(d + 100));
+
+                std::lock_guard<std::mutex> guard(lock);
+                order.push_back(d);
+            }, delay);
+    }
+
+    EXPECT_EQ(timers.GetPendingCount(), 8);
+
+    std::this_thread::sleep_for(ms(700));
+
+    std::lock_guard<std::mutex> guard(lock);
+    EXPECT_EQ(order, std::vector<int>({ 0, 5, 40, 255, 256, 257, 300, 600 }));
+    EXPECT_EQ(timers.GetPendingCount(), 0);
+}
+
+TEST(TimerManager, CancelAndPeriodic)
+{
+    TimerManager timers;
+
+    std::atomic<int> oneShot(0);
+    std::atomic<int> periodic(0);
+
+    std::vector<TimerEvent*> events;
+    for(int i = 0; i < 1000; i++)
+    {
+        events.push_back(timers.ScheduleEvent(Clock::now() + ms(50 + i),
+            [&oneShot]()
+            {
+                oneShot++;
+            }));
+    }
+
+    // Cancel every other event
+    for(size_t i = 0; i < events.size(); i += 2)
+    {
+        timers.CancelEvent(events[i]);
+    }
+
+    EXPECT_EQ(timers.GetPendingCount(), 500);
+
+    auto pPeriodic = timers.SchedulePeriodicEvent(ms(20), [&periodic]()
+        {
+            periodic++;
+        });
+
+    std::this_thread::sleep_for(ms(1200));
+
+    EXPECT_EQ(oneShot, 500);
+    EXPECT_GE(periodic, 10);
+
+    timers.CancelEvent(pPeriodic);
+    EXPECT_EQ(timers.GetPendingCount(), 0);
+
+    int count = periodic;
+    std::this_thread::sleep_for(ms(100));
+    EXPECT_EQ(periodic, count);
+}
+
+TEST(TimerManager, MessageQueueDispatch)
+{
+    TimerManager timers;
+
+    auto queue = std::make_shared<MessageQueue<Message::Message*>>();
+    timers.SetMessageQueue(queue);
+
+    std::thread::id runThread;
+    timers.ScheduleEvent(Clock::now() + ms(10), [&runThread]()
+        {
+            runThread = std::this_thread::get_id();
+        });
+
+    // The timer thread only queues the message
+    auto pMessage = dynamic_cast<Message::Execute*>(queue->Dequeue());
+    ASSERT_NE(pMessage, nullptr);
+
+    pMessage->Run();
+    delete pMessage;
+
+    EXPECT_EQ(runThread, std::this_thread::get_id());
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
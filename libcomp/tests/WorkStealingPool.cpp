@@ -0,0 +1,157 @@
+/**
+ * @file libcomp/tests/WorkStealingPool.cpp
+ * @ingroup libcomp
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the WorkStealingPool class.
+ *
+ * This file is part of the COMP_hack Library (libcomp).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <WorkStealingPool.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+using namespace libcomp;
+
+TEST(WorkStealingPool, RunsEveryTask)
+{
+    WorkStealingPool pool(3, "test");
+    EXPECT_EQ(pool.GetConcurrency(), 4);
+
+    std::vector<int> results(100, 0);
+
+    for(int batch = 1; batch <= 50; ++batch)
+    {
+        std::vector<std::function<void()>> tasks;
+        for(size_t i = 0; i < results.size(); ++i)
+        {
+            tasks.push_back([&results, i]()
+                {
+                    results[i]++;
+                });
+        }
+
+        pool.Run(tasks);
+        EXPECT_TRUE(tasks.empty());
+
+        for(int value : results)
+        {
+            ASSERT_EQ(value, batch);
+        }
+    }
+}
+
+TEST(WorkStealingPool, StealsFromBusyThreads)
+{
+    WorkStealingPool pool(2, "test");
+
+    std::atomic<int> count(0);
+    std::vector<std::function<void()>> tasks;
+
+    // One slow task followed by many short ones dealt to the same thread
+    for(int i = 0; i < 30; ++i)
+    {
+        tasks.push_back([&count, i]()
+            {
+                if(0 == i)
+                {
+                    std::this_thread::sleep_for(
+                        std::chrono::milliseconds(50));
+                }
+
+                count++;
+            });
+    }
+
+    pool.Run(tasks);
+    EXPECT_EQ(count.load(), 30);
+}
+
+TEST(WorkStealingPool, NoThreads)
+{
+    WorkStealingPool pool(0, "test");
+    EXPECT_EQ(pool.GetConcurrency(), 1);
+
+    int count = 0;
+    std::vector<std::function<void()>> tasks = {
+        [&count]() { count++; },
+        [&count]() { count++; },
+    };
+
+    pool.Run(tasks);
+    EXPECT_EQ(count, 2);
+}
+
+TEST(WorkStealingPool, RethrowsTaskException)
+{
+    for(size_t threadCount : { (size_t)0, (size_t)3 })
+    {
+        WorkStealingPool pool(threadCount, "test");
+
+        std::atomic<int> count(0);
+        std::vector<std::function<void()>> tasks;
+
+        for(int i = 0; i < 20; ++i)
+        {
+            tasks.push_back([&count, i]()
+                {
+                    count++;
+
+                    if(5 == i)
+                    {
+                        throw std::runtime_error("task failed");
+                    }
+                });
+        }
+
+        EXPECT_THROW(pool.Run(tasks), std::runtime_error);
+
+        // Every other task still ran and the pool is usable again
+        EXPECT_EQ(count.load(), 20);
+        EXPECT_TRUE(tasks.empty());
+
+        tasks.push_back([&count]() { count++; });
+        tasks.push_back([&count]() { count++; });
+
+        EXPECT_NO_THROW(pool.Run(tasks));
+        EXPECT_EQ(count.load(), 22);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -177,6 +177,28 @@ bool libobjgen::UUID::IsNull() const
     return 0 == mTimeAndVersion && 0 == mClockSequenceAndNode;
 }
 
+size_t libobjgen::UUID::Hash() const
+{
+    return (size_t)Hash64();
+}
+
+uint64_t libobjgen::UUID::Hash64() const
+{
+    // Fold both halves together and finish with the MurmurHash3 mixer so
+    // every output bit depends on all 128 input bits. Random UUIDs would
+    // hash fine on their own but the version bits never change.
+    uint64_t h = mTimeAndVersion ^ (mClockSequenceAndNode *
+        0x9E3779B97F4A7C15ULL);
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ULL;
+    h ^= h >> 33;
+
+    return h;
+}
+
 bool libobjgen::UUID::operator==(UUID other) const
 {
     return mTimeAndVersion == other.mTimeAndVersion &&
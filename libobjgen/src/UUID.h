@@ -31,6 +31,7 @@
 #include <stdint.h>
 
 // Standard C++ Includes
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -52,6 +53,8 @@ public:
     std::vector<char> ToData() const;
 
     bool IsNull() const;
+    size_t Hash() const;
+    uint64_t Hash64() const;
 
     bool operator==(UUID other) const;
     bool operator!=(UUID other) const;
@@ -63,4 +66,19 @@ private:
 
 } // namespace libcomp
 
+namespace std
+{
+    template<>
+    struct hash<libobjgen::UUID>
+    {
+        typedef libobjgen::UUID argument_type;
+        typedef std::size_t result_type;
+
+        result_type operator()(const argument_type& uuid) const
+        {
+            return uuid.Hash();
+        }
+    };
+} // namespace std
+
 #endif // LIBOBJGEN_SRC_UUID_H
@@ -74,6 +74,43 @@ TEST(UUID, BinaryConversion)
     EXPECT_EQ(memcmp(&uuidDataCopy[0], &uuidData[0], sizeof(uuidData)), 0);
 }
 
+TEST(UUID, Hash)
+{
+    // Both halves of the UUID change the hash
+    UUID a("e70ebdd0-7a79-4bff-9e1f-1d8c0a3a6fb6");
+    UUID b("e70ebdd0-7a79-4bff-9e1f-1d8c0a3a6fb7");
+    UUID c("f70ebdd0-7a79-4bff-9e1f-1d8c0a3a6fb6");
+
+    EXPECT_NE(a.Hash64(), b.Hash64());
+    EXPECT_NE(a.Hash64(), c.Hash64());
+    EXPECT_EQ(a.Hash64(), UUID(a.ToString()).Hash64());
+    EXPECT_EQ(a.Hash(), (size_t)a.Hash64());
+
+    // The high and the low 32 bits must both spread on their own as one
+    // picks a cache shard and the other a bucket inside it
+    const size_t bucketCount = 64;
+    const size_t uuidCount = bucketCount * 1000;
+
+    std::vector<size_t> high(bucketCount, 0);
+    std::vector<size_t> low(bucketCount, 0);
+
+    for(size_t i = 0; i < uuidCount; i++)
+    {
+        uint64_t hash = UUID::Random().Hash64();
+
+        high[(size_t)(hash >> 32) % bucketCount]++;
+        low[(size_t)(hash & 0xFFFFFFFFULL) % bucketCount]++;
+    }
+
+    for(size_t i = 0; i < bucketCount; i++)
+    {
+        EXPECT_GT(high[i], (size_t)800) << i;
+        EXPECT_LT(high[i], (size_t)1200) << i;
+        EXPECT_GT(low[i], (size_t)800) << i;
+        EXPECT_LT(low[i], (size_t)1200) << i;
+    }
+}
+
 int main(int argc, char *argv[])
 {
     try
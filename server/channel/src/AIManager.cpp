@@ -60,6 +60,7 @@ using namespace channel;
 
 std::unordered_map<std::string,
     std::shared_ptr<libcomp::ScriptEngine>> AIManager::sPreparedScripts;
+std::mutex AIManager::sScriptLock;
 
 namespace libcomp
 {
@@ -114,6 +115,8 @@ bool AIManager::Prepare(const std::shared_ptr<ActiveEntityState>& eState,
     std::shared_ptr<libcomp::ScriptEngine> aiEngine;
     if(!aiType.IsEmpty())
     {
+        std::unique_lock<std::mutex> lock(sScriptLock);
+
         auto it = sPreparedScripts.find(aiType.C());
         if(it == sPreparedScripts.end())
         {
@@ -129,7 +132,7 @@ bool AIManager::Prepare(const std::shared_ptr<ActiveEntityState>& eState,
             aiEngine = std::make_shared<libcomp::ScriptEngine>();
             aiEngine->Using<AIManager>();
 
-            if(!aiEngine->Eval(script->Source))
+            if(!aiEngine->EvalBytecode(script->Bytecode))
             {
                 LOG_ERROR(libcomp::String("AI type '%1' is not a valid AI script\n")
                     .Arg(aiType));
@@ -143,6 +146,11 @@ bool AIManager::Prepare(const std::shared_ptr<ActiveEntityState>& eState,
             aiEngine = it->second;
         }
 
+        lock.unlock();
+
+        std::lock_guard<std::recursive_mutex> engineLock(
+            aiEngine->GetLock());
+
         Sqrat::Function f(Sqrat::RootTable(aiEngine->GetVM()), "prepare");
         if(!f.IsNull())
         {
@@ -182,12 +190,23 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
     // Update enemy states first
     if(updated.size() > 0)
     {
+        auto zoneManager = mServer.lock()->GetZoneManager();
+        bool interest = zoneManager->InterestManagementEnabled();
+
         auto zConnections = zone->GetConnectionList();
         RelativeTimeMap timeMap;
         for(auto enemy : updated)
         {
             // Update the clients with what the enemy is doing
 
+            // Only send to the clients the enemy is visible to
+            auto eConnections = zConnections;
+            if(interest)
+            {
+                zoneManager->FilterInterestedConnections(zone,
+                    enemy->GetEntityID(), eConnections);
+            }
+
             // Check if the enemy's position or rotation has updated
             if(now == enemy->GetOriginTicks())
             {
@@ -204,7 +223,7 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
 
                     timeMap[p.Size()] = now;
                     timeMap[p.Size() + 4] = enemy->GetDestinationTicks();
-                    ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
+                    ChannelClientConnection::SendRelativeTimePacket(eConnections, p,
                         timeMap, true);
                 }
                 else if(enemy->IsRotating())
@@ -216,7 +235,7 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
 
                     timeMap[p.Size()] = now;
                     timeMap[p.Size() + 4] = enemy->GetDestinationTicks();
-                    ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
+                    ChannelClientConnection::SendRelativeTimePacket(eConnections, p,
                         timeMap, true);
                 }
                 else
@@ -230,7 +249,7 @@ void AIManager::UpdateActiveStates(const std::shared_ptr<Zone>& zone,
                     p.WriteFloat(enemy->GetDestinationY());
 
                     timeMap[p.Size()] = enemy->GetDestinationTicks();
-                    ChannelClientConnection::SendRelativeTimePacket(zConnections, p,
+                    ChannelClientConnection::SendRelativeTimePacket(eConnections, p,
                         timeMap, true);
                 }
             }
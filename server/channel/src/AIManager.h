@@ -180,6 +180,10 @@ private:
             return false;
         }
 
+        // Script engines are shared by every entity with the same AI type
+        // and can be used from more than one thread
+        std::lock_guard<std::recursive_mutex> lock(script->GetLock());
+
         Sqrat::Function f(Sqrat::RootTable(script->GetVM()), functionName.C());
 
         auto scriptResult = !f.IsNull() ? f.Evaluate<T>(eState, this, now) : 0;
@@ -217,6 +221,9 @@ private:
     static std::unordered_map<std::string,
         std::shared_ptr<libcomp::ScriptEngine>> sPreparedScripts;
 
+    /// Static lock for the prepared scripts map
+    static std::mutex sScriptLock;
+
     /// Pointer to the channel server.
     std::weak_ptr<ChannelServer> mServer;
 };
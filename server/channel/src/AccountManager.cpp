@@ -27,6 +27,7 @@
 #include "AccountManager.h"
 
 // libcomp Includes
+#include <Database.h>
 #include <DefinitionManager.h>
 #include <Log.h>
 #include <PacketCodes.h>
@@ -42,7 +43,9 @@
 #include <CharacterProgress.h>
 #include <Clan.h>
 #include <ClanMember.h>
+#include <Demon.h>
 #include <DemonBox.h>
+#include <EntityStats.h>
 #include <EventState.h>
 #include <Expertise.h>
 #include <FriendSettings.h>
@@ -55,6 +58,11 @@
 #include <MiPossessionData.h>
 #include <Quest.h>
 #include <ServerZone.h>
+#include <StatusEffect.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <chrono>
 
 // channel Includes
 #include "ChannelServer.h"
@@ -68,7 +76,7 @@
 using namespace channel;
 
 AccountManager::AccountManager(const std::weak_ptr<ChannelServer>& server)
-    : mServer(server)
+    : mServer(server), mLoginStats()
 {
 }
 
@@ -128,7 +136,24 @@ void AccountManager::HandleLoginResponse(const std::shared_ptr<
     libcomp::Packet reply;
     reply.WritePacketCode(ChannelToClientPacketCode_t::PACKET_LOGIN);
 
-    if(InitializeCharacter(character, state))
+    auto loadStart = std::chrono::steady_clock::now();
+    bool initialized = InitializeCharacter(character, state);
+    uint64_t loadTime = (uint64_t)std::chrono::duration_cast<
+        std::chrono::microseconds>(std::chrono::steady_clock::now() -
+        loadStart).count();
+
+    {
+        std::lock_guard<std::mutex> lock(mLoginStatsLock);
+        mLoginStats.Logins++;
+        mLoginStats.TotalTime += loadTime;
+        mLoginStats.MaxTime = std::max(mLoginStats.MaxTime, loadTime);
+        mLoginStats.LastTime = loadTime;
+    }
+
+    LOG_DEBUG(libcomp::String("Character data for account '%1' loaded in"
+        " %2us\n").Arg(state->GetAccountUID().ToString()).Arg(loadTime));
+
+    if(initialized)
     {
         auto definitionManager = server->GetDefinitionManager();
         auto demon = character->GetActiveDemon().Get();
@@ -353,6 +378,12 @@ void AccountManager::SendCPBalance(const std::shared_ptr<
     client->SendPacket(reply);
 }
 
+AccountManager::LoginStats AccountManager::GetLoginStats()
+{
+    std::lock_guard<std::mutex> lock(mLoginStatsLock);
+    return mLoginStats;
+}
+
 bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
     objects::Character>& character, channel::ClientState* state)
 {
@@ -413,6 +444,67 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
 
     state->SetAccountWorldData(worldData);
 
+    // Load the objects the character references in bulk, one query per
+    // type, instead of one query per reference. The references below then
+    // find them in the object cache. The loaded objects only need to be
+    // held here until their references have taken them.
+    std::list<std::shared_ptr<libcomp::PersistentObject>> prefetched;
+    auto prefetch = [&](size_t typeHash,
+        const std::list<libobjgen::UUID>& uuids)
+    {
+        prefetched.splice(prefetched.end(), libcomp::PersistentObject::
+            LoadObjectsByUUID(typeHash, db, uuids));
+    };
+
+    std::list<libobjgen::UUID> itemBoxUIDs;
+    for(auto itemBox : character->GetItemBoxes())
+    {
+        itemBoxUIDs.push_back(itemBox.GetUUID());
+    }
+
+    for(auto itemBox : worldData->GetItemBoxes())
+    {
+        itemBoxUIDs.push_back(itemBox.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> demonBoxUIDs;
+    demonBoxUIDs.push_back(character->GetCOMP().GetUUID());
+    for(auto box : worldData->GetDemonBoxes())
+    {
+        demonBoxUIDs.push_back(box.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> expertiseUIDs;
+    for(auto expertise : character->GetExpertises())
+    {
+        expertiseUIDs.push_back(expertise.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> effectUIDs;
+    for(auto effect : character->GetStatusEffects())
+    {
+        effectUIDs.push_back(effect.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> hotbarUIDs;
+    for(auto hotbar : character->GetHotbars())
+    {
+        hotbarUIDs.push_back(hotbar.GetUUID());
+    }
+
+    std::list<libobjgen::UUID> questUIDs;
+    for(auto qPair : character->GetQuests())
+    {
+        questUIDs.push_back(qPair.second.GetUUID());
+    }
+
+    prefetch(typeid(objects::ItemBox).hash_code(), itemBoxUIDs);
+    prefetch(typeid(objects::DemonBox).hash_code(), demonBoxUIDs);
+    prefetch(typeid(objects::Expertise).hash_code(), expertiseUIDs);
+    prefetch(typeid(objects::StatusEffect).hash_code(), effectUIDs);
+    prefetch(typeid(objects::Hotbar).hash_code(), hotbarUIDs);
+    prefetch(typeid(objects::Quest).hash_code(), questUIDs);
+
     // Bazaar
     if(!worldData->GetBazaarData().IsNull())
     {
@@ -516,6 +608,16 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
         allBoxes.push_back(itemBox);
     }
 
+    // Load the items of every box together
+    std::unordered_map<libobjgen::UUID, std::list<
+        std::shared_ptr<objects::Item>>> boxItems;
+    for(auto obj : db->LoadObjectsIn(typeid(objects::Item).hash_code(),
+        "ItemBox", itemBoxUIDs))
+    {
+        auto item = std::dynamic_pointer_cast<objects::Item>(obj);
+        boxItems[item->GetItemBox().GetUUID()].push_back(item);
+    }
+
     for(auto itemBox : allBoxes)
     {
         if(itemBox.IsNull()) continue;
@@ -528,9 +630,7 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
             return false;
         }
 
-        // Load all items together
-        auto allBoxItems = objects::Item::LoadItemListByItemBox(db,
-            itemBox.Get());
+        auto& allBoxItems = boxItems[itemBox.GetUUID()];
 
         // Check to make sure all items in slots in the ItemBox are valid
         std::set<size_t> openSlots;
@@ -589,6 +689,15 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
         }
     }
 
+    // Equipment not found in a box
+    std::list<libobjgen::UUID> equipUIDs;
+    for(auto equip : character->GetEquippedItems())
+    {
+        equipUIDs.push_back(equip.GetUUID());
+    }
+
+    prefetch(typeid(objects::Item).hash_code(), equipUIDs);
+
     // Equipment
     for(auto equip : character->GetEquippedItems())
     {
@@ -647,6 +756,43 @@ bool AccountManager::InitializeCharacter(libcomp::ObjectReference<
         demonBoxes.push_back(box);
     }
 
+    // Load the demons in every box then their stats, skills and effects
+    std::list<libobjgen::UUID> demonUIDs;
+    for(auto box : demonBoxes)
+    {
+        if(!box.IsNull() && box.Get(db))
+        {
+            for(auto demon : box->GetDemons())
+            {
+                demonUIDs.push_back(demon.GetUUID());
+            }
+        }
+    }
+
+    std::list<libobjgen::UUID> statsUIDs;
+    std::list<libobjgen::UUID> iSkillUIDs;
+    std::list<libobjgen::UUID> demonEffectUIDs;
+    for(auto demon : libcomp::PersistentObject::LoadObjectsByUUID<
+        objects::Demon>(db, demonUIDs))
+    {
+        prefetched.push_back(demon);
+
+        statsUIDs.push_back(demon->GetCoreStats().GetUUID());
+        for(auto iSkill : demon->GetInheritedSkills())
+        {
+            iSkillUIDs.push_back(iSkill.GetUUID());
+        }
+
+        for(auto effect : demon->GetStatusEffects())
+        {
+            demonEffectUIDs.push_back(effect.GetUUID());
+        }
+    }
+
+    prefetch(typeid(objects::EntityStats).hash_code(), statsUIDs);
+    prefetch(typeid(objects::InheritedSkill).hash_code(), iSkillUIDs);
+    prefetch(typeid(objects::StatusEffect).hash_code(), demonEffectUIDs);
+
     for(auto box : demonBoxes)
     {
         if(box.IsNull()) continue;
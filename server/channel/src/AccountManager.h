@@ -30,6 +30,9 @@
 // channel Includes
 #include "ChannelClientConnection.h"
 
+// Standard C++11 Includes
+#include <mutex>
+
 namespace libcomp
 {
 
@@ -138,6 +141,30 @@ public:
     void SendCPBalance(const std::shared_ptr<
         channel::ChannelClientConnection>& client);
 
+    /**
+     * Timing of the character data loaded when logging in.
+     */
+    struct LoginStats
+    {
+        /// Number of logins timed
+        uint64_t Logins;
+
+        /// Total time spent loading characters in microseconds
+        uint64_t TotalTime;
+
+        /// Longest single character load in microseconds
+        uint64_t MaxTime;
+
+        /// Most recent character load in microseconds
+        uint64_t LastTime;
+    };
+
+    /**
+     * Get the timing of the character data loaded when logging in.
+     * @return Login timing information
+     */
+    LoginStats GetLoginStats();
+
 private:
     /**
      * Create/load character data for use upon logging in.
@@ -209,6 +236,12 @@ private:
 
     /// Pointer to the channel server
     std::weak_ptr<ChannelServer> mServer;
+
+    /// Timing of the character data loaded when logging in
+    LoginStats mLoginStats;
+
+    /// Lock for the login timing
+    std::mutex mLoginStatsLock;
 };
 
 } // namespace channel
@@ -178,6 +178,8 @@ void ActiveEntityState::Stop(uint64_t now)
     SetOriginY(GetCurrentY());
     SetOriginRotation(GetCurrentRotation());
     SetOriginTicks(now);
+
+    UpdateZonePosition();
 }
 
 bool ActiveEntityState::IsAlive() const
@@ -324,6 +326,11 @@ void ActiveEntityState::RefreshCurrentPosition(uint64_t now)
             SetCurrentX(destX);
             SetCurrentY(destY);
             SetCurrentRotation(destRot);
+
+            if(xDiff || yDiff)
+            {
+                UpdateZonePosition();
+            }
         }
         else
         {
@@ -340,6 +347,11 @@ void ActiveEntityState::RefreshCurrentPosition(uint64_t now)
                 SetCurrentX(destX);
                 SetCurrentY(destY);
                 SetCurrentRotation(destRot);
+
+                if(xDiff || yDiff)
+                {
+                    UpdateZonePosition();
+                }
                 return;
             }
 
@@ -351,6 +363,8 @@ void ActiveEntityState::RefreshCurrentPosition(uint64_t now)
 
                 SetCurrentX(newX);
                 SetCurrentY(newY);
+
+                UpdateZonePosition();
             }
 
             if(rotDiff)
@@ -368,6 +382,16 @@ void ActiveEntityState::RefreshCurrentPosition(uint64_t now)
     }
 }
 
+void ActiveEntityState::UpdateZonePosition()
+{
+    auto zone = mCurrentZone;
+    if(zone)
+    {
+        zone->UpdateActiveEntityPosition(GetEntityID(), GetCurrentX(),
+            GetCurrentY());
+    }
+}
+
 void ActiveEntityState::ExpireStatusTimes(uint64_t now)
 {
     auto statusTimes = GetStatusTimes();
@@ -1407,6 +1431,19 @@ int8_t ActiveEntityState::GetNextActivatedAbilityID()
     return next;
 }
 
+TokuseiEvaluationCache ActiveEntityState::GetTokuseiEvaluations()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mTokuseiEvaluations;
+}
+
+void ActiveEntityState::SetTokuseiEvaluations(const std::unordered_map<int32_t,
+    bool>& evaluated, const TokuseiEvaluationCache::Inputs& inputs)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    mTokuseiEvaluations.Set(evaluated, inputs);
+}
+
 void ActiveEntityState::SetStatusEffects(
     const std::list<libcomp::ObjectReference<objects::StatusEffect>>& effects)
 {
@@ -2132,11 +2169,11 @@ const std::set<CorrectTbl> BASE_STATS =
 
 void ActiveEntityState::AdjustStats(
     const std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments,
-    libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    CorrectTblArray& stats,
     std::shared_ptr<objects::CalculatedEntityState> calcState, bool baseMode)
 {
     std::set<CorrectTbl> removed;
-    libcomp::EnumMap<CorrectTbl, int32_t> percentSums;
+    libcomp::EnumArray<CorrectTbl, int32_t, CORRECT_TBL_COUNT> percentSums;
     for(auto ct : adjustments)
     {
         auto tblID = ct->GetID();
@@ -2293,7 +2330,7 @@ void ActiveEntityState::AdjustStats(
 
 void ActiveEntityState::BaseStatsCalculated(libcomp::DefinitionManager* definitionManager,
     std::shared_ptr<objects::CalculatedEntityState> calcState,
-    libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    CorrectTblArray& stats,
     std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments)
 {
     (void)definitionManager;
@@ -2304,7 +2341,7 @@ void ActiveEntityState::BaseStatsCalculated(libcomp::DefinitionManager* definiti
     calcState->SetPendingSkillTokuseiFinal(calcState->GetPendingSkillTokusei());
 }
 
-void ActiveEntityState::UpdateNRAChances(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+void ActiveEntityState::UpdateNRAChances(CorrectTblArray& stats,
     std::shared_ptr<objects::CalculatedEntityState> calcState,
     const std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments)
 {
@@ -2461,7 +2498,7 @@ uint8_t ActiveEntityState::RecalculateDemonStats(
     auto battleData = demonData->GetBattleData();
     auto cs = GetCoreStats();
 
-    libcomp::EnumMap<CorrectTbl, int16_t> stats;
+    CorrectTblArray stats;
     for(size_t i = 0; i < 126; i++)
     {
         CorrectTbl tblID = (CorrectTbl)i;
@@ -2585,7 +2622,7 @@ const std::set<CorrectTbl> VISIBLE_STATS =
         CorrectTbl::MDEF
     };
 
-uint8_t ActiveEntityState::CompareAndResetStats(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+uint8_t ActiveEntityState::CompareAndResetStats(CorrectTblArray& stats,
     int32_t extraHP)
 {
     uint8_t result = 0;
@@ -28,6 +28,7 @@
 #define SERVER_CHANNEL_SRC_ACTIVEENTITYSTATE_H
 
 // libcomp Includes
+#include <EnumArray.h>
 #include <EnumMap.h>
 
 // objects Includes
@@ -37,6 +38,9 @@
 #include <StatusEffect.h>
 #include <TokuseiCondition.h>
 
+// channel Includes
+#include "TokuseiEvaluationCache.h"
+
 // Standard C++11 includes
 #include <map>
 
@@ -99,6 +103,13 @@ class DefinitionManager;
 typedef objects::MiCorrectTbl::ID_t CorrectTbl;
 typedef std::unordered_map<uint32_t, std::pair<uint8_t, bool>> AddStatusEffectMap;
 
+/// Number of CorrectTbl values an entity has
+const size_t CORRECT_TBL_COUNT = 128;
+
+/// Every CorrectTbl value of an entity stored by ID
+typedef libcomp::EnumArray<CorrectTbl, int16_t,
+    CORRECT_TBL_COUNT> CorrectTblArray;
+
 namespace channel
 {
 
@@ -293,6 +304,14 @@ public:
      */
     void RefreshCurrentPosition(uint64_t now);
 
+    /**
+     * Update the entity's position in the spatial index of the zone it
+     * is currently in. This is handled by @ref Stop and
+     * @ref RefreshCurrentPosition but must be called by anything else
+     * that sets the current X or Y position directly.
+     */
+    void UpdateZonePosition();
+
     /**
      * Expire any status times that have passed
      * @param now Current timestamp of the server
@@ -572,6 +591,22 @@ public:
      */
     int8_t GetNextActivatedAbilityID();
 
+    /**
+     * Get the result of each direct tokusei's conditions from the last
+     * time they were evaluated for the entity.
+     * @return Copy of the last evaluated results and their inputs
+     */
+    TokuseiEvaluationCache GetTokuseiEvaluations();
+
+    /**
+     * Set the result of each direct tokusei's conditions for the entity.
+     * @param evaluated Map of tokusei IDs to their evaluated result
+     * @param inputs Value of every tracked condition input during the
+     *  evaluation
+     */
+    void SetTokuseiEvaluations(const std::unordered_map<int32_t,
+        bool>& evaluated, const TokuseiEvaluationCache::Inputs& inputs);
+
 protected:
     /**
      * Set the status effects currently on the entity
@@ -647,7 +682,7 @@ protected:
      *  values will be updated immediately.
      */
     void AdjustStats(const std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments,
-        libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+        CorrectTblArray& stats,
         std::shared_ptr<objects::CalculatedEntityState> calcState, bool baseMode);
 
     /**
@@ -666,7 +701,7 @@ protected:
      */
     virtual void BaseStatsCalculated(libcomp::DefinitionManager* definitionManager,
         std::shared_ptr<objects::CalculatedEntityState> calcState,
-        libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+        CorrectTblArray& stats,
         std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments);
 
     /**
@@ -679,7 +714,7 @@ protected:
      * @param adjustments List of adjustments to the correct table values supplied
      *  by equipment
      */
-    void UpdateNRAChances(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    void UpdateNRAChances(CorrectTblArray& stats,
         std::shared_ptr<objects::CalculatedEntityState> calcState,
         const std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments = {});
 
@@ -743,7 +778,7 @@ protected:
      *  the world (for party members etc), 0 if no change resulted from the
      *  recalculation
      */
-    uint8_t CompareAndResetStats(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    uint8_t CompareAndResetStats(CorrectTblArray& stats,
         int32_t extraHP = 0);
 
     /// Map of active status effects by effect type ID
@@ -797,6 +832,11 @@ protected:
     /// Next available activated ability ID
     int8_t mNextActivatedAbilityID;
 
+    /// Result of the direct tokusei conditions the last time they were
+    /// evaluated, used to skip unaffected conditions when tokusei are
+    /// recalculated for a specific set of changes
+    TokuseiEvaluationCache mTokuseiEvaluations;
+
     /// Map of timestamps associated to AI specific actions
     std::unordered_map<std::string, uint64_t> mActionTimes;
 
@@ -28,6 +28,9 @@
 
 #include "ChannelServer.h"
 
+// Standard C++11 Includes
+#include <cstring>
+
 using namespace channel;
 
 ChannelClientConnection::ChannelClientConnection(asio::ip::tcp::socket& socket,
@@ -105,17 +108,33 @@ void ChannelClientConnection::SendRelativeTimePacket(
     libcomp::Packet& packet, const RelativeTimeMap& timeMap,
     bool queue)
 {
+    // Copy the payload once and share it between every client. Only the
+    // converted timestamps are stored per client and they are written over
+    // the shared data when the outgoing packets are prepared.
+    libcomp::Packet payload(packet);
+    libcomp::ReadOnlyPacket shared(std::move(payload));
+
     for(auto client : clients)
     {
-        libcomp::Packet pCopy(packet);
-
         auto state = client->GetClientState();
+
+        std::vector<libcomp::PacketPatch> patches;
+        patches.reserve(timeMap.size());
+
         for(auto tPair : timeMap)
         {
-            pCopy.Seek(tPair.first);
-            pCopy.WriteFloat(state->ToClientTime(tPair.second));
+            ClientTime clientTime = state->ToClientTime(tPair.second);
+
+            libcomp::PacketPatch patch;
+            patch.Offset = tPair.first;
+            memcpy(patch.Value, &clientTime, sizeof(patch.Value));
+
+            patches.push_back(patch);
         }
 
+        libcomp::ReadOnlyPacket pCopy(shared);
+        pCopy.SetPatches(std::move(patches));
+
         if(queue)
         {
             client->QueuePacket(pCopy);
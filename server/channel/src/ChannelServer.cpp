@@ -27,6 +27,7 @@
 #include "ChannelServer.h"
 
 // libcomp Includes
+#include <Constants.h>
 #include <DefinitionManager.h>
 #include <Log.h>
 #include <ManagerSystem.h>
@@ -64,7 +65,8 @@ ChannelServer::ChannelServer(const char *szProgram,
     mActionManager(0), mAIManager(0), mCharacterManager(0), mChatManager(0),
     mEventManager(0), mSkillManager(0), mZoneManager(0), mDefinitionManager(0),
     mServerDataManager(0), mRecalcTimeDependents(false), mMaxEntityID(0),
-    mMaxObjectID(0), mTickRunning(true)
+    mMaxObjectID(0), mTickScheduler(std::chrono::milliseconds(TICK_DELTA)),
+    mTickRunning(true)
 {
 }
 
@@ -91,6 +93,11 @@ bool ChannelServer::Initialize()
     auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(mConfig);
 
     mDefinitionManager = new libcomp::DefinitionManager();
+    if(conf)
+    {
+        mDefinitionManager->SetSnapshotPath(conf->GetDefinitionSnapshot());
+    }
+
     if(!mDefinitionManager->LoadAllData(GetDataStore()))
     {
         return false;
@@ -134,6 +141,10 @@ bool ChannelServer::Initialize()
     auto systemManager = std::make_shared<channel::ManagerSystem>(self);
     mQueueWorker.AddManager(systemManager);
 
+    // Expired one-shot timer events, including work from ScheduleWork,
+    // run on the queue worker like the rest of the game logic.
+    mTimerManager.SetMessageQueue(mQueueWorker.GetMessageQueue());
+
     // Map packet parsers to supported packets
     auto clientPacketManager = std::make_shared<ManagerClientPacket>(self);
     clientPacketManager->AddParser<Parsers::Login>(
@@ -540,6 +551,11 @@ bool ChannelServer::Initialize()
         return false;
     }
 
+    if(!mFusionManager->Initialize())
+    {
+        return false;
+    }
+
     mZoneManager = new ZoneManager(channelPtr);
     mZoneManager->LoadGeometry();
 
@@ -591,6 +607,34 @@ void ChannelServer::Cleanup()
         mTickThread.join();
     }
 
+    // Stop everything that can queue database changes before the final
+    // write so nothing is queued after the writers are gone
+    mQueueWorker.Join();
+
+    for(auto worker : mWorkers)
+    {
+        worker->Join();
+    }
+
+    // Write anything still queued before the connections close
+    for(auto db : { mWorldDatabase, mLobbyDatabase })
+    {
+        if(db)
+        {
+            db->StopTransactionWriter();
+
+            // Changes queued while the writer was stopping are written
+            // here instead
+            auto failures = db->ProcessTransactionQueue();
+            if(failures.size() > 0)
+            {
+                LOG_ERROR(libcomp::String("%1 queued database change"
+                    " set(s) failed to write during shutdown.\n").Arg(
+                    failures.size()));
+            }
+        }
+    }
+
     mDefaultCharacterObjectMap.clear();
 }
 
@@ -897,15 +941,14 @@ int64_t ChannelServer::GetNextObjectID()
 
 void ChannelServer::Tick()
 {
-    ServerTime tickTime = GetServerTime();
-
     // Update the active zone states
     mZoneManager->UpdateActiveZoneStates();
 
-    // Process queued world database changes
+    // Collect world database changes that failed to write (the changes
+    // themselves are written by the database's writer thread)
     auto worldFailures = mWorldDatabase->ProcessTransactionQueue();
 
-    // Process queued lobby database changes
+    // Collect lobby database changes that failed to write
     auto lobbyFailures = mLobbyDatabase->ProcessTransactionQueue();
 
     if(worldFailures.size() > 0 || lobbyFailures.size() > 0)
@@ -933,43 +976,6 @@ void ChannelServer::Tick()
             }
         }
     }
-
-    std::map<ServerTime, std::list<libcomp::Message::Execute*>> schedule;
-    {
-        std::lock_guard<std::mutex> lock(mLock);
-
-        // Retrieve all work scheduled for the current time or before
-        for(auto it = mScheduledWork.begin(); it != mScheduledWork.end(); it++)
-        {
-            if(it->first <= tickTime)
-            {
-                schedule[it->first] = it->second;
-            }
-            else
-            {
-                break;
-            }
-        }
-
-        // Clear all scheduled work retrieved from the member map
-        for(auto it = schedule.begin(); it != schedule.end(); it++)
-        {
-            mScheduledWork.erase(it->first);
-        }
-    }
-
-    // Queue any work that has been scheduled
-    if(schedule.size() > 0)
-    {
-        auto queue = mQueueWorker.GetMessageQueue();
-        for(auto it = schedule.begin(); it != schedule.end(); it++)
-        {
-            for(auto it2 = it->second.begin(); it2 != it->second.end(); it2++)
-            {
-                queue->Enqueue(*it2);
-            }
-        }
-    }
 }
 
 void ChannelServer::StartGameTick()
@@ -982,17 +988,27 @@ void ChannelServer::StartGameTick()
         pthread_setname_np(pthread_self(), "tick");
 #endif // !defined(_WIN32)
 
-        const static int TICK_DELTA = 100;
-        auto tickDelta = std::chrono::milliseconds(TICK_DELTA);
+        // Ticks are queued on absolute deadlines so the time spent
+        // processing them does not delay the next one
+        mTickScheduler.Start(libcomp::TickScheduler::Clock::now());
 
         while(*pTickRunning)
         {
-            std::this_thread::sleep_for(tickDelta);
-            queue->Enqueue(new libcomp::Message::Tick);
+            std::this_thread::sleep_until(mTickScheduler.GetNextDeadline());
+
+            if(mTickScheduler.Advance(libcomp::TickScheduler::Clock::now()))
+            {
+                queue->Enqueue(new libcomp::Message::Tick);
+            }
         }
     }, mQueueWorker.GetMessageQueue(), &mTickRunning);
 }
 
+libcomp::TickScheduler* ChannelServer::GetTickScheduler()
+{
+    return &mTickScheduler;
+}
+
 bool ChannelServer::SendSystemMessage(const std::shared_ptr<
     channel::ChannelClientConnection>& client,
     libcomp::String message, int8_t type, bool sendToAll)
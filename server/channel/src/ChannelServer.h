@@ -31,6 +31,7 @@
 #include <InternalConnection.h>
 #include <BaseServer.h>
 #include <ManagerConnection.h>
+#include <TickScheduler.h>
 #include <Worker.h>
 
 // object Includes
@@ -308,10 +309,16 @@ public:
     void Tick();
 
     /**
-     * Generates server game ticks.
+     * Generates server game ticks on fixed deadlines.
      */
     void StartGameTick();
 
+    /**
+     * Get a pointer to the scheduler of the server game ticks.
+     * @return Pointer to the TickScheduler
+     */
+    libcomp::TickScheduler* GetTickScheduler();
+
     /**
     * Sends an announcement to each client connected to world
     * @param client Client that sent announcement packet to channel
@@ -367,8 +374,8 @@ public:
     void HandleClockEvents();
 
     /**
-     * Schedule code work to be queued by the next server tick that occurs
-     * following the specified time.
+     * Schedule code work to be queued to the queue worker once the
+     * specified time has passed.
      * @param timestamp ServerTime timestamp that needs to pass for the
      *  specified work to be processed
      * @param f Function (lambda) to execute
@@ -381,8 +388,17 @@ public:
         auto msg = new libcomp::Message::ExecuteImpl<Args...>(
             std::forward<Function>(f), std::forward<Args>(args)...);
 
-        std::lock_guard<std::mutex> lock(mLock);
-        mScheduledWork[timestamp].push_back(msg);
+        // ServerTime may not share an epoch with the steady clock so
+        // convert the time left instead of the timestamp itself
+        ServerTime now = GetServerTime();
+        auto time = std::chrono::steady_clock::now();
+        if(timestamp > now)
+        {
+            time += std::chrono::microseconds((int64_t)(timestamp - now));
+        }
+
+        // The timer manager sends the work to the queue worker
+        mTimerManager.RegisterEvent(time, msg);
 
         return true;
     }
@@ -420,11 +436,6 @@ protected:
      */
     void RecalcNextWorldEventTime();
 
-    /// Timestamp ordered map of prepared Execute messages and timestamps
-    /// associated to when they should be queued following a server tick
-    std::map<ServerTime,
-        std::list<libcomp::Message::Execute*>> mScheduledWork;
-
     /// Map of world clock times to the type of event that will
     /// occur at that time. Types include:
     /// 1) Spawn activation/deactivation
@@ -511,6 +522,9 @@ protected:
     /// Thread that queues up tick messages after a delay.
     std::thread mTickThread;
 
+    /// Deadlines and timings of the tick messages.
+    libcomp::TickScheduler mTickScheduler;
+
     /// Server lock for shared resources
     std::mutex mLock;
 
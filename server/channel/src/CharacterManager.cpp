@@ -798,7 +798,8 @@ void CharacterManager::SendEntityStats(std::shared_ptr<
 
     p.WriteS32Little(eState->GetMaxHP());
 
-    server->GetZoneManager()->BroadcastPacket(client, p, includeSelf);
+    server->GetZoneManager()->BroadcastEntityPacket(client,
+        eState->GetEntityID(), p, includeSelf);
 }
 
 bool CharacterManager::GetEntityRevivalPacket(libcomp::Packet& p,
@@ -845,7 +846,8 @@ void CharacterManager::SetStatusIcon(const std::shared_ptr<ChannelClientConnecti
     p.WriteS32Little(state->GetCharacterState()->GetEntityID());
     p.WriteS8(icon);
 
-    mServer.lock()->GetZoneManager()->BroadcastPacket(client, p, false);
+    mServer.lock()->GetZoneManager()->BroadcastEntityPacket(client,
+        state->GetCharacterState()->GetEntityID(), p, false);
 }
 
 void CharacterManager::SendMovementSpeed(const std::shared_ptr<
@@ -2170,7 +2172,8 @@ void CharacterManager::EquipItem(const std::shared_ptr<
     reply.WriteS16Little((int16_t)cState->GetMaxHP());
     reply.WriteS16Little((int16_t)cState->GetMaxMP());
 
-    server->GetZoneManager()->BroadcastPacket(client, reply, false);
+    server->GetZoneManager()->BroadcastEntityPacket(client,
+        cState->GetEntityID(), reply, false);
 }
 
 bool CharacterManager::UnequipItem(const std::shared_ptr<
@@ -2668,7 +2671,8 @@ void CharacterManager::UpdateFamiliarity(const std::shared_ptr<
                 p.WriteS32Little(dState->GetEntityID());
                 p.WriteU16Little((uint16_t)newFamiliarity);
 
-                server->GetZoneManager()->BroadcastPacket(client, p);
+                server->GetZoneManager()->BroadcastEntityPacket(client,
+                    dState->GetEntityID(), p);
             }
 
             server->GetWorldDatabase()->QueueUpdate(demon, state->GetAccountUID());
@@ -2864,7 +2868,8 @@ void CharacterManager::ExperienceGain(const std::shared_ptr<
             reply.WriteS32Little(points);
         }
 
-        server->GetZoneManager()->BroadcastPacket(client, reply, true);
+        server->GetZoneManager()->BroadcastEntityPacket(client, entityID,
+            reply, true);
     }
 
     stats->SetXP(xpDelta);
@@ -3054,7 +3059,8 @@ void CharacterManager::UpdateExpertisePoints(const std::shared_ptr<
             reply.WriteS8((int8_t)expDef->GetID());
             reply.WriteS8(newRank);
 
-            server->GetZoneManager()->BroadcastPacket(client, reply);
+            server->GetZoneManager()->BroadcastEntityPacket(client,
+                cState->GetEntityID(), reply);
 
             rankedUp = true;
         }
@@ -3854,7 +3860,7 @@ bool CharacterManager::AddRemoveOpponent(bool add, const std::shared_ptr<
         return true;
     }
 
-    std::list<libcomp::Packet> packets;
+    std::list<std::pair<int32_t, libcomp::Packet>> packets;
     if(add)
     {
         // If one isn't alive, stop here
@@ -3929,7 +3935,7 @@ bool CharacterManager::AddRemoveOpponent(bool add, const std::shared_ptr<
             p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_BATTLE_STARTED);
             p.WriteS32Little(entity->GetEntityID());
             p.WriteFloat(entity->GetMovementSpeed());
-            packets.push_back(p);
+            packets.push_back(std::make_pair(entity->GetEntityID(), p));
         }
 
         for(auto enemy : activatedEnemies)
@@ -3938,7 +3944,7 @@ bool CharacterManager::AddRemoveOpponent(bool add, const std::shared_ptr<
             p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_ENEMY_ACTIVATED);
             p.WriteS32Little(eState1->GetEntityID());
             p.WriteS32Little(enemy->GetEntityID());
-            packets.push_back(p);
+            packets.push_back(std::make_pair(enemy->GetEntityID(), p));
         }
     }
     else
@@ -3992,14 +3998,14 @@ bool CharacterManager::AddRemoveOpponent(bool add, const std::shared_ptr<
             p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_BATTLE_STOPPED);
             p.WriteS32Little(entity->GetEntityID());
             p.WriteFloat(entity->GetMovementSpeed());
-            packets.push_back(p);
+            packets.push_back(std::make_pair(entity->GetEntityID(), p));
         }
     }
 
     if(packets.size() > 0)
     {
-        auto zoneConnections = zone->GetConnectionList();
-        ChannelClientConnection::BroadcastPackets(zoneConnections, packets);
+        mServer.lock()->GetZoneManager()->BroadcastEntityPackets(zone,
+            packets);
     }
 
     return true;
@@ -4084,7 +4090,7 @@ void CharacterManager::CalculateDemonBaseStats(
 	 * D | 85, 89, 93, 97
 	 */
 
-    libcomp::EnumMap<CorrectTbl, int16_t> stats;
+    CorrectTblArray stats;
     stats[CorrectTbl::STR] = battleData->GetCorrect((size_t)CorrectTbl::STR);
     stats[CorrectTbl::MAGIC] = battleData->GetCorrect((size_t)CorrectTbl::MAGIC);
     stats[CorrectTbl::VIT] = battleData->GetCorrect((size_t)CorrectTbl::VIT);
@@ -4183,10 +4189,10 @@ void CharacterManager::CalculateDemonBaseStats(
     ds->SetMDEF(stats[CorrectTbl::MDEF]);
 }
 
-libcomp::EnumMap<CorrectTbl, int16_t> CharacterManager::GetCharacterBaseStatMap(
+CorrectTblArray CharacterManager::GetCharacterBaseStatMap(
     const std::shared_ptr<objects::EntityStats>& cs)
 {
-    libcomp::EnumMap<CorrectTbl, int16_t> stats;
+    CorrectTblArray stats;
     for(size_t i = 0; i < 126; i++)
     {
         CorrectTbl tblID = (CorrectTbl)i;
@@ -4222,10 +4228,10 @@ libcomp::EnumMap<CorrectTbl, int16_t> CharacterManager::GetCharacterBaseStatMap(
 }
 
 void CharacterManager::CalculateDependentStats(
-    libcomp::EnumMap<CorrectTbl, int16_t>& stats, int8_t level, bool isDemon)
+    CorrectTblArray& stats, int8_t level, bool isDemon)
 {
     /// @todo: fix: close but not quite right
-    libcomp::EnumMap<CorrectTbl, int16_t> adjusted;
+    CorrectTblArray adjusted;
     if(isDemon)
     {
         // Round up each part
@@ -4310,9 +4316,9 @@ void CharacterManager::CalculateDependentStats(
     stats[CorrectTbl::COOLDOWN_TIME] = (int16_t)(coolAdjust < 5 ? 5 : coolAdjust);
 }
 
-void CharacterManager::AdjustStatBounds(libcomp::EnumMap<CorrectTbl, int16_t>& stats)
+void CharacterManager::AdjustStatBounds(CorrectTblArray& stats)
 {
-    static libcomp::EnumMap<CorrectTbl, int16_t> minStats =
+    static CorrectTblArray minStats =
         {
             { CorrectTbl::HP_MAX, 1 },
             { CorrectTbl::MP_MAX, 1 },
@@ -4334,14 +4340,7 @@ void CharacterManager::AdjustStatBounds(libcomp::EnumMap<CorrectTbl, int16_t>& s
             { CorrectTbl::CHANT_TIME, 0 }
         };
 
-    for(auto pair : minStats)
-    {
-        auto it = stats.find(pair.first);
-        if(it != stats.end() && it->second < pair.second)
-        {
-            stats[pair.first] = pair.second;
-        }
-    }
+    stats.ClampMin(minStats);
 }
 
 void CharacterManager::GetDemonPacketData(libcomp::Packet& p,
@@ -4592,7 +4591,7 @@ void CharacterManager::DeleteDemon(const std::shared_ptr<objects::Demon>& demon,
     }
 }
 
-void CharacterManager::BoostStats(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+void CharacterManager::BoostStats(CorrectTblArray& stats,
     const std::shared_ptr<objects::MiDevilLVUpData>& data, int boostLevel)
 {
     stats[CorrectTbl::STR] = (int16_t)(stats[CorrectTbl::STR] +
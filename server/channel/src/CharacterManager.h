@@ -27,13 +27,11 @@
 #ifndef SERVER_CHANNEL_SRC_CHARACTERMANAGER_H
 #define SERVER_CHANNEL_SRC_CHARACTERMANAGER_H
 
-// libcomp Includes
-#include <EnumMap.h>
-
 // object Includes
 #include <MiCorrectTbl.h>
 
 // channel Includes
+#include "ActiveEntityState.h"
 #include "ChannelClientConnection.h"
 #include "Zone.h"
 
@@ -838,7 +836,7 @@ public:
      * @param cs Pointer to the core stats of a character
      * @return Map of correct table indexes to corresponding stat values
      */
-    static libcomp::EnumMap<CorrectTbl, int16_t> GetCharacterBaseStatMap(
+    static CorrectTblArray GetCharacterBaseStatMap(
         const std::shared_ptr<objects::EntityStats>& cs);
 
     /**
@@ -848,7 +846,7 @@ public:
      * @param level Current level of the character or demon
      * @param isDemon true if the entity is a demon, false if it is character
      */
-    static void CalculateDependentStats(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    static void CalculateDependentStats(CorrectTblArray& stats,
         int8_t level, bool isDemon);
 
     /**
@@ -856,7 +854,7 @@ public:
      * minimum values possible.
      * @param stats Reference to a correct table map
      */
-    static void AdjustStatBounds(libcomp::EnumMap<CorrectTbl, int16_t>& stats);
+    static void AdjustStatBounds(CorrectTblArray& stats);
 
     /**
      * Add data to a packet about a demon in a box.
@@ -920,7 +918,7 @@ private:
      * @param data Pointer to the level up definition of a demon
      * @param boostLevel Boost level to use when calculating the stat increases
      */
-    void BoostStats(libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    void BoostStats(CorrectTblArray& stats,
         const std::shared_ptr<objects::MiDevilLVUpData>& data, int boostLevel);
 
     /// Pointer to the channel server
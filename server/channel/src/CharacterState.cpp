@@ -408,7 +408,7 @@ bool CharacterState::RecalcDisabledSkills(
 
 void CharacterState::BaseStatsCalculated(libcomp::DefinitionManager* definitionManager,
     std::shared_ptr<objects::CalculatedEntityState> calcState,
-    libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+    CorrectTblArray& stats,
     std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments)
 {
     if(calcState != GetCalculatedState())
@@ -101,7 +101,7 @@ public:
 protected:
     virtual void BaseStatsCalculated(libcomp::DefinitionManager* definitionManager,
         std::shared_ptr<objects::CalculatedEntityState> calcState,
-        libcomp::EnumMap<CorrectTbl, int16_t>& stats,
+        CorrectTblArray& stats,
         std::list<std::shared_ptr<objects::MiCorrectTbl>>& adjustments);
 
 private:
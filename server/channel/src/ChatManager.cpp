@@ -27,8 +27,11 @@
 #include "ChatManager.h"
 
 // libcomp Includes
+#include <Database.h>
 #include <DefinitionManager.h>
+#include <HandshakePool.h>
 #include <Log.h>
+#include <PacketBufferPool.h>
 #include <PacketCodes.h>
 #include <ServerConstants.h>
 #include <ServerDataManager.h>
@@ -57,12 +60,16 @@
 // Standard C Includes
 #include <cstdlib>
 
+// Standard C++11 Includes
+#include <algorithm>
+
 // channel Includes
 #include "AccountManager.h"
 #include "ChannelServer.h"
 #include "CharacterManager.h"
 #include "ClientState.h"
 #include "EventManager.h"
+#include "FusionManager.h"
 #include "Git.h"
 #include "ManagerConnection.h"
 #include "TokuseiManager.h"
@@ -84,6 +91,7 @@ ChatManager::ChatManager(const std::weak_ptr<ChannelServer>& server)
     mGMands["expertiseup"] = &ChatManager::GMCommand_ExpertiseUpdate;
     mGMands["familiarity"] = &ChatManager::GMCommand_Familiarity;
     mGMands["flag"] = &ChatManager::GMCommand_Flag;
+    mGMands["fusioncheck"] = &ChatManager::GMCommand_FusionCheck;
     mGMands["goto"] = &ChatManager::GMCommand_Goto;
     mGMands["help"] = &ChatManager::GMCommand_Help;
     mGMands["homepoint"] = &ChatManager::GMCommand_Homepoint;
@@ -94,6 +102,7 @@ ChatManager::ChatManager(const std::weak_ptr<ChannelServer>& server)
     mGMands["levelup"] = &ChatManager::GMCommand_LevelUp;
     mGMands["lnc"] = &ChatManager::GMCommand_LNC;
     mGMands["map"] = &ChatManager::GMCommand_Map;
+    mGMands["perf"] = &ChatManager::GMCommand_Perf;
     mGMands["plugin"] = &ChatManager::GMCommand_Plugin;
     mGMands["pos"] = &ChatManager::GMCommand_Position;
     mGMands["post"] = &ChatManager::GMCommand_Post;
@@ -897,6 +906,25 @@ bool ChatManager::GMCommand_Flag(const std::shared_ptr<
     return true;
 }
 
+bool ChatManager::GMCommand_FusionCheck(const std::shared_ptr<
+    channel::ChannelClientConnection>& client,
+    const std::list<libcomp::String>& args)
+{
+    (void)args;
+
+    if(!HaveUserLevel(client, 950))
+    {
+        return true;
+    }
+
+    uint32_t mismatches = mServer.lock()->GetFusionManager()
+        ->VerifyFusionTables();
+
+    return SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+        "Fusion tables: %1 mismatches (see the log for details)")
+        .Arg(mismatches));
+}
+
 bool ChatManager::GMCommand_Goto(const std::shared_ptr<
     channel::ChannelClientConnection>& client,
     const std::list<libcomp::String>& args)
@@ -1052,6 +1080,11 @@ bool ChatManager::GMCommand_Help(const std::shared_ptr<
             "CID may be 0 for no specific character. If VALUE is not",
             "given the key is printed out instead of set.",
         } },
+        { "fusioncheck", {
+            "@fusioncheck",
+            "Compares the precomputed fusion tables against the full",
+            "fusion calculation and prints the number of mismatches.",
+        } },
         { "goto", {
             "@goto [SELF] NAME",
             "If SELF is set to 'self' the player is moved to the",
@@ -1101,6 +1134,12 @@ bool ChatManager::GMCommand_Help(const std::shared_ptr<
             "@map ID",
             "Adds map for the player with the given ID.",
         } },
+        { "perf", {
+            "@perf [SECTION]",
+            "Prints performance counters for the channel. SECTION",
+            "limits the output to one group: tick, db, packets,",
+            "interest, zones, log, objects, login, scripts, net.",
+        } },
         { "plugin", {
             "@plugin ID",
             "Adds plugin for the player with the given ID.",
@@ -1634,6 +1673,274 @@ bool ChatManager::GMCommand_Map(const std::shared_ptr<
     return true;
 }
 
+bool ChatManager::GMCommand_Perf(const std::shared_ptr<
+    channel::ChannelClientConnection>& client,
+    const std::list<libcomp::String>& args)
+{
+    if(!HaveUserLevel(client, 950))
+    {
+        return true;
+    }
+
+    std::list<libcomp::String> argsCopy = args;
+
+    libcomp::String section;
+    GetStringArg(section, argsCopy);
+    section = section.ToLower();
+
+    bool all = section.IsEmpty();
+
+    if(all || section == "tick")
+    {
+        auto stats = mServer.lock()->GetTickScheduler()->GetStats();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Tick: %1 run, %2 overrun, %3 coalesced, %4 skipped")
+            .Arg(stats.Ticks).Arg(stats.Overruns).Arg(stats.Coalesced)
+            .Arg(stats.Skipped));
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Tick duration: p50 %1us, p99 %2us, max %3us")
+            .Arg(stats.DurationP50).Arg(stats.DurationP99)
+            .Arg(stats.DurationMax));
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Tick jitter: avg %1us, max %2us")
+            .Arg(stats.JitterAvg).Arg(stats.JitterMax));
+    }
+
+    if(all || section == "db")
+    {
+        auto server = mServer.lock();
+
+        for(auto dbPair : { std::make_pair("World", server->GetWorldDatabase()),
+            std::make_pair("Lobby", server->GetLobbyDatabase()) })
+        {
+            if(!dbPair.second)
+            {
+                continue;
+            }
+
+            auto stats = dbPair.second->GetTransactionQueueStats();
+
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "%1 DB: %2 queued (max %3), %4 batches, %5 committed,"
+                " %6 failed, %7 waits").Arg(dbPair.first)
+                .Arg(stats.QueueDepth).Arg(stats.MaxQueueDepth)
+                .Arg(stats.Batches).Arg(stats.Committed).Arg(stats.Failed)
+                .Arg(stats.BackpressureWaits));
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "%1 DB commit: last %2us, avg %3us, max %4us")
+                .Arg(dbPair.first).Arg(stats.LastCommitTime)
+                .Arg(stats.AvgCommitTime).Arg(stats.MaxCommitTime));
+
+            auto cacheStats = dbPair.second->GetStatementCacheStats();
+            uint64_t lookups = cacheStats.Hits + cacheStats.Prepares;
+
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "%1 DB statements: %2 prepared, %3 reused (%4% hit rate),"
+                " %5 cached, %6 evicted").Arg(dbPair.first)
+                .Arg(cacheStats.Prepares).Arg(cacheStats.Hits)
+                .Arg(lookups ? cacheStats.Hits * 100 / lookups : 0)
+                .Arg(cacheStats.Cached).Arg(cacheStats.Evictions));
+        }
+    }
+
+    if(all || section == "packets")
+    {
+        auto stats = libcomp::PacketBufferPool::GetStats();
+
+        for(auto& classStats : stats.Classes)
+        {
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "Packet buffers %1B: %2 allocated, %3 reused, %4 recycled,"
+                " %5 freed").Arg(classStats.Capacity)
+                .Arg(classStats.Allocated).Arg(classStats.Reused)
+                .Arg(classStats.Recycled).Arg(classStats.Freed));
+        }
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Packet buffers grown: %1").Arg(stats.Grown));
+    }
+
+    if(all || section == "interest")
+    {
+        auto zoneManager = mServer.lock()->GetZoneManager();
+        if(zoneManager->InterestManagementEnabled())
+        {
+            auto stats = zoneManager->GetInterestStats();
+
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "Interest: %1 movement packets saved, %2 shown, %3 removed")
+                .Arg(stats.PacketsSaved).Arg(stats.Entered).Arg(stats.Left));
+        }
+        else
+        {
+            SendChatMessage(client, ChatType_t::CHAT_SELF,
+                "Interest: disabled");
+        }
+    }
+
+    if(all || section == "zones")
+    {
+        auto stats = mServer.lock()->GetZoneManager()->GetZoneTickStats();
+
+        // Only list the zones with the most total update time
+        std::vector<std::pair<uint32_t, ZoneManager::ZoneTickStats>> hot(
+            stats.begin(), stats.end());
+        std::sort(hot.begin(), hot.end(), [](
+            const std::pair<uint32_t, ZoneManager::ZoneTickStats>& a,
+            const std::pair<uint32_t, ZoneManager::ZoneTickStats>& b)
+            {
+                return a.second.TotalTime > b.second.TotalTime;
+            });
+
+        if(hot.size() > 5)
+        {
+            hot.resize(5);
+        }
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Zones: %1 updated").Arg(stats.size()));
+
+        for(auto& zPair : hot)
+        {
+            auto& zStats = zPair.second;
+
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "Zone %1 (%2, %3): %4 ticks, avg %5us, max %6us, last %7us")
+                .Arg(zPair.first).Arg(zStats.DefinitionID)
+                .Arg(zStats.DynamicMapID).Arg(zStats.Ticks)
+                .Arg(zStats.TotalTime / zStats.Ticks).Arg(zStats.MaxTime)
+                .Arg(zStats.LastTime));
+        }
+    }
+
+    if(all || section == "log")
+    {
+        auto log = libcomp::Log::GetSingletonPtr();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Log: %1, %2 dropped").Arg(log->IsAsync() ? "async" : "sync")
+            .Arg(log->GetDroppedCount()));
+    }
+
+    if(all || section == "objects")
+    {
+        auto stats = libcomp::PersistentObject::GetCacheStats();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Objects: %1 cached, %2 hits, %3 misses, %4 expired, %5 swept")
+            .Arg(stats.Cached).Arg(stats.Hits).Arg(stats.Misses)
+            .Arg(stats.Expired).Arg(stats.Swept));
+    }
+
+    if(all || section == "login")
+    {
+        auto stats = mServer.lock()->GetAccountManager()->GetLoginStats();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Login: %1 characters loaded, avg %2us, max %3us, last %4us")
+            .Arg(stats.Logins).Arg(stats.Logins ? stats.TotalTime /
+            stats.Logins : 0).Arg(stats.MaxTime).Arg(stats.LastTime));
+    }
+
+    if(all || section == "scripts")
+    {
+        auto scriptStats = mServer.lock()->GetEventManager()
+            ->GetScriptStats();
+
+        // Show the scripts that have taken the most time first
+        std::list<std::pair<std::string, EventManager::ScriptStats>> sorted(
+            scriptStats.begin(), scriptStats.end());
+        sorted.sort([](const std::pair<std::string,
+            EventManager::ScriptStats>& a, const std::pair<std::string,
+            EventManager::ScriptStats>& b)
+            {
+                return a.second.TotalTime > b.second.TotalTime;
+            });
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Scripts: %1 event scripts called").Arg(
+            (uint32_t)sorted.size()));
+
+        for(auto& pair : sorted)
+        {
+            auto& stats = pair.second;
+
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "  %1: %2 calls, avg %3us, max %4us").Arg(pair.first)
+                .Arg(stats.Calls).Arg(stats.Calls ? stats.TotalTime /
+                stats.Calls : 0).Arg(stats.MaxTime));
+        }
+    }
+
+    if(all || section == "net")
+    {
+        auto stats = mServer.lock()->GetReactorStats();
+
+        for(size_t i = 0; i < stats.size(); i++)
+        {
+            auto& rStats = stats[i];
+
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "Network %1: %2 connections (%3 total), latency last %4us,"
+                " avg %5us, max %6us").Arg((uint32_t)i)
+                .Arg(rStats.Connections).Arg(rStats.Accepted)
+                .Arg(rStats.LatencyLast).Arg(rStats.LatencyAvg)
+                .Arg(rStats.LatencyMax));
+        }
+
+        auto receiveStats = libcomp::TcpConnection::GetReceiveStats();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Network receive: %1 reads, %2 bytes, %3 frames, %4 reads per"
+            " 100 frames").Arg(receiveStats.Receives).Arg(receiveStats.Bytes)
+            .Arg(receiveStats.Frames).Arg(receiveStats.Frames ?
+            receiveStats.Receives * 100 / receiveStats.Frames : 0));
+
+        auto sendStats = libcomp::TcpConnection::GetSendStats();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Network send: %1 writes, %2 bytes, %3 frames, %4 budget waits")
+            .Arg(sendStats.Writes).Arg(sendStats.Bytes).Arg(sendStats.Frames)
+            .Arg(sendStats.BudgetWaits));
+
+        auto handshakeStats = libcomp::HandshakePool::GetSingletonPtr()
+            ->GetStats();
+
+        SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+            "Network handshake: %1 done, %2 key pair hits, %3 misses,"
+            " %4 ready, %5 jobs, max %6us").Arg(handshakeStats.Handshakes)
+            .Arg(handshakeStats.KeyPairHits).Arg(handshakeStats.KeyPairMisses)
+            .Arg(handshakeStats.KeyPairsReady).Arg(handshakeStats.Jobs)
+            .Arg(handshakeStats.LatencyMax));
+
+        libcomp::String histogram;
+
+        for(size_t i = 0; i < libcomp::HandshakePool::LATENCY_BUCKET_COUNT;
+            i++)
+        {
+            if(0 == handshakeStats.Latency[i])
+            {
+                continue;
+            }
+
+            uint64_t limit = libcomp::HandshakePool::GetLatencyBucketLimit(i);
+
+            histogram += libcomp::String(" %1%2=%3").Arg(limit ? "<" : ">=")
+                .Arg(limit ? limit : libcomp::HandshakePool::
+                GetLatencyBucketLimit(i - 1)).Arg(handshakeStats.Latency[i]);
+        }
+
+        if(!histogram.IsEmpty())
+        {
+            SendChatMessage(client, ChatType_t::CHAT_SELF, libcomp::String(
+                "Network handshake latency (us):%1").Arg(histogram));
+        }
+    }
+
+    return true;
+}
+
 bool ChatManager::GMCommand_Plugin(const std::shared_ptr<
     channel::ChannelClientConnection>& client,
     const std::list<libcomp::String>& args)
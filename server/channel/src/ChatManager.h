@@ -230,6 +230,17 @@ private:
         channel::ChannelClientConnection>& client,
         const std::list<libcomp::String>& args);
 
+    /**
+     * GM command to compare the precomputed fusion tables against the full
+     * fusion calculation.
+     * @param client Pointer to the client that sent the command
+     * @param args List of arguments for the command
+     * @return true if the command was handled properly, else false
+     */
+    bool GMCommand_FusionCheck(const std::shared_ptr<
+        channel::ChannelClientConnection>& client,
+        const std::list<libcomp::String>& args);
+
     /**
      * GM command to move one player to another player.
      * @param client Pointer to the client that sent the command
@@ -331,6 +342,16 @@ private:
         channel::ChannelClientConnection>& client,
         const std::list<libcomp::String>& args);
 
+    /**
+     * GM command to print performance counters for the channel.
+     * @param client Pointer to the client that sent the command
+     * @param args List of arguments for the command
+     * @return true if the command was handled properly, else false
+     */
+    bool GMCommand_Perf(const std::shared_ptr<
+        channel::ChannelClientConnection>& client,
+        const std::list<libcomp::String>& args);
+
     /**
      * GM command to set a character's obtained plugins.
      * @param client Pointer to the client that sent the command
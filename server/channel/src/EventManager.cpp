@@ -37,6 +37,7 @@
 #include <ServerDataManager.h>
 
 // Standard C++11 Includes
+#include <chrono>
 #include <math.h>
 
 // object Includes
@@ -93,6 +94,9 @@ using namespace channel;
 const uint16_t EVENT_COMPARE_NUMERIC = (uint16_t)EventCompareMode::EQUAL |
     (uint16_t)EventCompareMode::LT | (uint16_t)EventCompareMode::GTE;
 
+/// Most idle engines kept per event script
+const size_t MAX_IDLE_SCRIPT_ENGINES = 8;
+
 const uint16_t EVENT_COMPARE_NUMERIC2 = EVENT_COMPARE_NUMERIC |
     (uint16_t)EventCompareMode::BETWEEN;
 
@@ -112,6 +116,20 @@ EventManager::~EventManager()
 {
 }
 
+std::unordered_map<std::string, EventManager::ScriptStats>
+    EventManager::GetScriptStats()
+{
+    std::unordered_map<std::string, ScriptStats> stats;
+
+    std::lock_guard<std::mutex> lock(mScriptPoolLock);
+    for(auto& pair : mScriptPools)
+    {
+        stats[pair.first] = pair.second.Stats;
+    }
+
+    return stats;
+}
+
 bool EventManager::HandleEvent(
     const std::shared_ptr<ChannelClientConnection>& client,
     const libcomp::String& eventID, int32_t sourceEntityID,
@@ -538,6 +556,61 @@ bool EventManager::EvaluateQuestConditions(EventContext& ctx, int16_t questID)
     return false;
 }
 
+std::shared_ptr<libcomp::ScriptEngine> EventManager::GetScriptEngine(
+    const std::shared_ptr<libcomp::ServerScript>& script)
+{
+    {
+        std::lock_guard<std::mutex> lock(mScriptPoolLock);
+
+        auto& pool = mScriptPools[script->Name.C()];
+        if(pool.Script != script)
+        {
+            // The script was reloaded so the idle engines are stale
+            pool.Script = script;
+            pool.Engines.clear();
+        }
+
+        if(pool.Engines.size() > 0)
+        {
+            auto engine = pool.Engines.front();
+            pool.Engines.pop_front();
+
+            return engine;
+        }
+    }
+
+    auto engine = std::make_shared<libcomp::ScriptEngine>();
+    engine->Using<CharacterState>();
+    engine->Using<DemonState>();
+    engine->Using<Zone>();
+    engine->Using<libcomp::Randomizer>();
+
+    if(!engine->EvalBytecode(script->Bytecode))
+    {
+        return nullptr;
+    }
+
+    return engine;
+}
+
+void EventManager::ReturnScriptEngine(
+    const std::shared_ptr<libcomp::ServerScript>& script,
+    const std::shared_ptr<libcomp::ScriptEngine>& engine, uint64_t callTime)
+{
+    std::lock_guard<std::mutex> lock(mScriptPoolLock);
+
+    auto& pool = mScriptPools[script->Name.C()];
+    if(pool.Script == script &&
+        pool.Engines.size() < MAX_IDLE_SCRIPT_ENGINES)
+    {
+        pool.Engines.push_back(engine);
+    }
+
+    pool.Stats.Calls++;
+    pool.Stats.TotalTime += callTime;
+    pool.Stats.MaxTime = std::max(pool.Stats.MaxTime, callTime);
+}
+
 bool EventManager::EvaluateEventCondition(EventContext& ctx, const std::shared_ptr<
     objects::EventCondition>& condition)
 {
@@ -559,14 +632,11 @@ bool EventManager::EvaluateEventCondition(EventContext& ctx, const std::shared_p
             auto script = serverDataManager->GetScript(scriptCondition->GetScriptID());
             if(script && script->Type.ToLower() == "eventcondition")
             {
-                auto engine = std::make_shared<libcomp::ScriptEngine>();
-                engine->Using<CharacterState>();
-                engine->Using<DemonState>();
-                engine->Using<Zone>();
-                engine->Using<libcomp::Randomizer>();
-
-                if(engine->Eval(script->Source))
+                auto engine = GetScriptEngine(script);
+                if(engine)
                 {
+                    auto callStart = std::chrono::steady_clock::now();
+
                     Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
 
                     Sqrat::Array sqParams(engine->GetVM());
@@ -584,6 +654,11 @@ bool EventManager::EvaluateEventCondition(EventContext& ctx, const std::shared_p
                             scriptCondition->GetValue1(),
                             scriptCondition->GetValue2(),
                             sqParams) : 0;
+
+                    ReturnScriptEngine(script, engine, (uint64_t)std::chrono::
+                        duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - callStart).count());
+
                     if(scriptResult)
                     {
                         return negate != (*scriptResult == 0);
@@ -2106,14 +2181,11 @@ void EventManager::HandleNext(EventContext& ctx)
             auto script = serverDataManager->GetScript(branchScriptID);
             if(script && script->Type.ToLower() == "eventbranchlogic")
             {
-                auto engine = std::make_shared<libcomp::ScriptEngine>();
-                engine->Using<CharacterState>();
-                engine->Using<DemonState>();
-                engine->Using<Zone>();
-                engine->Using<libcomp::Randomizer>();
-
-                if(engine->Eval(script->Source))
+                auto engine = GetScriptEngine(script);
+                if(engine)
                 {
+                    auto callStart = std::chrono::steady_clock::now();
+
                     Sqrat::Function f(Sqrat::RootTable(engine->GetVM()), "check");
 
                     Sqrat::Array sqParams(engine->GetVM());
@@ -2128,6 +2200,11 @@ void EventManager::HandleNext(EventContext& ctx)
                             state->GetDemonState(),
                             ctx.CurrentZone,
                             sqParams) : 0;
+
+                    ReturnScriptEngine(script, engine, (uint64_t)std::chrono::
+                        duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - callStart).count());
+
                     if(scriptResult)
                     {
                         size_t idx = *scriptResult;
@@ -38,6 +38,17 @@
 // channel Includes
 #include "ChannelClientConnection.h"
 
+// Standard C++11 Includes
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace libcomp
+{
+class ScriptEngine;
+struct ServerScript;
+}
+
 namespace objects
 {
 class EventConditionData;
@@ -173,7 +184,67 @@ public:
     bool HandleEvent(const std::shared_ptr<ChannelClientConnection>& client,
         const std::shared_ptr<objects::EventInstance>& instance);
 
+    /**
+     * Call counts and timing of one event condition or branch script.
+     */
+    struct ScriptStats
+    {
+        /// Number of times the script was called
+        uint64_t Calls;
+
+        /// Total time spent in the script in microseconds
+        uint64_t TotalTime;
+
+        /// Longest single call in microseconds
+        uint64_t MaxTime;
+    };
+
+    /**
+     * Get the call counts and timing of every event condition and branch
+     * script that has been called.
+     * @return Map of script timing by script ID
+     */
+    std::unordered_map<std::string, ScriptStats> GetScriptStats();
+
 private:
+    /**
+     * Engines for one event script with the bindings and the script
+     * already loaded, along with the timing of the script.
+     */
+    struct ScriptPool
+    {
+        /// Script the idle engines were loaded from
+        std::shared_ptr<libcomp::ServerScript> Script;
+
+        /// Engines not currently running the script
+        std::list<std::shared_ptr<libcomp::ScriptEngine>> Engines;
+
+        /// Call counts and timing of the script
+        ScriptStats Stats;
+    };
+
+    /**
+     * Take an engine ready to call an event condition or branch script
+     * from the pool, loading a new one if none are idle. Engines loaded
+     * from an older copy of the script are thrown away.
+     * @param script Script to get an engine for
+     * @return Pointer to the engine or nullptr if the script failed to load
+     */
+    std::shared_ptr<libcomp::ScriptEngine> GetScriptEngine(
+        const std::shared_ptr<libcomp::ServerScript>& script);
+
+    /**
+     * Put an engine taken with @ref GetScriptEngine back in the pool and
+     * record how long the script ran.
+     * @param script Script the engine was loaded with
+     * @param engine Engine to put back
+     * @param callTime Time spent in the script in microseconds
+     */
+    void ReturnScriptEngine(
+        const std::shared_ptr<libcomp::ServerScript>& script,
+        const std::shared_ptr<libcomp::ScriptEngine>& engine,
+        uint64_t callTime);
+
     /**
      * Handle an event instance by branching into the appropriate handler
      * function after updating the character's overhead icon if needed
@@ -360,6 +431,12 @@ private:
 
     /// Pointer to the channel server.
     std::weak_ptr<ChannelServer> mServer;
+
+    /// Engines and timing of event scripts by script ID
+    std::unordered_map<std::string, ScriptPool> mScriptPools;
+
+    /// Lock for the event script engines
+    std::mutex mScriptPoolLock;
 };
 
 } // namespace channel
@@ -35,6 +35,7 @@
 #include <ServerConstants.h>
 
 // Standard C++11 Includes
+#include <algorithm>
 #include <math.h>
 
 // object Includes
@@ -75,6 +76,97 @@ FusionManager::~FusionManager()
 {
 }
 
+bool FusionManager::Initialize()
+{
+    auto definitionManager = mServer.lock()->GetDefinitionManager();
+
+    mRaceIndexes.fill(0);
+    for(size_t i = 0; i < 34; i++)
+    {
+        mRaceIndexes[FUSION_RACE_MAP[0][i]] = (uint8_t)(i + 1);
+    }
+
+    // Resolve the fusion range result of every race for every level and
+    // the ranks directly above and below each demon in the ranges
+    for(auto& dPair : definitionManager->GetAllDevilData())
+    {
+        uint8_t race = (uint8_t)dPair.second->GetCategory()->GetRace();
+        if(mRaceLevelResults.find(race) != mRaceLevelResults.end())
+        {
+            continue;
+        }
+
+        auto fusionRanges = definitionManager->GetFusionRanges(race);
+        if(fusionRanges.size() == 0)
+        {
+            continue;
+        }
+
+        auto& levelResults = mRaceLevelResults[race];
+        levelResults.resize(256);
+        for(size_t i = 0; i < levelResults.size(); i++)
+        {
+            levelResults[i] = GetResultDemon(race, (int8_t)((int)i - 128),
+                false);
+        }
+
+        for(auto it = fusionRanges.begin(); it != fusionRanges.end(); it++)
+        {
+            uint64_t key = ((uint64_t)race << 32) | it->second;
+            if(mRankSteps.find(key) != mRankSteps.end())
+            {
+                continue;
+            }
+
+            mRankSteps[key] = std::make_pair(
+                RankUpDown(race, it->second, false, false),
+                RankUpDown(race, it->second, true, false));
+        }
+    }
+
+    // Store the special fusions that can apply to each demon type in the
+    // same order the definitions list them so the first match is the same
+    // one found when checking the definitions directly
+    size_t specialCount = 0;
+    for(auto& dPair : definitionManager->GetAllDevilData())
+    {
+        auto specialDefs = definitionManager->GetTriUnionSpecialData(
+            dPair.first);
+        if(specialDefs.size() == 0)
+        {
+            continue;
+        }
+
+        auto& specials = mSpecialFusions[dPair.first];
+        for(auto specialDef : specialDefs)
+        {
+            SpecialFusion special;
+            special.Definition = specialDef;
+
+            size_t i = 0;
+            for(uint32_t sourceID : { specialDef->GetSourceID1(),
+                specialDef->GetSourceID2(), specialDef->GetSourceID3() })
+            {
+                auto sourceDef = sourceID
+                    ? definitionManager->GetDevilData(sourceID) : nullptr;
+                special.SourceBaseTypes[i++] = sourceDef
+                    ? sourceDef->GetUnionData()->GetBaseDemonID() : sourceID;
+            }
+
+            specials.push_back(special);
+        }
+
+        specialCount += specials.size();
+    }
+
+    LOG_DEBUG(libcomp::String("Built fusion tables for %1 races and %2"
+        " special fusions of %3 demons\n")
+        .Arg((uint32_t)mRaceLevelResults.size()).Arg((uint32_t)specialCount)
+        .Arg((uint32_t)mSpecialFusions.size()));
+
+    return true;
+}
+
 bool FusionManager::HandleFusion(
     const std::shared_ptr<ChannelClientConnection>& client,
     int64_t demonID1, int64_t demonID2, uint32_t costItemType)
@@ -408,13 +500,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
     bool triFusion = demonID3 > 0;
 
     auto state = client->GetClientState();
-    auto cState = state->GetCharacterState();
-    auto dState = state->GetDemonState();
-    auto character = cState->GetEntity();
-
-    auto server = mServer.lock();
-    auto characterManager = server->GetCharacterManager();
-    auto definitionManager = server->GetDefinitionManager();
+    auto character = state->GetCharacterState()->GetEntity();
 
     auto demon1 = std::dynamic_pointer_cast<objects::Demon>(
         libcomp::PersistentObject::GetObjectByUUID(state->GetObjectUUID(demonID1)));
@@ -427,24 +513,179 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
     // Fail if any demon is missing or the same one is supplied twice for a
     // normal fusion
     if(!demon1 || !demon2 || (triFusion && !demon3) ||
-        (!triFusion && demon1 == demon2))
+        (!triFusion && demon1 == demon2) || !character)
     {
         return 0;
     }
 
-    uint32_t demonType1 = demon1->GetType();
-    uint32_t demonType2 = demon2->GetType();
-    uint32_t demonType3 = demon3 ? demon3->GetType() : 0;
+    libcomp::String error;
+    uint32_t result = CalculateResultDemon(demon1->GetType(),
+        (uint8_t)demon1->GetCoreStats()->GetLevel(), demon2->GetType(),
+        (uint8_t)demon2->GetCoreStats()->GetLevel(),
+        demon3 ? demon3->GetType() : 0,
+        demon3 ? (uint8_t)demon3->GetCoreStats()->GetLevel() : 0,
+        character->GetProgress().Get(), true, error);
+    if(!error.IsEmpty())
+    {
+        LOG_ERROR(libcomp::String("%1 received from account: %2\n")
+            .Arg(error).Arg(state->GetAccountUID().ToString()));
+    }
+
+    return result;
+}
+
+uint32_t FusionManager::GetResultDemon(uint32_t demonType1, uint8_t level1,
+    uint32_t demonType2, uint8_t level2, uint32_t demonType3, uint8_t level3,
+    const std::shared_ptr<objects::CharacterProgress>& progress)
+{
+    libcomp::String error;
+    return CalculateResultDemon(demonType1, level1, demonType2, level2,
+        demonType3, level3, progress, true, error);
+}
+
+uint32_t FusionManager::VerifyFusionTables()
+{
+    auto definitionManager = mServer.lock()->GetDefinitionManager();
+
+    // Variants match special fusions differently from their base demon so
+    // both are checked
+    std::vector<std::shared_ptr<objects::MiDevilData>> demons;
+    std::vector<std::shared_ptr<objects::MiDevilData>> variants;
+    for(auto& dPair : definitionManager->GetAllDevilData())
+    {
+        if(dPair.second->GetUnionData()->GetBaseDemonID() == dPair.first)
+        {
+            demons.push_back(dPair.second);
+        }
+        else
+        {
+            variants.push_back(dPair.second);
+        }
+    }
+
+    auto idOrder = [](const std::shared_ptr<objects::MiDevilData>& a,
+        const std::shared_ptr<objects::MiDevilData>& b)
+        {
+            return a->GetBasic()->GetID() < b->GetBasic()->GetID();
+        };
+
+    std::sort(demons.begin(), demons.end(), idOrder);
+    std::sort(variants.begin(), variants.end(), idOrder);
+
+    // Every plugin is available so plugin restricted fusions are included
+    auto progress = std::make_shared<objects::CharacterProgress>();
+    for(size_t i = 0; i < progress->GetPlugins().size(); i++)
+    {
+        progress->SetPlugins(i, 0xFF);
+    }
+
+    uint32_t mismatches = 0;
+    auto check = [&](const std::shared_ptr<objects::MiDevilData>& def1,
+        uint8_t level1, const std::shared_ptr<objects::MiDevilData>& def2,
+        uint8_t level2, const std::shared_ptr<objects::MiDevilData>& def3,
+        uint8_t level3)
+        {
+            uint32_t demonType1 = def1->GetBasic()->GetID();
+            uint32_t demonType2 = def2->GetBasic()->GetID();
+            uint32_t demonType3 = def3 ? def3->GetBasic()->GetID() : 0;
+
+            libcomp::String error;
+            uint32_t expected = CalculateResultDemon(demonType1, level1,
+                demonType2, level2, demonType3, level3, progress, false,
+                error);
+            uint32_t actual = CalculateResultDemon(demonType1, level1,
+                demonType2, level2, demonType3, level3, progress, true,
+                error);
+            if(expected != actual)
+            {
+                LOG_ERROR(libcomp::String("Fusion table mismatch for demon"
+                    " types %1, %2 and %3 at levels %4, %5 and %6: expected"
+                    " %7 but found %8\n").Arg(demonType1).Arg(demonType2)
+                    .Arg(demonType3).Arg(level1).Arg(level2).Arg(level3)
+                    .Arg(expected).Arg(actual));
+                mismatches++;
+            }
+        };
+
+    auto baseLevel = [](const std::shared_ptr<objects::MiDevilData>& def)
+        {
+            return (uint8_t)def->GetGrowth()->GetBaseLevel();
+        };
+
+    // Check the lowest and highest levels along with the base levels so
+    // the edges of every fusion range are crossed
+    uint32_t pairs = 0;
+    for(size_t i = 0; i < demons.size(); i++)
+    {
+        for(size_t k = i; k < demons.size(); k++)
+        {
+            check(demons[i], baseLevel(demons[i]), demons[k],
+                baseLevel(demons[k]), nullptr, 0);
+            check(demons[i], 1, demons[k], 1, nullptr, 0);
+            check(demons[i], 99, demons[k], 99, nullptr, 0);
+            check(demons[i], 1, demons[k], 99, nullptr, 0);
+            pairs += 4;
+        }
+    }
+
+    // Special fusions are found from the first demon so each variant is
+    // checked on both sides
+    for(auto& variant : variants)
+    {
+        for(auto& demon : demons)
+        {
+            check(variant, baseLevel(variant), demon, baseLevel(demon),
+                nullptr, 0);
+            check(demon, baseLevel(demon), variant, baseLevel(variant),
+                nullptr, 0);
+            pairs += 2;
+        }
+    }
+
+    // Every tri-fusion is far too many to check so use a fixed spread
+    // that includes the variants
+    std::vector<std::shared_ptr<objects::MiDevilData>> allDemons = demons;
+    allDemons.insert(allDemons.end(), variants.begin(), variants.end());
+
+    uint32_t triples = 0;
+    for(size_t i = 0; i < allDemons.size(); i++)
+    {
+        auto& def1 = allDemons[i];
+        for(size_t step : { 1u, 7u, 31u, 127u })
+        {
+            auto& def2 = allDemons[(i + step) % allDemons.size()];
+            auto& def3 = allDemons[(i + 2 * step + 1) % allDemons.size()];
+
+            check(def1, baseLevel(def1), def2, baseLevel(def2), def3,
+                baseLevel(def3));
+            check(def1, 1, def2, 50, def3, 99);
+            triples += 2;
+        }
+    }
+
+    LOG_INFO(libcomp::String("Fusion table check compared %1 2-way fusions"
+        " and %2 tri-fusions with %3 mismatches\n").Arg(pairs).Arg(triples)
+        .Arg(mismatches));
+
+    return mismatches;
+}
+
+uint32_t FusionManager::CalculateResultDemon(uint32_t demonType1,
+    uint8_t level1, uint32_t demonType2, uint8_t level2, uint32_t demonType3,
+    uint8_t level3, const std::shared_ptr<objects::CharacterProgress>& progress,
+    bool useTables, libcomp::String& error)
+{
+    bool triFusion = demonType3 > 0;
+
+    auto definitionManager = mServer.lock()->GetDefinitionManager();
 
     auto def1 = std::pair<uint8_t, std::shared_ptr<objects::MiDevilData>>(
-            (uint8_t)demon1->GetCoreStats()->GetLevel(),
-            definitionManager->GetDevilData(demonType1));
+            level1, definitionManager->GetDevilData(demonType1));
     auto def2 = std::pair<uint8_t, std::shared_ptr<objects::MiDevilData>>(
-            (uint8_t)demon2->GetCoreStats()->GetLevel(),
-            definitionManager->GetDevilData(demonType2));
+            level2, definitionManager->GetDevilData(demonType2));
     auto def3 = std::pair<uint8_t, std::shared_ptr<objects::MiDevilData>>(
-            demon3 ? (uint8_t)demon3->GetCoreStats()->GetLevel() : 0,
-            demonType3 ? definitionManager->GetDevilData(demonType3) : nullptr);
+            level3, demonType3 ? definitionManager->GetDevilData(demonType3)
+            : nullptr);
     if(!def1.second || !def2.second || (triFusion && !def3.second))
     {
         return 0;
@@ -455,130 +696,158 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
     uint32_t baseDemonType3 = def3.second
         ? def3.second->GetUnionData()->GetBaseDemonID() : 0;
 
-    auto specialFusions = definitionManager->GetTriUnionSpecialData(demonType1);
-    for(auto special : specialFusions)
+    if(useTables)
     {
-        if(triFusion != (special->GetSourceID3() > 0)) continue;
-
-        // Map of source ID to its "variant allowed" value
-        std::array<std::pair<uint32_t, bool>, 3> sources;
-        sources[0] = std::pair<uint32_t, bool>(special->GetSourceID1(),
-            special->GetVariant1Allowed() == 1);
-        sources[1] = std::pair<uint32_t, bool>(special->GetSourceID2(),
-            special->GetVariant2Allowed() == 1);
-        sources[2] = std::pair<uint32_t, bool>(special->GetSourceID3(),
-            special->GetVariant3Allowed() == 1);
-
-        // Store each demon number that matches the corresponding source
-        std::array<std::set<uint8_t>, 3> matches;
-
-        bool match = true;
-        for(size_t i = 0; i < 3; i++)
+        auto it = mSpecialFusions.find(demonType1);
+        if(it != mSpecialFusions.end())
         {
-            std::pair<uint32_t, bool>& sourcePair = sources[i];
+            std::array<uint32_t, 3> demonTypes = { { demonType1, demonType2,
+                demonType3 } };
+            std::array<uint32_t, 3> baseDemonTypes = { { baseDemonType1,
+                baseDemonType2, baseDemonType3 } };
 
-            uint32_t sourceID = sourcePair.first;
-            if(!sourceID) continue;
-
-            if(sourcePair.second)
+            for(auto& special : it->second)
             {
-                // Match against base demon
-                auto specialDef = definitionManager->GetDevilData(sourceID);
-                auto sourceBaseDemonType = specialDef->GetUnionData()
-                    ->GetBaseDemonID();
-                if(baseDemonType1 == sourceBaseDemonType)
+                if(MatchSpecialFusion(special, demonTypes, baseDemonTypes,
+                    triFusion, progress))
                 {
-                    matches[i].insert(1);
+                    return special.Definition->GetResultID();
                 }
+            }
+        }
+    }
+    else
+    {
+        auto characterManager = mServer.lock()->GetCharacterManager();
 
-                if(baseDemonType2 == sourceBaseDemonType)
-                {
-                    matches[i].insert(2);
-                }
+        auto specialFusions = definitionManager->GetTriUnionSpecialData(
+            demonType1);
+        for(auto special : specialFusions)
+        {
+            if(triFusion != (special->GetSourceID3() > 0)) continue;
+
+            // Map of source ID to its "variant allowed" value
+            std::array<std::pair<uint32_t, bool>, 3> sources;
+            sources[0] = std::pair<uint32_t, bool>(special->GetSourceID1(),
+                special->GetVariant1Allowed() == 1);
+            sources[1] = std::pair<uint32_t, bool>(special->GetSourceID2(),
+                special->GetVariant2Allowed() == 1);
+            sources[2] = std::pair<uint32_t, bool>(special->GetSourceID3(),
+                special->GetVariant3Allowed() == 1);
+
+            // Store each demon number that matches the corresponding source
+            std::array<std::set<uint8_t>, 3> matches;
+
+            bool match = true;
+            for(size_t i = 0; i < 3; i++)
+            {
+                std::pair<uint32_t, bool>& sourcePair = sources[i];
+
+                uint32_t sourceID = sourcePair.first;
+                if(!sourceID) continue;
 
-                if(baseDemonType3 == sourceBaseDemonType)
+                if(sourcePair.second)
                 {
-                    matches[i].insert(3);
+                    // Match against base demon
+                    auto specialDef = definitionManager->GetDevilData(
+                        sourceID);
+                    auto sourceBaseDemonType = specialDef->GetUnionData()
+                        ->GetBaseDemonID();
+                    if(baseDemonType1 == sourceBaseDemonType)
+                    {
+                        matches[i].insert(1);
+                    }
+
+                    if(baseDemonType2 == sourceBaseDemonType)
+                    {
+                        matches[i].insert(2);
+                    }
+
+                    if(baseDemonType3 == sourceBaseDemonType)
+                    {
+                        matches[i].insert(3);
+                    }
                 }
-            }
-            else
-            {
-                // Match against exact demon
-                if(demonType1 == sourceID)
+                else
                 {
-                    matches[i].insert(1);
-                }
+                    // Match against exact demon
+                    if(demonType1 == sourceID)
+                    {
+                        matches[i].insert(1);
+                    }
 
-                if(demonType2 == sourceID)
-                {
-                    matches[i].insert(2);
+                    if(demonType2 == sourceID)
+                    {
+                        matches[i].insert(2);
+                    }
+
+                    if(demonType3 == sourceID)
+                    {
+                        matches[i].insert(3);
+                    }
                 }
 
-                if(demonType3 == sourceID)
+                if(matches[i].size() == 0)
                 {
-                    matches[i].insert(3);
+                    // No match found for the current source demon
+                    match = false;
+                    break;
                 }
             }
 
-            if(matches[i].size() == 0)
+            if(match)
             {
-                // No match found for the current source demon
+                // If one of each required type is found, check to make sure
+                // there is a valid combination available (vital when fusing
+                // two of the same type or a variant and a specific demon with
+                // the same base type)
                 match = false;
-                break;
-            }
-        }
-
-        if(match)
-        {
-            // If one of each required type is found, check to make sure
-            // there is a valid combination available (vital when fusing
-            // two of the same type or a variant and a specific demon with
-            // the same base type)
-            match = false;
-            for(uint8_t m1 : matches[0])
-            {
-                for(uint8_t m2 : matches[1])
+                for(uint8_t m1 : matches[0])
                 {
-                    if(triFusion)
+                    for(uint8_t m2 : matches[1])
                     {
-                        for(uint8_t m3 : matches[2])
+                        if(triFusion)
                         {
-                            if(m1 != m2 && m1 != m3 && m2 != m3)
+                            for(uint8_t m3 : matches[2])
                             {
-                                match = true;
-                                break;
+                                if(m1 != m2 && m1 != m3 && m2 != m3)
+                                {
+                                    match = true;
+                                    break;
+                                }
                             }
-                        }
 
-                        if(match) break;
-                    }
-                    else if(m1 != m2)
-                    {
-                        match = true;
-                        break;
+                            if(match) break;
+                        }
+                        else if(m1 != m2)
+                        {
+                            match = true;
+                            break;
+                        }
                     }
-                }
 
-                if(match) break;
+                    if(match) break;
+                }
             }
-        }
 
-        if(match && special->GetPluginID() > 0)
-        {
-            // Check that the player has the plugin
-            size_t index;
-            uint8_t shiftVal;
-            characterManager->ConvertIDToMaskValues(
-                (uint16_t)special->GetPluginID(), index, shiftVal);
+            if(match && special->GetPluginID() > 0)
+            {
+                // Check that the player has the plugin
+                size_t index;
+                uint8_t shiftVal;
+                characterManager->ConvertIDToMaskValues(
+                    (uint16_t)special->GetPluginID(), index, shiftVal);
 
-            uint8_t indexVal = character->GetProgress()->GetPlugins(index);
+                uint8_t indexVal = progress
+                    ? progress->GetPlugins(index) : 0;
 
-            match = (indexVal & shiftVal) != 0;
-        }
+                match = (indexVal & shiftVal) != 0;
+            }
 
-        if(match)
-        {
-            return special->GetResultID();
+            if(match)
+            {
+                return special->GetResultID();
+            }
         }
     }
 
@@ -673,29 +942,30 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
 
                 bool found1, found2;
                 size_t race1Idx = GetRaceIndex((uint8_t)otherDef1.second
-                    ->GetCategory()->GetRace(), found1);
+                    ->GetCategory()->GetRace(), found1, useTables);
                 size_t race2Idx = GetRaceIndex((uint8_t)otherDef2.second
-                    ->GetCategory()->GetRace(), found2);
+                    ->GetCategory()->GetRace(), found2, useTables);
 
                 if(!found1 || !found2)
                 {
-                    LOG_ERROR("Invalid single dark, dual fusion race"
-                        " encountered for trifusion\n");
+                    error = "Invalid single dark, dual fusion race"
+                        " encountered for trifusion";
                     return 0;
                 }
 
                 uint8_t resultRace = FUSION_RACE_MAP[race1Idx + 1][race2Idx];
                 resultDef = GetResultDemon(resultRace,
-                    GetAdjustedLevelSum(otherDef1.first, otherDef2.first));
+                    GetAdjustedLevelSum(otherDef1.first, otherDef2.first),
+                    useTables);
 
-                race1Idx = GetRaceIndex(resultRace, found1);
+                race1Idx = GetRaceIndex(resultRace, found1, useTables);
                 race2Idx = GetRaceIndex((uint8_t)darkDef.second
-                    ->GetCategory()->GetRace(), found2);
+                    ->GetCategory()->GetRace(), found2, useTables);
 
                 if(!found1 || !found2)
                 {
-                    LOG_ERROR("Invalid single dark, 2nd dual fusion race"
-                        " encountered for trifusion\n");
+                    error = "Invalid single dark, 2nd dual fusion race"
+                        " encountered for trifusion";
                     return 0;
                 }
                 else if(!resultDef)
@@ -706,7 +976,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
                 resultRace = FUSION_RACE_MAP[race1Idx + 1][race2Idx];
                 resultDef = GetResultDemon(resultRace,
                     GetAdjustedLevelSum(darkDef.first,
-                        resultDef->GetGrowth()->GetBaseLevel()));
+                        resultDef->GetGrowth()->GetBaseLevel()), useTables);
             }
             else if(darkCount == 2)
             {
@@ -720,44 +990,43 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
 
                 bool found1, found2;
                 size_t race1Idx = GetRaceIndex((uint8_t)darkDef1.second
-                    ->GetCategory()->GetRace(), found1);
+                    ->GetCategory()->GetRace(), found1, useTables);
                 size_t race2Idx = GetRaceIndex((uint8_t)otherDef.second
-                    ->GetCategory()->GetRace(), found2);
+                    ->GetCategory()->GetRace(), found2, useTables);
 
                 if(!found1 || !found2)
                 {
-                    LOG_ERROR("Invalid double dark, dual fusion race"
-                        " encountered for trifusion\n");
+                    error = "Invalid double dark, dual fusion race"
+                        " encountered for trifusion";
                     return 0;
                 }
 
                 uint8_t resultRace = FUSION_RACE_MAP[race1Idx + 1][race2Idx];
                 resultDef = GetResultDemon(resultRace,
-                    GetAdjustedLevelSum(darkDef1.first, otherDef.first));
+                    GetAdjustedLevelSum(darkDef1.first, otherDef.first),
+                    useTables);
 
-                race1Idx = GetRaceIndex(resultRace, found1);
+                race1Idx = GetRaceIndex(resultRace, found1, useTables);
                 race2Idx = GetRaceIndex((uint8_t)darkDef2.second
-                    ->GetCategory()->GetRace(), found2);
+                    ->GetCategory()->GetRace(), found2, useTables);
 
                 if(!found1 || !found2 || !resultDef)
                 {
-                    LOG_ERROR("Invalid double dark, 2nd dual fusion race"
-                        " encountered for trifusion\n");
+                    error = "Invalid double dark, 2nd dual fusion race"
+                        " encountered for trifusion";
                     return 0;
                 }
 
                 resultRace = FUSION_RACE_MAP[race1Idx + 1][race2Idx];
                 resultDef = GetResultDemon(resultRace,
                     GetAdjustedLevelSum(darkDef2.first,
-                    resultDef->GetGrowth()->GetBaseLevel()));
+                    resultDef->GetGrowth()->GetBaseLevel()), useTables);
             }
             else
             {
                 // Get corrected level sum and return explicit level
                 // range demon
-                uint16_t levelSum = (uint16_t)(demon1->GetCoreStats()->GetLevel() +
-                    demon2->GetCoreStats()->GetLevel() +
-                    demon3->GetCoreStats()->GetLevel());
+                uint16_t levelSum = (uint16_t)(level1 + level2 + level3);
 
                 uint32_t resultID = SVR_CONST.TRIFUSION_SPECIAL_DARK.front().second;
                 for(auto pair : SVR_CONST.TRIFUSION_SPECIAL_DARK)
@@ -775,7 +1044,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
         }
         else if(elementalCount == 3)
         {
-            LOG_ERROR("Attempted to fuse 3 elementals\n");
+            error = "Attempted to fuse 3 elementals";
             return 0;
         }
         else if(elementalCount == 2)
@@ -820,7 +1089,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
                 }
             }
 
-            LOG_ERROR("Invalid double elemental trifusion encountered\n");
+            error = "Invalid double elemental trifusion encountered";
             return 0;
         }
         else if(elementalCount == 1)
@@ -832,24 +1101,25 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
 
             bool found1, found2;
             size_t race1Idx = GetRaceIndex((uint8_t)otherDef1.second
-                ->GetCategory()->GetRace(), found1);
+                ->GetCategory()->GetRace(), found1, useTables);
             size_t race2Idx = GetRaceIndex((uint8_t)otherDef2.second
-                ->GetCategory()->GetRace(), found2);
+                ->GetCategory()->GetRace(), found2, useTables);
 
             if(!found1 || !found2)
             {
-                LOG_ERROR("Invalid single element, dual fusion race"
-                    " encountered for trifusion\n");
+                error = "Invalid single element, dual fusion race"
+                    " encountered for trifusion";
                 return 0;
             }
 
             uint8_t resultRace = FUSION_RACE_MAP[race1Idx + 1][race2Idx];
             resultDef = GetResultDemon(resultRace,
-                GetAdjustedLevelSum(otherDef1.first, otherDef2.first));
+                GetAdjustedLevelSum(otherDef1.first, otherDef2.first),
+                useTables);
             if(resultRace == eRace)
             {
-                LOG_ERROR("Single element, dual fusion race for"
-                    " trifusion resulted in a second elemental\n");
+                error = "Single element, dual fusion race for"
+                    " trifusion resulted in a second elemental";
                 return 0;
             }
 
@@ -857,7 +1127,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
             {
                 resultDef = GetResultDemon(resultRace,
                     GetAdjustedLevelSum(elemDef.first,
-                        resultDef->GetGrowth()->GetBaseLevel()));
+                        resultDef->GetGrowth()->GetBaseLevel()), useTables);
             }
         }
         else
@@ -894,14 +1164,14 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
             if(race1 == race2 || f1 == f2)
             {
                 bool found1, found2, found3;
-                size_t race1Idx = GetRaceIndex(race1, found1);
-                size_t race2Idx = GetRaceIndex(race2, found2);
-                size_t race3Idx = GetRaceIndex(race3, found3);
+                size_t race1Idx = GetRaceIndex(race1, found1, useTables);
+                size_t race2Idx = GetRaceIndex(race2, found2, useTables);
+                size_t race3Idx = GetRaceIndex(race3, found3, useTables);
 
                 if(!found1 || !found2 || !found3)
                 {
-                    LOG_ERROR("Invalid dual fusion race"
-                        " encountered for trifusion\n");
+                    error = "Invalid dual fusion race"
+                        " encountered for trifusion";
                     return 0;
                 }
 
@@ -914,27 +1184,29 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
                     auto elemType = GetElementalType((size_t)(resultRace - 1));
 
                     uint32_t result = GetElementalFuseResult(elemType,
-                        race3, def3.second->GetBasic()->GetID(), true);
+                        race3, def3.second->GetBasic()->GetID(), useTables,
+                        true);
                     if(result == 0)
                     {
-                        LOG_ERROR(libcomp::String("Invalid elemental fusion request"
-                            " during TriFusion mid-point fusion: %1, %2, %3\n")
-                            .Arg(demonType1).Arg(demonType2).Arg(demonType3));
+                        error = libcomp::String("Invalid elemental fusion request"
+                            " during TriFusion mid-point fusion: %1, %2, %3")
+                            .Arg(demonType1).Arg(demonType2).Arg(demonType3);
                     }
 
                     return result;
                 }
 
-                race1Idx = GetRaceIndex(resultRace, found1);
+                race1Idx = GetRaceIndex(resultRace, found1, useTables);
                 if(found1)
                 {
                     resultRace = FUSION_RACE_MAP[race1Idx + 1][race3Idx];
-                    resultDef = GetResultDemon(resultRace, adjustedLevelSum);
+                    resultDef = GetResultDemon(resultRace, adjustedLevelSum,
+                        useTables);
                 }
                 else
                 {
-                    LOG_ERROR("Invalid nested dual fusion race"
-                        " encountered for trifusion\n");
+                    error = "Invalid nested dual fusion race"
+                        " encountered for trifusion";
                     return 0;
                 }
             }
@@ -949,7 +1221,8 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
 
                 uint8_t resultRace = TRIFUSION_FAMILY_MAP[fIdx1][fIdx2][fIdx3];
 
-                resultDef = GetResultDemon(resultRace, adjustedLevelSum);
+                resultDef = GetResultDemon(resultRace, adjustedLevelSum,
+                    useTables);
             }
         }
 
@@ -963,8 +1236,8 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
 
     // Get the race axis mappings from the first map row
     bool found1, found2;
-    size_t race1Idx = GetRaceIndex(race1, found1);
-    size_t race2Idx = GetRaceIndex(race2, found2);
+    size_t race1Idx = GetRaceIndex(race1, found1, useTables);
+    size_t race2Idx = GetRaceIndex(race2, found2, useTables);
 
     if(race1 == eRace || race2 == eRace)
     {
@@ -973,7 +1246,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
         if(race1 == race2)
         {
             /// @todo: support mitama result fusions
-            LOG_ERROR("Mitama fusion is not supported yet\n");
+            error = "Mitama fusion is not supported yet";
             return 0;
         }
 
@@ -993,13 +1266,11 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
         }
 
         uint32_t result = GetElementalFuseResult(elementalType, race,
-            demonType);
+            demonType, useTables);
         if(result == 0)
         {
-            LOG_ERROR(libcomp::String("Invalid elemental fusion request"
-                " of demon IDs  %1 and %2 received from account: %3\n")
-                .Arg(demonType1).Arg(demonType2)
-                .Arg(state->GetAccountUID().ToString()));
+            error = libcomp::String("Invalid elemental fusion request"
+                " of demon IDs %1 and %2").Arg(demonType1).Arg(demonType2);
         }
 
         return result;
@@ -1008,18 +1279,16 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
     {
         if(!found1 || !found2)
         {
-            LOG_ERROR(libcomp::String("Invalid fusion request of demon IDs"
-                " %1 and %2 received from account: %3\n").Arg(demonType1)
-                .Arg(demonType2).Arg(state->GetAccountUID().ToString()));
+            error = libcomp::String("Invalid fusion request of demon IDs"
+                " %1 and %2").Arg(demonType1).Arg(demonType2);
             return 0;
         }
 
         resultRace = FUSION_RACE_MAP[(size_t)(race1Idx + 1)][race2Idx];
         if(resultRace == 0)
         {
-            LOG_ERROR(libcomp::String("Invalid fusion result of demon IDs"
-                " %1 and %2 requested from account: %3\n").Arg(demonType1)
-                .Arg(demonType2).Arg(state->GetAccountUID().ToString()));
+            error = libcomp::String("Invalid fusion result of demon IDs"
+                " %1 and %2").Arg(demonType1).Arg(demonType2);
             return 0;
         }
 
@@ -1033,8 +1302,7 @@ uint32_t FusionManager::GetResultDemon(const std::shared_ptr<
     if(resultRace != 0)
     {
         auto resultDef = GetResultDemon(resultRace,
-            GetAdjustedLevelSum((uint8_t)demon1->GetCoreStats()->GetLevel(),
-                (uint8_t)demon2->GetCoreStats()->GetLevel()));
+            GetAdjustedLevelSum(level1, level2), useTables);
         return resultDef ? resultDef->GetBasic()->GetID() : 0;
     }
 
@@ -1136,6 +1404,112 @@ void FusionManager::EndExchange(const std::shared_ptr<
     }
 }
 
+bool FusionManager::MatchSpecialFusion(const SpecialFusion& special,
+    const std::array<uint32_t, 3>& demonTypes,
+    const std::array<uint32_t, 3>& baseDemonTypes, bool triFusion,
+    const std::shared_ptr<objects::CharacterProgress>& progress)
+{
+    auto def = special.Definition;
+    if(triFusion != (def->GetSourceID3() > 0))
+    {
+        return false;
+    }
+
+    // Map of source ID to its "variant allowed" value
+    std::array<std::pair<uint32_t, bool>, 3> sources;
+    sources[0] = std::pair<uint32_t, bool>(def->GetSourceID1(),
+        def->GetVariant1Allowed() == 1);
+    sources[1] = std::pair<uint32_t, bool>(def->GetSourceID2(),
+        def->GetVariant2Allowed() == 1);
+    sources[2] = std::pair<uint32_t, bool>(def->GetSourceID3(),
+        def->GetVariant3Allowed() == 1);
+
+    // Store each demon number that matches the corresponding source
+    std::array<std::set<uint8_t>, 3> matches;
+
+    for(size_t i = 0; i < 3; i++)
+    {
+        std::pair<uint32_t, bool>& sourcePair = sources[i];
+
+        uint32_t sourceID = sourcePair.first;
+        if(!sourceID) continue;
+
+        for(uint8_t k = 0; k < 3; k++)
+        {
+            if(sourcePair.second)
+            {
+                // Match against base demon
+                if(baseDemonTypes[k] == special.SourceBaseTypes[i])
+                {
+                    matches[i].insert((uint8_t)(k + 1));
+                }
+            }
+            else if(demonTypes[k] == sourceID)
+            {
+                // Match against exact demon
+                matches[i].insert((uint8_t)(k + 1));
+            }
+        }
+
+        if(matches[i].size() == 0)
+        {
+            // No match found for the current source demon
+            return false;
+        }
+    }
+
+    // If one of each required type is found, check to make sure there is a
+    // valid combination available (vital when fusing two of the same type or
+    // a variant and a specific demon with the same base type)
+    bool match = false;
+    for(uint8_t m1 : matches[0])
+    {
+        for(uint8_t m2 : matches[1])
+        {
+            if(triFusion)
+            {
+                for(uint8_t m3 : matches[2])
+                {
+                    if(m1 != m2 && m1 != m3 && m2 != m3)
+                    {
+                        match = true;
+                        break;
+                    }
+                }
+
+                if(match) break;
+            }
+            else if(m1 != m2)
+            {
+                match = true;
+                break;
+            }
+        }
+
+        if(match) break;
+    }
+
+    if(match && def->GetPluginID() > 0)
+    {
+        // Check that the player has the plugin
+        if(!progress)
+        {
+            return false;
+        }
+
+        size_t index;
+        uint8_t shiftVal;
+        mServer.lock()->GetCharacterManager()->ConvertIDToMaskValues(
+            (uint16_t)def->GetPluginID(), index, shiftVal);
+
+        uint8_t indexVal = progress->GetPlugins(index);
+
+        match = (indexVal & shiftVal) != 0;
+    }
+
+    return match;
+}
+
 int8_t FusionManager::ProcessFusion(
     const std::shared_ptr<ChannelClientConnection>& client, int64_t demonID1,
     int64_t demonID2, int64_t demonID3, uint32_t costItemType,
@@ -1542,8 +1916,21 @@ int8_t FusionManager::GetAdjustedLevelSum(uint8_t level1, uint8_t level2,
 }
 
 std::shared_ptr<objects::MiDevilData> FusionManager::GetResultDemon(
-    uint8_t race, int8_t adjustedLevelSum)
+    uint8_t race, int8_t adjustedLevelSum, bool useTables)
 {
+    if(useTables)
+    {
+        auto it = mRaceLevelResults.find(race);
+        if(it == mRaceLevelResults.end())
+        {
+            LOG_ERROR(libcomp::String("No valid fusion range found"
+                " for race ID: %1\n").Arg(race));
+            return 0;
+        }
+
+        return it->second[(size_t)(adjustedLevelSum + 128)];
+    }
+
     // Normal race selection adjusted for level range
     auto definitionManager = mServer.lock()->GetDefinitionManager();
     auto fusionRanges = definitionManager->GetFusionRanges(race);
@@ -1583,10 +1970,10 @@ uint32_t FusionManager::GetElementalType(size_t elementalIndex) const
 }
 
 uint32_t FusionManager::GetElementalFuseResult(uint32_t elementalType,
-    uint8_t otherRace, uint32_t otherType, bool adjustMinRank)
+    uint8_t otherRace, uint32_t otherType, bool useTables, bool adjustMinRank)
 {
     bool raceFound = false;
-    size_t raceIdx = GetRaceIndex(otherRace, raceFound);
+    size_t raceIdx = GetRaceIndex(otherRace, raceFound, useTables);
 
     bool elementalFound = false;
     size_t elementalIdx = GetElementalIndex(elementalType, elementalFound);
@@ -1597,22 +1984,31 @@ uint32_t FusionManager::GetElementalFuseResult(uint32_t elementalType,
     }
 
     bool up = FUSION_ELEMENTAL_ADJUST[raceIdx][elementalIdx] == 1;
-    uint32_t result = RankUpDown(otherRace, otherType, up);
+    uint32_t result = RankUpDown(otherRace, otherType, up, useTables);
     if(!up && adjustMinRank)
     {
-        uint32_t rankDown = RankUpDown(otherRace, result, false);
+        uint32_t rankDown = RankUpDown(otherRace, result, false, useTables);
         if(rankDown == result)
         {
             // Min rank must be one below lowest
-            result = RankUpDown(otherRace, result, true);
+            result = RankUpDown(otherRace, result, true, useTables);
         }
     }
 
     return result;
 }
 
-size_t FusionManager::GetRaceIndex(uint8_t raceID, bool& found)
+size_t FusionManager::GetRaceIndex(uint8_t raceID, bool& found,
+    bool useTables)
 {
+    if(useTables)
+    {
+        uint8_t idx = mRaceIndexes[raceID];
+        found = idx != 0;
+
+        return found ? (size_t)(idx - 1) : 0;
+    }
+
     found = false;
 
     for(size_t i = 0; i < 34; i++)
@@ -1644,8 +2040,19 @@ size_t FusionManager::GetElementalIndex(uint32_t elemType, bool& found)
 }
 
 uint32_t FusionManager::RankUpDown(uint8_t raceID, uint32_t demonType,
-    bool up)
+    bool up, bool useTables)
 {
+    if(useTables)
+    {
+        auto it = mRankSteps.find(((uint64_t)raceID << 32) | demonType);
+        if(it == mRankSteps.end())
+        {
+            return demonType;
+        }
+
+        return up ? it->second.second : it->second.first;
+    }
+
     auto fusionRanges = mServer.lock()->GetDefinitionManager()
         ->GetFusionRanges(raceID);
 
@@ -27,12 +27,17 @@
 #ifndef SERVER_CHANNEL_SRC_FUSIONMANAGER_H
 #define SERVER_CHANNEL_SRC_FUSIONMANAGER_H
 
+// Standard C++11 Includes
+#include <array>
+
 // channel Includes
 #include "ChannelClientConnection.h"
 
 namespace objects
 {
+class CharacterProgress;
 class MiDevilData;
+class MiTriUnionSpecialData;
 }
 
 namespace channel
@@ -57,6 +62,13 @@ public:
      */
     virtual ~FusionManager();
 
+    /**
+     * Build the fusion lookup tables from the loaded definitions. This must
+     * be called once all definitions have been loaded.
+     * @return false if the tables could not be built
+     */
+    bool Initialize();
+
     /**
      * Perform a normal 2-way fusion and respond to the client with the
      * results
@@ -97,6 +109,36 @@ public:
         ChannelClientConnection>& client, int64_t demonID1, int64_t demonID2,
         int64_t demonID3);
 
+    /**
+     * Calculate the resulting demon of a fusion from the supplied demon
+     * types and levels using the precomputed fusion tables
+     * @param demonType1 Type of the first demon being fused
+     * @param level1 Current level of the first demon
+     * @param demonType2 Type of the second demon being fused
+     * @param level2 Current level of the second demon
+     * @param demonType3 Type of the third demon being fused, 0 for a
+     *  normal 2-way fusion
+     * @param level3 Current level of the third demon
+     * @param progress Pointer to the progress of the character performing
+     *  the fusion, used to check for plugin restricted special fusions.
+     *  If null, no plugins are available.
+     * @return Type ID of the demon that would be fused, 0 if the fusion
+     *  is not valid
+     */
+    uint32_t GetResultDemon(uint32_t demonType1, uint8_t level1,
+        uint32_t demonType2, uint8_t level2, uint32_t demonType3,
+        uint8_t level3, const std::shared_ptr<
+        objects::CharacterProgress>& progress);
+
+    /**
+     * Compare the results of the precomputed fusion tables against the full
+     * calculation from the definitions for every 2-way fusion between base
+     * demons at several levels, every variant fused with each base demon
+     * and a spread of tri-fusions. Each mismatch is logged.
+     * @return Number of fusions with mismatched results
+     */
+    uint32_t VerifyFusionTables();
+
     /**
      * End any fusion based exchanges the player is a part of. If they
      * are hosting a tri-fusion, all guests will be informed as well.
@@ -106,6 +148,60 @@ public:
         channel::ChannelClientConnection>& client);
 
 private:
+    /**
+     * Special fusion definition with the base demon type of each source
+     * resolved ahead of time.
+     */
+    struct SpecialFusion
+    {
+        /// Pointer to the special fusion definition
+        std::shared_ptr<objects::MiTriUnionSpecialData> Definition;
+
+        /// Base demon type of each source, 0 if the source is not set
+        std::array<uint32_t, 3> SourceBaseTypes;
+    };
+
+    /**
+     * Calculate the resulting demon of a fusion from the supplied demon
+     * types and levels
+     * @param demonType1 Type of the first demon being fused
+     * @param level1 Current level of the first demon
+     * @param demonType2 Type of the second demon being fused
+     * @param level2 Current level of the second demon
+     * @param demonType3 Type of the third demon being fused, 0 for a
+     *  normal 2-way fusion
+     * @param level3 Current level of the third demon
+     * @param progress Pointer to the progress of the character performing
+     *  the fusion, null if no plugins are available
+     * @param useTables true if the precomputed tables should be used, false
+     *  if every step should be calculated from the definitions
+     * @param error Output parameter set to a description of the problem if
+     *  the fusion is not valid
+     * @return Type ID of the demon that would be fused, 0 if the fusion
+     *  is not valid
+     */
+    uint32_t CalculateResultDemon(uint32_t demonType1, uint8_t level1,
+        uint32_t demonType2, uint8_t level2, uint32_t demonType3,
+        uint8_t level3, const std::shared_ptr<
+        objects::CharacterProgress>& progress, bool useTables,
+        libcomp::String& error);
+
+    /**
+     * Check if the supplied demons satisfy a special fusion
+     * @param special Special fusion to check
+     * @param demonTypes Types of the demons being fused, 0 if not set
+     * @param baseDemonTypes Base types of the demons being fused, 0 if
+     *  not set
+     * @param triFusion true if the fusion is a tri-fusion
+     * @param progress Pointer to the progress of the character performing
+     *  the fusion, null if no plugins are available
+     * @return true if the special fusion applies
+     */
+    bool MatchSpecialFusion(const SpecialFusion& special,
+        const std::array<uint32_t, 3>& demonTypes,
+        const std::array<uint32_t, 3>& baseDemonTypes, bool triFusion,
+        const std::shared_ptr<objects::CharacterProgress>& progress);
+
     /**
      * Perform a two-way or tri-fusion based upon the supplied demon IDs
      * @param client Pointer to the client performing the fusion
@@ -145,10 +241,11 @@ private:
      * Get the resulting demon of an adjusted race level range
      * @param race Race of the demon to retrieve
      * @param adjustedLevelSum Level to use when checking level ranges
+     * @param useTables true if the precomputed tables should be used
      * @return Pointer to the definition of the result demon
      */
     std::shared_ptr<objects::MiDevilData> GetResultDemon(uint8_t race,
-        int8_t adjustedLevelSum);
+        int8_t adjustedLevelSum, bool useTables);
 
     /**
      * Get the demon type ID associated to an elemental index from the manager
@@ -162,21 +259,23 @@ private:
      * @param elementalType Elemental demon type
      * @param otherRace Race of the non-elemental demon
      * @param otherType Type of the non-elemental demon
+     * @param useTables true if the precomputed tables should be used
      * @param adjustMinRank true if the second to lowest rank should be used
      *  should a rank down occur and reach the lowest rank
      * @return Type ID of the result demon
      */
     uint32_t GetElementalFuseResult(uint32_t elementalType, uint8_t otherRace,
-        uint32_t otherType, bool adjustMinRank = false);
+        uint32_t otherType, bool useTables, bool adjustMinRank = false);
 
     /**
      * Get the race index of the supplied race that matches the FusionTables
      * entries
      * @param otherRace Race to calculate
      * @param found Output parameter indicating if the index was found
+     * @param useTables true if the precomputed tables should be used
      * @return Race index for the supplied race
      */
-    size_t GetRaceIndex(uint8_t raceID, bool& found);
+    size_t GetRaceIndex(uint8_t raceID, bool& found, bool useTables);
 
     /**
      * Get the elemental index of the supplied type that matches the
@@ -193,9 +292,29 @@ private:
      * @param raceID Race of the demon to adjust
      * @param demonType Type of the demon to adjust
      * @param up true if checking higher, false if checking lower
+     * @param useTables true if the precomputed tables should be used
      * @return Demon type directly above or below the supplied type
      */
-    uint32_t RankUpDown(uint8_t raceID, uint32_t demonType, bool up);
+    uint32_t RankUpDown(uint8_t raceID, uint32_t demonType, bool up,
+        bool useTables);
+
+    /// Index of each race ID in the first row of FUSION_RACE_MAP plus one
+    /// or 0 if the race is not in the table
+    std::array<uint8_t, 256> mRaceIndexes;
+
+    /// Map of race IDs to the demon resulting from a fusion of that race
+    /// indexed by adjusted level sum plus 128
+    std::unordered_map<uint8_t, std::vector<
+        std::shared_ptr<objects::MiDevilData>>> mRaceLevelResults;
+
+    /// Map of race IDs (upper 32 bits) and demon types (lower 32 bits) to
+    /// the demon types one rank below and one rank above in the race's
+    /// fusion ranges
+    std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> mRankSteps;
+
+    /// Map of demon types to the special fusions that can apply when the
+    /// demon is the first one being fused, in the order they are checked
+    std::unordered_map<uint32_t, std::vector<SpecialFusion>> mSpecialFusions;
 
     /// Pointer to the channel server.
     std::weak_ptr<ChannelServer> mServer;
@@ -63,8 +63,13 @@ bool ManagerSystem::ProcessMessage(const libcomp::Message::Message *pMessage)
         auto server = std::dynamic_pointer_cast<ChannelServer>(
             mServer.lock());
 
+        auto scheduler = server->GetTickScheduler();
+        scheduler->TickStarted(libcomp::TickScheduler::Clock::now());
+
         server->Tick();
 
+        scheduler->TickFinished(libcomp::TickScheduler::Clock::now());
+
         return true;
     }
 
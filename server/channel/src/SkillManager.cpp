@@ -38,6 +38,7 @@
 #include <ServerDataManager.h>
 
 // Standard C++11 Includes
+#include <algorithm>
 #include <math.h>
 
 // object Includes
@@ -962,8 +963,8 @@ void SkillManager::SendFailure(const std::shared_ptr<ActiveEntityState> source,
     }
     else if(source && source->GetZone())
     {
-        auto zConnections = source->GetZone()->GetConnectionList();
-        ChannelClientConnection::BroadcastPacket(zConnections, p);
+        mServer.lock()->GetZoneManager()->BroadcastEntityPacket(
+            source->GetZone(), source->GetEntityID(), p);
     }
 }
 
@@ -1243,10 +1244,6 @@ bool SkillManager::ProcessSkillResult(std::shared_ptr<objects::ActivatedAbility>
 
                 double maxTargetRange = (double)(skillData->GetTarget()->GetRange() * 10);
 
-                // Get entities in range using the target distance
-                auto potentialTargets = zone->GetActiveEntitiesInRadius(
-                    sourceX, sourceY, maxTargetRange);
-
                 // Center pointer of the arc
                 float sourceRot = ActiveEntityState::CorrectRotation(
                     effectiveSource->GetCurrentRotation());
@@ -1256,8 +1253,9 @@ bool SkillManager::ProcessSkillResult(std::shared_ptr<objects::ActivatedAbility>
                 // behave like a source radius AoE)
                 float maxRotOffset = (float)aoeRange * 0.001f * 3.14f;
 
-                effectiveTargets = ZoneManager::GetEntitiesInFoV(potentialTargets, sourceX,
-                    sourceY, sourceRot, maxRotOffset);
+                // Get entities in the FoV using the target distance
+                effectiveTargets = zone->GetActiveEntitiesInFoV(sourceX,
+                    sourceY, maxTargetRange, sourceRot, maxRotOffset);
             }
             break;
         case objects::MiEffectiveRangeData::AreaType_t::STRAIGHT_LINE:
@@ -1316,7 +1314,19 @@ bool SkillManager::ProcessSkillResult(std::shared_ptr<objects::ActivatedAbility>
                     break;
                 }
 
-                for(auto t : zone->GetActiveEntities())
+                // Only check entities in the bounding box of the line
+                float minX = rect.front().x, maxX = rect.front().x;
+                float minY = rect.front().y, maxY = rect.front().y;
+                for(auto& corner : rect)
+                {
+                    minX = std::min(minX, corner.x);
+                    maxX = std::max(maxX, corner.x);
+                    minY = std::min(minY, corner.y);
+                    maxY = std::max(maxY, corner.y);
+                }
+
+                for(auto t : zone->GetActiveEntitiesInRect(minX, minY, maxX,
+                    maxY))
                 {
                     Point p(t->GetCurrentX(), t->GetCurrentY());
                     if(ZoneManager::PointInPolygon(p, rect))
@@ -2504,7 +2514,8 @@ void SkillManager::ProcessSkillResultFinal(const std::shared_ptr<ProcessingSkill
         libcomp::Packet p;
         if(characterManager->GetEntityRevivalPacket(p, entity, 6))
         {
-            zoneManager->BroadcastPacket(zone, p);
+            zoneManager->BroadcastEntityPacket(zone, entity->GetEntityID(),
+                p);
         }
     }
 
@@ -6518,6 +6529,12 @@ void SkillManager::SendActivateSkill(std::shared_ptr<objects::ActivatedAbility>
     auto zone = source ? source->GetZone() : nullptr;
     auto zConnections = zone
         ? zone->GetConnectionList() : std::list<std::shared_ptr<ChannelClientConnection>>();
+    if(zone)
+    {
+        mServer.lock()->GetZoneManager()->FilterInterestedConnections(zone,
+            source->GetEntityID(), zConnections);
+    }
+
     if(zConnections.size() > 0)
     {
         RelativeTimeMap timeMap;
@@ -6554,6 +6571,12 @@ void SkillManager::SendExecuteSkill(std::shared_ptr<objects::ActivatedAbility> a
     auto zone = source ? source->GetZone() : nullptr;
     auto zConnections = zone
         ? zone->GetConnectionList() : std::list<std::shared_ptr<ChannelClientConnection>>();
+    if(zone)
+    {
+        mServer.lock()->GetZoneManager()->FilterInterestedConnections(zone,
+            source->GetEntityID(), zConnections);
+    }
+
     if(zConnections.size() > 0)
     {
         int32_t targetedEntityID = activated->GetEntityTargeted()
@@ -6596,6 +6619,12 @@ void SkillManager::SendExecuteSkillInstant(std::shared_ptr<
     auto zone = source ? source->GetZone() : nullptr;
     auto zConnections = zone
         ? zone->GetConnectionList() : std::list<std::shared_ptr<ChannelClientConnection>>();
+    if(zone)
+    {
+        mServer.lock()->GetZoneManager()->FilterInterestedConnections(zone,
+            source->GetEntityID(), zConnections);
+    }
+
     if(zConnections.size() > 0)
     {
         int32_t targetedEntityID = activated->GetEntityTargeted()
@@ -6643,6 +6672,12 @@ void SkillManager::SendCompleteSkill(std::shared_ptr<objects::ActivatedAbility>
     auto zone = source ? source->GetZone() : nullptr;
     auto zConnections = zone
         ? zone->GetConnectionList() : std::list<std::shared_ptr<ChannelClientConnection>>();
+    if(zone)
+    {
+        mServer.lock()->GetZoneManager()->FilterInterestedConnections(zone,
+            source->GetEntityID(), zConnections);
+    }
+
     if(zConnections.size() > 0)
     {
         RelativeTimeMap timeMap;
@@ -0,0 +1,93 @@
+/**
+ * @file server/channel/src/TokuseiEvaluationCache.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Last tokusei condition results of an entity and the inputs they
+ *  were evaluated with.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TokuseiEvaluationCache.h"
+
+using namespace channel;
+
+uint32_t TokuseiEvaluationCache::InputMask(int8_t conditionType)
+{
+    return (uint32_t)1 << ((uint8_t)conditionType & 31);
+}
+
+uint32_t TokuseiEvaluationCache::GetChanged(const Inputs& inputs) const
+{
+    uint32_t tracked = 0;
+    uint32_t changed = 0;
+
+    for(auto& pair : inputs)
+    {
+        uint32_t mask = InputMask(pair.first);
+        tracked |= mask;
+
+        auto it = mInputs.find(pair.first);
+        if(it == mInputs.end() || it->second != pair.second)
+        {
+            changed |= mask;
+        }
+    }
+
+    return changed | ~tracked;
+}
+
+bool TokuseiEvaluationCache::Get(int32_t tokuseiID, uint32_t tokuseiInputs,
+    uint32_t changed, bool& result) const
+{
+    if((tokuseiInputs & changed) != 0)
+    {
+        return false;
+    }
+
+    auto it = mResults.find(tokuseiID);
+    if(it == mResults.end())
+    {
+        return false;
+    }
+
+    result = it->second;
+
+    return true;
+}
+
+const std::unordered_map<int32_t, bool>&
+    TokuseiEvaluationCache::GetResults() const
+{
+    return mResults;
+}
+
+void TokuseiEvaluationCache::Set(const std::unordered_map<int32_t,
+    bool>& results, const Inputs& inputs)
+{
+    mResults = results;
+    mInputs = inputs;
+}
+
+void TokuseiEvaluationCache::Clear()
+{
+    mResults.clear();
+    mInputs.clear();
+}
@@ -0,0 +1,112 @@
+/**
+ * @file server/channel/src/TokuseiEvaluationCache.h
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Last tokusei condition results of an entity and the inputs they
+ *  were evaluated with.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_CHANNEL_SRC_TOKUSEIEVALUATIONCACHE_H
+#define SERVER_CHANNEL_SRC_TOKUSEIEVALUATIONCACHE_H
+
+// Standard C++11 Includes
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+namespace channel
+{
+
+/**
+ * Result of each direct tokusei's conditions from the last time they were
+ * evaluated for an entity, along with the value of every condition input
+ * the cache can track. A result is only reused if every condition type the
+ * tokusei depends upon is tracked and has the same value as when it was
+ * evaluated, so a recalculation using the cache always matches evaluating
+ * every condition again.
+ */
+class TokuseiEvaluationCache
+{
+public:
+    /// Tracked input values by condition type. Types without an entry
+    /// are not tracked and their tokusei are always evaluated again.
+    typedef std::unordered_map<int8_t, std::vector<int32_t>> Inputs;
+
+    /**
+     * Get the bit representing a condition type in an input mask.
+     * @param conditionType Condition type
+     * @return Mask with only the bit for the condition type set
+     */
+    static uint32_t InputMask(int8_t conditionType);
+
+    /**
+     * Get the condition types that might have changed since the results
+     * were stored.
+     * @param inputs Current value of every tracked input
+     * @return Mask of every untracked condition type and every tracked
+     *  type whose value is different from the stored one
+     */
+    uint32_t GetChanged(const Inputs& inputs) const;
+
+    /**
+     * Get the stored result for a tokusei if it is still valid.
+     * @param tokuseiID ID of the tokusei
+     * @param tokuseiInputs Mask of the condition types the tokusei
+     *  depends upon
+     * @param changed Mask returned by @ref GetChanged
+     * @param result Output parameter to store the result in
+     * @return true if the stored result can be used, false if the
+     *  conditions must be evaluated again
+     */
+    bool Get(int32_t tokuseiID, uint32_t tokuseiInputs, uint32_t changed,
+        bool& result) const;
+
+    /**
+     * Get every stored result.
+     * @return Map of tokusei IDs to their last evaluated result
+     */
+    const std::unordered_map<int32_t, bool>& GetResults() const;
+
+    /**
+     * Replace the stored results and the inputs they were evaluated with.
+     * @param results Map of tokusei IDs to their evaluated result
+     * @param inputs Value of every tracked input during the evaluation
+     */
+    void Set(const std::unordered_map<int32_t, bool>& results,
+        const Inputs& inputs);
+
+    /**
+     * Remove every stored result.
+     */
+    void Clear();
+
+private:
+    /// Map of tokusei IDs to their last evaluated result
+    std::unordered_map<int32_t, bool> mResults;
+
+    /// Value of every tracked input when the results were evaluated
+    Inputs mInputs;
+};
+
+} // namespace channel
+
+#endif // SERVER_CHANNEL_SRC_TOKUSEIEVALUATIONCACHE_H
@@ -60,6 +60,7 @@
 #include <TokuseiCorrectTbl.h>
 
 // C++ Standard Includes
+#include <algorithm>
 #include <cmath>
 
 // channel Includes
@@ -72,6 +73,19 @@
 
 using namespace channel;
 
+/**
+ * Get the bit representing a tokusei condition type in an input mask.
+ * @param type Condition type
+ * @return Mask with only the bit for the condition type set
+ */
+static uint32_t TokuseiInputMask(TokuseiConditionType type)
+{
+    static_assert((size_t)TokuseiConditionType::MOON_PHASE < 32,
+        "Tokusei condition types no longer fit in an input mask");
+
+    return TokuseiEvaluationCache::InputMask((int8_t)type);
+}
+
 TokuseiManager::TokuseiManager(const std::weak_ptr<
     ChannelServer>& server) : mServer(server)
 {
@@ -97,6 +111,8 @@ bool TokuseiManager::Initialize()
         std::set<uint32_t> skillIDs;
         for(auto aspect : tPair.second->GetAspects())
         {
+            mTokuseiAspects[tPair.first].insert((int8_t)aspect->GetType());
+
             if(aspect->GetType() == TokuseiAspectType::SKILL_ADD)
             {
                 if(tPair.second->GetTargetType() != objects::Tokusei::TargetType_t::SELF)
@@ -129,6 +145,14 @@ bool TokuseiManager::Initialize()
             }
         }
 
+        // Record which inputs the conditions depend upon so recalculations
+        // for a specific set of changes can skip everything else
+        for(auto condition : tPair.second->GetConditions())
+        {
+            mTokuseiInputs[tPair.first] |= TokuseiInputMask(
+                condition->GetType());
+        }
+
         for(uint32_t skillID : skillIDs)
         {
             auto skillData = definitionManager->GetSkillData(skillID);
@@ -520,7 +544,8 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::shared_
 
     if(doRecalc)
     {
-        return Recalculate(eState);
+        return RecalculateEntities(GetAllTokuseiEntities(eState), false, {},
+            changes);
     }
 
     return std::unordered_map<int32_t, bool>();
@@ -535,9 +560,25 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::shared_
 
 std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<std::shared_ptr<
     ActiveEntityState>>& entities, bool recalcStats, std::set<int32_t> ignoreStatRecalc)
+{
+    return RecalculateEntities(entities, recalcStats, ignoreStatRecalc, {});
+}
+
+std::unordered_map<int32_t, bool> TokuseiManager::RecalculateEntities(
+    const std::list<std::shared_ptr<ActiveEntityState>>& entities,
+    bool recalcStats, const std::set<int32_t>& ignoreStatRecalc,
+    const std::set<TokuseiConditionType>& changes)
 {
     std::unordered_map<int32_t, bool> result;
 
+    // If specific changes were supplied, the last results can be reused
+    // for conditions whose inputs are tracked and have not changed. The
+    // inputs are compared directly so changes that were not reported
+    // (or inputs that are not tracked) are still evaluated again.
+    bool useCache = !changes.empty();
+
+    bool evaluationChanged = !useCache;
+
     // Effects directly on the entity
     std::unordered_map<int32_t,
         std::unordered_map<bool, std::unordered_map<int32_t, uint16_t>>> newMaps;
@@ -553,9 +594,6 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
     // Keep track of direct timed tokusei on all player entities
     std::unordered_map<int32_t, std::set<int32_t>> playerEntityTimedTokusei;
 
-    // Keep track of aspects encountered to avoid having to loop multiple times
-    std::unordered_map<int32_t, std::set<int8_t>> aspectMap;
-
     for(auto eState : entities)
     {
         result[eState->GetEntityID()] = false;
@@ -573,6 +611,22 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
 
         std::set<int8_t> triggers;
 
+        // Results evaluated before the entity is ready are all false so
+        // they are stored without inputs and never reused
+        bool ready = eState->Ready();
+        auto inputs = ready ? GetEvaluationInputs(eState)
+            : TokuseiEvaluationCache::Inputs();
+
+        TokuseiEvaluationCache previous;
+        uint32_t changed = 0;
+        if(useCache && ready)
+        {
+            previous = eState->GetTokuseiEvaluations();
+            changed = previous.GetChanged(inputs);
+        }
+
+        auto& previousResults = previous.GetResults();
+
         std::unordered_map<int32_t, bool> evaluated;
         for(auto tokusei : GetDirectTokusei(eState))
         {
@@ -585,7 +639,21 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
             }
             else
             {
-                add = EvaluateTokuseiConditions(eState, tokusei);
+                auto inputIter = mTokuseiInputs.find(tokuseiID);
+                uint32_t tokuseiInputs = inputIter != mTokuseiInputs.end()
+                    ? inputIter->second : 0;
+                if(!previous.Get(tokuseiID, tokuseiInputs, changed, add))
+                {
+                    add = EvaluateTokuseiConditions(eState, tokusei);
+
+                    auto prevIter = previousResults.find(tokuseiID);
+                    if(prevIter == previousResults.end() ||
+                        prevIter->second != add)
+                    {
+                        evaluationChanged = true;
+                    }
+                }
+
                 evaluated[tokuseiID] = add;
 
                 if(worldCID &&
@@ -594,11 +662,6 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
                     playerEntityTimedTokusei[worldCID].insert(tokuseiID);
                 }
 
-                for(auto aspect : tokusei->GetAspects())
-                {
-                    aspectMap[tokuseiID].insert((int8_t)aspect->GetType());
-                }
-
                 for(auto condition : tokusei->GetConditions())
                 {
                     triggers.insert((int8_t)condition->GetType());
@@ -649,9 +712,23 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
             }
         }
 
+        // A tokusei no longer on the entity changes the effective set too
+        if(evaluated.size() != previousResults.size())
+        {
+            evaluationChanged = true;
+        }
+
+        eState->SetTokuseiEvaluations(evaluated, inputs);
         eState->GetCalculatedState()->SetActiveTokuseiTriggers(triggers);
     }
 
+    // If no condition result changed, the effective tokusei (and therefore
+    // the stats) are the same as the last calculation
+    if(!evaluationChanged)
+    {
+        return result;
+    }
+
     // Set or clear all timed tokusei for player entities
     if(playerEntityTimedTokusei.size() > 0)
     {
@@ -776,14 +853,14 @@ std::unordered_map<int32_t, bool> TokuseiManager::Recalculate(const std::list<st
             // Gather all possible aspects on the entity for quick
             // reference later
             std::set<int8_t> aspects;
-            for(auto& aPair : aspectMap)
+            for(auto tokuseiMap : { &effective, &skillPending })
             {
-                if(effective.find(aPair.first) != effective.end() ||
-                    skillPending.find(aPair.first) != skillPending.end())
+                for(auto& tPair : *tokuseiMap)
                 {
-                    for(int8_t aspect : aPair.second)
+                    auto it = mTokuseiAspects.find(tPair.first);
+                    if(it != mTokuseiAspects.end())
                     {
-                        aspects.insert(aspect);
+                        aspects.insert(it->second.begin(), it->second.end());
                     }
                 }
             }
@@ -1096,6 +1173,42 @@ std::list<std::shared_ptr<objects::Tokusei>> TokuseiManager::GetDirectTokusei(
     return retval;
 }
 
+TokuseiEvaluationCache::Inputs TokuseiManager::GetEvaluationInputs(
+    const std::shared_ptr<ActiveEntityState>& eState)
+{
+    TokuseiEvaluationCache::Inputs inputs;
+
+    // Never true outside of skill processing
+    inputs[(int8_t)TokuseiConditionType::DIGITALIZED];
+    inputs[(int8_t)TokuseiConditionType::SKILL_STATE];
+
+    // HP and MP conditions only compare the percent
+    auto cs = eState->GetCoreStats();
+    int32_t maxHP = eState->GetMaxHP();
+    int32_t maxMP = eState->GetMaxMP();
+    if(cs && maxHP > 0 && maxMP > 0)
+    {
+        inputs[(int8_t)TokuseiConditionType::CURRENT_HP].push_back(
+            (int32_t)floor((float)cs->GetHP() / (float)maxHP * 100.f));
+        inputs[(int8_t)TokuseiConditionType::CURRENT_MP].push_back(
+            (int32_t)floor((float)cs->GetMP() / (float)maxMP * 100.f));
+    }
+
+    inputs[(int8_t)TokuseiConditionType::LNC].push_back(
+        (int32_t)eState->GetLNCType());
+
+    auto statusEffects = eState->GetStatusEffects();
+    auto& statusInput = inputs[(int8_t)TokuseiConditionType::STATUS_ACTIVE];
+    for(auto& ePair : statusEffects)
+    {
+        statusInput.push_back((int32_t)ePair.first);
+    }
+
+    std::sort(statusInput.begin(), statusInput.end());
+
+    return inputs;
+}
+
 bool TokuseiManager::EvaluateTokuseiConditions(const std::shared_ptr<
     ActiveEntityState>& eState, const std::shared_ptr<objects::Tokusei>& tokusei)
 {
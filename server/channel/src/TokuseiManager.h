@@ -244,6 +244,36 @@ public:
         ChannelClientConnection>& client);
 
 private:
+    /**
+     * Recalculate the tokusei effects on the supplied entities. If a set of
+     * changes is supplied, conditions whose inputs are tracked and have the
+     * same value as the last calculation use the result stored on the
+     * entity and the rest are evaluated again. If no result differs from
+     * the last calculation, the effective tokusei and stats are left as
+     * they are.
+     * @param entities List of pointers to the entities to recalculate
+     * @param recalcStats false if the effect tokusei should be determined but the entities
+     *  should not have their stats recalculated, true if both should occur
+     * @param ignoreStateRecalc Set of entity IDs to ignore when recalculating stats
+     * @param changes Condition types that have changed since the last calculation
+     *  or empty if every condition should be evaluated
+     * @return Map of entity IDs to a true value if they have had their stats recalculated
+     *  or false if only their tokusei sets and triggers were updated
+     */
+    std::unordered_map<int32_t, bool> RecalculateEntities(const std::list<
+        std::shared_ptr<ActiveEntityState>>& entities, bool recalcStats,
+        const std::set<int32_t>& ignoreStatRecalc,
+        const std::set<TokuseiConditionType>& changes);
+
+    /**
+     * Get the current value of every tokusei condition input that can be
+     * compared against the last evaluation of an entity.
+     * @param eState Pointer to the entity
+     * @return Tracked input values by condition type
+     */
+    TokuseiEvaluationCache::Inputs GetEvaluationInputs(
+        const std::shared_ptr<ActiveEntityState>& eState);
+
     /**
      * Recalculate skill cost adjustments from tokusei for the specified
      * entity. If the entity's data has already been sent to the client,
@@ -318,6 +348,13 @@ private:
     /// that the effect is ultimately marked as effective.
     std::unordered_map<int32_t, std::set<int32_t>> mTimedTokuseiEntities;
 
+    /// Map of tokusei IDs to a mask of the condition types their conditions
+    /// depend upon, with one bit per type
+    std::unordered_map<int32_t, uint32_t> mTokuseiInputs;
+
+    /// Map of tokusei IDs to the aspect types they contain
+    std::unordered_map<int32_t, std::set<int8_t>> mTokuseiAspects;
+
     /// Set of all tokusei with at least one cost adjustment aspect
     std::set<int32_t> mCostAdjustmentTokusei;
 
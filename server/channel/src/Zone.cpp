@@ -199,6 +199,8 @@ void Zone::RemoveConnection(const std::shared_ptr<ChannelClientConnection>& clie
 
     std::lock_guard<std::mutex> lock(mLock);
     mConnections.erase(state->GetWorldCID());
+    mHiddenEntities.erase(state->GetWorldCID());
+    mInterestViews.erase(state->GetWorldCID());
 
     // If this zone is not part of an instance, clear the character
     // specific flags
@@ -460,19 +462,158 @@ const std::list<std::shared_ptr<ActiveEntityState>>
 {
     std::list<std::shared_ptr<ActiveEntityState>> results;
 
-    float rSquared = (float)std::pow(radius, 2);
+    std::lock_guard<std::mutex> lock(mGridLock);
+    mActiveGrid.QueryRadius(x, y, (float)radius,
+        [&results](const std::shared_ptr<ActiveEntityState>& active,
+            float, float)
+        {
+            results.push_back(active);
+        });
+
+    return results;
+}
+
+const std::list<std::shared_ptr<ActiveEntityState>>
+    Zone::GetActiveEntitiesInFoV(float x, float y, double radius, float rot,
+    float maxAngle)
+{
+    std::list<std::shared_ptr<ActiveEntityState>> results;
+
+    std::lock_guard<std::mutex> lock(mGridLock);
+    mActiveGrid.QueryCone(x, y, (float)radius, rot, maxAngle,
+        [&results](const std::shared_ptr<ActiveEntityState>& active,
+            float, float)
+        {
+            results.push_back(active);
+        });
+
+    return results;
+}
+
+const std::list<std::shared_ptr<ActiveEntityState>>
+    Zone::GetActiveEntitiesInRect(float x1, float y1, float x2, float y2)
+{
+    std::list<std::shared_ptr<ActiveEntityState>> results;
+
+    std::lock_guard<std::mutex> lock(mGridLock);
+    mActiveGrid.QueryRect(x1, y1, x2, y2,
+        [&results](const std::shared_ptr<ActiveEntityState>& active,
+            float, float)
+        {
+            results.push_back(active);
+        });
+
+    return results;
+}
+
+void Zone::UpdateActiveEntityPosition(int32_t entityID, float x, float y)
+{
+    std::lock_guard<std::mutex> lock(mGridLock);
+    mActiveGrid.Update(entityID, x, y);
+}
 
+std::set<int32_t> Zone::GetHiddenEntities(int32_t worldCID)
+{
     std::lock_guard<std::mutex> lock(mLock);
-    for(auto ePair : mAllEntities)
+    auto it = mHiddenEntities.find(worldCID);
+    return it != mHiddenEntities.end() ? it->second : std::set<int32_t>();
+}
+
+void Zone::SetEntitiesHidden(int32_t worldCID,
+    const std::set<int32_t>& entityIDs, bool hidden)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    if(hidden)
     {
-        auto active = std::dynamic_pointer_cast<ActiveEntityState>(ePair.second);
-        if(active && rSquared >= active->GetDistance(x, y, true))
+        // Only track clients still in the zone
+        if(mConnections.find(worldCID) != mConnections.end())
         {
-            results.push_back(active);
+            mHiddenEntities[worldCID].insert(entityIDs.begin(),
+                entityIDs.end());
         }
     }
+    else
+    {
+        auto it = mHiddenEntities.find(worldCID);
+        if(it != mHiddenEntities.end())
+        {
+            for(int32_t entityID : entityIDs)
+            {
+                it->second.erase(entityID);
+            }
 
-    return results;
+            if(it->second.size() == 0)
+            {
+                mHiddenEntities.erase(it);
+            }
+        }
+    }
+}
+
+size_t Zone::RemoveHiddenConnections(int32_t entityID,
+    std::list<std::shared_ptr<ChannelClientConnection>>& connections)
+{
+    size_t count = connections.size();
+
+    std::lock_guard<std::mutex> lock(mLock);
+    if(mHiddenEntities.size() > 0)
+    {
+        connections.remove_if([this, entityID](
+            const std::shared_ptr<ChannelClientConnection>& connection)
+            {
+                auto it = mHiddenEntities.find(connection->GetClientState()
+                    ->GetWorldCID());
+                return it != mHiddenEntities.end() &&
+                    it->second.find(entityID) != it->second.end();
+            });
+    }
+
+    return count - connections.size();
+}
+
+bool Zone::GetInterestView(int32_t worldCID, std::set<int32_t>& entityIDs)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    auto it = mInterestViews.find(worldCID);
+    if(it == mInterestViews.end())
+    {
+        return false;
+    }
+
+    entityIDs = it->second;
+
+    return true;
+}
+
+void Zone::SetInterestView(int32_t worldCID,
+    const std::set<int32_t>& entityIDs)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    // Only track clients still in the zone
+    if(mConnections.find(worldCID) != mConnections.end())
+    {
+        mInterestViews[worldCID] = entityIDs;
+    }
+}
+
+void Zone::QueueInterestCheck(int32_t entityID)
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    if(mInterestViews.size() > 0)
+    {
+        mInterestChecks.insert(entityID);
+    }
+}
+
+std::set<int32_t> Zone::PopInterestChecks()
+{
+    std::set<int32_t> entityIDs;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    entityIDs.swap(mInterestChecks);
+
+    return entityIDs;
 }
 
 std::shared_ptr<BazaarState> Zone::GetBazaar(int32_t id)
@@ -574,15 +715,48 @@ const std::shared_ptr<objects::ServerZone> Zone::GetDefinition()
 
 void Zone::RegisterEntityState(const std::shared_ptr<objects::EntityStateObject>& state)
 {
-    std::lock_guard<std::mutex> lock(mLock);
-    mAllEntities[state->GetEntityID()] = state;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mAllEntities[state->GetEntityID()] = state;
+
+        // New entities are shown to every client regardless of distance
+        if(mInterestViews.size() > 0)
+        {
+            mInterestChecks.insert(state->GetEntityID());
+        }
+    }
+
+    auto active = std::dynamic_pointer_cast<ActiveEntityState>(state);
+    if(active)
+    {
+        std::lock_guard<std::mutex> lock(mGridLock);
+        mActiveGrid.Insert(active->GetEntityID(), active->GetCurrentX(),
+            active->GetCurrentY(), active);
+    }
 }
 
 void Zone::UnregisterEntityState(int32_t entityID)
 {
-    std::lock_guard<std::mutex> lock(mLock);
-    mAllEntities.erase(entityID);
-    mPendingDespawnEntities.erase(entityID);
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        mAllEntities.erase(entityID);
+        mPendingDespawnEntities.erase(entityID);
+
+        for(auto& hPair : mHiddenEntities)
+        {
+            hPair.second.erase(entityID);
+        }
+
+        for(auto& vPair : mInterestViews)
+        {
+            vPair.second.erase(entityID);
+        }
+
+        mInterestChecks.erase(entityID);
+    }
+
+    std::lock_guard<std::mutex> lock(mGridLock);
+    mActiveGrid.Remove(entityID);
 }
 
 std::shared_ptr<objects::EntityStateObject> Zone::GetEntity(int32_t id)
@@ -985,9 +1159,17 @@ void Zone::Cleanup()
     mNPCs.clear();
     mObjects.clear();
     mAllEntities.clear();
+    mHiddenEntities.clear();
+    mInterestViews.clear();
+    mInterestChecks.clear();
     mSpawnGroups.clear();
     mSpawnLocationGroups.clear();
 
+    {
+        std::lock_guard<std::mutex> gridLock(mGridLock);
+        mActiveGrid.Clear();
+    }
+
     mZoneInstance = nullptr;
 }
 
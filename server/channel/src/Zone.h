@@ -27,6 +27,9 @@
 #ifndef SERVER_CHANNEL_SRC_ZONE_H
 #define SERVER_CHANNEL_SRC_ZONE_H
 
+// libcomp Includes
+#include <SpatialGrid.h>
+
 // channel Includes
 #include "ActiveEntityState.h"
 #include "BazaarState.h"
@@ -246,6 +249,101 @@ public:
     const std::list<std::shared_ptr<ActiveEntityState>>
         GetActiveEntitiesInRadius(float x, float y, double radius);
 
+    /**
+     * Get all active entities in the zone within a supplied radius that
+     * are also in the specified field of view
+     * @param x X coordinate of the FoV origin
+     * @param y Y coordinate of the FoV origin
+     * @param radius Maximum distance from the FoV origin
+     * @param rot Rotation in radians for the center of the FoV
+     * @param maxAngle Maximum angle in radians for either side of the FoV
+     * @return List of pointers to active entities in the FoV
+     */
+    const std::list<std::shared_ptr<ActiveEntityState>>
+        GetActiveEntitiesInFoV(float x, float y, double radius, float rot,
+        float maxAngle);
+
+    /**
+     * Get all active entities in the zone within an axis aligned rectangle
+     * @param x1 X coordinate of one corner of the rectangle
+     * @param y1 Y coordinate of one corner of the rectangle
+     * @param x2 X coordinate of the opposite corner of the rectangle
+     * @param y2 Y coordinate of the opposite corner of the rectangle
+     * @return List of pointers to active entities in the rectangle
+     */
+    const std::list<std::shared_ptr<ActiveEntityState>>
+        GetActiveEntitiesInRect(float x1, float y1, float x2, float y2);
+
+    /**
+     * Move an active entity to a new position in the zone's spatial
+     * index. This should be called any time the entity's current position
+     * changes and is handled by @ref ActiveEntityState for its own
+     * movement functions.
+     * @param entityID ID of the active entity
+     * @param x New X coordinate of the entity
+     * @param y New Y coordinate of the entity
+     */
+    void UpdateActiveEntityPosition(int32_t entityID, float x, float y);
+
+    /**
+     * Get the IDs of entities that area of interest management has
+     * removed from a client because they are out of view
+     * @param worldCID World CID of the client's character
+     * @return Set of hidden entity IDs
+     */
+    std::set<int32_t> GetHiddenEntities(int32_t worldCID);
+
+    /**
+     * Mark entities as hidden from or visible to a client again
+     * @param worldCID World CID of the client's character
+     * @param entityIDs IDs of the entities to update
+     * @param hidden true if the entities were removed from the client,
+     *  false if they have been shown to the client again
+     */
+    void SetEntitiesHidden(int32_t worldCID, const std::set<int32_t>& entityIDs,
+        bool hidden);
+
+    /**
+     * Remove every connection from the supplied list that the entity is
+     * currently hidden from
+     * @param entityID ID of the entity being broadcast
+     * @param connections List of connections to filter
+     * @return Number of connections removed
+     */
+    size_t RemoveHiddenConnections(int32_t entityID,
+        std::list<std::shared_ptr<ChannelClientConnection>>& connections);
+
+    /**
+     * Get the IDs of the entities that were in range of a client the last
+     * time area of interest management checked it
+     * @param worldCID World CID of the client's character
+     * @param entityIDs Output set of the entity IDs in range
+     * @return false if the client has not been checked since it entered
+     *  the zone
+     */
+    bool GetInterestView(int32_t worldCID, std::set<int32_t>& entityIDs);
+
+    /**
+     * Set the IDs of the entities in range of a client
+     * @param worldCID World CID of the client's character
+     * @param entityIDs IDs of the entities in range
+     */
+    void SetInterestView(int32_t worldCID, const std::set<int32_t>& entityIDs);
+
+    /**
+     * Queue an entity that was shown to every client in the zone to be
+     * checked by the next area of interest update regardless of distance.
+     * Nothing is queued until a client has been checked.
+     * @param entityID ID of the entity to check
+     */
+    void QueueInterestCheck(int32_t entityID);
+
+    /**
+     * Get and clear the entities queued by @ref QueueInterestCheck
+     * @return Set of entity IDs to check
+     */
+    std::set<int32_t> PopInterestChecks();
+
     /**
      * Get an entity instance by it's ID.
      * @param id Instance ID of the entity.
@@ -615,6 +713,22 @@ private:
     /// Map of entities in the zone by their ID
     std::unordered_map<int32_t, std::shared_ptr<objects::EntityStateObject>> mAllEntities;
 
+    /// Spatial index of the active entities in the zone by their current
+    /// position, used for all range based entity lookups
+    libcomp::SpatialGrid<std::shared_ptr<ActiveEntityState>> mActiveGrid;
+
+    /// Map of world CIDs to the entities hidden from that client by area
+    /// of interest management
+    std::unordered_map<int32_t, std::set<int32_t>> mHiddenEntities;
+
+    /// Map of world CIDs to the entities that were in range of that client
+    /// at the last area of interest update
+    std::unordered_map<int32_t, std::set<int32_t>> mInterestViews;
+
+    /// Entities shown to every client since the last area of interest
+    /// update that may be out of range of some of them
+    std::set<int32_t> mInterestChecks;
+
     /// Map of entities in the zone with a specified actor ID for used
     /// when referencing in actions or events
     std::unordered_map<int32_t, std::shared_ptr<objects::EntityStateObject>> mActors;
@@ -661,6 +775,10 @@ private:
 
     /// Server lock for shared resources
     std::mutex mLock;
+
+    /// Lock for the active entity spatial index which is updated far more
+    /// often than the other shared resources
+    std::mutex mGridLock;
 };
 
 } // namespace channel
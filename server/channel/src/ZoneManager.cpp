@@ -39,6 +39,7 @@
 #include <Account.h>
 #include <AccountLogin.h>
 #include <AccountWorldData.h>
+#include <ChannelConfig.h>
 #include <ActionSpawn.h>
 #include <CharacterLogin.h>
 #include <Enemy.h>
@@ -85,13 +86,25 @@
 #include "ZoneInstance.h"
 
 // C++ Standard Includes
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 
 using namespace channel;
 
 ZoneManager::ZoneManager(const std::weak_ptr<ChannelServer>& server)
-    : mNextZoneID(1), mNextZoneInstanceID(1), mServer(server)
+    : mNextZoneID(1), mNextZoneInstanceID(1), mInterestRadius(0.f),
+    mInterestHysteresis(0.f), mNextInterestUpdate(0),
+    mInterestPacketsSaved(0), mInterestEntered(0), mInterestLeft(0),
+    mServer(server)
 {
+    auto conf = std::dynamic_pointer_cast<objects::ChannelConfig>(
+        server.lock()->GetConfig());
+    if(conf && conf->GetInterestRadius() > 0.f)
+    {
+        mInterestRadius = conf->GetInterestRadius();
+        mInterestHysteresis = std::max(conf->GetInterestHysteresis(), 0.f);
+    }
 }
 
 ZoneManager::~ZoneManager()
@@ -487,6 +500,9 @@ bool ZoneManager::EnterZone(const std::shared_ptr<ChannelClientConnection>& clie
     dState->SetCurrentY(yCoord);
     dState->SetCurrentRotation(rotation);
 
+    cState->UpdateZonePosition();
+    dState->UpdateZonePosition();
+
     server->GetTokuseiManager()->RecalculateParty(state->GetParty());
 
     if(!nextInstance && currentZone)
@@ -1002,6 +1018,20 @@ void ZoneManager::ShowEntityToZone(const std::shared_ptr<Zone>& zone, int32_t en
 
     BroadcastPacket(zone, p);
 
+    if(InterestManagementEnabled())
+    {
+        // Every client knows about the entity again
+        std::set<int32_t> entityIDs = { entityID };
+        for(auto zConnection : zone->GetConnectionList())
+        {
+            zone->SetEntitiesHidden(zConnection->GetClientState()
+                ->GetWorldCID(), entityIDs, false);
+        }
+
+        // Clients it is out of range of need to hide it again
+        zone->QueueInterestCheck(entityID);
+    }
+
     // If its an active entity, set it as displayed
     auto activeState = zone->GetActiveEntity(entityID);
     if(activeState)
@@ -1109,6 +1139,8 @@ void ZoneManager::FixCurrentPosition(const std::shared_ptr<ActiveEntityState>& e
         timeMap[p.Size() + 4] = fixUntil;
 
         auto zConnections = zone->GetConnectionList();
+        FilterInterestedConnections(zone, eState->GetEntityID(),
+            zConnections);
         ChannelClientConnection::SendRelativeTimePacket(zConnections, p, timeMap);
     }
 }
@@ -1432,7 +1464,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
     auto definitionManager = server->GetDefinitionManager();
     auto characterManager = server->GetCharacterManager();
 
-    std::list<libcomp::Packet> zonePackets;
+    std::list<std::pair<int32_t, libcomp::Packet>> zonePackets;
     std::set<uint32_t> added, updated, removed;
     std::set<std::shared_ptr<ActiveEntityState>> displayStateModified;
     std::set<std::shared_ptr<ActiveEntityState>> statusRemoved;
@@ -1489,7 +1521,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
                 }
             }
 
-            zonePackets.push_back(p);
+            zonePackets.push_back(std::make_pair(entity->GetEntityID(), p));
         }
 
         if(hpTDamage != 0 || mpTDamage != 0)
@@ -1510,7 +1542,8 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
                 p.WriteS32Little(entity->GetEntityID());
                 p.WriteS32Little(hpAdjusted);
                 p.WriteS32Little(mpAdjusted);
-                zonePackets.push_back(p);
+                zonePackets.push_back(std::make_pair(entity->GetEntityID(),
+                    p));
 
                 server->GetTokuseiManager()->Recalculate(entity,
                     std::set<TokuseiConditionType>
@@ -1529,7 +1562,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
             {
                 p.WriteU32Little(effectType);
             }
-            zonePackets.push_back(p);
+            zonePackets.push_back(std::make_pair(entity->GetEntityID(), p));
 
             statusRemoved.insert(entity);
         }
@@ -1537,8 +1570,7 @@ void ZoneManager::UpdateStatusEffectStates(const std::shared_ptr<Zone>& zone,
 
     if(zonePackets.size() > 0)
     {
-        auto zConnections = zone->GetConnectionList();
-        ChannelClientConnection::BroadcastPackets(zConnections, zonePackets);
+        BroadcastEntityPackets(zone, zonePackets);
     }
 
     for(auto eState : statusRemoved)
@@ -1585,6 +1617,70 @@ void ZoneManager::BroadcastPacket(const std::shared_ptr<Zone>& zone, libcomp::Pa
     }
 }
 
+void ZoneManager::BroadcastEntityPacket(const std::shared_ptr<
+    ChannelClientConnection>& client, int32_t entityID, libcomp::Packet& p,
+    bool includeSelf)
+{
+    auto connections = GetZoneConnections(client, includeSelf);
+    FilterInterestedConnections(client->GetClientState()->GetCharacterState()
+        ->GetZone(), entityID, connections);
+
+    ChannelClientConnection::BroadcastPacket(connections, p);
+}
+
+void ZoneManager::BroadcastEntityPacket(const std::shared_ptr<Zone>& zone,
+    int32_t entityID, libcomp::Packet& p)
+{
+    if(nullptr != zone)
+    {
+        auto connections = zone->GetConnectionList();
+        FilterInterestedConnections(zone, entityID, connections);
+
+        ChannelClientConnection::BroadcastPacket(connections, p);
+    }
+}
+
+void ZoneManager::BroadcastEntityPackets(const std::shared_ptr<Zone>& zone,
+    std::list<std::pair<int32_t, libcomp::Packet>>& packets)
+{
+    if(nullptr == zone)
+    {
+        return;
+    }
+
+    bool interest = InterestManagementEnabled();
+
+    uint64_t saved = 0;
+    for(auto client : zone->GetConnectionList())
+    {
+        std::set<int32_t> hidden;
+        if(interest)
+        {
+            hidden = zone->GetHiddenEntities(client->GetClientState()
+                ->GetWorldCID());
+        }
+
+        for(auto& pPair : packets)
+        {
+            if(hidden.find(pPair.first) == hidden.end())
+            {
+                client->QueuePacketCopy(pPair.second);
+            }
+            else
+            {
+                saved++;
+            }
+        }
+
+        client->FlushOutgoing();
+    }
+
+    if(saved > 0)
+    {
+        mInterestPacketsSaved += saved;
+    }
+}
+
 void ZoneManager::SendToRange(const std::shared_ptr<ChannelClientConnection>& client,
     libcomp::Packet& p, bool includeSelf)
 {
@@ -2349,7 +2445,7 @@ std::shared_ptr<EnemyState> ZoneManager::CreateEnemy(const std::shared_ptr<Zone>
 
 void ZoneManager::UpdateActiveZoneStates()
 {
-    std::list<std::shared_ptr<Zone>> zones;
+    std::vector<std::shared_ptr<Zone>> zones;
     {
         std::lock_guard<std::mutex> lock(mLock);
         for(auto uniqueID : mActiveZones)
@@ -2358,24 +2454,48 @@ void ZoneManager::UpdateActiveZoneStates()
         }
     }
 
+    // Time spent on each zone in microseconds
+    std::vector<uint64_t> tickTimes(zones.size(), 0);
+
     // Spin through entities with updated status effects
     uint32_t systemTime = (uint32_t)std::time(0);
-    for(auto zone : zones)
+    for(size_t i = 0; i < zones.size(); i++)
     {
-        UpdateStatusEffectStates(zone, systemTime);
+        auto start = std::chrono::steady_clock::now();
+
+        UpdateStatusEffectStates(zones[i], systemTime);
+
+        tickTimes[i] += (uint64_t)std::chrono::duration_cast<
+            std::chrono::microseconds>(std::chrono::steady_clock::now() -
+            start).count();
     }
 
     auto serverTime = ChannelServer::GetServerTime();
     auto aiManager = mServer.lock()->GetAIManager();
 
-    for(auto zone : zones)
+    bool updateInterest = InterestManagementEnabled() &&
+        serverTime >= mNextInterestUpdate;
+    if(updateInterest)
     {
+        mNextInterestUpdate = serverTime + INTEREST_UPDATE_INTERVAL;
+    }
+
+    for(size_t i = 0; i < zones.size(); i++)
+    {
+        auto zone = zones[i];
+        auto start = std::chrono::steady_clock::now();
+
         // Despawn first
         HandleDespawns(zone);
 
         // Update active AI controlled entities
         aiManager->UpdateActiveStates(zone, serverTime);
 
+        if(updateInterest)
+        {
+            UpdateInterest(zone, serverTime);
+        }
+
         if(zone->HasRespawns())
         {
             // Spawn new enemies next (since they should not immediately act)
@@ -2385,20 +2505,45 @@ void ZoneManager::UpdateActiveZoneStates()
             UpdatePlasma(zone, serverTime);
         }
 
-        mTimeRestrictUpdatedZones.erase(zone->GetID());
+        tickTimes[i] += (uint64_t)std::chrono::duration_cast<
+            std::chrono::microseconds>(std::chrono::steady_clock::now() -
+            start).count();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        for(size_t i = 0; i < zones.size(); i++)
+        {
+            auto zone = zones[i];
+
+            mTimeRestrictUpdatedZones.erase(zone->GetID());
+
+            auto& stats = mZoneTickStats[zone->GetID()];
+            if(stats.Ticks == 0)
+            {
+                stats.DefinitionID = zone->GetDefinitionID();
+                stats.DynamicMapID = zone->GetDefinition()
+                    ->GetDynamicMapID();
+            }
+
+            stats.Ticks++;
+            stats.TotalTime += tickTimes[i];
+            stats.LastTime = tickTimes[i];
+            stats.MaxTime = std::max(stats.MaxTime, tickTimes[i]);
+        }
     }
 
+    std::list<std::shared_ptr<Zone>> restrictZones;
+
     // Get any updated time restricted zones and clear the list
     // after retrieval (essentially they "unfreeze" momentarily
     {
-        zones.clear();
-
         std::lock_guard<std::mutex> lock(mLock);
         if(mTimeRestrictUpdatedZones.size() > 0)
         {
             for(auto uniqueID : mTimeRestrictUpdatedZones)
             {
-                zones.push_back(mZones[uniqueID]);
+                restrictZones.push_back(mZones[uniqueID]);
             }
 
             mTimeRestrictUpdatedZones.clear();
@@ -2406,7 +2551,7 @@ void ZoneManager::UpdateActiveZoneStates()
     }
 
     // Handle all time restrict updated zones
-    for(auto zone : zones)
+    for(auto zone : restrictZones)
     {
         // Despawn first
         HandleDespawns(zone);
@@ -2419,6 +2564,248 @@ void ZoneManager::UpdateActiveZoneStates()
     }
 }
 
+std::unordered_map<uint32_t, ZoneManager::ZoneTickStats>
+    ZoneManager::GetZoneTickStats()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+    return mZoneTickStats;
+}
+
+bool ZoneManager::InterestManagementEnabled() const
+{
+    return mInterestRadius > 0.f;
+}
+
+void ZoneManager::FilterInterestedConnections(const std::shared_ptr<Zone>& zone,
+    int32_t entityID, std::list<std::shared_ptr<
+    ChannelClientConnection>>& connections)
+{
+    if(InterestManagementEnabled() && zone)
+    {
+        size_t removed = zone->RemoveHiddenConnections(entityID, connections);
+        if(removed > 0)
+        {
+            mInterestPacketsSaved += (uint64_t)removed;
+        }
+    }
+}
+
+ZoneManager::InterestStats ZoneManager::GetInterestStats() const
+{
+    InterestStats stats;
+    stats.PacketsSaved = mInterestPacketsSaved.load();
+    stats.Entered = mInterestEntered.load();
+    stats.Left = mInterestLeft.load();
+
+    return stats;
+}
+
+void ZoneManager::UpdateInterest(const std::shared_ptr<Zone>& zone,
+    uint64_t now)
+{
+    auto connections = zone->GetConnectionList();
+    if(connections.size() == 0)
+    {
+        return;
+    }
+
+    auto characterManager = mServer.lock()->GetCharacterManager();
+
+    // Bring the spatial grid up to date before it is queried
+    auto entities = zone->GetActiveEntities();
+    for(auto eState : entities)
+    {
+        eState->RefreshCurrentPosition(now);
+    }
+
+    // Entities shown to the whole zone since the last update can be out
+    // of range of clients that never had them in view
+    auto checks = zone->PopInterestChecks();
+    std::set<int32_t> recheck;
+
+    float enterRadius = mInterestRadius;
+    float leaveRadius = mInterestRadius + mInterestHysteresis;
+    float enterSquared = enterRadius * enterRadius;
+    float leaveSquared = leaveRadius * leaveRadius;
+
+    for(auto client : connections)
+    {
+        auto state = client->GetClientState();
+        auto cState = state->GetCharacterState();
+        auto dState = state->GetDemonState();
+        int32_t worldCID = state->GetWorldCID();
+
+        float x = cState->GetCurrentX();
+        float y = cState->GetCurrentY();
+
+        auto hidden = zone->GetHiddenEntities(worldCID);
+
+        std::set<int32_t> lastView;
+        bool checked = zone->GetInterestView(worldCID, lastView);
+
+        std::list<std::shared_ptr<ChannelClientConnection>> self = { client };
+        std::set<int32_t> inRange;
+        std::set<int32_t> view;
+        std::set<int32_t> entered;
+        std::set<int32_t> forget;
+        std::list<int32_t> left;
+
+        // Only entities in range can be shown again
+        for(auto eState : zone->GetActiveEntitiesInRadius(x, y, leaveRadius))
+        {
+            int32_t entityID = eState->GetEntityID();
+            if(eState == cState || eState == dState)
+            {
+                continue;
+            }
+
+            inRange.insert(entityID);
+
+            bool isHidden = hidden.find(entityID) != hidden.end();
+            if(!eState->Ready())
+            {
+                // Whatever displays the entity again will describe it to
+                // the client so stop tracking it
+                if(isHidden)
+                {
+                    forget.insert(entityID);
+                }
+
+                view.insert(entityID);
+                continue;
+            }
+
+            if(!isHidden)
+            {
+                view.insert(entityID);
+            }
+            else if(eState->GetDistance(x, y, true) <= enterSquared)
+            {
+                switch(eState->GetEntityType())
+                {
+                case objects::EntityStateObject::EntityType_t::CHARACTER:
+                case objects::EntityStateObject::EntityType_t::PARTNER_DEMON:
+                    {
+                        auto oState = ClientState::GetEntityClientState(
+                            entityID);
+                        if(!oState)
+                        {
+                            forget.insert(entityID);
+                            continue;
+                        }
+
+                        if(eState->GetEntityType() ==
+                            objects::EntityStateObject::EntityType_t::CHARACTER)
+                        {
+                            characterManager->SendOtherCharacterData(self,
+                                oState);
+                        }
+                        else
+                        {
+                            characterManager->SendOtherPartnerData(self,
+                                oState);
+                        }
+
+                        PopEntityForProduction(client, entityID, 0, true);
+                        ShowEntity(client, entityID, true);
+                    }
+                    break;
+                case objects::EntityStateObject::EntityType_t::ENEMY:
+                    SendEnemyData(client, std::dynamic_pointer_cast<
+                        EnemyState>(eState), zone, false, true);
+                    break;
+                default:
+                    break;
+                }
+
+                entered.insert(entityID);
+                view.insert(entityID);
+            }
+        }
+
+        // Only entities that were in range or were shown by something else
+        // can leave. A client seen for the first time knows every entity.
+        std::set<int32_t> candidates = checks;
+        if(checked)
+        {
+            candidates.insert(lastView.begin(), lastView.end());
+        }
+        else
+        {
+            for(auto eState : entities)
+            {
+                candidates.insert(eState->GetEntityID());
+            }
+        }
+
+        for(int32_t entityID : candidates)
+        {
+            if(inRange.find(entityID) != inRange.end() ||
+                hidden.find(entityID) != hidden.end())
+            {
+                continue;
+            }
+
+            auto eState = zone->GetActiveEntity(entityID);
+            if(!eState || eState == cState || eState == dState)
+            {
+                continue;
+            }
+
+            if(!eState->Ready())
+            {
+                // Check again once it is displayed
+                recheck.insert(entityID);
+                continue;
+            }
+
+            if(eState->GetDistance(x, y, true) <= leaveSquared)
+            {
+                // Moved into range after the query
+                view.insert(entityID);
+                continue;
+            }
+
+            switch(eState->GetEntityType())
+            {
+            case objects::EntityStateObject::EntityType_t::CHARACTER:
+            case objects::EntityStateObject::EntityType_t::PARTNER_DEMON:
+            case objects::EntityStateObject::EntityType_t::ENEMY:
+                left.push_back(entityID);
+                break;
+            default:
+                break;
+            }
+        }
+
+        if(left.size() > 0)
+        {
+            RemoveEntities(self, left, 0, true);
+
+            zone->SetEntitiesHidden(worldCID, std::set<int32_t>(
+                left.begin(), left.end()), true);
+            mInterestLeft += (uint64_t)left.size();
+        }
+
+        if(entered.size() > 0 || forget.size() > 0)
+        {
+            mInterestEntered += (uint64_t)entered.size();
+
+            entered.insert(forget.begin(), forget.end());
+            zone->SetEntitiesHidden(worldCID, entered, false);
+        }
+
+        zone->SetInterestView(worldCID, view);
+
+        client->FlushOutgoing();
+    }
+
+    for(int32_t entityID : recheck)
+    {
+        zone->QueueInterestCheck(entityID);
+    }
+}
+
 void ZoneManager::Warp(const std::shared_ptr<ChannelClientConnection>& client,
     const std::shared_ptr<ActiveEntityState>& eState, float xPos, float yPos,
     float rot)
@@ -2434,6 +2821,7 @@ void ZoneManager::Warp(const std::shared_ptr<ChannelClientConnection>& client,
     eState->SetDestinationTicks(timestamp);
     eState->SetCurrentX(xPos);
     eState->SetCurrentY(yPos);
+    eState->UpdateZonePosition();
 
     libcomp::Packet p;
     p.WritePacketCode(ChannelToClientPacketCode_t::PACKET_WARP);
@@ -3010,6 +3398,7 @@ bool ZoneManager::RemoveInstance(uint32_t instanceID)
         mZones.erase(z->GetID());
         mActiveZones.erase(z->GetID());
         mTimeRestrictUpdatedZones.erase(z->GetID());
+        mZoneTickStats.erase(z->GetID());
 
         if(mAllTimeRestrictZones.find(z->GetID()) !=
             mAllTimeRestrictZones.end())
@@ -33,6 +33,9 @@
 #include "ZoneGeometry.h"
 #include "ZoneInstance.h"
 
+// Standard C++11 Includes
+#include <atomic>
+
 namespace libcomp
 {
 class Packet;
@@ -314,6 +317,40 @@ public:
      */
     void BroadcastPacket(const std::shared_ptr<Zone>& zone, libcomp::Packet& p);
 
+    /**
+     * Send a packet about an entity to every connection in the zone or all
+     * but the client specified that the entity is not hidden from by area
+     * of interest management
+     * @param client Client connection to use as the "source" connection
+     * @param entityID ID of the entity the packet is about
+     * @param p Packet to send to the zone
+     * @param includeSelf Optional parameter to include the connection being passed
+     *  in when sending the packets. Defaults to true
+     */
+    void BroadcastEntityPacket(const std::shared_ptr<ChannelClientConnection>& client,
+        int32_t entityID, libcomp::Packet& p, bool includeSelf = true);
+
+    /**
+     * Send a packet about an entity to every connection in the specified
+     * zone that the entity is not hidden from by area of interest management
+     * @param zone Pointer to the zone to send the packet to
+     * @param entityID ID of the entity the packet is about
+     * @param p Packet to send to the zone
+     */
+    void BroadcastEntityPacket(const std::shared_ptr<Zone>& zone,
+        int32_t entityID, libcomp::Packet& p);
+
+    /**
+     * Send packets about entities to every connection in the specified zone
+     * skipping the packets about entities hidden from each connection by
+     * area of interest management
+     * @param zone Pointer to the zone to send the packets to
+     * @param packets List of packets paired with the ID of the entity each
+     *  one is about
+     */
+    void BroadcastEntityPackets(const std::shared_ptr<Zone>& zone,
+        std::list<std::pair<int32_t, libcomp::Packet>>& packets);
+
     /**
     * sends a packet to a specified range
     * @param client Client connection to use as the "source" connection
@@ -372,10 +409,84 @@ public:
     /**
      * Updates the current states of entities in the zone.  Enemy AI is
      * processed from here as well as updating the current state of moving
-     * entities.
+     * entities. The time spent on each zone is recorded in its
+     * @ref ZoneTickStats.
      */
     void UpdateActiveZoneStates();
 
+    /**
+     * Timing information for the updates of one zone
+     */
+    struct ZoneTickStats
+    {
+        /// Definition ID of the zone
+        uint32_t DefinitionID;
+
+        /// Dynamic map ID of the zone
+        uint32_t DynamicMapID;
+
+        /// Number of updates timed
+        uint64_t Ticks;
+
+        /// Total time spent updating the zone in microseconds
+        uint64_t TotalTime;
+
+        /// Longest single update in microseconds
+        uint64_t MaxTime;
+
+        /// Most recent update in microseconds
+        uint64_t LastTime;
+    };
+
+    /**
+     * Get the update timing information of every zone that has been
+     * updated since it was created.
+     * @return Map of zone unique IDs to their timing information
+     */
+    std::unordered_map<uint32_t, ZoneTickStats> GetZoneTickStats();
+
+    /**
+     * Counters kept by area of interest management
+     */
+    struct InterestStats
+    {
+        /// Movement packets not sent because the entity was out of view
+        uint64_t PacketsSaved;
+
+        /// Number of times an entity was shown to a client again
+        uint64_t Entered;
+
+        /// Number of times an entity was removed from a client
+        uint64_t Left;
+    };
+
+    /**
+     * Check if area of interest management is enabled. When enabled,
+     * clients only receive movement updates for entities within the
+     * configured view radius.
+     * @return true if enabled, false if every client in a zone receives
+     *  every movement update
+     */
+    bool InterestManagementEnabled() const;
+
+    /**
+     * Remove connections from a movement broadcast for an entity that
+     * area of interest management has removed from those clients. Does
+     * nothing if area of interest management is disabled.
+     * @param zone Pointer to the zone the entity is in
+     * @param entityID ID of the entity the broadcast is for
+     * @param connections List of connections to filter
+     */
+    void FilterInterestedConnections(const std::shared_ptr<Zone>& zone,
+        int32_t entityID, std::list<std::shared_ptr<
+        ChannelClientConnection>>& connections);
+
+    /**
+     * Get the area of interest management counters.
+     * @return Area of interest counters since the server started
+     */
+    InterestStats GetInterestStats() const;
+
     /**
      * Warp an entity to the specified location immediately.
      * @param client Pointer to the client connection to use for gathering zone
@@ -602,6 +713,17 @@ private:
     bool RegisterTimeRestrictions(const std::shared_ptr<Zone>& zone,
         const std::shared_ptr<objects::ServerZone>& definition);
 
+    /**
+     * Remove characters, partner demons and enemies that have moved out
+     * of the view of each client in the zone and show the ones that have
+     * moved back into view. Entities in range are found with the zone's
+     * spatial grid and only the ones that were in range at the last
+     * update (or have been shown to the whole zone since) can leave.
+     * @param zone Pointer to the zone to update
+     * @param now Current server time
+     */
+    void UpdateInterest(const std::shared_ptr<Zone>& zone, uint64_t now);
+
     /// Map of zones by unique ID
     std::unordered_map<uint32_t, std::shared_ptr<Zone>> mZones;
 
@@ -655,6 +777,27 @@ private:
     /// Next available zone instance unique ID
     uint32_t mNextZoneInstanceID;
 
+    /// View radius for area of interest management, 0 if disabled
+    float mInterestRadius;
+
+    /// Extra distance past the view radius before an entity is removed
+    float mInterestHysteresis;
+
+    /// Server time of the next area of interest visibility update
+    uint64_t mNextInterestUpdate;
+
+    /// Movement packets not sent because the entity was out of view
+    std::atomic<uint64_t> mInterestPacketsSaved;
+
+    /// Number of times an entity was shown to a client again
+    std::atomic<uint64_t> mInterestEntered;
+
+    /// Number of times an entity was removed from a client
+    std::atomic<uint64_t> mInterestLeft;
+
+    /// Update timing information by zone unique ID
+    std::unordered_map<uint32_t, ZoneTickStats> mZoneTickStats;
+
     /// Server lock for shared resources
     std::mutex mLock;
 
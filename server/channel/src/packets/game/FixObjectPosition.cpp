@@ -79,6 +79,7 @@ bool Parsers::FixObjectPosition::Parse(libcomp::ManagerPacket *pPacketManager,
     eState->SetCurrentX(destX);
     eState->SetDestinationY(destY);
     eState->SetCurrentY(destY);
+    eState->UpdateZonePosition();
 
     eState->SetDestinationTicks(stopTime);
 
@@ -107,6 +107,7 @@ bool Parsers::Move::Parse(libcomp::ManagerPacket *pPacketManager,
     eState->SetCurrentX(originX);
     eState->SetOriginY(originY);
     eState->SetCurrentY(originY);
+    eState->UpdateZonePosition();
     eState->SetOriginTicks(startTime);
     eState->SetDestinationX(destX);
     eState->SetDestinationY(destY);
@@ -123,8 +124,11 @@ bool Parsers::Move::Parse(libcomp::ManagerPacket *pPacketManager,
 
     /// @todo: Fire zone triggers
 
-    auto zoneConnections = server->GetZoneManager()->GetZoneConnections(client,
+    auto zoneManager = server->GetZoneManager();
+    auto zoneConnections = zoneManager->GetZoneConnections(client,
         positionCorrected);
+    zoneManager->FilterInterestedConnections(eState->GetZone(), entityID,
+        zoneConnections);
     if(zoneConnections.size() > 0)
     {
         libcomp::Packet reply;
@@ -93,7 +93,10 @@ bool Parsers::Rotate::Parse(libcomp::ManagerPacket *pPacketManager,
     eState->SetOriginRotation(eState->GetCurrentRotation());
     eState->SetDestinationRotation(rotation);
 
-    auto zoneConnections = server->GetZoneManager()->GetZoneConnections(client, false);
+    auto zoneManager = server->GetZoneManager();
+    auto zoneConnections = zoneManager->GetZoneConnections(client, false);
+    zoneManager->FilterInterestedConnections(eState->GetZone(), entityID,
+        zoneConnections);
     if(zoneConnections.size() > 0)
     {
         libcomp::Packet reply;
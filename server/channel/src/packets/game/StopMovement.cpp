@@ -82,11 +82,15 @@ bool Parsers::StopMovement::Parse(libcomp::ManagerPacket *pPacketManager,
     eState->SetCurrentX(destX);
     eState->SetDestinationY(destY);
     eState->SetCurrentY(destY);
+    eState->UpdateZonePosition();
 
     eState->SetOriginTicks(stopTime);
     eState->SetDestinationTicks(stopTime);
 
-    auto zoneConnections = server->GetZoneManager()->GetZoneConnections(client, false);
+    auto zoneManager = server->GetZoneManager();
+    auto zoneConnections = zoneManager->GetZoneConnections(client, false);
+    zoneManager->FilterInterestedConnections(eState->GetZone(), entityID,
+        zoneConnections);
     if(zoneConnections.size() > 0)
     {
         libcomp::Packet reply;
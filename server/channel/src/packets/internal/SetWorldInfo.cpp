@@ -120,6 +120,11 @@ bool SetWorldInfoFromPacket(libcomp::ManagerPacket *pPacketManager,
     }
     server->SetLobbyDatabase(lobbyDatabase);
 
+    // Write queued changes in the background so slow queries do not hold
+    // up the game tick
+    worldDatabase->StartTransactionWriter();
+    lobbyDatabase->StartTransactionWriter();
+
     // Get the world shared config
     auto worldSharedConfig = std::make_shared<objects::WorldSharedConfig>();
     if(!worldSharedConfig->LoadPacket(p, false))
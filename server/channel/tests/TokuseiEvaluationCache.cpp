@@ -0,0 +1,265 @@
+/**
+ * @file server/channel/tests/TokuseiEvaluationCache.cpp
+ * @ingroup channel
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Tests of the TokuseiEvaluationCache class.
+ *
+ * This file is part of the Channel Server (channel).
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <PushIgnore.h>
+#include <gtest/gtest.h>
+#include <PopIgnore.h>
+
+#include <TokuseiEvaluationCache.h>
+
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+using namespace channel;
+
+namespace
+{
+
+// Condition types as they are numbered in TokuseiCondition::Type_t
+const int8_t CURRENT_HP = 1;
+const int8_t CURRENT_MP = 2;
+const int8_t LNC = 6;
+const int8_t STATUS_ACTIVE = 9;
+const int8_t PARTNER_FAMILIARITY = 13;
+
+/// Everything the test conditions read
+struct Entity
+{
+    int32_t HPPercent;
+    int32_t MPPercent;
+    int32_t LNCType;
+    std::set<int32_t> StatusEffects;
+    int32_t Familiarity;
+};
+
+/// One tokusei with every condition type it depends upon
+struct Tokusei
+{
+    int32_t ID;
+    std::vector<int8_t> Types;
+    std::function<bool(const Entity&)> Condition;
+};
+
+std::vector<Tokusei> GetTokusei()
+{
+    return {
+        { 1, {}, [](const Entity&) { return true; } },
+        { 2, { CURRENT_HP }, [](const Entity& e)
+            { return e.HPPercent <= 30; } },
+        { 3, { CURRENT_MP }, [](const Entity& e)
+            { return e.MPPercent >= 50; } },
+        { 4, { LNC }, [](const Entity& e) { return e.LNCType == 2; } },
+        { 5, { STATUS_ACTIVE }, [](const Entity& e)
+            { return e.StatusEffects.count(7) != 0; } },
+        { 6, { CURRENT_HP, STATUS_ACTIVE }, [](const Entity& e)
+            { return e.HPPercent >= 80 || e.StatusEffects.count(3) != 0; } },
+        { 7, { PARTNER_FAMILIARITY }, [](const Entity& e)
+            { return e.Familiarity >= 5000; } },
+        { 8, { CURRENT_MP, PARTNER_FAMILIARITY }, [](const Entity& e)
+            { return e.MPPercent < 20 && e.Familiarity < 2000; } },
+    };
+}
+
+uint32_t GetInputs(const Tokusei& tokusei)
+{
+    uint32_t inputs = 0;
+    for(int8_t type : tokusei.Types)
+    {
+        inputs |= TokuseiEvaluationCache::InputMask(type);
+    }
+
+    return inputs;
+}
+
+/// Tracked inputs the same way TokuseiManager builds them
+TokuseiEvaluationCache::Inputs GetInputValues(const Entity& e)
+{
+    TokuseiEvaluationCache::Inputs inputs;
+    inputs[CURRENT_HP].push_back(e.HPPercent);
+    inputs[CURRENT_MP].push_back(e.MPPercent);
+    inputs[LNC].push_back(e.LNCType);
+    inputs[STATUS_ACTIVE].assign(e.StatusEffects.begin(),
+        e.StatusEffects.end());
+
+    return inputs;
+}
+
+std::unordered_map<int32_t, bool> EvaluateAll(const Entity& e,
+    const std::vector<Tokusei>& tokusei)
+{
+    std::unordered_map<int32_t, bool> results;
+    for(auto& t : tokusei)
+    {
+        results[t.ID] = t.Condition(e);
+    }
+
+    return results;
+}
+
+/// Recalculation for a set of changes the same way TokuseiManager does it
+std::unordered_map<int32_t, bool> EvaluateCached(const Entity& e,
+    const std::vector<Tokusei>& tokusei, TokuseiEvaluationCache& cache,
+    size_t& evaluatedCount)
+{
+    auto inputs = GetInputValues(e);
+    uint32_t changed = cache.GetChanged(inputs);
+
+    std::unordered_map<int32_t, bool> results;
+    for(auto& t : tokusei)
+    {
+        bool add = false;
+        if(!cache.Get(t.ID, GetInputs(t), changed, add))
+        {
+            add = t.Condition(e);
+            evaluatedCount++;
+        }
+
+        results[t.ID] = add;
+    }
+
+    cache.Set(results, inputs);
+
+    return results;
+}
+
+} // namespace
+
+TEST(TokuseiEvaluationCache, MatchesFullEvaluation)
+{
+    auto tokusei = GetTokusei();
+
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<int32_t> percent(0, 100);
+    std::uniform_int_distribution<int32_t> pick(0, 5);
+
+    Entity e = { 100, 100, 1, {}, 0 };
+
+    TokuseiEvaluationCache cache;
+    cache.Set(EvaluateAll(e, tokusei), GetInputValues(e));
+
+    size_t evaluatedCount = 0;
+    for(int i = 0; i < 5000; i++)
+    {
+        // Change one input. Nothing tells the cache which one changed.
+        switch(pick(rng))
+        {
+        case 0:
+            e.HPPercent = percent(rng);
+            break;
+        case 1:
+            e.MPPercent = percent(rng);
+            break;
+        case 2:
+            e.LNCType = 1 << (percent(rng) % 3);
+            break;
+        case 3:
+            e.StatusEffects.insert(percent(rng) % 10);
+            break;
+        case 4:
+            e.StatusEffects.erase(percent(rng) % 10);
+            break;
+        default:
+            e.Familiarity = percent(rng) * 100;
+            break;
+        }
+
+        EXPECT_EQ(EvaluateAll(e, tokusei),
+            EvaluateCached(e, tokusei, cache, evaluatedCount));
+    }
+
+    // Some results must have been reused for the cache to be useful
+    EXPECT_LT(evaluatedCount, (size_t)5000 * tokusei.size());
+}
+
+TEST(TokuseiEvaluationCache, ReusesOnlyUnchangedInputs)
+{
+    auto tokusei = GetTokusei();
+
+    Entity e = { 100, 100, 1, {}, 0 };
+
+    TokuseiEvaluationCache cache;
+    cache.Set(EvaluateAll(e, tokusei), GetInputValues(e));
+
+    // Only the HP tokusei and the untracked familiarity tokusei are
+    // evaluated again when the HP changes
+    e.HPPercent = 10;
+
+    size_t evaluatedCount = 0;
+    auto results = EvaluateCached(e, tokusei, cache, evaluatedCount);
+
+    EXPECT_EQ(EvaluateAll(e, tokusei), results);
+    EXPECT_EQ((size_t)4, evaluatedCount);
+    EXPECT_TRUE(results[2]);
+
+    // Nothing tracked changed so only the untracked tokusei are evaluated
+    evaluatedCount = 0;
+    e.Familiarity = 6000;
+    results = EvaluateCached(e, tokusei, cache, evaluatedCount);
+
+    EXPECT_EQ(EvaluateAll(e, tokusei), results);
+    EXPECT_EQ((size_t)2, evaluatedCount);
+    EXPECT_TRUE(results[7]);
+}
+
+TEST(TokuseiEvaluationCache, EmptyCacheEvaluatesEverything)
+{
+    auto tokusei = GetTokusei();
+
+    Entity e = { 25, 60, 2, { 7 }, 0 };
+
+    TokuseiEvaluationCache cache;
+
+    size_t evaluatedCount = 0;
+    EXPECT_EQ(EvaluateAll(e, tokusei), EvaluateCached(e, tokusei, cache,
+        evaluatedCount));
+    EXPECT_EQ(tokusei.size(), evaluatedCount);
+
+    // Clearing the cache forces everything to be evaluated again
+    cache.Clear();
+
+    evaluatedCount = 0;
+    EXPECT_EQ(EvaluateAll(e, tokusei), EvaluateCached(e, tokusei, cache,
+        evaluatedCount));
+    EXPECT_EQ(tokusei.size(), evaluatedCount);
+}
+
+int main(int argc, char *argv[])
+{
+    try
+    {
+        ::testing::InitGoogleTest(&argc, argv);
+
+        return RUN_ALL_TESTS();
+    }
+    catch(...)
+    {
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file tools/bench/src/Bench.h
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Shared helpers for the micro-benchmarks.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TOOLS_BENCH_SRC_BENCH_H
+#define TOOLS_BENCH_SRC_BENCH_H
+
+// Standard C++11 Includes
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bench
+{
+
+/**
+ * Measures the wall time of a scope in seconds.
+ */
+class Stopwatch
+{
+public:
+    /**
+     * Start timing.
+     */
+    Stopwatch() : mStart(std::chrono::steady_clock::now())
+    {
+    }
+
+    /**
+     * Get the number of seconds since the stopwatch was created.
+     * @return Elapsed seconds
+     */
+    double Elapsed() const
+    {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - mStart).count();
+    }
+
+private:
+    /// Time the stopwatch was created
+    std::chrono::steady_clock::time_point mStart;
+};
+
+/**
+ * Print one result line in a consistent format.
+ * @param name Name of the measured case
+ * @param ops Number of operations performed
+ * @param seconds Time taken for all operations
+ */
+inline void Report(const std::string& name, double ops, double seconds)
+{
+    std::cout << std::left << std::setw(40) << name << std::right
+        << std::fixed << std::setprecision(1)
+        << std::setw(14) << (ops / seconds) << " ops/s"
+        << std::setw(12) << (seconds * 1e9 / ops) << " ns/op"
+        << std::endl;
+}
+
+/// Benchmark of the Blowfish ECB engines in MB/s on one core.
+int BlowfishBench();
+
+/// Benchmark of a wave of encryption handshakes done on the reactor thread
+/// and on the HandshakePool.
+int HandshakeBench();
+
+/// Benchmark of MessageQueue against the mutex based queue it replaced.
+int MessageQueueBench();
+
+/// Benchmark of PersistentObjectCache against the string keyed map it
+/// replaced.
+int ObjectCacheBench();
+
+/// Benchmark of socket reads per frame with and without the TcpConnection
+/// receive buffer.
+int ReceiveBench();
+
+/// Benchmark of a flood of small packets sent one frame per write and
+/// with the TcpConnection send budget.
+int SendBench();
+
+/// Benchmark of zone range queries against a SpatialGrid and a full scan.
+int SpatialGridBench();
+
+/// Benchmark of entity stat recalculation with EnumArray against the
+/// EnumMap it replaced.
+int StatsBench();
+
+/// Benchmark of String argument formatting against the regex version.
+int StringBench();
+
+/// Benchmark of TimerManager against the ordered set it replaced.
+int TimerManagerBench();
+
+} // namespace bench
+
+#endif // TOOLS_BENCH_SRC_BENCH_H
@@ -0,0 +1,127 @@
+/**
+ * @file tools/bench/src/BlowfishBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of the Blowfish ECB engines.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <BlowfishEcb.h>
+
+// Standard C++11 Includes
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+
+/// Bytes encrypted and decrypted for each case.
+const std::size_t BYTES_PER_CASE = 128 * 1024 * 1024;
+
+/**
+ * Encrypt and decrypt a buffer over and over with one engine on the
+ * calling thread.
+ * @param key Blowfish key
+ * @param engine Engine to use
+ * @param size Size of the buffer (like the size of a packet)
+ * @return true if the data came back the same
+ */
+bool RunEngine(const BF_KEY& key, libcomp::BlowfishEcb::Engine_t engine,
+    uint32_t size)
+{
+    libcomp::BlowfishEcb::SetEngine(engine);
+
+    std::vector<char> data(size);
+
+    for(std::size_t i = 0; i < data.size(); i++)
+    {
+        data[i] = static_cast<char>(i);
+    }
+
+    std::vector<char> original = data;
+
+    std::size_t count = BYTES_PER_CASE / size;
+    uint32_t blockCount = size / 8;
+
+    bench::Stopwatch timer;
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        libcomp::BlowfishEcb::Encrypt(key, data.data(), blockCount);
+        libcomp::BlowfishEcb::Decrypt(key, data.data(), blockCount);
+    }
+
+    double elapsed = timer.Elapsed();
+
+    bench::Report(std::string(libcomp::BlowfishEcb::GetEngineName(
+        engine)) + " " + std::to_string(size) + " bytes",
+        static_cast<double>(count * 2), elapsed);
+
+    std::cout << "  " << std::setprecision(1) << (static_cast<double>(
+        count * 2 * size) / elapsed / 1e6) << " MB/s per core" << std::endl;
+
+    return data == original;
+}
+
+} // namespace
+
+int bench::BlowfishBench()
+{
+    static const libcomp::BlowfishEcb::Engine_t engines[] = {
+        libcomp::BlowfishEcb::Engine_t::OPENSSL,
+        libcomp::BlowfishEcb::Engine_t::LANES_4,
+        libcomp::BlowfishEcb::Engine_t::LANES_8,
+        libcomp::BlowfishEcb::Engine_t::AVX2,
+    };
+
+    static const unsigned char keyData[] = {
+        0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF,
+        0xF0, 0xE1, 0xD2, 0xC3, 0xB4, 0xA5, 0x96, 0x87
+    };
+
+    BF_KEY key;
+    BF_set_key(&key, static_cast<int>(sizeof(keyData)), keyData);
+
+    libcomp::BlowfishEcb::SetEngine(libcomp::BlowfishEcb::Engine_t::AUTO);
+
+    std::cout << "Engine picked at runtime: "
+        << libcomp::BlowfishEcb::GetEngineName(
+        libcomp::BlowfishEcb::GetEngine()) << std::endl;
+
+    bool ok = true;
+
+    // Small game packets, a large packet and a full frame.
+    for(uint32_t size : { 64u, 1024u, 16384u })
+    {
+        for(auto engine : engines)
+        {
+            if(libcomp::BlowfishEcb::IsSupported(engine))
+            {
+                ok &= RunEngine(key, engine, size);
+            }
+        }
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
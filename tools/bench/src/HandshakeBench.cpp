@@ -0,0 +1,371 @@
+/**
+ * @file tools/bench/src/HandshakeBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of a wave of encryption handshakes on one reactor.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <Constants.h>
+#include <EncryptedConnection.h>
+#include <HandshakePool.h>
+#include <TcpServer.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/// Number of clients that connect at the same time.
+const std::size_t CONNECTION_COUNT = 2000;
+
+/// Time between two samples of the reactor latency.
+const std::chrono::milliseconds PROBE_INTERVAL(1);
+
+/// 1024-bit MODP prime from RFC 2409 (the base is 2).
+const char *DH_PRIME = "FFFFFFFFFFFFFFFFC90FDAA22168C234C4C6628B80DC1CD1"
+    "29024E088A67CC74020BBEA63B139B22514A08798E3404DDEF9519B3CD3A431B"
+    "302B0A6DF25F14374FE1356D6D51C245E485B576625E7EC6F44C42E9A637ED6B"
+    "0BFF5CB6F406B7EDEE386BFB5A899FA5AE9F24117C4B1FE649286651ECE65381"
+    "FFFFFFFFFFFFFFFF";
+
+/// Size of the base, prime and server public sent by the server.
+const std::size_t REPLY_SIZE = 4 * sizeof(uint32_t) +
+    (sizeof(DH_BASE_STRING) - 1) + 2 * DH_KEY_HEX_SIZE;
+
+/**
+ * Server side of a handshake that only counts the connections that reach
+ * the encrypted state.
+ */
+class HandshakeConnection : public libcomp::EncryptedConnection
+{
+public:
+    HandshakeConnection(asio::ip::tcp::socket& socket, DH *pDiffieHellman,
+        const std::function<void()>& encrypted) :
+        libcomp::EncryptedConnection(socket, pDiffieHellman),
+        mEncrypted(encrypted)
+    {
+    }
+
+protected:
+    virtual void ConnectionEncrypted()
+    {
+        mEncrypted();
+    }
+
+private:
+    std::function<void()> mEncrypted;
+};
+
+/**
+ * Client side of a handshake. The client public is computed once up front
+ * so the clients cost nothing next to the server.
+ */
+struct Client
+{
+    explicit Client(asio::io_service& service) : Socket(service),
+        Reply(REPLY_SIZE)
+    {
+    }
+
+    /// Socket connected to the server
+    asio::ip::tcp::socket Socket;
+
+    /// Buffer for the reply of the server
+    std::vector<char> Reply;
+};
+
+/**
+ * Append a 32-bit big endian value to a buffer.
+ * @param buffer Buffer to append to
+ * @param value Value to append
+ */
+void WriteU32Big(std::vector<char>& buffer, uint32_t value)
+{
+    for(int shift = 24; shift >= 0; shift -= 8)
+    {
+        buffer.push_back(static_cast<char>((value >> shift) & 0xFF));
+    }
+}
+
+/**
+ * Run the client side of one handshake.
+ * @param client Client to run
+ * @param endpoint Address of the server
+ * @param hello First packet of the handshake
+ * @param clientPublic Packet with the client public
+ */
+void RunClient(Client& client, const asio::ip::tcp::endpoint& endpoint,
+    const std::vector<char>& hello, const std::vector<char>& clientPublic)
+{
+    client.Socket.async_connect(endpoint, [&client, &hello, &clientPublic](
+        asio::error_code errorCode)
+    {
+        if(errorCode)
+        {
+            return;
+        }
+
+        asio::async_write(client.Socket, asio::buffer(hello),
+            [](asio::error_code, std::size_t)
+            {
+            });
+
+        asio::async_read(client.Socket, asio::buffer(client.Reply),
+            [&client, &clientPublic](asio::error_code readError,
+                std::size_t)
+            {
+                if(readError)
+                {
+                    return;
+                }
+
+                asio::async_write(client.Socket, asio::buffer(clientPublic),
+                    [](asio::error_code, std::size_t)
+                    {
+                    });
+            });
+    });
+}
+
+/**
+ * Print the handshakes in each latency bucket.
+ * @param before Pool counters before the case
+ * @param after Pool counters after the case
+ */
+void ReportLatency(const libcomp::HandshakePool::Stats& before,
+    const libcomp::HandshakePool::Stats& after)
+{
+    std::cout << "  handshake latency:";
+
+    for(size_t i = 0; i < libcomp::HandshakePool::LATENCY_BUCKET_COUNT; i++)
+    {
+        uint64_t count = after.Latency[i] - before.Latency[i];
+
+        if(0 == count)
+        {
+            continue;
+        }
+
+        uint64_t limit = libcomp::HandshakePool::GetLatencyBucketLimit(i);
+
+        if(0 != limit)
+        {
+            std::cout << " <" << (static_cast<double>(limit) / 1000.0)
+                << "ms=" << count;
+        }
+        else
+        {
+            std::cout << " >=" << (static_cast<double>(libcomp::
+                HandshakePool::GetLatencyBucketLimit(i - 1)) / 1000.0)
+                << "ms=" << count;
+        }
+    }
+
+    std::cout << std::endl;
+}
+
+/**
+ * Connect every client at once and complete the handshakes on a single
+ * reactor thread.
+ * @param name Name of the case
+ * @param pDiffieHellman Prime and base of the server
+ * @param clientPublic Packet with the client public
+ * @param threadCount Number of handshake pool threads (0 for inline)
+ * @param keyPairCount Number of key pairs to generate before the wave
+ * @return true if every connection was encrypted
+ */
+bool RunHandshakes(const std::string& name, const DH *pDiffieHellman,
+    const std::vector<char>& clientPublic, uint32_t threadCount,
+    uint32_t keyPairCount)
+{
+    auto pool = libcomp::HandshakePool::GetSingletonPtr();
+
+    if(0 != threadCount)
+    {
+        pool->Start(threadCount, keyPairCount, pDiffieHellman);
+
+        // Let the pool fill up like it would before the wave.
+        while(pool->GetStats().KeyPairsReady < keyPairCount)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    asio::io_service service;
+    asio::ip::tcp::acceptor acceptor(service, asio::ip::tcp::endpoint(
+        asio::ip::address_v4::loopback(), 0));
+    asio::ip::tcp::socket serverSocket(service);
+    asio::steady_timer probe(service);
+
+    std::vector<std::shared_ptr<HandshakeConnection>> connections;
+    std::size_t encrypted = 0;
+    int64_t stallMax = 0;
+    bool done = false;
+
+    std::function<void()> accept = [&]()
+    {
+        acceptor.async_accept(serverSocket, [&](asio::error_code errorCode)
+        {
+            if(errorCode)
+            {
+                return;
+            }
+
+            auto connection = std::make_shared<HandshakeConnection>(
+                serverSocket, libcomp::TcpServer::CopyDiffieHellman(
+                pDiffieHellman), [&]()
+                {
+                    if(CONNECTION_COUNT == ++encrypted)
+                    {
+                        done = true;
+                        acceptor.close();
+                        probe.cancel();
+                    }
+                });
+
+            connections.push_back(connection);
+            connection->ConnectionSuccess();
+
+            if(connections.size() < CONNECTION_COUNT)
+            {
+                accept();
+            }
+        });
+    };
+
+    std::function<void()> sample = [&]()
+    {
+        probe.expires_from_now(PROBE_INTERVAL);
+        probe.async_wait([&](asio::error_code errorCode)
+        {
+            if(errorCode || done)
+            {
+                return;
+            }
+
+            stallMax = std::max(stallMax, static_cast<int64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - probe.expires_at())
+                .count()));
+
+            sample();
+        });
+    };
+
+    // The clients run on their own thread so they never delay the server.
+    asio::io_service clientService;
+    std::vector<std::unique_ptr<Client>> clients;
+
+    std::vector<char> hello;
+    WriteU32Big(hello, 1);
+    WriteU32Big(hello, 8);
+
+    for(std::size_t i = 0; i < CONNECTION_COUNT; ++i)
+    {
+        clients.emplace_back(new Client(clientService));
+        RunClient(*clients.back(), acceptor.local_endpoint(), hello,
+            clientPublic);
+    }
+
+    auto before = pool->GetStats();
+
+    bench::Stopwatch timer;
+
+    std::thread clientThread([&clientService]()
+    {
+        clientService.run();
+    });
+
+    accept();
+    sample();
+
+    service.run();
+
+    double elapsed = timer.Elapsed();
+
+    auto after = pool->GetStats();
+
+    clientService.stop();
+    clientThread.join();
+
+    pool->Stop();
+
+    bench::Report(name, static_cast<double>(encrypted), elapsed);
+
+    std::cout << "  " << encrypted << " handshakes in " << std::fixed
+        << std::setprecision(1) << (elapsed * 1000.0) << "ms, reactor"
+        << " stalled up to " << (static_cast<double>(stallMax) / 1000.0)
+        << "ms, " << (after.KeyPairHits - before.KeyPairHits)
+        << " key pairs ready ahead of time" << std::endl;
+
+    ReportLatency(before, after);
+
+    return CONNECTION_COUNT == encrypted;
+}
+
+} // namespace
+
+int bench::HandshakeBench()
+{
+    DH *pDiffieHellman = libcomp::TcpServer::LoadDiffieHellman(
+        libcomp::String(DH_PRIME));
+
+    if(nullptr == pDiffieHellman)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Every client sends the same public; the server math is the same.
+    DH *pClient = libcomp::TcpServer::CopyDiffieHellman(pDiffieHellman);
+    libcomp::String publicKey = libcomp::TcpConnection::
+        GenerateDiffieHellmanPublic(pClient).RightJustified(
+        DH_KEY_HEX_SIZE, '0');
+    DH_free(pClient);
+
+    std::vector<char> clientPublic;
+    WriteU32Big(clientPublic, static_cast<uint32_t>(publicKey.Size()));
+    clientPublic.insert(clientPublic.end(), publicKey.C(),
+        publicKey.C() + publicKey.Size());
+
+    uint32_t threadCount = std::max(2u, std::thread::hardware_concurrency());
+
+    bool ok = true;
+
+    ok &= RunHandshakes("inline", pDiffieHellman, clientPublic, 0, 0);
+    ok &= RunHandshakes("pool", pDiffieHellman, clientPublic,
+        threadCount, 0);
+    ok &= RunHandshakes("pool + 2000 key pairs", pDiffieHellman,
+        clientPublic, threadCount, (uint32_t)CONNECTION_COUNT);
+
+    DH_free(pDiffieHellman);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file tools/bench/src/MessageQueueBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of the lock free MessageQueue.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <MessageQueue.h>
+
+// Standard C++11 Includes
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The mutex and condition variable queue MessageQueue used to be. Kept
+ * here as the baseline for the comparison. The wait is timed because the
+ * original can lose a wakeup (a producer may notify between the empty
+ * check and the wait) which would hang the benchmark.
+ */
+template<class T>
+class LockingMessageQueue
+{
+public:
+    void Enqueue(T item)
+    {
+        mQueueLock.lock();
+        bool wasEmpty = mQueue.empty();
+        mQueue.push_back(item);
+        mQueueLock.unlock();
+
+        if(wasEmpty)
+        {
+            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
+            mEmptyCondition.notify_one();
+        }
+    }
+
+    void DequeueAll(std::list<T>& destinationQueue)
+    {
+        std::list<T> tempQueue;
+
+        mQueueLock.lock();
+
+        if(mQueue.empty())
+        {
+            mQueueLock.unlock();
+            std::unique_lock<std::mutex> uniqueLock(mEmptyConditionLock);
+            mEmptyCondition.wait_for(uniqueLock,
+                std::chrono::milliseconds(1));
+            mQueueLock.lock();
+        }
+
+        mQueue.swap(tempQueue);
+        mQueueLock.unlock();
+
+        destinationQueue.splice(destinationQueue.end(), tempQueue);
+    }
+
+private:
+    std::list<T> mQueue;
+    std::mutex mQueueLock;
+    std::mutex mEmptyConditionLock;
+    std::condition_variable mEmptyCondition;
+};
+
+/// Total messages sent per run regardless of the producer count.
+const std::size_t MESSAGE_COUNT = 2000000;
+
+/**
+ * Push MESSAGE_COUNT messages through the queue from the given number of
+ * producer threads into one consumer (the calling thread).
+ * @param name Name of the queue implementation
+ * @param producerCount Number of producer threads
+ * @return true if every message arrived
+ */
+template<class Queue>
+bool RunQueue(const std::string& name, std::size_t producerCount)
+{
+    Queue queue;
+    std::size_t perProducer = MESSAGE_COUNT / producerCount;
+    std::size_t expected = perProducer * producerCount;
+    std::size_t received = 0;
+    std::size_t checksum = 0;
+
+    bench::Stopwatch timer;
+
+    std::vector<std::thread> producers;
+
+    for(std::size_t p = 0; p < producerCount; ++p)
+    {
+        producers.emplace_back([&queue, perProducer]()
+        {
+            for(std::size_t i = 0; i < perProducer; ++i)
+            {
+                queue.Enqueue(i);
+            }
+        });
+    }
+
+    // The baseline queue may return an empty list after a timed out wait
+    // so loop on the count rather than on the number of calls.
+    while(received < expected)
+    {
+        std::list<std::size_t> msgs;
+        queue.DequeueAll(msgs);
+
+        for(auto msg : msgs)
+        {
+            checksum += msg;
+        }
+
+        received += msgs.size();
+    }
+
+    double elapsed = timer.Elapsed();
+
+    for(auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    bench::Report(name + " x" + std::to_string(producerCount),
+        static_cast<double>(expected), elapsed);
+
+    return checksum == producerCount * (perProducer * (perProducer - 1) / 2);
+}
+
+} // namespace
+
+int bench::MessageQueueBench()
+{
+    bool ok = true;
+
+    for(std::size_t producerCount : { 1u, 4u, 16u })
+    {
+        ok &= RunQueue<LockingMessageQueue<std::size_t>>("locking",
+            producerCount);
+        ok &= RunQueue<libcomp::MessageQueue<std::size_t>>("lockfree",
+            producerCount);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
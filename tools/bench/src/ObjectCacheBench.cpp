@@ -0,0 +1,185 @@
+/**
+ * @file tools/bench/src/ObjectCacheBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of PersistentObjectCache against the string keyed map it
+ * replaced.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <PersistentObjectCache.h>
+
+// object Includes
+#include <Account.h>
+
+// Standard C++11 Includes
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The single map and lock PersistentObject used to cache objects in.
+ */
+class LegacyObjectCache
+{
+public:
+    bool Add(const libobjgen::UUID& uuid,
+        const std::shared_ptr<libcomp::PersistentObject>& obj)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        std::string uuidString = uuid.ToString();
+        if(mCached.find(uuidString) != mCached.end())
+        {
+            return false;
+        }
+
+        mCached[uuidString] = obj;
+
+        return true;
+    }
+
+    std::shared_ptr<libcomp::PersistentObject> Get(
+        const libobjgen::UUID& uuid)
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+
+        auto it = mCached.find(uuid.ToString());
+        if(it != mCached.end())
+        {
+            return it->second.lock();
+        }
+
+        return nullptr;
+    }
+
+private:
+    std::unordered_map<std::string,
+        std::weak_ptr<libcomp::PersistentObject>> mCached;
+    std::mutex mLock;
+};
+
+/// Number of objects in the cache
+const size_t OBJECT_COUNT = 100000;
+
+/// Number of lookups each thread performs
+const size_t LOOKUP_COUNT = 200000;
+
+/// Number of threads to look up objects from in each run
+const size_t THREAD_COUNTS[] = { 1, 8 };
+
+/**
+ * Fill a cache and look objects up from several threads at once.
+ * @param name Name of the cache implementation
+ * @param threadCount Number of threads looking up objects
+ * @param objs Objects to cache
+ * @param uuids UUID of each object
+ * @return true if every lookup found its object
+ */
+template<class Cache>
+bool RunCache(const std::string& name, size_t threadCount,
+    const std::vector<std::shared_ptr<libcomp::PersistentObject>>& objs,
+    const std::vector<libobjgen::UUID>& uuids)
+{
+    Cache cache;
+
+    {
+        bench::Stopwatch sw;
+
+        for(size_t i = 0; i < objs.size(); i++)
+        {
+            cache.Add(uuids[i], objs[i]);
+        }
+
+        bench::Report(name + " add", (double)objs.size(), sw.Elapsed());
+    }
+
+    std::atomic<size_t> missing(0);
+    std::vector<std::thread> threads;
+
+    bench::Stopwatch sw;
+
+    for(size_t t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            std::mt19937 rng((uint32_t)t);
+            std::uniform_int_distribution<size_t> pick(0,
+                objs.size() - 1);
+
+            for(size_t i = 0; i < LOOKUP_COUNT; i++)
+            {
+                size_t idx = pick(rng);
+
+                if(cache.Get(uuids[idx]) != objs[idx])
+                {
+                    missing++;
+                }
+            }
+        });
+    }
+
+    for(auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    bench::Report(name + " get x" + std::to_string(threadCount),
+        (double)(LOOKUP_COUNT * threadCount), sw.Elapsed());
+
+    return 0 == missing;
+}
+
+} // namespace
+
+int bench::ObjectCacheBench()
+{
+    std::vector<std::shared_ptr<libcomp::PersistentObject>> objs;
+    std::vector<libobjgen::UUID> uuids;
+
+    for(size_t i = 0; i < OBJECT_COUNT; i++)
+    {
+        objs.push_back(std::make_shared<objects::Account>());
+        uuids.push_back(libobjgen::UUID::Random());
+    }
+
+    bool ok = true;
+
+    for(size_t threadCount : THREAD_COUNTS)
+    {
+        ok = RunCache<LegacyObjectCache>("string map", threadCount,
+            objs, uuids) && ok;
+        ok = RunCache<libcomp::PersistentObjectCache>("sharded",
+            threadCount, objs, uuids) && ok;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,291 @@
+/**
+ * @file tools/bench/src/ReceiveBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of the buffered TcpConnection receive path.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <Constants.h>
+#include <TcpConnection.h>
+
+// Standard C++11 Includes
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Number of frames sent when no capture is given.
+const std::size_t SYNTHETIC_FRAME_COUNT = 200000;
+
+/**
+ * Connection that parses frames the same way as @ref EncryptedConnection
+ * (sizes then padded body) without decrypting or queueing them.
+ */
+class FrameConnection : public libcomp::TcpConnection
+{
+public:
+    FrameConnection(asio::ip::tcp::socket& socket, std::size_t expected) :
+        libcomp::TcpConnection(socket, nullptr), mExpected(expected),
+        mFrames(0)
+    {
+    }
+
+    std::size_t Frames() const
+    {
+        return mFrames;
+    }
+
+    virtual void ConnectionSuccess()
+    {
+        (void)RequestPacket(2 * sizeof(uint32_t));
+    }
+
+protected:
+    virtual void PacketReceived(libcomp::Packet& packet)
+    {
+        if((2 * sizeof(uint32_t)) > packet.Size())
+        {
+            (void)RequestPacket(2 * sizeof(uint32_t) - packet.Size());
+            return;
+        }
+
+        uint32_t paddedSize = packet.PeekU32Big();
+
+        if((paddedSize + 2 * sizeof(uint32_t)) > packet.Size())
+        {
+            (void)RequestPacket(paddedSize + 2 * sizeof(uint32_t) -
+                packet.Size());
+            return;
+        }
+
+        CountReceivedFrame();
+        packet.Clear();
+
+        if(++mFrames < mExpected)
+        {
+            (void)RequestPacket(2 * sizeof(uint32_t));
+        }
+        else
+        {
+            Close();
+        }
+    }
+
+private:
+    std::size_t mExpected;
+    std::size_t mFrames;
+};
+
+/**
+ * Append one frame header to the stream.
+ * @param stream Stream to append to
+ * @param paddedSize Size of the frame body
+ * @param realSize Size of the frame body without padding
+ */
+void WriteHeader(std::vector<char>& stream, uint32_t paddedSize,
+    uint32_t realSize)
+{
+    for(uint32_t value : { paddedSize, realSize })
+    {
+        for(int shift = 24; shift >= 0; shift -= 8)
+        {
+            stream.push_back(static_cast<char>((value >> shift) & 0xFF));
+        }
+    }
+}
+
+/**
+ * Build a stream of frames sized like game traffic (mostly small commands).
+ * @param stream Stream to fill
+ * @return Number of frames in the stream
+ */
+std::size_t BuildSyntheticStream(std::vector<char>& stream)
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> blocks(2, 32);
+
+    for(std::size_t i = 0; i < SYNTHETIC_FRAME_COUNT; ++i)
+    {
+        uint32_t paddedSize = blocks(rng) * 8;
+
+        WriteHeader(stream, paddedSize, paddedSize - 3);
+        stream.insert(stream.end(), paddedSize, 0);
+    }
+
+    return SYNTHETIC_FRAME_COUNT;
+}
+
+/**
+ * Load the frames of a capture file written with the CapturePath option.
+ * Frames are stored decrypted but the sizes are intact which is all the
+ * receive path looks at.
+ * @param szPath Path to the capture file
+ * @param stream Stream to fill
+ * @return Number of frames loaded or 0 on error
+ */
+std::size_t LoadCaptureStream(const char *szPath, std::vector<char>& stream)
+{
+    std::ifstream file(szPath, std::ifstream::binary);
+
+    uint32_t magic = 0, version = 0, addrlen = 0;
+    uint64_t stamp = 0;
+
+    file.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    file.read(reinterpret_cast<char*>(&version), sizeof(version));
+    file.read(reinterpret_cast<char*>(&stamp), sizeof(stamp));
+    file.read(reinterpret_cast<char*>(&addrlen), sizeof(addrlen));
+
+    if(!file.good() || HACK_FORMAT_MAGIC != magic ||
+        HACK_FORMAT_VER2 != version)
+    {
+        std::cerr << "Invalid capture file: " << szPath << std::endl;
+
+        return 0;
+    }
+
+    file.seekg(addrlen, std::ifstream::cur);
+
+    std::size_t frames = 0;
+
+    while(file.good())
+    {
+        uint8_t source = 0;
+        uint64_t microtime = 0;
+        uint32_t size = 0;
+
+        file.read(reinterpret_cast<char*>(&source), sizeof(source));
+        file.read(reinterpret_cast<char*>(&stamp), sizeof(stamp));
+        file.read(reinterpret_cast<char*>(&microtime), sizeof(microtime));
+        file.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+        if(!file.good() || size > MAX_PACKET_SIZE)
+        {
+            break;
+        }
+
+        std::vector<char> frame(size);
+        file.read(frame.data(), size);
+
+        // Only keep frames with a consistent padded size.
+        if(file.good() && (2 * sizeof(uint32_t)) <= size &&
+            (uint32_t)(((uint8_t)frame[0] << 24) | ((uint8_t)frame[1] << 16) |
+            ((uint8_t)frame[2] << 8) | (uint8_t)frame[3]) ==
+            size - 2 * sizeof(uint32_t))
+        {
+            stream.insert(stream.end(), frame.begin(), frame.end());
+            frames++;
+        }
+    }
+
+    return frames;
+}
+
+/**
+ * Send the stream over a loopback socket and parse it with a connection.
+ * @param name Name of the case
+ * @param stream Frames to send
+ * @param frameCount Number of frames in the stream
+ * @param bufferSize Receive buffer size (0 for direct reads)
+ * @return true if every frame was parsed
+ */
+bool RunReceive(const std::string& name, const std::vector<char>& stream,
+    std::size_t frameCount, uint32_t bufferSize)
+{
+    libcomp::TcpConnection::SetReceiveBufferSize(bufferSize);
+
+    asio::io_service service;
+    asio::ip::tcp::acceptor acceptor(service, asio::ip::tcp::endpoint(
+        asio::ip::address_v4::loopback(), 0));
+    asio::ip::tcp::socket serverSocket(service);
+    asio::ip::tcp::socket clientSocket(service);
+
+    clientSocket.connect(acceptor.local_endpoint());
+    acceptor.accept(serverSocket);
+
+    auto connection = std::make_shared<FrameConnection>(serverSocket,
+        frameCount);
+
+    auto before = libcomp::TcpConnection::GetReceiveStats();
+
+    bench::Stopwatch timer;
+
+    connection->ConnectionSuccess();
+
+    asio::async_write(clientSocket, asio::buffer(stream),
+        [](asio::error_code, std::size_t)
+        {
+        });
+
+    service.run();
+
+    double elapsed = timer.Elapsed();
+
+    auto after = libcomp::TcpConnection::GetReceiveStats();
+    uint64_t reads = after.Receives - before.Receives;
+
+    bench::Report(name, static_cast<double>(frameCount), elapsed);
+
+    std::cout << "  " << reads << " reads for " << frameCount << " frames, "
+        << std::setprecision(3)
+        << (static_cast<double>(reads) / static_cast<double>(frameCount))
+        << " reads per frame" << std::endl;
+
+    return connection->Frames() == frameCount;
+}
+
+} // namespace
+
+int bench::ReceiveBench()
+{
+    std::vector<char> stream;
+    std::size_t frameCount;
+
+    // Replay a capture if one is given, otherwise use synthetic traffic.
+    const char *szCapture = getenv("COMP_BENCH_CAPTURE");
+
+    if(nullptr != szCapture)
+    {
+        frameCount = LoadCaptureStream(szCapture, stream);
+    }
+    else
+    {
+        frameCount = BuildSyntheticStream(stream);
+    }
+
+    if(0 == frameCount)
+    {
+        return EXIT_FAILURE;
+    }
+
+    bool ok = true;
+
+    ok &= RunReceive("direct", stream, frameCount, 0);
+    ok &= RunReceive("buffered 64KiB", stream, frameCount, 65536);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
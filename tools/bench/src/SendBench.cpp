@@ -0,0 +1,183 @@
+/**
+ * @file tools/bench/src/SendBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of the pipelined TcpConnection send path.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <Packet.h>
+#include <TcpConnection.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Number of packets queued in each case.
+const std::size_t PACKET_COUNT = 200000;
+
+/**
+ * Connection that counts the frames that finished sending.
+ */
+class SinkConnection : public libcomp::TcpConnection
+{
+public:
+    explicit SinkConnection(asio::ip::tcp::socket& socket) :
+        libcomp::TcpConnection(socket, nullptr), mSent(0)
+    {
+    }
+
+    std::size_t Sent() const
+    {
+        return mSent;
+    }
+
+protected:
+    virtual void PacketSent(libcomp::ReadOnlyPacket& packet)
+    {
+        (void)packet;
+
+        mSent++;
+    }
+
+private:
+    std::size_t mSent;
+};
+
+/**
+ * Read from the socket until the expected number of bytes arrive.
+ * @param socket Socket to read from
+ * @param buffer Buffer to read into
+ * @param remaining Bytes left to read
+ */
+void Drain(asio::ip::tcp::socket& socket, std::vector<char>& buffer,
+    std::size_t& remaining)
+{
+    socket.async_read_some(asio::buffer(buffer), [&socket, &buffer,
+        &remaining](asio::error_code errorCode, std::size_t length)
+    {
+        remaining -= std::min(remaining, length);
+
+        if(!errorCode && 0 != remaining)
+        {
+            Drain(socket, buffer, remaining);
+        }
+    });
+}
+
+/**
+ * Send a flood of small packets over a loopback socket.
+ * @param name Name of the case
+ * @param sizes Size of each packet
+ * @param budget Send budget in bytes
+ * @return true if every packet was sent
+ */
+bool RunSend(const std::string& name, const std::vector<uint32_t>& sizes,
+    uint32_t budget)
+{
+    libcomp::TcpConnection::SetSendBudget(budget);
+
+    asio::io_service service;
+    asio::ip::tcp::acceptor acceptor(service, asio::ip::tcp::endpoint(
+        asio::ip::address_v4::loopback(), 0));
+    asio::ip::tcp::socket serverSocket(service);
+    asio::ip::tcp::socket clientSocket(service);
+
+    clientSocket.connect(acceptor.local_endpoint());
+    acceptor.accept(serverSocket);
+
+    auto connection = std::make_shared<SinkConnection>(serverSocket);
+
+    std::size_t remaining = 0;
+
+    for(uint32_t size : sizes)
+    {
+        remaining += size;
+    }
+
+    std::vector<char> readBuffer(65536);
+
+    auto before = libcomp::TcpConnection::GetSendStats();
+
+    bench::Stopwatch timer;
+
+    // Queue everything up front like a zone broadcast would.
+    service.post([&]()
+    {
+        for(uint32_t size : sizes)
+        {
+            libcomp::Packet p;
+            p.WriteBlank(size);
+
+            connection->SendPacket(p);
+        }
+    });
+
+    Drain(clientSocket, readBuffer, remaining);
+
+    service.run();
+
+    double elapsed = timer.Elapsed();
+
+    auto after = libcomp::TcpConnection::GetSendStats();
+    uint64_t writes = after.Writes - before.Writes;
+
+    bench::Report(name, static_cast<double>(sizes.size()), elapsed);
+
+    std::cout << "  " << writes << " writes for " << sizes.size()
+        << " packets, " << std::setprecision(3)
+        << (static_cast<double>(sizes.size()) / static_cast<double>(
+        writes ? writes : 1)) << " packets per write" << std::endl;
+
+    return connection->Sent() == sizes.size() && 0 == remaining;
+}
+
+} // namespace
+
+int bench::SendBench()
+{
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<uint32_t> bytes(16, 256);
+
+    std::vector<uint32_t> sizes;
+    sizes.reserve(PACKET_COUNT);
+
+    for(std::size_t i = 0; i < PACKET_COUNT; ++i)
+    {
+        sizes.push_back(bytes(rng));
+    }
+
+    bool ok = true;
+
+    // A budget of 1 byte only allows one frame at a time.
+    ok &= RunSend("one frame per write", sizes, 1);
+    ok &= RunSend("budget 64KiB", sizes, 65536);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,223 @@
+/**
+ * @file tools/bench/src/SpatialGridBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of zone range queries with and without a SpatialGrid.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <SpatialGrid.h>
+
+// Standard C++11 Includes
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+/// Stand-in for an entity state so the scan pays for the same indirection
+struct Entity
+{
+    virtual ~Entity() { }
+
+    int32_t id;
+    float x;
+    float y;
+};
+
+/// Stand-in for an active entity state
+struct ActiveEntity : public Entity
+{
+};
+
+/// Number of enemies in the zone
+const int32_t ENEMY_COUNT = 5000;
+
+/// Number of players in the zone
+const int32_t PLAYER_COUNT = 500;
+
+/// Width and height of the zone
+const float ZONE_SIZE = 40000.0f;
+
+/// Default AI aggro radius
+const float AGGRO_RADIUS = 2000.0f;
+
+/// Number of simulated AI ticks
+const int TICKS = 20;
+
+} // namespace
+
+int bench::SpatialGridBench()
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coord(0.0f, ZONE_SIZE);
+    std::uniform_real_distribution<float> step(-300.0f, 300.0f);
+
+    // Mirror Zone::mAllEntities for the full scan
+    std::unordered_map<int32_t, std::shared_ptr<Entity>> allEntities;
+    std::vector<std::shared_ptr<ActiveEntity>> entities;
+
+    libcomp::SpatialGrid<std::shared_ptr<ActiveEntity>> grid;
+
+    for(int32_t i = 0; i < ENEMY_COUNT + PLAYER_COUNT; ++i)
+    {
+        auto e = std::make_shared<ActiveEntity>();
+        e->id = i;
+        e->x = coord(rng);
+        e->y = coord(rng);
+
+        allEntities[i] = e;
+        entities.push_back(e);
+        grid.Insert(i, e->x, e->y, e);
+    }
+
+    auto moveAll = [&](bool updateGrid)
+    {
+        for(auto& e : entities)
+        {
+            e->x += step(rng);
+            e->y += step(rng);
+
+            if(updateGrid)
+            {
+                grid.Update(e->id, e->x, e->y);
+            }
+        }
+    };
+
+    // Every enemy looks for targets once per tick
+    size_t scanFound = 0;
+    {
+        Stopwatch sw;
+
+        for(int t = 0; t < TICKS; ++t)
+        {
+            moveAll(false);
+
+            for(int32_t i = 0; i < ENEMY_COUNT; ++i)
+            {
+                auto& source = entities[(size_t)i];
+                float rSquared = AGGRO_RADIUS * AGGRO_RADIUS;
+
+                std::list<std::shared_ptr<ActiveEntity>> results;
+                for(auto& ePair : allEntities)
+                {
+                    auto active = std::dynamic_pointer_cast<ActiveEntity>(
+                        ePair.second);
+                    if(!active)
+                    {
+                        continue;
+                    }
+
+                    float dx = active->x - source->x;
+                    float dy = active->y - source->y;
+
+                    if(rSquared >= (dx * dx) + (dy * dy))
+                    {
+                        results.push_back(active);
+                    }
+                }
+
+                scanFound += results.size();
+            }
+        }
+
+        Report("full scan radius query", (double)(TICKS * ENEMY_COUNT),
+            sw.Elapsed());
+    }
+
+    // Reset the positions so both runs see the same layout
+    rng.seed(42);
+    for(auto& e : entities)
+    {
+        e->x = coord(rng);
+        e->y = coord(rng);
+        grid.Update(e->id, e->x, e->y);
+    }
+
+    size_t gridFound = 0;
+    {
+        Stopwatch sw;
+
+        for(int t = 0; t < TICKS; ++t)
+        {
+            moveAll(true);
+
+            for(int32_t i = 0; i < ENEMY_COUNT; ++i)
+            {
+                auto& source = entities[(size_t)i];
+
+                std::list<std::shared_ptr<ActiveEntity>> results;
+                grid.QueryRadius(source->x, source->y, AGGRO_RADIUS,
+                    [&results](const std::shared_ptr<ActiveEntity>& active,
+                        float, float)
+                    {
+                        results.push_back(active);
+                    });
+
+                gridFound += results.size();
+            }
+        }
+
+        Report("grid radius query (incl. updates)",
+            (double)(TICKS * ENEMY_COUNT), sw.Elapsed());
+    }
+
+    // FoV checks for every enemy as the AI does when picking a target
+    {
+        Stopwatch sw;
+        size_t found = 0;
+
+        for(int t = 0; t < TICKS; ++t)
+        {
+            for(int32_t i = 0; i < ENEMY_COUNT; ++i)
+            {
+                auto& source = entities[(size_t)i];
+
+                grid.QueryCone(source->x, source->y, AGGRO_RADIUS, 0.0f,
+                    1.395f, [&found](const std::shared_ptr<ActiveEntity>&,
+                        float, float)
+                    {
+                        found++;
+                    });
+            }
+        }
+
+        Report("grid FoV query", (double)(TICKS * ENEMY_COUNT), sw.Elapsed());
+    }
+
+    if(scanFound != gridFound)
+    {
+        std::cerr << "Result mismatch: scan found " << scanFound
+            << " but grid found " << gridFound << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
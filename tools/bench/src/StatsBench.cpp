@@ -0,0 +1,238 @@
+/**
+ * @file tools/bench/src/StatsBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of entity stat tables stored in an EnumArray.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <EnumArray.h>
+#include <EnumMap.h>
+
+// Standard C++11 Includes
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+/// Stand-in for the CorrectTbl enum
+enum class Stat_t : uint8_t
+{
+    STR = 0,
+    MAGIC = 1,
+    VIT = 2,
+    INT = 3,
+    SPEED = 4,
+    LUCK = 5,
+    HP_MAX = 6,
+    MP_MAX = 7,
+    CLSR = 10,
+    LNGR = 11,
+    SPELL = 12,
+    SUPPORT = 13,
+    PDEF = 14,
+    MDEF = 15,
+};
+
+/// Number of stats the channel calculates for each entity
+const size_t STAT_COUNT = 126;
+
+/// Number of entities recalculated
+const size_t ENTITY_COUNT = 1000;
+
+/// Number of stat adjustments from equipment, tokusei and status effects
+const size_t ADJUST_COUNT = 40;
+
+/// Number of full recalculations of every entity
+const int PASSES = 50;
+
+/// A single numeric or percentage adjustment to a stat
+struct Adjustment
+{
+    Stat_t Stat;
+    int16_t Value;
+    bool Percent;
+};
+
+/**
+ * Clamp the way CharacterManager::AdjustStatBounds did with an EnumMap.
+ */
+void ClampMin(libcomp::EnumMap<Stat_t, int16_t>& stats,
+    const libcomp::EnumMap<Stat_t, int16_t>& minStats)
+{
+    for(auto pair : minStats)
+    {
+        auto it = stats.find(pair.first);
+        if(it != stats.end() && it->second < pair.second)
+        {
+            stats[pair.first] = pair.second;
+        }
+    }
+}
+
+/**
+ * Clamp the way CharacterManager::AdjustStatBounds does with an EnumArray.
+ */
+template<size_t Count>
+void ClampMin(libcomp::EnumArray<Stat_t, int16_t, Count>& stats,
+    const libcomp::EnumArray<Stat_t, int16_t, Count>& minStats)
+{
+    stats.ClampMin(minStats);
+}
+
+/**
+ * Run the same steps as ActiveEntityState::RecalculateStats for one entity:
+ * copy the base stats, sum and apply the adjustments, calculate the
+ * dependent stats and clamp to the minimums.
+ */
+template<typename Table, typename PercentTable>
+int64_t Recalculate(const Table& base,
+    const std::vector<Adjustment>& adjustments, const Table& minStats)
+{
+    Table stats = base;
+
+    PercentTable percentSums;
+    for(auto& adjust : adjustments)
+    {
+        if(adjust.Percent)
+        {
+            percentSums[adjust.Stat] = percentSums[adjust.Stat] +
+                adjust.Value;
+        }
+        else
+        {
+            stats[adjust.Stat] = (int16_t)(stats[adjust.Stat] + adjust.Value);
+        }
+    }
+
+    for(auto pair : percentSums)
+    {
+        int16_t& value = stats[pair.first];
+        value = (int16_t)(value + value * pair.second / 100);
+    }
+
+    stats[Stat_t::HP_MAX] = (int16_t)(stats[Stat_t::HP_MAX] +
+        stats[Stat_t::VIT] * 6);
+    stats[Stat_t::MP_MAX] = (int16_t)(stats[Stat_t::MP_MAX] +
+        stats[Stat_t::INT] * 3);
+    stats[Stat_t::CLSR] = (int16_t)(stats[Stat_t::CLSR] +
+        stats[Stat_t::STR]);
+    stats[Stat_t::LNGR] = (int16_t)(stats[Stat_t::LNGR] +
+        stats[Stat_t::SPEED]);
+    stats[Stat_t::SPELL] = (int16_t)(stats[Stat_t::SPELL] +
+        stats[Stat_t::MAGIC]);
+    stats[Stat_t::SUPPORT] = (int16_t)(stats[Stat_t::SUPPORT] +
+        stats[Stat_t::INT]);
+    stats[Stat_t::PDEF] = (int16_t)(stats[Stat_t::PDEF] +
+        stats[Stat_t::VIT]);
+    stats[Stat_t::MDEF] = (int16_t)(stats[Stat_t::MDEF] +
+        stats[Stat_t::INT]);
+
+    ClampMin(stats, minStats);
+
+    int64_t sum = 0;
+    for(auto pair : stats)
+    {
+        sum += pair.second;
+    }
+
+    return sum;
+}
+
+/**
+ * Time a full recalculation of every entity with one table type.
+ */
+template<typename Table, typename PercentTable>
+int64_t Run(const char *name, const std::vector<std::vector<Adjustment>>& all)
+{
+    Table base;
+    for(size_t i = 0; i < STAT_COUNT; i++)
+    {
+        base[(Stat_t)i] = (int16_t)(i % 50);
+    }
+
+    Table minStats;
+    for(size_t i = 0; i < 18; i++)
+    {
+        minStats[(Stat_t)i] = 1;
+    }
+
+    int64_t total = 0;
+
+    bench::Stopwatch sw;
+
+    for(int p = 0; p < PASSES; p++)
+    {
+        for(auto& adjustments : all)
+        {
+            total += Recalculate<Table, PercentTable>(base, adjustments,
+                minStats);
+        }
+    }
+
+    bench::Report(name, (double)(PASSES * (int)ENTITY_COUNT), sw.Elapsed());
+
+    return total;
+}
+
+} // namespace
+
+int bench::StatsBench()
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> stat(0, (int)STAT_COUNT - 1);
+    std::uniform_int_distribution<int> value(-20, 50);
+
+    std::vector<std::vector<Adjustment>> all(ENTITY_COUNT);
+    for(auto& adjustments : all)
+    {
+        for(size_t i = 0; i < ADJUST_COUNT; i++)
+        {
+            Adjustment adjust;
+            adjust.Stat = (Stat_t)stat(rng);
+            adjust.Value = (int16_t)value(rng);
+            adjust.Percent = (i % 4) == 0;
+
+            adjustments.push_back(adjust);
+        }
+    }
+
+    int64_t mapTotal = Run<libcomp::EnumMap<Stat_t, int16_t>,
+        libcomp::EnumMap<Stat_t, int32_t>>("EnumMap recalculate", all);
+    int64_t arrayTotal = Run<libcomp::EnumArray<Stat_t, int16_t, 128>,
+        libcomp::EnumArray<Stat_t, int32_t, 128>>("EnumArray recalculate",
+        all);
+
+    if(mapTotal != arrayTotal)
+    {
+        std::cerr << "Result mismatch: map total " << mapTotal
+            << " but array total " << arrayTotal << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
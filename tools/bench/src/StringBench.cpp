@@ -0,0 +1,153 @@
+/**
+ * @file tools/bench/src/StringBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of String argument formatting against the regex version.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <CString.h>
+#include <StringFormat.h>
+
+// Standard C++11 Includes
+#include <cstdlib>
+#include <regex_ext>
+
+namespace
+{
+
+/**
+ * The regex based String::Arg this replaced. Kept here as the baseline
+ * for the comparison.
+ * @param subject String to replace the first argument in
+ * @param a Argument to place into the string
+ * @return String with the argument added
+ */
+std::string LegacyArg(const std::string& subject, const std::string& a)
+{
+    auto callback = [&](const std::smatch& match)
+    {
+        int n = std::atoi(match.str(1).c_str());
+
+        if(1 == n)
+        {
+            return a;
+        }
+        else
+        {
+            return "%" + std::to_string(n - 1);
+        }
+    };
+
+    std::regex re("\\%([0-9]+)");
+
+    return std::regex_replace(subject.cbegin(), subject.cend(), re,
+        callback);
+}
+
+/// Number of strings formatted by each case
+const int FORMAT_COUNT = 200000;
+
+/// Format string shaped like a typical log line
+const char *FORMAT = "Failed to execute query: %1 on %2 (%3 of %4)\n";
+
+} // namespace
+
+int bench::StringBench()
+{
+    std::string expected = "Failed to execute query: SELECT * FROM "
+        "`Character` on 12 (3 of 4)\n";
+
+    bool ok = true;
+    size_t total = 0;
+
+    {
+        bench::Stopwatch sw;
+
+        for(int i = 0; i < FORMAT_COUNT; ++i)
+        {
+            std::string s = LegacyArg(LegacyArg(LegacyArg(LegacyArg(FORMAT,
+                "SELECT * FROM `Character`"), std::to_string(12)),
+                std::to_string(3)), std::to_string(4));
+            total += s.size();
+            ok = ok && s == expected;
+        }
+
+        bench::Report("regex Arg x4", (double)FORMAT_COUNT, sw.Elapsed());
+    }
+
+    {
+        bench::Stopwatch sw;
+
+        for(int i = 0; i < FORMAT_COUNT; ++i)
+        {
+            libcomp::String s = libcomp::String(FORMAT).Arg(
+                "SELECT * FROM `Character`").Arg(12).Arg(3).Arg(4);
+            total += s.Size();
+            ok = ok && s == expected;
+        }
+
+        bench::Report("single pass Arg x4", (double)FORMAT_COUNT,
+            sw.Elapsed());
+    }
+
+    {
+        bench::Stopwatch sw;
+
+        for(int i = 0; i < FORMAT_COUNT; ++i)
+        {
+            libcomp::String s = libcomp::String::Format(FORMAT,
+                "SELECT * FROM `Character`", 12, 3, 4);
+            total += s.Size();
+            ok = ok && s == expected;
+        }
+
+        bench::Report("String::Format", (double)FORMAT_COUNT, sw.Elapsed());
+    }
+
+    {
+        bench::Stopwatch sw;
+
+        static const libcomp::StringFormat format(FORMAT);
+
+        for(int i = 0; i < FORMAT_COUNT; ++i)
+        {
+            libcomp::String s = format.Format("SELECT * FROM `Character`",
+                12, 3, 4);
+            total += s.Size();
+            ok = ok && s == expected;
+        }
+
+        bench::Report("StringFormat", (double)FORMAT_COUNT, sw.Elapsed());
+    }
+
+    if(!ok || 0 == total)
+    {
+        std::cerr << "Formatted strings did not match" << std::endl;
+
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
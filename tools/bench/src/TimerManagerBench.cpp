@@ -0,0 +1,287 @@
+/**
+ * @file tools/bench/src/TimerManagerBench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Benchmark of TimerManager against the ordered set it replaced.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// libcomp Includes
+#include <TimerManager.h>
+
+// Standard C++11 Includes
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+/**
+ * The ordered set TimerManager used to be. Kept here as the baseline for
+ * the comparison. Periodic events are left out as the benchmark does not
+ * use them.
+ */
+class LegacyTimerManager
+{
+public:
+    struct Event
+    {
+        std::chrono::steady_clock::time_point time;
+        libcomp::Message::Execute *msg;
+    };
+
+    struct EventComp
+    {
+        bool operator()(const Event *lhs, const Event *rhs) const
+        {
+            return lhs->time < rhs->time;
+        }
+    };
+
+    LegacyTimerManager() : mRunning(true), mProcessingEvents(false)
+    {
+        mRunThread = std::thread([&]()
+        {
+            while(mRunning)
+            {
+                std::unique_lock<std::mutex> lock(mEventLock);
+
+                ProcessEvents(lock);
+
+                if(mEvents.empty())
+                {
+                    mEventCondition.wait(lock);
+                }
+                else
+                {
+                    (void)mEventCondition.wait_until(lock,
+                        (*mEvents.begin())->time);
+                }
+            }
+        });
+    }
+
+    ~LegacyTimerManager()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mEventLock);
+            mRunning = false;
+        }
+
+        mEventCondition.notify_all();
+        mRunThread.join();
+
+        for(Event *pEvent : mEvents)
+        {
+            delete pEvent->msg;
+            delete pEvent;
+        }
+    }
+
+    template<typename Function, typename... Args>
+    Event* ScheduleEvent(const std::chrono::steady_clock::time_point& time,
+        Function&& f, Args&&... args)
+    {
+        Event *pEvent = new Event;
+        pEvent->time = time;
+        pEvent->msg = new libcomp::Message::ExecuteImpl<Args...>(
+            std::forward<Function>(f), std::forward<Args>(args)...);
+
+        std::unique_lock<std::mutex> lock(mEventLock);
+
+        mEvents.insert(pEvent);
+        mEventCondition.notify_all();
+
+        return pEvent;
+    }
+
+    void CancelEvent(Event *pEvent)
+    {
+        std::unique_lock<std::mutex> lock(mEventLock);
+
+        if(mProcessingEvents)
+        {
+            return;
+        }
+
+        // The original used find() which can return another event with
+        // the same time, look for the exact event instead
+        auto range = mEvents.equal_range(pEvent);
+        auto it = std::find(range.first, range.second, pEvent);
+
+        if(range.second != it)
+        {
+            mEvents.erase(it);
+
+            delete pEvent->msg;
+            delete pEvent;
+        }
+
+        mEventCondition.notify_all();
+    }
+
+private:
+    void ProcessEvents(std::unique_lock<std::mutex>& lock)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        mProcessingEvents = true;
+
+        while(!mEvents.empty())
+        {
+            auto it = mEvents.begin();
+            Event *pEvent = *it;
+
+            if(pEvent->time > now)
+            {
+                break;
+            }
+
+            mEvents.erase(it);
+
+            lock.unlock();
+            pEvent->msg->Run();
+            lock.lock();
+
+            delete pEvent->msg;
+            delete pEvent;
+        }
+
+        mProcessingEvents = false;
+    }
+
+    volatile bool mRunning;
+    volatile bool mProcessingEvents;
+    std::multiset<Event*, EventComp> mEvents;
+    std::condition_variable mEventCondition;
+    std::mutex mEventLock;
+    std::thread mRunThread;
+};
+
+/// Number of timers pending at once
+const int TIMER_COUNT = 100000;
+
+/// Earliest a timer expires in milliseconds, late enough that every timer
+/// is scheduled and cancelled before the first one runs
+const int TIMER_MIN = 1000;
+
+/// Latest a timer expires in milliseconds
+const int TIMER_MAX = 3000;
+
+/**
+ * Schedule TIMER_COUNT timers, cancel half of them and wait for the rest
+ * to run.
+ * @param name Name of the timer implementation
+ * @return true if every timer that was not cancelled ran
+ */
+template<class Timers, class Event>
+bool RunTimers(const std::string& name)
+{
+    Timers timers;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> delay(TIMER_MIN, TIMER_MAX);
+
+    std::atomic<int> fired(0);
+    std::atomic<int64_t> maxLate(0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Event*> events;
+    events.reserve((size_t)TIMER_COUNT);
+
+    {
+        bench::Stopwatch sw;
+
+        for(int i = 0; i < TIMER_COUNT; ++i)
+        {
+            auto due = start + std::chrono::microseconds(
+                delay(rng) * 1000 + i % 1000);
+
+            events.push_back(timers.ScheduleEvent(due, [&fired, &maxLate](
+                std::chrono::steady_clock::time_point t)
+                {
+                    int64_t late = std::chrono::duration_cast<
+                        std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - t).count();
+
+                    int64_t current = maxLate;
+                    while(late > current &&
+                        !maxLate.compare_exchange_weak(current, late));
+
+                    fired++;
+                }, due));
+        }
+
+        bench::Report(name + " schedule", (double)TIMER_COUNT,
+            sw.Elapsed());
+    }
+
+    {
+        bench::Stopwatch sw;
+
+        for(size_t i = 0; i < events.size(); i += 2)
+        {
+            timers.CancelEvent(events[i]);
+        }
+
+        bench::Report(name + " cancel", (double)(TIMER_COUNT / 2),
+            sw.Elapsed());
+    }
+
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(
+        TIMER_MAX + 500));
+
+    std::cout << std::left << std::setw(40) << (name + " max lateness")
+        << std::right << std::setw(14) << maxLate.load() << " us"
+        << std::endl;
+
+    if(fired != TIMER_COUNT / 2)
+    {
+        std::cerr << name << " ran " << fired << " timers but expected "
+            << (TIMER_COUNT / 2) << std::endl;
+
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+int bench::TimerManagerBench()
+{
+    bool ok = RunTimers<LegacyTimerManager, LegacyTimerManager::Event>(
+        "ordered set");
+    ok = RunTimers<libcomp::TimerManager, libcomp::TimerEvent>(
+        "timing wheel") && ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
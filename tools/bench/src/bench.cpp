@@ -0,0 +1,89 @@
+/**
+ * @file tools/bench/src/bench.cpp
+ * @ingroup tools
+ *
+ * @author COMP Omega <compomega@tutanota.com>
+ *
+ * @brief Entry point for the micro-benchmarks.
+ *
+ * This tool runs micro-benchmarks of libcomp components.
+ *
+ * Copyright (C) 2012-2018 COMP_hack Team <compomega@tutanota.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Bench.h"
+
+// Standard C++11 Includes
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+int main(int argc, char *argv[])
+{
+    static const std::vector<std::pair<const char*, int (*)()>> benchmarks = {
+        { "blowfish", &bench::BlowfishBench },
+        { "handshake", &bench::HandshakeBench },
+        { "messagequeue", &bench::MessageQueueBench },
+        { "objectcache", &bench::ObjectCacheBench },
+        { "receive", &bench::ReceiveBench },
+        { "send", &bench::SendBench },
+        { "spatialgrid", &bench::SpatialGridBench },
+        { "stats", &bench::StatsBench },
+        { "string", &bench::StringBench },
+        { "timermanager", &bench::TimerManagerBench },
+    };
+
+    int result = EXIT_SUCCESS;
+    bool found = false;
+
+    for(auto& benchmark : benchmarks)
+    {
+        bool run = 1 == argc;
+
+        for(int i = 1; !run && i < argc; ++i)
+        {
+            run = 0 == strcmp(argv[i], benchmark.first);
+        }
+
+        if(run)
+        {
+            std::cout << "== " << benchmark.first << " ==" << std::endl;
+
+            if(EXIT_SUCCESS != benchmark.second())
+            {
+                result = EXIT_FAILURE;
+            }
+
+            found = true;
+        }
+    }
+
+    if(!found)
+    {
+        std::cerr << "USAGE: " << argv[0] << " [BENCHMARK...]" << std::endl
+            << "Available benchmarks:" << std::endl;
+
+        for(auto& benchmark : benchmarks)
+        {
+            std::cerr << "  " << benchmark.first << std::endl;
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    return result;
+}